@@ -21,9 +21,11 @@ CPP_VERSION          = "C++20"
 SOLUTION_NAME        = "spartan"
 EDITOR_PROJECT_NAME  = "editor"
 RUNTIME_PROJECT_NAME = "runtime"
+TESTS_PROJECT_NAME   = "tests"
 EXECUTABLE_NAME      = "spartan"
 EDITOR_DIR           = "../" .. EDITOR_PROJECT_NAME
 RUNTIME_DIR          = "../" .. RUNTIME_PROJECT_NAME
+TESTS_DIR            = "../" .. TESTS_PROJECT_NAME
 LIBRARY_DIR          = "../third_party/libraries"
 OBJ_DIR              = "../binaries/obj"
 TARGET_DIR           = "../binaries"
@@ -348,7 +350,57 @@ function editor_project_configuration()
             end
 end
 
+function tests_project_configuration()
+    project (TESTS_PROJECT_NAME)
+        location (TESTS_DIR)
+        links (RUNTIME_PROJECT_NAME)
+        dependson (RUNTIME_PROJECT_NAME)
+        objdir (OBJ_DIR)
+        cppdialect (CPP_VERSION)
+        kind "ConsoleApp"
+        staticruntime "On"
+        defines{ API_CPP_DEFINE }
+        if os.target() == "windows" then
+            conformancemode "On"
+        end
+
+        -- Files
+        files
+        {
+            TESTS_DIR .. "/**.h",
+            TESTS_DIR .. "/**.cpp",
+            EDITOR_DIR .. "/Widgets/WorldHierarchy.cpp"     -- it doesn't depend on imgui, so it's tested directly
+        }
+
+        -- Includes
+        includedirs { RUNTIME_DIR }
+        includedirs { RUNTIME_DIR .. "/Core" }                 -- this is here because the runtime uses it
+        includedirs { EDITOR_DIR }
+        if os.target() == "windows" then
+            includedirs { "../third_party/meshoptimizer" }     -- the geometry processing header uses it
+            includedirs { "../third_party/physx" }             -- the physics test creates colliders directly
+        else
+            includedirs { "/usr/include/physx" }
+        end
+
+        -- Libraries
+        libdirs (LIBRARY_DIR)
+
+        -- "Release"
+        filter "configurations:release"
+            targetname ( TESTS_PROJECT_NAME )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+
+        -- "Debug"
+        filter "configurations:debug"
+            targetname ( TESTS_PROJECT_NAME .. "_debug" )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+end
+
 configure_graphics_api()
 solution_configuration()
 runtime_project_configuration()
 editor_project_configuration()
+tests_project_configuration()
@@ -22,6 +22,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 static const float sea_level  = 0.0f;
 static const float snow_level = 400.0f;
 
+// cdlod patches, these mirror TerrainQuadtree.h
+static const float cdlod_patch_resolution = 32.0f; // quads per side of the patch
+static const float cdlod_range_scale      = 4.0f;  // the range of a lod, in node sizes
+static const float cdlod_morph_start      = 0.75f; // where, within its range, a lod starts morphing to the next
+static const uint cdlod_max_morph_levels  = 8;     // how many coarser lods a vertex can morph through
+
 static float get_snow_blend_factor(float3 position_world, float3 normal_world)
 {
     const float snow_blend_speed = 0.06f; // transition sharpness
@@ -159,6 +159,69 @@ struct vertex_processing
         }
     };
 
+    // continuous distance-dependent level of detail
+    struct terrain
+    {
+        // the page is a grid of (normal, height) texels, its first row is a header: the position of the first texel and
+        // the texel spacing, followed by the rectangle the whole terrain covers (for the uvs)
+        static float4 load_page(float2 position_xz, float4 page, uint2 page_size)
+        {
+            int2 texel = int2(round((position_xz - page.xy) / page.z));
+            texel      = clamp(texel, int2(0, 0), int2(page_size.x - 1, page_size.y - 2));
+
+            return tex.Load(int3(texel.x, texel.y + 1, 0));
+        }
+
+        // rounding to the grid first keeps the parity exact
+        static float2 morph_coordinate(float2 coordinate, float spacing, float morph)
+        {
+            float2 grid = round(coordinate / spacing);
+            float2 odd  = grid - 2.0f * floor(grid * 0.5f);
+
+            return (grid - odd * morph) * spacing;
+        }
+
+        // the patch is a unit grid, the instance transform places and scales it over a quadtree node, heights come from the page in tex
+        static void apply_cdlod(inout Vertex_PosUvNorTan input, inout gbuffer_vertex vertex, matrix transform)
+        {
+            float4 page   = tex.Load(int3(0, 0, 0));
+            float4 extent = tex.Load(int3(1, 0, 0));
+            uint2 page_size;
+            tex.GetDimensions(page_size.x, page_size.y);
+
+            // relative to the corner of the terrain, the node grids are aligned to it
+            float node_size = length(transform[0].xyz);
+            float spacing   = node_size / cdlod_patch_resolution;
+            float2 local    = round((transform[3].xz - extent.xy + input.position.xz * node_size) / spacing) * spacing;
+
+            // odd vertices slide onto their even neighbours as the end of the range approaches, a vertex which is fully morphed
+            // carries on into the next coarser lod, so nodes drawn in place of their parent match it (see TerrainQuadtree::MorphVertex())
+            float range = node_size * cdlod_range_scale;
+            [loop]
+            for (uint level = 0; level < cdlod_max_morph_levels; level++)
+            {
+                float2 position_xz = extent.xy + local;
+                float height       = load_page(clamp(position_xz, extent.xy, extent.xy + extent.zw), page, page_size).w;
+                float distance     = length(float3(position_xz.x, height, position_xz.y) - buffer_frame.camera_position);
+                float morph        = saturate((distance - range * cdlod_morph_start) / (range * (1.0f - cdlod_morph_start)));
+                local              = morph_coordinate(local, spacing, morph);
+                if (morph < 1.0f)
+                    break;
+
+                spacing *= 2.0f;
+                range   *= 2.0f;
+            }
+
+            float2 position_xz       = clamp(extent.xy + local, extent.xy, extent.xy + extent.zw);
+            float4 texel             = load_page(position_xz, page, page_size);
+            vertex.position          = float3(position_xz.x, texel.w, position_xz.y);
+            vertex.position_previous = vertex.position;
+            vertex.normal            = normalize(texel.xyz);
+            vertex.tangent           = normalize(float3(1.0f, 0.0f, 0.0f) - vertex.normal * vertex.normal.x);
+            input.uv                 = (position_xz - extent.xy) / extent.zw;
+        }
+    };
+
     static void process_local_space(Surface surface, inout Vertex_PosUvNorTan input, inout gbuffer_vertex vertex, float width_percent, uint instance_id)
     {
         if (!surface.is_grass_blade())
@@ -326,6 +389,12 @@ gbuffer_vertex transform_to_world_space(Vertex_PosUvNorTan input, uint instance_
     vertex.normal            = normalize(mul(input.normal, (float3x3)transform));
     vertex.tangent           = normalize(mul(input.tangent, (float3x3)transform));
 
+    // terrain patches are displaced by the heights of the page they are drawn with
+    if (surface.is_terrain() && is_instanced)
+    {
+        vertex_processing::terrain::apply_cdlod(input, vertex, transform);
+    }
+
     // compute (world-space) uv
     float3 abs_normal = abs(vertex.normal); // absolute normal for weights
     float3 weights    = abs_normal / (abs_normal.x + abs_normal.y + abs_normal.z + FLT_MIN); // normalize weights
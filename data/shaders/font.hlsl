@@ -39,16 +39,14 @@ vertex main_vs(vertex input)
 
 float4 main_ps(vertex input) : SV_TARGET
 {
-    float4 color = float4(0.0f, 0.0f, 0.0f, 1.0f);
-    
-    // sample text from texture atlas
-    color.r = tex.Sample(samplers[sampler_bilinear_clamp], input.uv).r;
-    color.g = color.r;
-    color.b = color.r;
-    color.a = color.r;
+    // sample the distance from the atlas, 0.5 is the glyph edge, higher values are inside
+    float distance = tex.Sample(samplers[sampler_bilinear_clamp], input.uv).r;
 
-    // color it
-    color *= float4(pass_get_f4_value().rgb, 1.0f);
+    // keep the band of distances this pass draws (the glyph, or its outline), anti-aliased over a screen pixel
+    float2 band     = pass_get_f3_value().xy;
+    float smoothing = max(fwidth(distance) * 0.5f, 0.0001f);
+    float alpha     = smoothstep(band.x - smoothing, band.x + smoothing, distance) * (1.0f - smoothstep(band.y - smoothing, band.y + smoothing, distance));
 
-    return color;
+    // color it
+    return float4(pass_get_f4_value().rgb, 1.0f) * alpha;
 }
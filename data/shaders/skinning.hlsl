@@ -0,0 +1,102 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========
+#include "common.hlsl"
+//====================
+
+// the bind pose vertices, each followed by its bones and weights, see Mesh::CreateGpuBuffers()
+RWStructuredBuffer<uint> skin_source     : register(u20);
+// skinning matrices, as written by the animator, four columns each
+RWStructuredBuffer<float4> skin_palettes : register(u21);
+// the geometry pool vertex buffer, the mesh is deformed in place
+RWStructuredBuffer<uint> skin_output     : register(u22);
+
+static const uint vertex_stride = 11;                // position, uv, normal and tangent, as in RHI_Vertex_PosTexNorTan
+static const uint source_stride = vertex_stride + 8; // followed by 4 bone indices and 4 weights
+
+float3 transform_direction(float3 direction, float4 column_x, float4 column_y, float4 column_z)
+{
+    float3 transformed = float3(dot(float4(direction, 0.0f), column_x), dot(float4(direction, 0.0f), column_y), dot(float4(direction, 0.0f), column_z));
+    return any(transformed) ? normalize(transformed) : transformed; // meshes without tangents have them zeroed
+}
+
+float3 load_float3(uint index)
+{
+    return asfloat(uint3(skin_source[index], skin_source[index + 1], skin_source[index + 2]));
+}
+
+void store_float3(uint index, float3 value)
+{
+    skin_output[index + 0] = asuint(value.x);
+    skin_output[index + 1] = asuint(value.y);
+    skin_output[index + 2] = asuint(value.z);
+}
+
+[numthreads(256, 1, 1)]
+void main_cs(uint3 dispatch_thread_id : SV_DispatchThreadID)
+{
+    // x: vertex count, y: where the mesh starts in the pool, z: where its palette starts (all stored as raw bits)
+    uint4 values        = asuint(pass_get_f4_value());
+    uint vertex_index   = dispatch_thread_id.x;
+    uint vertex_count   = values.x;
+    uint pool_offset    = values.y;
+    uint palette_offset = values.z;
+    if (vertex_index >= vertex_count)
+        return;
+
+    uint source     = vertex_index * source_stride;
+    float3 position = load_float3(source + 0);
+    float3 normal   = load_float3(source + 5);
+    float3 tangent  = load_float3(source + 8);
+    uint4 bones     = uint4(skin_source[source + 11], skin_source[source + 12], skin_source[source + 13], skin_source[source + 14]);
+    float4 weights  = asfloat(uint4(skin_source[source + 15], skin_source[source + 16], skin_source[source + 17], skin_source[source + 18]));
+
+    // blend the first three columns of the bone matrices, the fourth is always (0, 0, 0, 1)
+    float4 column_x = float4(1.0f, 0.0f, 0.0f, 0.0f);
+    float4 column_y = float4(0.0f, 1.0f, 0.0f, 0.0f);
+    float4 column_z = float4(0.0f, 0.0f, 1.0f, 0.0f);
+    if (dot(weights, 1.0f) > 0.0f) // vertices without weights keep their bind pose
+    {
+        column_x = 0.0f;
+        column_y = 0.0f;
+        column_z = 0.0f;
+        for (uint i = 0; i < 4; i++)
+        {
+            uint matrix_index = (palette_offset + bones[i]) * 4;
+            column_x += skin_palettes[matrix_index + 0] * weights[i];
+            column_y += skin_palettes[matrix_index + 1] * weights[i];
+            column_z += skin_palettes[matrix_index + 2] * weights[i];
+        }
+    }
+
+    position = float3(dot(float4(position, 1.0f), column_x), dot(float4(position, 1.0f), column_y), dot(float4(position, 1.0f), column_z));
+    normal   = transform_direction(normal,  column_x, column_y, column_z);
+    tangent  = transform_direction(tangent, column_x, column_y, column_z);
+
+    // write the vertex, the uv doesn't change
+    uint output = (pool_offset + vertex_index) * vertex_stride;
+    store_float3(output + 0, position);
+    skin_output[output + 3] = skin_source[source + 3];
+    skin_output[output + 4] = skin_source[source + 4];
+    store_float3(output + 5, normal);
+    store_float3(output + 8, tangent);
+}
@@ -53,7 +53,7 @@ namespace
 
     void process_event(spartan::sp_variant data)
     {
-        SDL_Event* event_sdl = static_cast<SDL_Event*>(get<void*>(data));
+        SDL_Event* event_sdl = get<SDL_Event*>(data);
         ImGui_ImplSDL3_ProcessEvent(event_sdl);
     }
 }
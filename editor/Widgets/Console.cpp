@@ -56,6 +56,45 @@ Console::~Console()
     Log::SetLogger(nullptr);
 }
 
+void Console::OnTick()
+{
+    // take what the engine logged since the last tick, the lock is only held for a swap
+    deque<LogPackage> logs_new;
+    {
+        lock_guard lock(m_mutex);
+        logs_new.swap(m_logs_pending);
+    }
+
+    for (LogPackage& package : logs_new)
+    {
+        // update count
+        m_log_type_count[package.error_level]++;
+
+        // only the new log has to be tested against the filters
+        if (PassesFilter(package))
+        {
+            m_logs_visible.push_back(m_log_index_front + m_logs.size());
+
+            // if the user is displaying this type of messages, scroll to bottom
+            m_scroll_to_bottom = true;
+        }
+
+        m_logs.push_back(move(package));
+    }
+
+    // drop the oldest logs, and their visible indices
+    while (static_cast<uint32_t>(m_logs.size()) > m_log_max_count)
+    {
+        m_logs.pop_front();
+        m_log_index_front++;
+    }
+
+    while (!m_logs_visible.empty() && m_logs_visible.front() < m_log_index_front)
+    {
+        m_logs_visible.pop_front();
+    }
+}
+
 void Console::OnTickVisible()
 {
     // clear button
@@ -72,7 +111,8 @@ void Console::OnTickVisible()
         ImGui::PushStyleColor(ImGuiCol_Button, visibility ? ImGui::GetStyle().Colors[ImGuiCol_Button] : ImGui::GetStyle().Colors[ImGuiCol_FrameBg]);
         if (ImGuiSp::image_button(nullptr, IconType::Console, 15.0f * spartan::Window::GetDpiScale(), false, m_log_type_color[index]))
         {
-            visibility = !visibility;
+            visibility     = !visibility;
+            m_filter_dirty = true;
         }
         ImGui::PopStyleColor();
         ImGui::SameLine();
@@ -87,11 +127,17 @@ void Console::OnTickVisible()
 
     // text filter
     const float label_width = 37.0f * spartan::Window::GetDpiScale();
-    m_log_filter.Draw("Filter", ImGui::GetContentRegionAvail().x - label_width);
+    if (m_log_filter.Draw("Filter", ImGui::GetContentRegionAvail().x - label_width))
+    {
+        m_filter_dirty = true;
+    }
     ImGui::Separator();
 
-    // safety first
-    lock_guard lock(m_mutex);
+    // the filters changed, so every kept log has to be tested again
+    if (m_filter_dirty)
+    {
+        FilterRebuild();
+    }
 
     // content properties
     static const ImGuiTableFlags table_flags =
@@ -105,14 +151,15 @@ void Console::OnTickVisible()
     // content
     if (ImGui::BeginTable("##widget_console_content", 1, table_flags, size))
     {
-        // logs
-        for (uint32_t row = 0; row < m_logs.size(); row++)
+        // logs, only the rows that are in view are submitted
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(m_logs_visible.size()));
+        while (clipper.Step())
         {
-            LogPackage& log = m_logs[row];
-
-            // text and visibility filters
-            if (m_log_filter.PassFilter(log.text.c_str()) && m_log_type_visibility[log.error_level])
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
             {
+                LogPackage& log = m_logs[static_cast<size_t>(m_logs_visible[row] - m_log_index_front)];
+
                 // switch row
                 ImGui::TableNextRow();
                 ImGui::TableSetColumnIndex(0);
@@ -155,6 +202,7 @@ void Console::OnTickVisible()
                 ImGui::PopID();
             }
         }
+        clipper.End();
 
         // scroll to bottom (if requested)
         if (m_scroll_to_bottom)
@@ -169,29 +217,27 @@ void Console::OnTickVisible()
 
 void Console::AddLogPackage(const LogPackage& package)
 {
+    // called by the engine's log writer thread
     lock_guard lock(m_mutex);
 
-    // save to deque
-    m_logs.push_back(package);
-    if (static_cast<uint32_t>(m_logs.size()) > m_log_max_count)
-    {
-        m_logs.pop_front();
-    }
-
-    // update count
-    m_log_type_count[package.error_level]++;
-
-    // if the user is displaying this type of messages, scroll to bottom
-    if (m_log_type_visibility[package.error_level])
+    m_logs_pending.push_back(package);
+    if (static_cast<uint32_t>(m_logs_pending.size()) > m_log_max_count)
     {
-        m_scroll_to_bottom = true;
+        m_logs_pending.pop_front();
     }
 }
 
 void Console::Clear()
 {
+    {
+        lock_guard lock(m_mutex);
+        m_logs_pending.clear();
+    }
+
     m_logs.clear();
     m_logs.shrink_to_fit();
+    m_logs_visible.clear();
+    m_log_index_front = 0;
 
     m_log_type_count[0] = 0;
     m_log_type_count[1] = 0;
@@ -199,3 +245,22 @@ void Console::Clear()
 
     spartan::Log::Clear();
 }
+
+void Console::FilterRebuild()
+{
+    m_logs_visible.clear();
+    for (size_t i = 0; i < m_logs.size(); i++)
+    {
+        if (PassesFilter(m_logs[i]))
+        {
+            m_logs_visible.push_back(m_log_index_front + i);
+        }
+    }
+
+    m_filter_dirty = false;
+}
+
+bool Console::PassesFilter(const LogPackage& package)
+{
+    return m_log_type_visibility[package.error_level] && m_log_filter.PassFilter(package.text.c_str());
+}
@@ -66,12 +66,17 @@ class Console : public Widget
     Console(Editor* editor);
     ~Console();
 
+    void OnTick() override;
     void OnTickVisible() override;
     void AddLogPackage(const LogPackage& package);
     void Clear();
 
 private:
+    void FilterRebuild();
+    bool PassesFilter(const LogPackage& package);
+
     bool m_scroll_to_bottom       = false;
+    bool m_filter_dirty           = false;
     uint32_t m_log_max_count      = 1000;
     bool m_log_type_visibility[3] = { true, true, true };
     uint32_t m_log_type_count[3]  = { 0, 0, 0 };
@@ -84,7 +89,10 @@ class Console : public Widget
     };
 
     std::shared_ptr<EngineLogger> m_logger;
+    std::deque<LogPackage> m_logs_pending; // filled by the engine's log writer, consumed on the main thread
     std::deque<LogPackage> m_logs;
+    std::deque<uint64_t> m_logs_visible;   // indices (counted from the first log ever kept) of the logs that pass the filters
+    uint64_t m_log_index_front = 0;        // index of m_logs.front()
     std::mutex m_mutex;
     ImGuiTextFilter m_log_filter;
 };
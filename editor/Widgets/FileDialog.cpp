@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../ImGui/Source/imgui_stdlib.h"
 #include "../Widgets/Viewport.h"
 #include "Rendering/Mesh.h"
+#include "Core/ThreadPool.h"
 #include <Rendering/Material.h>
 //=========================================
 
@@ -38,12 +39,6 @@ namespace
 {
     #define OPERATION_NAME (m_operation == FileDialog_Op_Open) ? "Open"      : (m_operation == FileDialog_Op_Load)   ? "Load"       : (m_operation == FileDialog_Op_Save) ? "Save" : "View"
     #define FILTER_NAME    (m_filter == FileDialog_Filter_All) ? "All (*.*)" : (m_filter == FileDialog_Filter_Model) ? "Model(*.*)" : "World (*.world)"
-
-    void set_cursor_position_x(float pos_x)
-    {
-        ImGui::SetCursorPosX(pos_x);
-        ImGui::Dummy(ImVec2(0, 0)); // imgui requirement to avoid assert
-    }
 }
 
 FileDialog::FileDialog(const bool standalone_window, const FileDialog_Type type, const FileDialog_Operation operation, const FileDialog_Filter filter)
@@ -80,6 +75,13 @@ bool FileDialog::Show(bool* is_visible, Editor* editor, string* directory /*= nu
     m_is_hovering_item   = false;
     m_is_hovering_window = false;
 
+    // pick up the items once the scan of the directory is done
+    if (m_scan && m_scan->done.load(memory_order_acquire))
+    {
+        m_items = move(m_scan->items);
+        m_scan  = nullptr;
+    }
+
     ShowTop(is_visible, editor); // top menu
     ShowMiddle();                // contents of the current directory
     ShowBottom(is_visible);      // bottom menu
@@ -173,8 +175,6 @@ void FileDialog::ShowMiddle()
     const float label_height  = font_height;
     const float text_offset   = 3.0f;
     float pen_x_min           = 0.0f;
-    float pen_x               = 0.0f;
-    bool new_line             = true;
     m_displayed_item_count    = 0;
     ImRect rect_button;
     ImRect rect_label;
@@ -190,204 +190,204 @@ void FileDialog::ShowMiddle()
         {
             float offset = ImGui::GetStyle().ItemSpacing.x;
             pen_x_min    = ImGui::GetCursorPosX() + offset;
-            set_cursor_position_x(pen_x_min);
         }
 
-        // Go through all the items
-        for (int i = 0; i < m_items.size(); i++)
+        // filter first, so that only the rows which are visible have to be laid out
+        m_items_filtered.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_items.size()); i++)
         {
-            // Get item to be displayed
-            auto& item = m_items[i];
-
-            // Apply search filter
-            if (!m_search_filter.PassFilter(item.GetLabel().c_str()))
-                continue;
-
-            m_displayed_item_count++;
-
-            // Start new line ?
-            if (new_line)
+            if (m_search_filter.PassFilter(m_items[i].GetLabel().c_str()))
             {
-                ImGui::BeginGroup();
-                new_line = false;
+                m_items_filtered.push_back(i);
             }
+        }
+        m_displayed_item_count = static_cast<uint32_t>(m_items_filtered.size());
 
-            ImGui::BeginGroup();
-            {
-                // Compute rectangles for elements that make up an item
-                {
-                    rect_button = ImRect
-                    (
-                        ImGui::GetCursorScreenPos().x,
-                        ImGui::GetCursorScreenPos().y,
-                        ImGui::GetCursorScreenPos().x + m_item_size.x,
-                        ImGui::GetCursorScreenPos().y + m_item_size.y
-                    );
-
-                    rect_label = ImRect
-                    (
-                        rect_button.Min.x,
-                        rect_button.Max.y - label_height - style.FramePadding.y,
-                        rect_button.Max.x,
-                        rect_button.Max.y
-                    );
-                }
+        // items have a fixed size, so the grid can be clipped by rows
+        const float item_stride_x   = m_item_size.x + style.ItemSpacing.x;
+        const uint32_t column_count = max(1u, static_cast<uint32_t>((content_width - pen_x_min) / item_stride_x));
+        const uint32_t row_count    = (m_displayed_item_count + column_count - 1) / column_count;
 
-                // Drop shadow effect
-                if (m_drop_shadow)
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(row_count), m_item_size.y + style.ItemSpacing.y);
+        while (clipper.Step())
+        {
+            for (uint32_t row = static_cast<uint32_t>(clipper.DisplayStart); row < static_cast<uint32_t>(clipper.DisplayEnd); row++)
+            {
+                const ImVec2 row_position = ImVec2(pen_x_min, ImGui::GetCursorPosY());
+                for (uint32_t column = 0; column < column_count; column++)
                 {
-                    static const float shadow_thickness = 2.0f;
-                    ImVec4 color = {1.0f, 1.0f, 4.0f, 0.1f};
-                    ImGui::GetWindowDrawList()->AddRectFilled(
-                        rect_button.Min,
-                        ImVec2(rect_label.Max.x + shadow_thickness, rect_label.Max.y + shadow_thickness),
-                        IM_COL32(color.x * 255, color.y * 255, color.z * 255, color.w * 255),
-                        5.0f);
-                }
+                    const uint32_t index_filtered = row * column_count + column;
+                    if (index_filtered >= m_displayed_item_count)
+                        break;
 
-                // THUMBNAIL
-                {
-                    ImGui::PushID(i);
-                    ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 0));
-                    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1.0f, 1.0f, 1.0f, 0.0f));
-                    ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 5.0f);
+                    const uint32_t i = m_items_filtered[index_filtered];
+                    auto& item       = m_items[i];
+                    ImGui::SetCursorPos(ImVec2(row_position.x + column * item_stride_x, row_position.y));
 
-                    if (ImGuiSp::button("##dummy", m_item_size))
+                    ImGui::BeginGroup();
                     {
-                        // Determine type of click
-                        item.Clicked();
-                        const bool is_single_click = item.GetTimeSinceLastClickMs() > 500;
-
-                        if (is_single_click)
+                        // Compute rectangles for elements that make up an item
                         {
-                            // Updated input box
-                            m_input_box = item.GetLabel();
-                            // Callback
-                            if (m_callback_on_item_clicked) m_callback_on_item_clicked(item.GetPath());
-                        }
-                        else // Double Click
-                        {
-                            m_current_path   = item.GetPath();
-                            m_is_dirty       = true;
-                            m_selection_made = !item.IsDirectory();
-
-                            // When browsing files, open them on double click
-                            if (m_type == FileDialog_Type_Browser)
-                            {
-                                if (!item.IsDirectory())
-                                {
-                                    FileSystem::OpenUrl(item.GetPath());
-                                }
-                            }
+                            rect_button = ImRect
+                            (
+                                ImGui::GetCursorScreenPos().x,
+                                ImGui::GetCursorScreenPos().y,
+                                ImGui::GetCursorScreenPos().x + m_item_size.x,
+                                ImGui::GetCursorScreenPos().y + m_item_size.y
+                            );
 
-                            // Callback
-                            if (m_callback_on_item_double_clicked)
-                            {
-                                m_callback_on_item_double_clicked(m_current_path);
-                            }
+                            rect_label = ImRect
+                            (
+                                rect_button.Min.x,
+                                rect_button.Max.y - label_height - style.FramePadding.y,
+                                rect_button.Max.x,
+                                rect_button.Max.y
+                            );
                         }
-                    }
 
-                    // Item functionality
-                    {
-                        // Manually detect some useful states
-                        if (ImGui::IsItemHovered(ImGuiHoveredFlags_RectOnly))
+                        // Drop shadow effect
+                        if (m_drop_shadow)
                         {
-                            m_is_hovering_item = true;
-                            m_hovered_item_path = item.GetPath();
+                            static const float shadow_thickness = 2.0f;
+                            ImVec4 color = {1.0f, 1.0f, 4.0f, 0.1f};
+                            ImGui::GetWindowDrawList()->AddRectFilled(
+                                rect_button.Min,
+                                ImVec2(rect_label.Max.x + shadow_thickness, rect_label.Max.y + shadow_thickness),
+                                IM_COL32(color.x * 255, color.y * 255, color.z * 255, color.w * 255),
+                                5.0f);
                         }
 
-                        ItemClick(&item);
-                        ItemContextMenu(&item);
-                        ItemDrag(&item);
-                    }
-
-                    // Image
-                    if (RHI_Texture* texture = item.GetTexture())
-                    {
-                        if (texture->GetResourceState() == ResourceState::PreparedForGpu) // This is possible for when the editor is reading from drive
+                        // THUMBNAIL
                         {
-                            // Compute thumbnail size
-                            ImVec2 image_size     = ImVec2(static_cast<float>(texture->GetWidth()), static_cast<float>(texture->GetHeight()));
-                            ImVec2 image_size_max = ImVec2(rect_button.Max.x - rect_button.Min.x - style.FramePadding.x * 2.0f, rect_button.Max.y - rect_button.Min.y - style.FramePadding.y - label_height - 5.0f);
+                            ImGui::PushID(static_cast<int>(i));
+                            ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 0));
+                            ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1.0f, 1.0f, 1.0f, 0.0f));
+                            ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 5.0f);
 
-                            // Scale the image size to fit the max available size while respecting its aspect ratio
+                            if (ImGuiSp::button("##dummy", m_item_size))
                             {
-                                float width_scale  = image_size_max.x / image_size.x;
-                                float height_scale = image_size_max.y / image_size.y;
-                                float scale        = (width_scale < height_scale) ? width_scale : height_scale;
+                                // Determine type of click
+                                item.Clicked();
+                                const bool is_single_click = item.GetTimeSinceLastClickMs() > 500;
 
-                                image_size.x *= scale;
-                                image_size.y *= scale;
+                                if (is_single_click)
+                                {
+                                    // Updated input box
+                                    m_input_box = item.GetLabel();
+                                    // Callback
+                                    if (m_callback_on_item_clicked) m_callback_on_item_clicked(item.GetPath());
+                                }
+                                else // Double Click
+                                {
+                                    m_current_path   = item.GetPath();
+                                    m_is_dirty       = true;
+                                    m_selection_made = !item.IsDirectory();
+
+                                    // When browsing files, open them on double click
+                                    if (m_type == FileDialog_Type_Browser)
+                                    {
+                                        if (!item.IsDirectory())
+                                        {
+                                            FileSystem::OpenUrl(item.GetPath());
+                                        }
+                                    }
+
+                                    // Callback
+                                    if (m_callback_on_item_double_clicked)
+                                    {
+                                        m_callback_on_item_double_clicked(m_current_path);
+                                    }
+                                }
                             }
 
-                            // Calculate button center and image position
-                            ImVec2 button_center = ImVec2(
-                                rect_button.Min.x + (rect_button.Max.x - rect_button.Min.x) / 2,
-                                rect_button.Min.y + (rect_button.Max.y - rect_button.Min.y - label_height - 5.0f) / 2
-                            );
+                            // Item functionality
+                            {
+                                // Manually detect some useful states
+                                if (ImGui::IsItemHovered(ImGuiHoveredFlags_RectOnly))
+                                {
+                                    m_is_hovering_item = true;
+                                    m_hovered_item_path = item.GetPath();
+                                }
 
-                            ImVec2 image_pos = ImVec2(
-                                button_center.x - image_size.x / 2,
-                                button_center.y - image_size.y / 2
-                            );
+                                ItemClick(&item);
+                                ItemContextMenu(&item);
+                                ItemDrag(&item);
+                            }
 
-                            // Position the image within the square border
-                            ImGui::SetCursorScreenPos(image_pos);
+                            // Image
+                            if (RHI_Texture* texture = item.GetTexture())
+                            {
+                                if (texture->GetResourceState() == ResourceState::PreparedForGpu) // This is possible for when the editor is reading from drive
+                                {
+                                    // Compute thumbnail size
+                                    ImVec2 image_size     = ImVec2(static_cast<float>(texture->GetWidth()), static_cast<float>(texture->GetHeight()));
+                                    ImVec2 image_size_max = ImVec2(rect_button.Max.x - rect_button.Min.x - style.FramePadding.x * 2.0f, rect_button.Max.y - rect_button.Min.y - style.FramePadding.y - label_height - 5.0f);
+
+                                    // Scale the image size to fit the max available size while respecting its aspect ratio
+                                    {
+                                        float width_scale  = image_size_max.x / image_size.x;
+                                        float height_scale = image_size_max.y / image_size.y;
+                                        float scale        = (width_scale < height_scale) ? width_scale : height_scale;
+
+                                        image_size.x *= scale;
+                                        image_size.y *= scale;
+                                    }
+
+                                    // Calculate button center and image position
+                                    ImVec2 button_center = ImVec2(
+                                        rect_button.Min.x + (rect_button.Max.x - rect_button.Min.x) / 2,
+                                        rect_button.Min.y + (rect_button.Max.y - rect_button.Min.y - label_height - 5.0f) / 2
+                                    );
+
+                                    ImVec2 image_pos = ImVec2(
+                                        button_center.x - image_size.x / 2,
+                                        button_center.y - image_size.y / 2
+                                    );
+
+                                    // Position the image within the square border
+                                    ImGui::SetCursorScreenPos(image_pos);
+
+                                    // Draw the image
+                                    ImGuiSp::image(texture, image_size);
+                                }
+                            }
 
-                            // Draw the image
-                            ImGuiSp::image(item.GetTexture(), image_size);
+                            ImGui::PopStyleColor(2);
+                            ImGui::PopStyleVar(1);
+                            ImGui::PopID();
                         }
-                    }
 
-                    ImGui::PopStyleColor(2);
-                    ImGui::PopStyleVar(1);
-                    ImGui::PopID();
-                }
+                        // LABEL
+                        {
+                            const char* label_text  = item.GetLabel().c_str();
+                            const ImVec2 label_size = ImGui::CalcTextSize(label_text, nullptr, true);
 
-                // LABEL
-                {
-                    const char* label_text  = item.GetLabel().c_str();
-                    const ImVec2 label_size = ImGui::CalcTextSize(label_text, nullptr, true);
+                            // Draw text background
+                            ImGui::GetWindowDrawList()->AddRectFilled(rect_label.Min, rect_label.Max, ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_ChildBg]),style.ChildRounding,0);
+                            //ImGui::GetWindowDrawList()->AddRect(rect_label.Min, rect_label.Max, IM_COL32(255, 0, 0, 255)); // debug
 
-                    // Draw text background
-                    ImGui::GetWindowDrawList()->AddRectFilled(rect_label.Min, rect_label.Max, ImGui::ColorConvertFloat4ToU32(style.Colors[ImGuiCol_ChildBg]),style.ChildRounding,0);
-                    //ImGui::GetWindowDrawList()->AddRect(rect_label.Min, rect_label.Max, IM_COL32(255, 0, 0, 255)); // debug
+                            // Draw text
+                            ImGui::SetCursorScreenPos(ImVec2(rect_label.Min.x + text_offset, rect_label.Min.y + text_offset));
+                            if (label_size.x <= m_item_size.x && label_size.y <= m_item_size.y)
+                            {
+                                ImGui::TextUnformatted(label_text);
+                            }
+                            else
+                            {
+                                ImGui::RenderTextClipped(rect_label.Min, rect_label.Max, label_text, nullptr, &label_size, ImVec2(0, 0), &rect_label);
+                            }
+                        }
 
-                    // Draw text
-                    ImGui::SetCursorScreenPos(ImVec2(rect_label.Min.x + text_offset, rect_label.Min.y + text_offset));
-                    if (label_size.x <= m_item_size.x && label_size.y <= m_item_size.y)
-                    {
-                        ImGui::TextUnformatted(label_text);
-                    }
-                    else
-                    {
-                        ImGui::RenderTextClipped(rect_label.Min, rect_label.Max, label_text, nullptr, &label_size, ImVec2(0, 0), &rect_label);
+                        ImGui::EndGroup();
                     }
                 }
 
-                ImGui::EndGroup();
-            }
-
-            // Decide whether we should switch to the next column or switch row
-            pen_x += m_item_size.x + ImGui::GetStyle().ItemSpacing.x;
-            if (pen_x >= content_width - m_item_size.x)
-            {
-                ImGui::EndGroup();
-                pen_x = pen_x_min;
-                set_cursor_position_x(pen_x);
-                new_line = true;
-            }
-            else
-            {
-                ImGui::SameLine();
+                // advance by exactly one row, which is the height the clipper assumes
+                ImGui::SetCursorPos(row_position);
+                ImGui::Dummy(ImVec2(column_count * item_stride_x, m_item_size.y));
             }
         }
-
-        if (!new_line)
-        {
-            ImGui::EndGroup();
-        }
     }
 
     ImGui::EndChild(); // BeginChild() requires EndChild() to always be called
@@ -403,6 +403,7 @@ void FileDialog::ShowBottom(bool* is_visible)
         ImGui::SetCursorPosY(ImGui::GetWindowSize().y - m_offset_bottom);
 
         string text = (m_displayed_item_count == 1) ? "%d item" : "%d items";
+        text       += m_scan ? ", scanning..." : "";
         ImGui::Text(text.c_str(), m_displayed_item_count);
     }
     else
@@ -514,41 +515,41 @@ bool FileDialog::DialogUpdateFromDirectory(const string& file_path)
     m_items.clear();
     m_items.shrink_to_fit();
 
-    // Get directories
-    auto directories = FileSystem::GetDirectoriesInDirectory(file_path);
-    for (const string& directory : directories)
+    // a scan that is still running for a previous directory finishes into its own (now unreferenced) result
+    m_scan = make_shared<FileDialogScan>();
+    ThreadPool::AddTask([scan = m_scan, filter = m_filter, file_path]()
     {
-        m_items.emplace_back(directory, IconLoader::LoadFromFile(directory, IconType::Directory_Folder));
-    }
-
-    // Get files (based on filter)
-    if (m_filter == FileDialog_Filter_All)
-    {
-        vector<string> paths_anything = FileSystem::GetFilesInDirectory(file_path);
-        for (const string& anything : paths_anything)
+        // a single pass gives the type, size and time of every entry, the icons come from a hashed lookup
+        for (const FileSystemEntry& entry : FileSystem::GetEntriesInDirectory(file_path))
         {
-            if (!FileSystem::IsEngineModelFile(anything))
+            if (entry.is_directory)
             {
-                m_items.emplace_back(anything, IconLoader::LoadFromFile(anything, IconType::Undefined));
+                scan->items.emplace_back(entry, IconLoader::LoadFromFile(entry.path, IconType::Directory_Folder));
+            }
+            else if (filter == FileDialog_Filter_All)
+            {
+                // images get a thumbnail (once visible), the texture icon stands in until then
+                if (FileSystem::IsSupportedImageFile(entry.path))
+                {
+                    scan->items.emplace_back(entry, IconLoader::LoadFromFile(entry.path, IconType::Directory_File_Texture));
+                }
+                else if (!FileSystem::IsEngineModelFile(entry.path))
+                {
+                    scan->items.emplace_back(entry, IconLoader::LoadFromFile(entry.path, IconType::Directory_File_Default));
+                }
+            }
+            else if (filter == FileDialog_Filter_World && FileSystem::IsEngineSceneFile(entry.path))
+            {
+                scan->items.emplace_back(entry, IconLoader::LoadFromFile(entry.path, IconType::Directory_File_World));
+            }
+            else if (filter == FileDialog_Filter_Model && FileSystem::IsSupportedModelFile(entry.path))
+            {
+                scan->items.emplace_back(entry, IconLoader::LoadFromFile(entry.path, IconType::Directory_File_Model));
             }
         }
-    }
-    else if (m_filter == FileDialog_Filter_World)
-    {
-        vector<string> paths_world = FileSystem::GetSupportedSceneFilesInDirectory(file_path);
-        for (const string& world : paths_world)
-        {
-            m_items.emplace_back(world, IconLoader::LoadFromFile(world, IconType::Directory_File_World));
-        }
-    }
-    else if (m_filter == FileDialog_Filter_Model)
-    {
-        vector<string> paths_models = FileSystem::GetSupportedModelFilesInDirectory(file_path);
-        for (const string& model : paths_models)
-        {
-            m_items.emplace_back(model, IconLoader::LoadFromFile(model, IconType::Directory_File_Model));
-        }
-    }
+
+        scan->done.store(true, memory_order_release);
+    });
 
     return true;
 }
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FileSystem/FileSystem.h"
 #include "../ImGui/ImGui_Extension.h"
 #include <chrono>
+#include <atomic>
 //===================================
 
 enum FileDialog_Type
@@ -51,22 +52,28 @@ enum FileDialog_Filter
 class FileDialogItem
 {
 public:
-    FileDialogItem(const std::string& path, Icon* icon)
+    FileDialogItem(const spartan::FileSystemEntry& entry, Icon* icon)
     {
-        m_path        = path;
-        m_icon        = icon;
-        m_id          = spartan::SpartanObject::GenerateObjectId();
-        m_isDirectory = spartan::FileSystem::IsDirectory(path);
-        m_label       = spartan::FileSystem::GetFileNameFromFilePath(path);
+        m_entry    = entry;
+        m_icon     = icon;
+        m_id       = spartan::SpartanObject::GenerateObjectId();
+        m_label    = spartan::FileSystem::GetFileNameFromFilePath(entry.path);
+        m_is_image = !entry.is_directory && spartan::FileSystem::IsSupportedImageFile(entry.path);
     }
 
-    const auto& GetPath()              const { return m_path; }
+    const auto& GetPath()              const { return m_entry.path; }
     const auto& GetLabel()             const { return m_label; }
     auto GetId()                       const { return m_id; }
-    spartan::RHI_Texture* GetTexture() const { return m_icon->GetTexture(); }
-    auto IsDirectory()                 const { return m_isDirectory; }
+    auto IsDirectory()                 const { return m_entry.is_directory; }
     auto GetTimeSinceLastClickMs()     const { return static_cast<float>(m_time_since_last_click.count()); }
 
+    // images show a thumbnail once it's ready, so this should only be called for visible items
+    spartan::RHI_Texture* GetTexture() const
+    {
+        spartan::RHI_Texture* thumbnail = m_is_image ? IconLoader::GetThumbnail(m_entry) : nullptr;
+        return thumbnail ? thumbnail : m_icon->GetTexture();
+    }
+
     void Clicked()
     {
         const auto now          = std::chrono::high_resolution_clock::now();
@@ -77,13 +84,20 @@ class FileDialogItem
 private:
     Icon* m_icon;
     uint64_t m_id;
-    std::string m_path;
+    spartan::FileSystemEntry m_entry;
     std::string m_label;
-    bool m_isDirectory;
+    bool m_is_image;
     std::chrono::duration<double, std::milli> m_time_since_last_click;
     std::chrono::time_point<std::chrono::high_resolution_clock> m_last_click_time;
 };
 
+// the items of a directory, listed on a worker thread so that large directories don't stall the ui
+struct FileDialogScan
+{
+    std::vector<FileDialogItem> items;
+    std::atomic<bool> done = false;
+};
+
 class FileDialog
 {
 public:
@@ -142,6 +156,8 @@ class FileDialog
     FileDialog_Operation m_operation;
     FileDialog_Filter m_filter;
     std::vector<FileDialogItem> m_items;
+    std::vector<uint32_t> m_items_filtered;
+    std::shared_ptr<FileDialogScan> m_scan;
     spartan::math::Vector2 m_item_size;
     ImGuiTextFilter m_search_filter;
     std::string m_current_path;
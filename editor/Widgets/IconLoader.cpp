@@ -19,13 +19,16 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ======================
+//= INCLUDES =============================
 #include "IconLoader.h"
 #include "Resource/ResourceCache.h"
 #include "RHI/RHI_Texture.h"
 #include "Core/ThreadPool.h"
+#include "IO/FileStream.h"
+#include "Rendering/Renderer.h"
+#include "Resource/Import/ImageImporter.h"
 #include "Event.h"
-//=================================
+//========================================
 
 //= NAMESPACES =========
 using namespace std;
@@ -35,23 +38,144 @@ using namespace spartan;
 namespace
 {
     vector<shared_ptr<Icon>> icons;
+    array<Icon*, static_cast<size_t>(IconType::Undefined)> icons_by_type = {};
+    unordered_map<string, Icon*> icons_by_path;
     Icon no_icon;
     mutex icon_mutex;
 
+    namespace thumbnails
+    {
+        const uint32_t size          = 128;
+        const uint32_t capacity      = 512; // in memory, beyond that the least recently used ones are evicted
+        const uint32_t in_flight_max = 4;   // limits the work to what's visible, since requests are repeated every frame
+        const uint32_t cache_magic   = 0x4D485453; // "STHM"
+        const uint32_t cache_version = 1;
+        const string cache_directory = "cache/thumbnails/";
+
+        struct Thumbnail
+        {
+            shared_ptr<RHI_Texture> texture;
+            atomic<bool> done    = false;
+            uint64_t frame_used  = 0;
+        };
+
+        unordered_map<uint64_t, shared_ptr<Thumbnail>> thumbnails; // only accessed from the ui thread
+        atomic<uint32_t> in_flight = 0;
+
+        // fnv-1a over the path, the size and the modification time, an edited file gets a new key
+        uint64_t compute_key(const FileSystemEntry& entry)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            auto mix      = [&hash](const void* data, const size_t size)
+            {
+                for (size_t i = 0; i < size; i++)
+                {
+                    hash = (hash ^ static_cast<const uint8_t*>(data)[i]) * 1099511628211ull;
+                }
+            };
+
+            mix(entry.path.data(), entry.path.size());
+            mix(&entry.size, sizeof(entry.size));
+            mix(&entry.time_modified, sizeof(entry.time_modified));
+
+            return hash;
+        }
+
+        string get_cache_path(const uint64_t key)
+        {
+            char name[17];
+            snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+            return cache_directory + name + ".thumbnail";
+        }
+
+        bool load(const uint64_t key, vector<byte>& pixels, uint32_t& width, uint32_t& height)
+        {
+            const string path = get_cache_path(key);
+            if (!FileSystem::Exists(path))
+                return false;
+
+            FileStream stream(path, FileStream_Read);
+            if (!stream.IsOpen() || stream.ReadAs<uint32_t>() != cache_magic || stream.ReadAs<uint32_t>() != cache_version || stream.ReadAs<uint64_t>() != key)
+                return false;
+
+            stream.Read(&width);
+            stream.Read(&height);
+            stream.Read(&pixels);
+
+            return width > 0 && height > 0 && pixels.size() == static_cast<size_t>(width) * height * 4;
+        }
+
+        void save(const uint64_t key, const vector<byte>& pixels, const uint32_t width, const uint32_t height)
+        {
+            FileStream stream(get_cache_path(key), FileStream_Write);
+            if (!stream.IsOpen())
+                return;
+
+            stream.Write(cache_magic);
+            stream.Write(cache_version);
+            stream.Write(key);
+            stream.Write(width);
+            stream.Write(height);
+            stream.Write(pixels);
+        }
+
+        // runs on a worker thread, from the disk cache if possible, otherwise from the image itself
+        void generate(const FileSystemEntry entry, const uint64_t key, shared_ptr<Thumbnail> thumbnail)
+        {
+            vector<byte> pixels;
+            uint32_t width  = 0;
+            uint32_t height = 0;
+            bool loaded     = load(key, pixels, width, height);
+            if (!loaded && ImageImporter::LoadThumbnail(entry.path, size, pixels, width, height))
+            {
+                save(key, pixels, width, height);
+                loaded = true;
+            }
+
+            if (loaded)
+            {
+                vector<RHI_Texture_Slice> data(1);
+                data[0].mips.push_back({ move(pixels) });
+                const string name  = FileSystem::GetFileNameFromFilePath(entry.path);
+                thumbnail->texture = make_shared<RHI_Texture>(RHI_Texture_Type::Type2D, width, height, 1, 1, RHI_Format::R8G8B8A8_Unorm, RHI_Texture_Srv, name.c_str(), data);
+            }
+
+            thumbnail->done.store(true, memory_order_release);
+            in_flight--;
+        }
+
+        // textures which haven't been drawn for a few frames can go, the gpu releases them through the deletion queue
+        void evict(const uint64_t frame)
+        {
+            vector<pair<uint64_t, uint64_t>> candidates; // frame used, key
+            for (const auto& [key, thumbnail] : thumbnails)
+            {
+                if (thumbnail->done.load(memory_order_acquire) && thumbnail->frame_used + 2 < frame)
+                {
+                    candidates.emplace_back(thumbnail->frame_used, key);
+                }
+            }
+
+            sort(candidates.begin(), candidates.end());
+            for (size_t i = 0; i < candidates.size() && thumbnails.size() > capacity; i++)
+            {
+                thumbnails.erase(candidates[i].second);
+            }
+        }
+    }
+
     void destroy_rhi_resources()
     {
         icons.clear();
+        icons_by_type.fill(nullptr);
+        icons_by_path.clear();
+        thumbnails::thumbnails.clear();
     }
 
     Icon* get_icon_by_type(IconType type)
     {
-        for (auto& icon : icons)
-        {
-            if (icon->GetType() == type)
-                return icon.get();
-        }
-
-        return &no_icon;
+        Icon* icon = type != IconType::Undefined ? icons_by_type[static_cast<size_t>(type)] : nullptr;
+        return icon ? icon : &no_icon;
     }
 }
 
@@ -142,32 +266,73 @@ RHI_Texture* IconLoader::GetTextureByType(IconType type)
 
 Icon* IconLoader::LoadFromFile(const string& file_path, IconType type /*Undefined*/)
 {
+    lock_guard<mutex> guard(icon_mutex);
+
     // check if the texture is already loaded, and return that
-    bool search_by_type = type != IconType::Undefined;
-    for (auto& icon : icons)
+    if (type != IconType::Undefined)
     {
-        if (search_by_type)
-        {
-            if (icon->GetType() == type)
-                return icon.get();
-        }
-        else if (icon->GetFilePath() == file_path)
-        {
-            return icon.get();
-        }
+        if (Icon* icon = icons_by_type[static_cast<size_t>(type)])
+            return icon;
+    }
+    else
+    {
+        auto it = icons_by_path.find(file_path);
+        if (it != icons_by_path.end())
+            return it->second;
     }
 
     // the texture is new so load it
     if (FileSystem::IsSupportedImageFile(file_path))
     {
-        lock_guard<mutex> guard(icon_mutex);
-
-        // add a new icon
         icons.push_back(make_shared<Icon>(type, file_path));
+        Icon* icon = icons.back().get();
+
+        if (type != IconType::Undefined)
+        {
+            icons_by_type[static_cast<size_t>(type)] = icon;
+        }
+        icons_by_path[file_path] = icon;
 
-        // return it
-        return icons.back().get();
+        return icon;
     }
 
     return get_icon_by_type(IconType::Directory_File_Default);
 }
+
+RHI_Texture* IconLoader::GetThumbnail(const FileSystemEntry& entry)
+{
+    const uint64_t frame = Renderer::GetFrameNumber();
+    const uint64_t key   = thumbnails::compute_key(entry);
+
+    auto it = thumbnails::thumbnails.find(key);
+    if (it != thumbnails::thumbnails.end())
+    {
+        it->second->frame_used = frame;
+        return it->second->done.load(memory_order_acquire) ? it->second->texture.get() : nullptr;
+    }
+
+    // requests beyond the limit are simply retried next frame, if the item is still visible by then
+    if (thumbnails::in_flight.load() >= thumbnails::in_flight_max)
+        return nullptr;
+
+    if (thumbnails::thumbnails.empty())
+    {
+        FileSystem::CreateDirectory_(thumbnails::cache_directory);
+    }
+
+    shared_ptr<thumbnails::Thumbnail> thumbnail = make_shared<thumbnails::Thumbnail>();
+    thumbnail->frame_used                       = frame;
+    thumbnails::thumbnails[key]                 = thumbnail;
+    thumbnails::in_flight++;
+    ThreadPool::AddTask([entry, key, thumbnail]()
+    {
+        thumbnails::generate(entry, key, thumbnail);
+    });
+
+    if (thumbnails::thumbnails.size() > thumbnails::capacity + thumbnails::capacity / 4)
+    {
+        thumbnails::evict(frame);
+    }
+
+    return nullptr;
+}
@@ -29,6 +29,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI/RHI_Definitions.h"
 //==============================
 
+namespace spartan
+{
+    struct FileSystemEntry;
+}
+
 enum class IconType
 {
     Component_Options,
@@ -95,4 +100,8 @@ class IconLoader
 
     static spartan::RHI_Texture* GetTextureByType(IconType type);
     static Icon* LoadFromFile(const std::string& filePath, IconType type = IconType::Undefined);
+
+    // a downscaled preview of an image file, generated in the background and cached on disk (keyed by path, size and time)
+    // returns nullptr until it's ready (or if the image can't be read), so it's meant to be called for visible items only
+    static spartan::RHI_Texture* GetThumbnail(const spartan::FileSystemEntry& entry);
 };
@@ -171,6 +171,10 @@ void Profiler::OnTickVisible()
         {
             if (ImGuiSp::button("Clear")) { m_timings.Clear(); }
             ImGui::SameLine();
+            ImGui::BeginDisabled(spartan::Trace::IsCapturing());
+            if (ImGuiSp::button("Capture trace")) { spartan::Trace::CaptureFrames(60); } // written to the working directory as trace_<frame>.json
+            ImGui::EndDisabled();
+            ImGui::SameLine();
             ImGui::Text("Cur:%.2f, Avg:%.2f, Min:%.2f, Max:%.2f", time_last, m_timings.m_avg, m_timings.m_min, m_timings.m_max);
             bool is_stuttering = type == spartan::TimeBlockType::Cpu ? spartan::Profiler::IsCpuStuttering() : spartan::Profiler::IsGpuStuttering();
             ImGui::SameLine();
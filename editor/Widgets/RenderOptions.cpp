@@ -419,6 +419,9 @@ void RenderOptions::OnTickVisible()
             // vsync
             option_check_box("VSync", Renderer_Option::Vsync, "Vertical Synchronization");
 
+            // texture streaming
+            option_value("Texture streaming budget (MB)", Renderer_Option::TextureStreamingBudget, "The GPU memory material textures can take, mips which aren't needed are evicted to stay within it", 64.0f, 0.0f, numeric_limits<float>::max(), "%.0f");
+
             // fps Limit
             {
                 option_first_column();
@@ -0,0 +1,206 @@
+#/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "WorldHierarchy.h"
+#include <algorithm>
+#include <cctype>
+//=======================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace
+{
+    string to_lowercase(const string& text)
+    {
+        string result = text;
+        transform(result.begin(), result.end(), result.begin(), [](const unsigned char c) { return static_cast<char>(tolower(c)); });
+        return result;
+    }
+}
+
+void WorldHierarchy::Build(vector<Node> nodes)
+{
+    m_nodes = move(nodes);
+
+    const uint32_t count = static_cast<uint32_t>(m_nodes.size());
+    m_names_lowercase.resize(count);
+    m_parent.assign(count, -1);
+    m_first_child.assign(count, -1);
+    m_next_sibling.assign(count, -1);
+    m_roots.clear();
+    m_index_by_id.clear();
+    m_index_by_id.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_index_by_id[m_nodes[i].id] = i;
+        m_names_lowercase[i]         = to_lowercase(m_nodes[i].name);
+    }
+
+    // link the children, back to front, so that prepending keeps them in the order they were given
+    for (uint32_t i = count; i-- > 0;)
+    {
+        auto it = m_nodes[i].parent_id != 0 ? m_index_by_id.find(m_nodes[i].parent_id) : m_index_by_id.end();
+        if (it != m_index_by_id.end())
+        {
+            m_parent[i]               = static_cast<int32_t>(it->second);
+            m_next_sibling[i]         = m_first_child[it->second];
+            m_first_child[it->second] = static_cast<int32_t>(i);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (m_parent[i] == -1 && m_nodes[i].active)
+        {
+            m_roots.push_back(i);
+        }
+    }
+
+    // forget the expansion of nodes which are gone
+    for (auto it = m_expanded.begin(); it != m_expanded.end();)
+    {
+        it = m_index_by_id.count(*it) ? next(it) : m_expanded.erase(it);
+    }
+
+    m_rows_dirty = true;
+    Search(false);
+}
+
+void WorldHierarchy::SetExpanded(const uint64_t id, const bool expanded)
+{
+    const bool changed = expanded ? m_expanded.insert(id).second : m_expanded.erase(id) > 0;
+    m_rows_dirty      |= changed;
+}
+
+void WorldHierarchy::ExpandTo(const uint64_t id)
+{
+    auto it = m_index_by_id.find(id);
+    if (it == m_index_by_id.end())
+        return;
+
+    for (int32_t parent = m_parent[it->second]; parent != -1; parent = m_parent[parent])
+    {
+        SetExpanded(m_nodes[parent].id, true);
+    }
+}
+
+const vector<WorldHierarchy::Row>& WorldHierarchy::GetRows()
+{
+    if (m_rows_dirty)
+    {
+        BuildRows();
+        m_rows_dirty = false;
+    }
+
+    return m_rows;
+}
+
+int32_t WorldHierarchy::GetRowIndex(const uint64_t id)
+{
+    auto it = m_index_by_id.find(id);
+    if (it == m_index_by_id.end())
+        return -1;
+
+    const vector<Row>& rows = GetRows();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(rows.size()); i++)
+    {
+        if (rows[i].node == it->second)
+            return static_cast<int32_t>(i);
+    }
+
+    return -1;
+}
+
+void WorldHierarchy::SetSearch(const string& text)
+{
+    const string search = to_lowercase(text);
+    if (search == m_search)
+        return;
+
+    // a longer query can only match a subset of what the shorter one matched
+    const bool incremental = !m_search.empty() && search.find(m_search) != string::npos;
+    m_search               = search;
+    Search(incremental);
+}
+
+void WorldHierarchy::BuildRows()
+{
+    m_rows.clear();
+
+    // depth first, with an explicit stack since hierarchies can be deep
+    vector<pair<uint32_t, uint32_t>> stack; // node, depth
+    for (auto it = m_roots.rbegin(); it != m_roots.rend(); ++it)
+    {
+        stack.emplace_back(*it, 0);
+    }
+
+    vector<uint32_t> children;
+    while (!stack.empty())
+    {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+
+        const bool has_children = m_first_child[node] != -1;
+        m_rows.push_back({ node, depth, has_children });
+
+        if (has_children && IsExpanded(m_nodes[node].id))
+        {
+            children.clear();
+            for (int32_t child = m_first_child[node]; child != -1; child = m_next_sibling[child])
+            {
+                children.push_back(static_cast<uint32_t>(child));
+            }
+
+            for (auto it = children.rbegin(); it != children.rend(); ++it)
+            {
+                stack.emplace_back(*it, depth + 1);
+            }
+        }
+    }
+}
+
+void WorldHierarchy::Search(const bool incremental)
+{
+    if (m_search.empty())
+    {
+        m_matches.clear();
+        return;
+    }
+
+    if (incremental)
+    {
+        m_matches.erase(remove_if(m_matches.begin(), m_matches.end(), [this](const uint32_t i) { return m_names_lowercase[i].find(m_search) == string::npos; }), m_matches.end());
+        return;
+    }
+
+    m_matches.clear();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_nodes.size()); i++)
+    {
+        if (m_names_lowercase[i].find(m_search) != string::npos)
+        {
+            m_matches.push_back(i);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+//=====================
+
+// a flattened model of the entity hierarchy, the tree view only submits the rows which are visible (with a list clipper)
+// it knows nothing about imgui or the world, it's built from plain nodes, so it can be exercised without either
+class WorldHierarchy
+{
+public:
+    struct Node
+    {
+        uint64_t id        = 0;
+        uint64_t parent_id = 0; // 0 for roots
+        std::string name;
+        bool active        = true; // inactive roots are hidden, along with their descendants
+    };
+
+    struct Row
+    {
+        uint32_t node     = 0; // index into the nodes, as they were given to Build()
+        uint32_t depth    = 0;
+        bool has_children = false;
+    };
+
+    // children keep the order in which they appear in the nodes, so they should be given depth first
+    void Build(std::vector<Node> nodes);
+
+    // expansion
+    void SetExpanded(const uint64_t id, const bool expanded);
+    bool IsExpanded(const uint64_t id) const { return m_expanded.count(id) > 0; }
+    void ExpandTo(const uint64_t id); // expands every ancestor, so that the node gets a row
+
+    // the rows of the tree, only expanded nodes contribute their children
+    const std::vector<Row>& GetRows();
+    int32_t GetRowIndex(const uint64_t id);
+
+    // case insensitive substring search over all the nodes (expanded or not), when the text extends
+    // the previous one, only the previous matches are tested, the matches are in node order
+    void SetSearch(const std::string& text);
+    bool IsSearching() const                       { return !m_search.empty(); }
+    const std::vector<uint32_t>& GetMatches() const { return m_matches; }
+
+    const Node& GetNode(const uint32_t index) const { return m_nodes[index]; }
+    uint32_t GetNodeCount() const                   { return static_cast<uint32_t>(m_nodes.size()); }
+
+private:
+    void BuildRows();
+    void Search(const bool incremental);
+
+    std::vector<Node> m_nodes;
+    std::vector<std::string> m_names_lowercase;
+    std::vector<int32_t> m_parent;        // -1 for roots
+    std::vector<int32_t> m_first_child;   // -1 when there are none
+    std::vector<int32_t> m_next_sibling;  // -1 for the last child
+    std::vector<uint32_t> m_roots;
+    std::unordered_map<uint64_t, uint32_t> m_index_by_id;
+    std::unordered_set<uint64_t> m_expanded;
+    std::vector<Row> m_rows;
+    bool m_rows_dirty = true;
+    std::string m_search;
+    std::vector<uint32_t> m_matches;
+};
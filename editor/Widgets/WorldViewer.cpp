@@ -32,6 +32,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Commands/CommandStack.h"
 #include "Input/Input.h"
 #include "Core/Engine.h"
+#include "Core/ProgressTracker.h"
 #include "../ImGui/ImGui_Extension.h"
 SP_WARNINGS_OFF
 #include "../ImGui/Source/imgui_stdlib.h"
@@ -49,7 +50,6 @@ namespace
     ImGuiSp::DragDropPayload drag_drop_payload;
     bool popup_rename_entity       = false;
     spartan::Entity* entity_copied = nullptr;
-    ImRect selected_entity_rect;
 }
 
 WorldViewer::WorldViewer(Editor* editor) : Widget(editor)
@@ -85,32 +85,124 @@ void WorldViewer::TreeShow()
 {
     OnTreeBegin();
 
+    // a world which is loading is being modified by another thread, so keep showing what was there before
+    const uint64_t revision = spartan::World::GetHierarchyRevision();
+    if (revision != m_hierarchy_revision && !spartan::ProgressTracker::IsLoading())
+    {
+        TreeRebuild();
+        m_hierarchy_revision = revision;
+    }
+
     bool is_in_game_mode = spartan::Engine::IsFlagSet(spartan::EngineMode::Playing);
     ImGui::BeginDisabled(is_in_game_mode);
     {
-        // iterate over root entities directly, omitting the root node
-        vector<shared_ptr<spartan::Entity>> root_entities = spartan::World::GetRootEntities();
-        for (const shared_ptr<spartan::Entity>& entity : root_entities)
+        // search
+        ImGui::SetNextItemWidth(-1.0f);
+        ImGui::InputTextWithHint("##world_search", "Search", &m_search);
+        m_hierarchy.SetSearch(m_search);
+        const bool is_searching = m_hierarchy.IsSearching();
+
+        uint64_t selected_id = 0;
+        if (!is_in_game_mode)
+        {
+            if (spartan::Camera* camera = spartan::World::GetCamera())
+            {
+                if (shared_ptr<spartan::Entity> selected_entity = camera->GetSelectedEntity())
+                {
+                    selected_id = selected_entity->GetObjectId();
+                }
+            }
+        }
+
+        // if the selection changed (e.g. it was selected in the viewport), expand the tree down to it and bring it into view
+        int32_t row_to_reveal = -1;
+        if (m_expand_to_selection && selected_id != 0)
         {
-            if (entity->GetActive())
+            if (is_searching)
+            {
+                const vector<uint32_t>& matches = m_hierarchy.GetMatches();
+                for (uint32_t i = 0; i < static_cast<uint32_t>(matches.size()) && row_to_reveal == -1; i++)
+                {
+                    row_to_reveal = m_hierarchy.GetNode(matches[i]).id == selected_id ? static_cast<int32_t>(i) : -1;
+                }
+            }
+            else
             {
-                TreeAddEntity(entity);
+                m_hierarchy.ExpandTo(selected_id);
+                row_to_reveal = m_hierarchy.GetRowIndex(selected_id);
             }
         }
+        m_expand_to_selection = false;
 
-        // if we have been expanding to show an entity and no more expansions are taking place, we reached it
-        // so, we stop expanding and we bring it into view
-        if (m_expand_to_selection && !m_expanded_to_selection)
+        // only the visible rows are submitted, while searching, the matches are listed flat
+        const uint32_t row_count = static_cast<uint32_t>(is_searching ? m_hierarchy.GetMatches().size() : m_hierarchy.GetRows().size());
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(row_count));
+        if (row_to_reveal != -1)
         {
-            ImGui::ScrollToBringRectIntoView(m_window, selected_entity_rect);
-            m_expand_to_selection = false;
+            clipper.IncludeItemByIndex(row_to_reveal);
         }
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+            {
+                const WorldHierarchy::Row row = is_searching ? WorldHierarchy::Row{ m_hierarchy.GetMatches()[i], 0, false } : m_hierarchy.GetRows()[i];
+                TreeAddRow(row, selected_id, i == row_to_reveal);
+            }
+        }
+        clipper.End();
     }
     ImGui::EndDisabled();
 
     OnTreeEnd();
 }
 
+void WorldViewer::TreeRebuild()
+{
+    const vector<shared_ptr<spartan::Entity>>& entities = spartan::World::GetEntities();
+
+    unordered_map<uint64_t, shared_ptr<spartan::Entity>> entities_by_id;
+    entities_by_id.reserve(entities.size());
+    for (const shared_ptr<spartan::Entity>& entity : entities)
+    {
+        entities_by_id[entity->GetObjectId()] = entity;
+    }
+
+    // depth first, so that children keep the order of their parent's child list
+    vector<WorldHierarchy::Node> nodes;
+    nodes.reserve(entities.size());
+    m_entities.clear();
+    m_entities.reserve(entities.size());
+
+    vector<shared_ptr<spartan::Entity>> stack = spartan::World::GetRootEntities();
+    reverse(stack.begin(), stack.end());
+    while (!stack.empty())
+    {
+        shared_ptr<spartan::Entity> entity = move(stack.back());
+        stack.pop_back();
+
+        shared_ptr<spartan::Entity> parent = entity->GetParent();
+        WorldHierarchy::Node& node         = nodes.emplace_back();
+        node.id                            = entity->GetObjectId();
+        node.parent_id                     = parent ? parent->GetObjectId() : 0;
+        node.name                          = entity->GetObjectName();
+        node.active                        = parent ? true : entity->GetActive(); // only roots are hidden when inactive
+        m_entities.push_back(entity);
+
+        const vector<spartan::Entity*>& children = entity->GetChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+        {
+            auto child = entities_by_id.find((*it)->GetObjectId());
+            if (child != entities_by_id.end())
+            {
+                stack.push_back(child->second);
+            }
+        }
+    }
+
+    m_hierarchy.Build(move(nodes));
+}
+
 void WorldViewer::OnTreeBegin()
 {
     entity_hovered.reset();
@@ -123,74 +215,56 @@ void WorldViewer::OnTreeEnd()
     Popups();
 }
 
-void WorldViewer::TreeAddEntity(shared_ptr<spartan::Entity> entity)
+void WorldViewer::TreeAddRow(const WorldHierarchy::Row& row, const uint64_t selected_id, const bool reveal)
 {
-    if (!entity)
-        return;
-
-    m_expanded_to_selection       = false;
-    ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_SpanFullWidth;
-
-    // flag - is expandable (does it have has children) ?
-    const vector<spartan::Entity*>& children  = entity->GetChildren();
-    bool has_children                         = !children.empty();
-    node_flags                               |= has_children ? ImGuiTreeNodeFlags_OpenOnArrow : ImGuiTreeNodeFlags_Leaf; 
-
-    // flag - is it selected?
-    bool is_in_game_mode = spartan::Engine::IsFlagSet(spartan::EngineMode::Playing);
-    if (!is_in_game_mode)
-    { 
-        if (spartan::Camera* camera = spartan::World::GetCamera())
-        {
-            if (shared_ptr<spartan::Entity> selected_entity = camera->GetSelectedEntity())
-            {
-                node_flags |= selected_entity->GetObjectId() == entity->GetObjectId() ? ImGuiTreeNodeFlags_Selected : node_flags;
+    const WorldHierarchy::Node& node   = m_hierarchy.GetNode(row.node);
+    shared_ptr<spartan::Entity> entity = m_entities[row.node].lock();
 
-                if (m_expand_to_selection)
-                {
-                    // if the selected entity is a descendant of the this entity, start expanding (this can happen if an entity is selected in the viewport)
-                    if (selected_entity->IsDescendantOf(entity.get()))
-                    {
-                        ImGui::SetNextItemOpen(true);
-                        m_expanded_to_selection = true;
-                    }
-                }
-            }
-        }
+    // rows are indented manually, since they are not nested
+    const float indent = static_cast<float>(row.depth) * ImGui::GetStyle().IndentSpacing;
+    if (indent > 0.0f)
+    {
+        ImGui::Indent(indent);
     }
 
-    // add node
-    const void* node_id     = reinterpret_cast<void*>(static_cast<uint64_t>(entity->GetObjectId()));
-    string node_name        = entity->GetObjectName();
-    const bool is_node_open = ImGui::TreeNodeEx(node_id, node_flags, node_name.c_str());
+    ImGuiTreeNodeFlags node_flags  = ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+    node_flags                    |= row.has_children ? ImGuiTreeNodeFlags_OpenOnArrow : ImGuiTreeNodeFlags_Leaf;
+    node_flags                    |= node.id == selected_id ? ImGuiTreeNodeFlags_Selected : 0;
 
-    // keep a copy of the selected item's rect so that we can scroll to bring it into view
-    if ((node_flags & ImGuiTreeNodeFlags_Selected) && m_expand_to_selection)
+    // the expansion state lives in the hierarchy, imgui only reports the clicks on the arrow
+    const bool is_expanded = m_hierarchy.IsExpanded(node.id);
+    if (row.has_children)
     {
-        selected_entity_rect = ImGui::GetCurrentContext()->LastItemData.Rect;
+        ImGui::SetNextItemOpen(is_expanded);
     }
 
-    // manually detect some useful states
-    if (ImGui::IsItemHovered(ImGuiHoveredFlags_RectOnly))
+    // the name is read from the entity, the copy in the hierarchy is only for searching
+    const void* node_id     = reinterpret_cast<void*>(static_cast<uint64_t>(node.id));
+    const bool is_node_open = ImGui::TreeNodeEx(node_id, node_flags, "%s", entity ? entity->GetObjectName().c_str() : node.name.c_str());
+    if (row.has_children && is_node_open != is_expanded)
     {
-        entity_hovered = entity;
+        m_hierarchy.SetExpanded(node.id, is_node_open);
     }
 
-    EntityHandleDragDrop(entity);
+    if (reveal)
+    {
+        ImGui::ScrollToBringRectIntoView(m_window, ImGui::GetCurrentContext()->LastItemData.Rect);
+    }
 
-    // recursively show all child nodes
-    if (is_node_open)
+    if (entity)
     {
-        if (has_children)
+        // manually detect some useful states
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_RectOnly))
         {
-            for (const auto& child : children)
-            {
-                TreeAddEntity(spartan::World::GetEntityById(child->GetObjectId()));
-            }
+            entity_hovered = entity;
         }
 
-        // pop if isNodeOpen
-        ImGui::TreePop();
+        EntityHandleDragDrop(entity);
+    }
+
+    if (indent > 0.0f)
+    {
+        ImGui::Unindent(indent);
     }
 }
 
@@ -424,8 +498,11 @@ void WorldViewer::PopupEntityRename() const
 
         string name = selected_entity->GetObjectName();
         ImGui::Text("Name:");
-        ImGui::InputText("##edit", &name);
-        selected_entity->SetObjectName(string(name));
+        if (ImGui::InputText("##edit", &name))
+        {
+            selected_entity->SetObjectName(string(name));
+            spartan::World::MarkHierarchyChanged();
+        }
 
         if (ImGuiSp::button("Ok"))
         { 
@@ -21,10 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ======
+//= INCLUDES ============
 #include "Widget.h"
+#include "WorldHierarchy.h"
 #include <memory>
-//=================
+//=======================
 
 namespace spartan { class Entity; }
 
@@ -39,9 +40,10 @@ class WorldViewer : public Widget
 private:
     // tree
     void TreeShow();
+    void TreeRebuild();
     void OnTreeBegin();
     void OnTreeEnd();
-    void TreeAddEntity(std::shared_ptr<spartan::Entity> entity);
+    void TreeAddRow(const WorldHierarchy::Row& row, const uint64_t selected_id, const bool reveal);
     void HandleClicking();
     void EntityHandleDragDrop(std::shared_ptr<spartan::Entity> entity_ptr) const;
 
@@ -68,6 +70,11 @@ class WorldViewer : public Widget
     static void ActionEntityCreateAudioSource();
 
     std::shared_ptr<spartan::Entity> m_entity_empty;
-    bool m_expand_to_selection   = false;
-    bool m_expanded_to_selection = false;
+    bool m_expand_to_selection = false;
+
+    // the hierarchy, flattened, it's only rebuilt when the world's hierarchy revision changes
+    WorldHierarchy m_hierarchy;
+    std::vector<std::weak_ptr<spartan::Entity>> m_entities; // parallel to the hierarchy nodes
+    uint64_t m_hierarchy_revision = UINT64_MAX;
+    std::string m_search;
 };
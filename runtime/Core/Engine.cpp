@@ -71,6 +71,7 @@ namespace spartan
         Stopwatch timer_initialize;
         {
             Log::Initialize();
+            Trace::Initialize();
             FontImporter::Initialize();
             ImageImporter::Initialize();
             ModelImporter::Initialize();
@@ -106,11 +107,13 @@ namespace spartan
         ImageImporter::Shutdown();
         FontImporter::Shutdown();
         Settings::Shutdown();
+        Log::Shutdown();
     }
 
     void Engine::Tick()
     {
         // pre-tick
+        Event::Dispatch(); // what other threads fired since the last frame
         Input::PreTick();
 
         // tick
@@ -118,7 +121,10 @@ namespace spartan
         Input::Tick();
         PhysicsWorld::Tick();
         World::Tick();
+        Event::Dispatch(); // what this frame's simulation fired, so the renderer sees it in the same frame
+        PhysicsWorld::Simulate();
         Renderer::Tick();
+        PhysicsWorld::FetchResults(); // before the editor, which can modify bodies
 
         // post-tick
         Timer::PostTick();
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ======
 #include "pch.h"
 #include "Event.h"
+#include <bit>
 //=================
 
 //= NAMESPACES =====
@@ -32,7 +33,17 @@ namespace spartan
 {
     namespace
     {
-        static array<vector<subscriber>, static_cast<uint32_t>(EventType::Max)> event_subscribers;
+        const uint32_t event_count = static_cast<uint32_t>(EventType::Max);
+        static_assert(event_count <= 64, "The pending events are tracked with a 64-bit mask");
+        SP_ASSERT_STATIC_IS_TRIVIALLY_COPYABLE(sp_variant);
+
+        static array<vector<subscriber>, event_count> event_subscribers;
+        static array<vector<subscriber>, event_count> event_subscribers_main_thread;
+
+        // events that fired since the last dispatch, with the data they last fired with
+        static atomic<uint64_t> pending_mask = 0;
+        static array<sp_variant, event_count> pending_data;
+        static mutex pending_mutex;
     }
 
     void Event::Shutdown()
@@ -41,18 +52,60 @@ namespace spartan
         {
             subscribers.clear();
         }
+
+        for (vector<subscriber>& subscribers : event_subscribers_main_thread)
+        {
+            subscribers.clear();
+        }
+
+        pending_mask = 0;
     }
 
-    void Event::Subscribe(const EventType event_type, subscriber&& function)
+    void Event::Subscribe(const EventType event_type, subscriber&& function, const EventThread thread /*= EventThread::Caller*/)
     {
-        event_subscribers[static_cast<uint32_t>(event_type)].push_back(std::forward<subscriber>(function));
+        auto& subscribers = (thread == EventThread::Main) ? event_subscribers_main_thread : event_subscribers;
+        subscribers[static_cast<uint32_t>(event_type)].push_back(std::forward<subscriber>(function));
     }
 
     void Event::Fire(const EventType event_type, sp_variant data /*= 0*/)
     {
-        for (const auto& subscriber : event_subscribers[static_cast<uint32_t>(event_type)])
+        const uint32_t index = static_cast<uint32_t>(event_type);
+
+        for (const auto& subscriber : event_subscribers[index])
         {
             subscriber(data);
         }
+
+        // queue for the main thread, firing again before the dispatch only replaces the data
+        if (!event_subscribers_main_thread[index].empty())
+        {
+            {
+                lock_guard<mutex> lock(pending_mutex);
+                pending_data[index] = data;
+            }
+            pending_mask.fetch_or(1ull << index, memory_order_release);
+        }
+    }
+
+    void Event::Dispatch()
+    {
+        // events fired by the subscribers themselves are picked up by the next dispatch
+        uint64_t mask = pending_mask.exchange(0, memory_order_acquire);
+        while (mask != 0)
+        {
+            const uint32_t index = static_cast<uint32_t>(countr_zero(mask));
+            mask                &= mask - 1;
+
+            sp_variant data;
+            {
+                lock_guard<mutex> lock(pending_mutex);
+                data = pending_data[index];
+            }
+
+            for (const auto& subscriber : event_subscribers_main_thread[index])
+            {
+                subscriber(data);
+            }
+        }
     }
 }
@@ -30,28 +30,38 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 HOW TO USE
 ================================================================================
 To subscribe a function to an event -> SP_SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
+To run it on the main thread        -> SP_SUBSCRIBE_TO_EVENT_MAIN_THREAD(EVENT_ID, Handler);
 To fire an event                    -> SP_FIRE_EVENT(EVENT_ID);
-To fire an event with data          -> SP_FIRE_EVENT_DATA(EVENT_ID, Variant);
+To fire an event with data          -> SP_FIRE_EVENT_DATA(EVENT_ID, Data);
 
-Note: This is a blocking event system
+Note: Subscribers run on the thread that fires the event, blocking it, unless they
+subscribed for the main thread. Those are queued and run once per dispatch point in
+Engine::Tick(), no matter how many times the event fired, with the last data it was
+fired with. Pointers in the data have to outlive the frame for them.
+
+The data an event carries is listed next to it in EventType, and it's one of the
+types of sp_variant, a new kind of data is a new type there (not a void pointer).
 ================================================================================
 */
 
-//= MACROS ===============================================================================================
-#define SP_EVENT_HANDLER_EXPRESSION(expression)        [this](spartan::sp_variant var)  { expression }
-#define SP_EVENT_HANDLER_EXPRESSION_STATIC(expression) [](spartan::sp_variant var)      { expression }
-
-#define SP_EVENT_HANDLER(function)                     [this](spartan::sp_variant var)  { function(); }
-#define SP_EVENT_HANDLER_STATIC(function)              [](spartan::sp_variant var)      { function(); }
-                                                                                     
-#define SP_EVENT_HANDLER_VARIANT(function)             [this](spartan::sp_variant var)  { function(var); }
-#define SP_EVENT_HANDLER_VARIANT_STATIC(function)      [](spartan::sp_variant var)      { function(var); }
-                                                       
-#define SP_FIRE_EVENT(event_enum)                      spartan::Event::Fire(event_enum)
-#define SP_FIRE_EVENT_DATA(event_enum, data)           spartan::Event::Fire(event_enum, data)
-                                                       
-#define SP_SUBSCRIBE_TO_EVENT(event_enum, function)    spartan::Event::Subscribe(event_enum, function);
-//========================================================================================================
+//= MACROS =================================================================================================================================
+#define SP_EVENT_HANDLER_EXPRESSION(expression)                 [this](spartan::sp_variant var)  { expression }
+#define SP_EVENT_HANDLER_EXPRESSION_STATIC(expression)          [](spartan::sp_variant var)      { expression }
+
+#define SP_EVENT_HANDLER(function)                              [this](spartan::sp_variant var)  { function(); }
+#define SP_EVENT_HANDLER_STATIC(function)                       [](spartan::sp_variant var)      { function(); }
+
+#define SP_EVENT_HANDLER_VARIANT(function)                      [this](spartan::sp_variant var)  { function(var); }
+#define SP_EVENT_HANDLER_VARIANT_STATIC(function)               [](spartan::sp_variant var)      { function(var); }
+
+#define SP_FIRE_EVENT(event_enum)                               spartan::Event::Fire(event_enum)
+#define SP_FIRE_EVENT_DATA(event_enum, data)                    spartan::Event::Fire(event_enum, data)
+
+#define SP_SUBSCRIBE_TO_EVENT(event_enum, function)             spartan::Event::Subscribe(event_enum, function);
+#define SP_SUBSCRIBE_TO_EVENT_MAIN_THREAD(event_enum, function) spartan::Event::Subscribe(event_enum, function, spartan::EventThread::Main);
+//==========================================================================================================================================
+
+typedef union SDL_Event SDL_Event;
 
 namespace spartan
 {
@@ -64,7 +74,7 @@ namespace spartan
         // World                       
         WorldClear,                    // The world is about to clear everything
         // SDL                         
-        Sdl,                           // An SDL event
+        Sdl,                           // An SDL event, data: SDL_Event*
         // Window                      
         WindowResized,                 // The window has been resized
         WindowFullScreenToggled,       // The window has been toggled to full screen
@@ -75,12 +85,16 @@ namespace spartan
         Max
     };
 
-    class Entity;
+    enum class EventThread
+    {
+        Caller, // runs right away, on the thread that fires the event
+        Main    // queued and coalesced, runs on the main thread when the engine dispatches
+    };
 
+    // the data of an event, trivially copyable, so that firing and queuing never allocates
     using sp_variant = std::variant<
-        int,
-        void*,
-        std::vector<std::shared_ptr<Entity>>
+        int,       // no data
+        SDL_Event*
     >;
     using subscriber = std::function<void(const sp_variant&)>;
 
@@ -88,7 +102,8 @@ namespace spartan
     {
     public:
         static void Shutdown();
-        static void Subscribe(const EventType event_type, subscriber&& function);
+        static void Subscribe(const EventType event_type, subscriber&& function, const EventThread thread = EventThread::Caller);
         static void Fire(const EventType event_type, sp_variant data = 0);
+        static void Dispatch(); // runs the main thread subscribers of the events that fired since the last dispatch
     };
 }
@@ -0,0 +1,265 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+//===============
+
+namespace spartan
+{
+    // sub-allocates ranges out of a linear address space (e.g. a gpu buffer), it doesn't own any memory
+    // allocations are best-fit, freed ranges are coalesced with their neighbours and allocation ids stay
+    // stable across defragmentation, so owners can look up their (possibly moved) offset at any time
+    class FreeListAllocator
+    {
+    public:
+        static constexpr uint32_t invalid_id = UINT32_MAX;
+
+        struct Stats
+        {
+            uint64_t capacity          = 0;
+            uint64_t used              = 0;
+            uint64_t free              = 0;
+            uint64_t largest_free      = 0;
+            uint32_t allocation_count  = 0;
+            uint32_t free_block_count  = 0;
+            float fragmentation        = 0.0f; // 0 when all free space is contiguous, approaches 1 as it gets scattered
+        };
+
+        // a range that has to be copied when defragmenting
+        struct Move
+        {
+            uint64_t offset_source      = 0;
+            uint64_t offset_destination = 0;
+            uint64_t size               = 0;
+        };
+
+        FreeListAllocator(const uint64_t capacity = 0) { Reset(capacity); }
+
+        void Reset(const uint64_t capacity)
+        {
+            m_capacity = capacity;
+            m_used     = 0;
+            m_allocations.clear();
+            m_ids_free.clear();
+            m_free_by_offset.clear();
+            m_free_by_size.clear();
+            if (capacity > 0)
+            {
+                insert_free(0, capacity);
+            }
+        }
+
+        // returns invalid_id if there is no free range that is large enough
+        uint32_t Allocate(const uint64_t size)
+        {
+            if (size == 0)
+                return invalid_id;
+
+            // best fit: the smallest free range that can hold the allocation
+            auto it = m_free_by_size.lower_bound(size);
+            if (it == m_free_by_size.end())
+                return invalid_id;
+
+            const uint64_t block_size   = it->first;
+            const uint64_t block_offset = it->second;
+            erase_free(block_offset, block_size);
+            if (block_size > size)
+            {
+                insert_free(block_offset + size, block_size - size);
+            }
+
+            uint32_t id = invalid_id;
+            if (!m_ids_free.empty())
+            {
+                id = m_ids_free.back();
+                m_ids_free.pop_back();
+            }
+            else
+            {
+                id = static_cast<uint32_t>(m_allocations.size());
+                m_allocations.emplace_back();
+            }
+
+            m_allocations[id] = { block_offset, size, true };
+            m_used           += size;
+
+            return id;
+        }
+
+        void Free(const uint32_t id)
+        {
+            if (id >= m_allocations.size() || !m_allocations[id].alive)
+                return;
+
+            Allocation& allocation = m_allocations[id];
+            uint64_t offset        = allocation.offset;
+            uint64_t size          = allocation.size;
+            allocation.alive       = false;
+            m_used                -= size;
+            m_ids_free.push_back(id);
+
+            // coalesce with the next free range
+            auto next = m_free_by_offset.find(offset + size);
+            if (next != m_free_by_offset.end())
+            {
+                const uint64_t next_size = next->second;
+                erase_free(next->first, next_size);
+                size += next_size;
+            }
+
+            // coalesce with the previous free range
+            auto previous = m_free_by_offset.lower_bound(offset);
+            if (previous != m_free_by_offset.begin())
+            {
+                --previous;
+                if (previous->first + previous->second == offset)
+                {
+                    const uint64_t previous_offset = previous->first;
+                    size                          += previous->second;
+                    erase_free(previous_offset, previous->second);
+                    offset = previous_offset;
+                }
+            }
+
+            insert_free(offset, size);
+        }
+
+        // extends the address space, the new space is merged with a free range at the end (if any)
+        void Grow(const uint64_t capacity)
+        {
+            if (capacity <= m_capacity)
+                return;
+
+            uint64_t offset = m_capacity;
+            uint64_t size   = capacity - m_capacity;
+            if (!m_free_by_offset.empty())
+            {
+                auto last = std::prev(m_free_by_offset.end());
+                if (last->first + last->second == m_capacity)
+                {
+                    offset = last->first;
+                    size  += last->second;
+                    erase_free(last->first, last->second);
+                }
+            }
+
+            m_capacity = capacity;
+            insert_free(offset, size);
+        }
+
+        // packs all allocations to the start of the address space, in offset order, and returns the copies that
+        // have to be made, they are in ascending order and always move data down, so they can be applied in place
+        // front to back (with memmove semantics) or as regions of a copy into a new buffer
+        void Defragment(std::vector<Move>& moves)
+        {
+            moves.clear();
+
+            std::vector<uint32_t> ids;
+            for (uint32_t id = 0; id < static_cast<uint32_t>(m_allocations.size()); id++)
+            {
+                if (m_allocations[id].alive)
+                {
+                    ids.push_back(id);
+                }
+            }
+            std::sort(ids.begin(), ids.end(), [this](uint32_t a, uint32_t b) { return m_allocations[a].offset < m_allocations[b].offset; });
+
+            uint64_t offset = 0;
+            for (uint32_t id : ids)
+            {
+                Allocation& allocation = m_allocations[id];
+                if (allocation.offset != offset)
+                {
+                    moves.push_back({ allocation.offset, offset, allocation.size });
+                    allocation.offset = offset;
+                }
+                offset += allocation.size;
+            }
+
+            m_free_by_offset.clear();
+            m_free_by_size.clear();
+            if (offset < m_capacity)
+            {
+                insert_free(offset, m_capacity - offset);
+            }
+        }
+
+        uint64_t GetOffset(const uint32_t id) const { return m_allocations[id].offset; }
+        uint64_t GetSize(const uint32_t id) const   { return m_allocations[id].size; }
+        bool IsAllocated(const uint32_t id) const   { return id < m_allocations.size() && m_allocations[id].alive; }
+        uint64_t GetCapacity() const                { return m_capacity; }
+
+        Stats GetStats() const
+        {
+            Stats stats;
+            stats.capacity         = m_capacity;
+            stats.used             = m_used;
+            stats.free             = m_capacity - m_used;
+            stats.largest_free     = m_free_by_size.empty() ? 0 : std::prev(m_free_by_size.end())->first;
+            stats.allocation_count = static_cast<uint32_t>(m_allocations.size() - m_ids_free.size());
+            stats.free_block_count = static_cast<uint32_t>(m_free_by_offset.size());
+            stats.fragmentation    = stats.free > 0 ? 1.0f - static_cast<float>(stats.largest_free) / static_cast<float>(stats.free) : 0.0f;
+            return stats;
+        }
+
+    private:
+        struct Allocation
+        {
+            uint64_t offset = 0;
+            uint64_t size   = 0;
+            bool alive      = false;
+        };
+
+        void insert_free(const uint64_t offset, const uint64_t size)
+        {
+            m_free_by_offset.emplace(offset, size);
+            m_free_by_size.emplace(size, offset);
+        }
+
+        void erase_free(const uint64_t offset, const uint64_t size)
+        {
+            m_free_by_offset.erase(offset);
+            auto range = m_free_by_size.equal_range(size);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == offset)
+                {
+                    m_free_by_size.erase(it);
+                    break;
+                }
+            }
+        }
+
+        uint64_t m_capacity = 0;
+        uint64_t m_used     = 0;
+        std::vector<Allocation> m_allocations;
+        std::vector<uint32_t> m_ids_free;
+        std::map<uint64_t, uint64_t> m_free_by_offset;    // offset -> size
+        std::multimap<uint64_t, uint64_t> m_free_by_size; // size -> offset
+    };
+}
@@ -19,10 +19,11 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========
+//= INCLUDES ===================
 #include "pch.h"
 #include "ThreadPool.h"
-//====================
+#include "../Profiling/Trace.h"
+//==============================
 
 //= NAMESPACES =====
 using namespace std;
@@ -39,44 +40,59 @@ namespace spartan
         // Sync objects
         static mutex mutex_tasks;
         static condition_variable condition_var;
+        static condition_variable condition_var_idle; // signaled when the last working thread finishes its task
 
         // Threads
         static vector<thread> threads;
 
         // Tasks
         static deque<Task> tasks;
+        static deque<Task> tasks_urgent; // taken before any regular task, for work something is blocked on every frame
 
         // Misc
         static bool is_stopping;
     }
 
-    static void thread_loop()
+    static void thread_loop(const uint32_t index)
     {
+        Trace::SetThreadName("worker_" + to_string(index));
+
         while (true)
         {
             // Lock tasks mutex
             unique_lock<mutex> lock(mutex_tasks);
 
             // Check condition on notification
-            condition_var.wait(lock, [] { return !tasks.empty() || is_stopping; });
+            condition_var.wait(lock, [] { return !tasks_urgent.empty() || !tasks.empty() || is_stopping; });
 
             // If m_stopping is true, it's time to shut everything down
-            if (is_stopping && tasks.empty())
+            if (is_stopping && tasks_urgent.empty() && tasks.empty())
                 return;
 
-            // Get next task in the queue.
-            Task task = tasks.front();
+            // Get next task in the queue, urgent ones first
+            deque<Task>& queue = !tasks_urgent.empty() ? tasks_urgent : tasks;
+            Task task          = move(queue.front());
 
             // Remove it from the queue.
-            tasks.pop_front();
+            queue.pop_front();
+
+            // Count it as running before unlocking, so a flush can't miss it
+            working_thread_count++;
 
             // Unlock the mutex
             lock.unlock();
 
             // Execute the task.
-            working_thread_count++;
-            task();
-            working_thread_count--;
+            {
+                TraceScope trace_scope("task");
+                task();
+            }
+
+            lock.lock();
+            if (--working_thread_count == 0)
+            {
+                condition_var_idle.notify_all();
+            }
         }
     }
 
@@ -89,7 +105,7 @@ namespace spartan
 
         for (uint32_t i = 0; i < thread_count; i++)
         {
-            threads.emplace_back(thread(&thread_loop));
+            threads.emplace_back(thread(&thread_loop, i));
         }
 
         SP_LOG_INFO("%d threads have been created", thread_count);
@@ -121,8 +137,10 @@ namespace spartan
         threads.clear();
     }
 
-    future<void> ThreadPool::AddTask(Task&& task)
+    future<void> ThreadPool::AddTask(Task&& task, const bool is_urgent /*= false*/)
     {
+        TraceScope trace_scope("ThreadPool::AddTask");
+
         // create a packaged task that will give us a future
         auto packaged_task = make_shared<std::packaged_task<void()>>(std::forward<Task>(task));
         
@@ -133,8 +151,11 @@ namespace spartan
         unique_lock<mutex> lock(mutex_tasks);
         
         // save the task - wrap the packaged_task in a lambda that will execute it
-        tasks.emplace_back([packaged_task]()
+        // the flow links the task, in the trace, to where it was added
+        const uint64_t flow_id = Trace::FlowBegin("task");
+        (is_urgent ? tasks_urgent : tasks).emplace_back([packaged_task, flow_id]()
         {
+            Trace::FlowEnd("task", flow_id);
             (*packaged_task)();
         });
         
@@ -150,57 +171,80 @@ namespace spartan
 
     void ThreadPool::ParallelLoop(function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total)
     {
-        SP_ASSERT_MSG(work_total > 1, "A parallel loop can't have a range of 1 or smaller");
-
-        uint32_t available_threads = GetIdleThreadCount();
-        uint32_t work_per_thread   = work_total / available_threads;
-        uint32_t work_remainder    = work_total % available_threads;
-        uint32_t work_index        = 0;
-        atomic<uint32_t> work_done = 0;
-        condition_variable cv;
-        mutex cv_m;
-
-        // split work into multiple tasks
-        while (work_index < work_total)
+        // nothing to split, so callers don't have to guard against small ranges themselves
+        if (work_total == 0)
+            return;
+
+        if (work_total == 1)
         {
-            uint32_t work_to_do = work_per_thread;
+            function(0, work_total);
+            return;
+        }
 
-            // if the work doesn't divide evenly across threads, add the remainder work to the first thread.
-            if (work_remainder != 0)
+        // the range is split into one chunk per idle worker plus one for the caller, and chunks are claimed rather than
+        // assigned, the caller claims them too, so the loop finishes even if no worker gets to its task (e.g. when every
+        // worker is itself blocked in a parallel loop), and a task that starts late just finds nothing left to do
+        struct Loop
+        {
+            const std::function<void(uint32_t, uint32_t)>* function = nullptr;
+            uint32_t work_total                                     = 0;
+            uint32_t chunk_size                                     = 0;
+            uint32_t chunk_count                                    = 0;
+            atomic<uint32_t> chunk_next                             = 0;
+
+            // owned by the tasks as well, a task can still be returning from the notify after the caller's wait is satisfied
+            mutex mutex_done;
+            condition_variable condition_done;
+            uint32_t chunks_done = 0;
+        };
+        const uint32_t chunk_count_max = GetIdleThreadCount() + 1;
+        shared_ptr<Loop> loop          = make_shared<Loop>();
+        loop->function                 = &function;
+        loop->work_total               = work_total;
+        loop->chunk_size               = (work_total + chunk_count_max - 1) / chunk_count_max;
+        loop->chunk_count              = (work_total + loop->chunk_size - 1) / loop->chunk_size;
+
+        auto run_chunks = [](Loop& loop)
+        {
+            for (uint32_t chunk = loop.chunk_next++; chunk < loop.chunk_count; chunk = loop.chunk_next++)
             {
-                work_to_do     += work_remainder;
-                work_remainder = 0;
+                const uint32_t work_index_start = chunk * loop.chunk_size;
+                const uint32_t work_index_end   = min(work_index_start + loop.chunk_size, loop.work_total);
+                (*loop.function)(work_index_start, work_index_end);
+
+                // counted and notified under the lock, so the notification can't fall between the caller's check and its wait
+                lock_guard<mutex> lock(loop.mutex_done);
+                if (++loop.chunks_done == loop.chunk_count)
+                {
+                    loop.condition_done.notify_one();
+                }
             }
+        };
 
-            AddTask([&function, &work_done, &cv, work_index, work_to_do]()
-            {
-                function(work_index, work_index + work_to_do);
-                work_done += work_to_do;
-
-                cv.notify_one(); // notify that a thread has finished its work
-            });
-
-            work_index += work_to_do;
+        for (uint32_t i = 1; i < loop->chunk_count; i++)
+        {
+            AddTask([loop, run_chunks]() { run_chunks(*loop); });
         }
 
-        // wait for threads to finish work
-        unique_lock<mutex> lk(cv_m);
-        cv.wait(lk, [&]() { return work_done == work_total; });
+        // work alongside the workers, then wait for the chunks they claimed
+        run_chunks(*loop);
+        unique_lock<mutex> lock(loop->mutex_done);
+        loop->condition_done.wait(lock, [&]() { return loop->chunks_done == loop->chunk_count; });
     }
 
     void ThreadPool::Flush(bool remove_queued /*= false*/)
     {
+        unique_lock<mutex> lock(mutex_tasks);
+
         // clear any queued tasks
         if (remove_queued)
         {
+            tasks_urgent.clear();
             tasks.clear();
         }
 
         // wait for any tasks to complete
-        while (AreTasksRunning())
-        {
-            this_thread::sleep_for(chrono::milliseconds(16));
-        }
+        condition_var_idle.wait(lock, [] { return working_thread_count == 0; });
     }
 
     uint32_t ThreadPool::GetThreadCount()        { return thread_count; }
@@ -36,8 +36,8 @@ namespace spartan
         static void Initialize();
         static void Shutdown();
 
-        // add a task
-        static std::future<void> AddTask(Task&& task);
+        // add a task, urgent tasks run before any queued regular task (for work that a frame waits on)
+        static std::future<void> AddTask(Task&& task, const bool is_urgent = false);
 
         // spread execution of a given function across all available threads
         static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total);
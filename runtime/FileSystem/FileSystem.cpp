@@ -516,6 +516,50 @@ namespace spartan
         return file_paths;
     }
 
+    vector<FileSystemEntry> FileSystem::GetEntriesInDirectory(const string& path)
+    {
+        vector<FileSystemEntry> directories;
+        vector<FileSystemEntry> files;
+
+        // the directory iterator caches what the os returns while enumerating, so the type (and on windows the
+        // size and time) of each entry doesn't cost an extra query, errors skip the entry instead of throwing
+        error_code error;
+        for (filesystem::directory_iterator it(path, filesystem::directory_options::skip_permission_denied, error), it_end; !error && it != it_end; it.increment(error))
+        {
+            error_code error_entry;
+            FileSystemEntry entry;
+            entry.is_directory = it->is_directory(error_entry);
+            if (!entry.is_directory && !it->is_regular_file(error_entry))
+                continue;
+
+            try
+            {
+                // a system_error is possible if the characters are something that can't be converted, like russian
+                entry.path = it->path().string();
+            }
+            catch (system_error& e)
+            {
+                SP_LOG_WARNING("Failed to read a path. %s", e.what());
+                continue;
+            }
+
+            if (!entry.is_directory)
+            {
+                const uint64_t size = it->file_size(error_entry);
+                entry.size          = error_entry ? 0 : size;
+                const auto time     = it->last_write_time(error_entry);
+                entry.time_modified = error_entry ? 0 : static_cast<uint64_t>(time.time_since_epoch().count());
+            }
+
+            (entry.is_directory ? directories : files).push_back(move(entry));
+        }
+
+        directories.reserve(directories.size() + files.size());
+        move(files.begin(), files.end(), back_inserter(directories));
+
+        return directories;
+    }
+
     bool FileSystem::IsSupportedAudioFile(const string& path)
     {
         const string extension = GetExtensionFromFilePath(path);
@@ -29,6 +29,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace spartan
 {
+    struct FileSystemEntry
+    {
+        std::string path;
+        uint64_t size          = 0; // bytes, files only
+        uint64_t time_modified = 0; // file clock ticks, only comparable with other values of this
+        bool is_directory      = false;
+    };
+
     class FileSystem
     {
     public:
@@ -80,6 +88,7 @@ namespace spartan
         static std::string GetParentDirectory(const std::string& path);
         static std::vector<std::string> GetDirectoriesInDirectory(const std::string& path);
         static std::vector<std::string> GetFilesInDirectory(const std::string& path);
+        static std::vector<FileSystemEntry> GetEntriesInDirectory(const std::string& path); // directories first, then files, in a single pass
         static bool Exists(const std::string& path);
         static bool IsDirectoryEmpty(const std::string& path);
         static bool IsDirectory(const std::string& path);
@@ -95,12 +104,13 @@ namespace spartan
         static bool IsExecutableInPath(const std::string& executable);
     };
 
-    static const char* EXTENSION_WORLD    = ".world";
-    static const char* EXTENSION_MATERIAL = ".xml";
-    static const char* EXTENSION_MODEL    = ".model";
-    static const char* EXTENSION_PREFAB   = ".prefab";
-    static const char* EXTENSION_SHADER   = ".shader";
-    static const char* EXTENSION_FONT     = ".font";
-    static const char* EXTENSION_MESH     = ".mesh";
-    static const char* EXTENSION_AUDIO    = ".audio";
+    static const char* EXTENSION_WORLD     = ".world";
+    static const char* EXTENSION_MATERIAL  = ".xml";
+    static const char* EXTENSION_MODEL     = ".model";
+    static const char* EXTENSION_PREFAB    = ".prefab";
+    static const char* EXTENSION_SHADER    = ".shader";
+    static const char* EXTENSION_FONT      = ".font";
+    static const char* EXTENSION_MESH      = ".mesh";
+    static const char* EXTENSION_AUDIO     = ".audio";
+    static const char* EXTENSION_ANIMATION = ".animation";
 }
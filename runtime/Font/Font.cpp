@@ -22,10 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===============================
 #include "pch.h"
 #include "Font.h"
+#include "FontLayout.h"
 #include "../Rendering/Renderer.h"
 #include "../Resource/Import/FontImporter.h"
 #include "../RHI/RHI_Buffer.h"
-#include "../RHI/RHI_CommandList.h"
 //==========================================
 
 //= NAMESPACES ===============
@@ -37,18 +37,47 @@ namespace spartan
 {
     namespace
     {
-        const uint8_t ASCII_TAB      = 9;
-        const uint8_t ASCII_NEW_LINE = 10;
-        const uint8_t ASCII_SPACE    = 32;
+        const uint32_t quad_count_initial  = 4096;
+        const uint32_t quad_count_max      = 250000; // per frame
+        const uint64_t text_cache_lifetime = 4;      // frames an unused entry survives
+
+        uint64_t hash_placement(const Vector2& position, const float viewport_width, const float viewport_height)
+        {
+            uint64_t seed = 0;
+            seed ^= hash<float>()(position.x)      + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= hash<float>()(position.y)      + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= hash<float>()(viewport_width)  + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= hash<float>()(viewport_height) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+
+        shared_ptr<RHI_Buffer> create_vertex_buffer(const uint32_t quad_count)
+        {
+            return make_shared<RHI_Buffer>(RHI_Buffer_Type::Vertex, sizeof(RHI_Vertex_PosTex), quad_count * 4, nullptr, true, "font_vertex");
+        }
+
+        shared_ptr<RHI_Buffer> create_index_buffer(const uint32_t quad_count)
+        {
+            // two triangles per quad: left-top, right-bottom, left-bottom and left-top, right-top, right-bottom
+            vector<uint32_t> indices(static_cast<size_t>(quad_count) * 6);
+            for (uint32_t quad = 0; quad < quad_count; quad++)
+            {
+                const uint32_t vertex = quad * 4;
+                uint32_t* index       = &indices[static_cast<size_t>(quad) * 6];
+                index[0]              = vertex + 0;
+                index[1]              = vertex + 1;
+                index[2]              = vertex + 2;
+                index[3]              = vertex + 0;
+                index[4]              = vertex + 3;
+                index[5]              = vertex + 1;
+            }
+
+            return make_shared<RHI_Buffer>(RHI_Buffer_Type::Index, sizeof(uint32_t), static_cast<uint32_t>(indices.size()), indices.data(), false, "font_index");
+        }
     }
 
     Font::Font(const string& file_path, const uint32_t font_size, const Color& color) : IResource(ResourceType::Font)
     {
-        for (uint32_t i = 0; i < buffer_count; i++)
-        {
-            m_buffers_vertex[i] = make_shared<RHI_Buffer>();
-            m_buffers_index[i]  = make_shared<RHI_Buffer>();
-        }
         m_color = color;
 
         SetSize(font_size);
@@ -71,25 +100,74 @@ namespace spartan
             return;
         }
 
-        // find max character height (todo, actually get spacing from FreeType)
-        for (const auto& char_info : m_glyphs)
+        // the glyphs changed, so any laid out text is stale
+        m_text_cache.clear();
+
+        SP_LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
+    }
+
+    RHI_Vertex_PosTex* Font::reserve_quads(uint32_t& quad_count)
+    {
+        const uint32_t quad_count_available = quad_count_max - m_quad_count;
+        if (quad_count > quad_count_available)
+        {
+            SP_LOG_WARNING("Text input too large, quad limit (%u) reached. Truncating text.", quad_count_max);
+            quad_count = quad_count_available;
+        }
+
+        if (quad_count == 0)
+            return nullptr;
+
+        // grow (by doubling), the quads written so far this frame are carried over
+        shared_ptr<RHI_Buffer>& buffer = m_buffers_vertex[m_buffer_index];
+        const uint32_t capacity        = buffer ? buffer->GetElementCount() / 4 : 0;
+        if (m_quad_count + quad_count > capacity)
         {
-            m_char_max_width    = max(char_info.second.width, m_char_max_width);
-            m_char_max_height   = max(char_info.second.height, m_char_max_height);
+            const uint32_t capacity_new   = min(max(max(capacity * 2, quad_count_initial), m_quad_count + quad_count), quad_count_max);
+            shared_ptr<RHI_Buffer> buffer_new = create_vertex_buffer(capacity_new);
+            if (buffer && m_quad_count > 0)
+            {
+                memcpy(buffer_new->GetMappedData(), buffer->GetMappedData(), static_cast<size_t>(m_quad_count) * 4 * sizeof(RHI_Vertex_PosTex));
+            }
+            buffer = buffer_new;
         }
 
-        SP_LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
+        RHI_Vertex_PosTex* vertices = static_cast<RHI_Vertex_PosTex*>(buffer->GetMappedData()) + static_cast<size_t>(m_quad_count) * 4;
+        m_quad_count               += quad_count;
+
+        return vertices;
     }
 
     void Font::AddText(const std::string& text, const Vector2& position_screen_percentage)
     {
-        // define a maximum vertex limit
-        const uint32_t max_vertices = 1000000;
-        uint32_t vertex_offset      = static_cast<uint32_t>(m_vertices.size());
+        if (text.empty())
+            return;
 
         const float viewport_width  = Renderer::GetViewport().width;
         const float viewport_height = Renderer::GetViewport().height;
 
+        // same text, at the same place, as a previous frame, copy the vertices it produced
+        const uint64_t key       = hash_placement(position_screen_percentage, viewport_width, viewport_height);
+        const uint64_t text_hash = hash<string>()(text);
+        auto it                  = m_text_cache.find(key);
+        if (it != m_text_cache.end() && it->second.text_hash == text_hash)
+        {
+            CachedText& cached = it->second;
+            cached.frame_used  = m_frame;
+
+            uint32_t quad_count = static_cast<uint32_t>(cached.vertices.size() / 4);
+            if (quad_count == 0)
+                return;
+
+            // the quads are in glyph order, so copying fewer of them truncates the text
+            if (RHI_Vertex_PosTex* vertices = reserve_quads(quad_count))
+            {
+                memcpy(vertices, cached.vertices.data(), static_cast<size_t>(quad_count) * 4 * sizeof(RHI_Vertex_PosTex));
+            }
+
+            return;
+        }
+
         // convert screen percentage to pixel coordinates
         Vector2 position;
         position.x = viewport_width  * position_screen_percentage.x;
@@ -98,121 +176,80 @@ namespace spartan
         // make the origin be the top left corner
         position.x -= 0.5f * viewport_width;
         position.y += 0.5f * viewport_height;
-    
-        // generate vertices - draw each letter onto a quad
-        Vector2 cursor = position;
-        for (char character : text)
-        {
-            // check if adding this character would exceed the vertex limit
-            if (m_vertices.size() + 6 > max_vertices)
-            {
-                SP_LOG_WARNING("Text input too large, vertex limit (%u) reached. Truncating text.", max_vertices);
-                break;
-            }
-    
-            Glyph& glyph = m_glyphs[character];
-    
-            if (character == ASCII_TAB)
-            {
-                const float space_offset = static_cast<float>(m_glyphs[ASCII_SPACE].horizontal_advance);
-                const float tab_spacing  = space_offset * 4.0f;
-                float relative_x         = cursor.x - position.x;
-                float k                  = std::floor((relative_x + tab_spacing) / tab_spacing);
-                float next_tab_stop      = position.x + k * tab_spacing;
-                cursor.x                 = next_tab_stop;
-            }
-            else if (character == ASCII_NEW_LINE)
-            {
-                cursor.x  = position.x;
-                cursor.y -= m_char_max_height;
-            }
-            else if (character == ASCII_SPACE)
-            {
-                cursor.x += glyph.horizontal_advance;
-            }
-            else
-            {
-                // first triangle in quad
-                m_vertices.push_back({cursor.x + glyph.offset_x,               cursor.y + glyph.offset_y,                0.0f, glyph.uv_x_left,  glyph.uv_y_top});
-                m_vertices.push_back({cursor.x + glyph.offset_x + glyph.width, cursor.y + glyph.offset_y - glyph.height, 0.0f, glyph.uv_x_right, glyph.uv_y_bottom});
-                m_vertices.push_back({cursor.x + glyph.offset_x,               cursor.y + glyph.offset_y - glyph.height, 0.0f, glyph.uv_x_left,  glyph.uv_y_bottom});
-    
-                // second triangle in quad
-                m_vertices.push_back({cursor.x + glyph.offset_x,               cursor.y + glyph.offset_y,                0.0f, glyph.uv_x_left,  glyph.uv_y_top});
-                m_vertices.push_back({cursor.x + glyph.offset_x + glyph.width, cursor.y + glyph.offset_y,                0.0f, glyph.uv_x_right, glyph.uv_y_top});
-                m_vertices.push_back({cursor.x + glyph.offset_x + glyph.width, cursor.y + glyph.offset_y - glyph.height, 0.0f, glyph.uv_x_right, glyph.uv_y_bottom});
-    
-                // add indices for the two triangles
-                for (uint32_t i = 0; i < 6; ++i)
-                {
-                    m_indices.push_back(vertex_offset + i);
-                }
-    
-                // advance the cursor and vertex offset
-                cursor.x      += glyph.horizontal_advance;
-                vertex_offset += 6;
-            }
-        }
+
+        // the atlas glyphs are scaled to the requested size
+        const float scale = m_atlas_font_size != 0 ? static_cast<float>(m_font_size) / static_cast<float>(m_atlas_font_size) : 1.0f;
+
+        // count the visible glyphs, so that the whole string can be reserved at once
+        const uint32_t quad_count = font_layout::count_quads(text);
+
+        // near the quad limit, only the glyphs that fit are written
+        uint32_t quad_count_reserved = quad_count;
+        RHI_Vertex_PosTex* vertices  = quad_count > 0 ? reserve_quads(quad_count_reserved) : nullptr;
+        if (quad_count > 0 && !vertices)
+            return;
+
+        // generate vertices - draw each letter onto a quad, the glyphs are padded by the spread so lines are that much closer
+        const float line_height = (m_glyphs.GetMaxHeight() - m_atlas_spread * 2) * scale;
+        font_layout::write_quads(m_glyphs, text, position, scale, line_height, vertices, quad_count_reserved);
+
+        // truncated text isn't cached, so that it's laid out in full once there is room again
+        if (quad_count_reserved != quad_count)
+            return;
+
+        // assign() keeps the capacity of an entry that is being replaced, so no allocation once it's large enough
+        CachedText& cached = m_text_cache[key];
+        cached.text_hash   = text_hash;
+        cached.frame_used  = m_frame;
+        cached.vertices.assign(vertices, vertices + static_cast<size_t>(quad_count) * 4);
     }
 
     bool Font::HasText() const
     {
-        return !m_vertices.empty() && !m_indices.empty();
+        return m_quad_count != 0;
     }
 
     void Font::SetSize(const uint32_t size)
     {
+        // the atlas is a distance field, so a new size is just a new scale
         m_font_size = clamp<uint32_t>(size, 8, 50);
+        m_text_cache.clear();
     }
 
-    void Font::UpdateVertexAndIndexBuffers(RHI_CommandList* cmd_list)
+    float Font::GetOutlineWidthDistance() const
     {
-        m_buffer_index = (m_buffer_index + 1) % buffer_count;
-    
-        // grow gpu buffers if needed
+        if (m_atlas_spread == 0 || m_atlas_font_size == 0)
+            return 0.0f;
+
+        // screen pixels to atlas pixels, then to distance units (the spread maps to 0.5)
+        const float atlas_pixels = static_cast<float>(m_outline_size) * static_cast<float>(m_atlas_font_size) / static_cast<float>(m_font_size);
+        return min(atlas_pixels * 0.5f / static_cast<float>(m_atlas_spread), 0.5f);
+    }
+
+    void Font::UpdateVertexAndIndexBuffers()
+    {
+        // the index buffer never changes, unless more quads have to be drawn than ever before
+        if (!m_buffer_index_quads || m_quad_count * 6 > m_buffer_index_quads->GetElementCount())
         {
-            if (m_vertices.size() > m_buffers_vertex[m_buffer_index]->GetElementCount())
-            {
-                m_buffers_vertex[m_buffer_index] = make_shared<RHI_Buffer>(
-                    RHI_Buffer_Type::Vertex,                                          // type
-                    static_cast<uint32_t>(m_vertices.size()) * sizeof(m_vertices[0]), // stride
-                    1,                                                                // element count
-                    m_vertices.data(),                                                // data
-                    true,                                                             // mappable
-                    "font_vertex"
-                );
-            }
-        
-            if (m_indices.size() > m_buffers_index[m_buffer_index]->GetElementCount())
+            uint32_t capacity = m_buffer_index_quads ? m_buffer_index_quads->GetElementCount() / 6 : quad_count_initial;
+            while (capacity < m_quad_count)
             {
-                m_buffers_index[m_buffer_index] = make_shared<RHI_Buffer>(
-                    RHI_Buffer_Type::Index,                                         // type
-                    static_cast<uint32_t>(m_indices.size()) * sizeof(m_indices[0]), // stride
-                    1,                                                              // element count
-                    m_indices.data(),                                               // data
-                    true,                                                           // mappable
-                    "font_index"
-                );
+                capacity *= 2;
             }
+            m_buffer_index_quads = create_index_buffer(min(capacity, quad_count_max));
         }
-    
-        // map vertices and indices to gpu buffers
-        uint64_t vertex_data_size = static_cast<uint64_t>(m_vertices.size()) * sizeof(m_vertices[0]);
-        cmd_list->UpdateBuffer(m_buffers_vertex[m_buffer_index].get(), 0, vertex_data_size, m_vertices.data());
-        
-        uint64_t index_data_size = static_cast<uint64_t>(m_indices.size()) * sizeof(m_indices[0]);
-        cmd_list->UpdateBuffer(m_buffers_index[m_buffer_index].get(), 0, index_data_size, m_indices.data());
-    
-        // store the used index count
-        m_index_count[m_buffer_index] = static_cast<uint32_t>(m_indices.size());
-    
-        // clear vertices and indices
-        m_vertices.clear();
-        m_indices.clear();
-    }
 
-    uint32_t Font::GetIndexCount()
-    {
-        return m_index_count[m_buffer_index];
+        // the vertices are already in the buffer, draw it and move on to the next one
+        m_buffer_index_draw = m_buffer_index;
+        m_index_count       = m_quad_count * 6;
+        m_buffer_index      = (m_buffer_index + 1) % buffer_count;
+        m_quad_count        = 0;
+
+        // forget text that is no longer drawn
+        m_frame++;
+        for (auto it = m_text_cache.begin(); it != m_text_cache.end();)
+        {
+            it = (m_frame - it->second.frame_used > text_cache_lifetime) ? m_text_cache.erase(it) : next(it);
+        }
     }
 }
@@ -33,7 +33,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace spartan
 {
     class RHI_Buffer;
-    class RHI_CommandList;
     class RHI_Texture;
 
     namespace math
@@ -86,24 +85,25 @@ namespace spartan
         void SetOutlineSize(const uint32_t outline_size) { m_outline_size = outline_size; }
         const uint32_t GetOutlineSize() const            { return m_outline_size; }
 
-        // atlas
-        const auto& GetAtlas() const                                    { return m_atlas; }
-        void SetAtlas(const std::shared_ptr<RHI_Texture>& atlas)        { m_atlas = atlas; }
-        const auto& GetAtlasOutline() const                             { return m_atlas_outline; }
-        void SetAtlasOutline(const std::shared_ptr<RHI_Texture>& atlas) { m_atlas_outline = atlas; }
+        // atlas, a signed distance field which serves every size and outline
+        const auto& GetAtlas() const                             { return m_atlas; }
+        void SetAtlas(const std::shared_ptr<RHI_Texture>& atlas) { m_atlas = atlas; }
+        void SetAtlasFontSize(const uint32_t size)               { m_atlas_font_size = size; }
+        void SetAtlasSpread(const uint32_t spread)               { m_atlas_spread = spread; }
+        float GetOutlineWidthDistance() const; // the outline size, in the units of the distance field (where 0.5 is the edge)
 
         // misc
-        void UpdateVertexAndIndexBuffers(RHI_CommandList* cmd_list);
-        uint32_t GetIndexCount();
+        void UpdateVertexAndIndexBuffers();
+        uint32_t GetIndexCount() const { return m_index_count; }
 
         // properties
         void SetSize(uint32_t size);
-        RHI_Buffer* GetIndexBuffer() const                          { return m_buffers_index[m_buffer_index].get(); }
-        RHI_Buffer* GetVertexBuffer() const                         { return m_buffers_vertex[m_buffer_index].get(); }
+        RHI_Buffer* GetIndexBuffer() const                          { return m_buffer_index_quads.get(); }
+        RHI_Buffer* GetVertexBuffer() const                         { return m_buffers_vertex[m_buffer_index_draw].get(); }
         uint32_t GetSize() const                                    { return m_font_size; }
         Font_Hinting_Type GetHinting() const                        { return m_hinting; }
         auto GetForceAutohint() const                               { return m_force_autohint; }
-        void SetGlyph(const uint32_t char_code, const Glyph& glyph) { m_glyphs[char_code] = glyph; }
+        void SetGlyph(const uint32_t char_code, const Glyph& glyph) { m_glyphs.Set(char_code, glyph); }
 
     private:
         uint32_t m_font_size        = 14;
@@ -113,18 +113,31 @@ namespace spartan
         Font_Outline_Type m_outline = Font_Outline_Positive;
         Color m_color               = Color(1.0f, 1.0f, 1.0f, 1.0f);
         Color m_color_outline       = Color(0.0f, 0.0f, 0.0f, 1.0f);
-        uint32_t m_char_max_width   = 0;
-        uint32_t m_char_max_height  = 0;
-        std::unordered_map<uint32_t, Glyph> m_glyphs;
+        GlyphTable m_glyphs;
         std::shared_ptr<RHI_Texture> m_atlas;
-        std::shared_ptr<RHI_Texture> m_atlas_outline;
-        std::vector<RHI_Vertex_PosTex> m_vertices;
-        std::vector<uint32_t> m_indices;
-
-        static const uint32_t buffer_count               = 8;
-        uint32_t m_buffer_index                          = 0;
-        std::array<uint32_t, buffer_count> m_index_count = { 0 };
-        std::array<std::shared_ptr<RHI_Buffer>, buffer_count> m_buffers_index;
+        uint32_t m_atlas_font_size = 0;
+        uint32_t m_atlas_spread    = 0;
+
+        // text that is drawn again (e.g. every frame) skips layout and its vertices are copied as a whole, entries are
+        // keyed by where the text is drawn, so text that changes in place (e.g. a counter) reuses the entry and its storage
+        struct CachedText
+        {
+            uint64_t text_hash = 0;
+            std::vector<RHI_Vertex_PosTex> vertices;
+            uint64_t frame_used = 0;
+        };
+        std::unordered_map<uint64_t, CachedText> m_text_cache;
+        uint64_t m_frame = 0;
+
+        // vertices are written straight into a persistently mapped buffer, one per frame in flight (and then some),
+        // all of them are drawn with a single index buffer which holds the same quad pattern
+        RHI_Vertex_PosTex* reserve_quads(uint32_t& quad_count); // reserves fewer quads (updating the count) once the limit is reached
+        static const uint32_t buffer_count = 8;
+        uint32_t m_buffer_index            = 0; // written to by AddText()
+        uint32_t m_buffer_index_draw       = 0; // drawn by the renderer
+        uint32_t m_quad_count              = 0;
+        uint32_t m_index_count             = 0;
         std::array<std::shared_ptr<RHI_Buffer>, buffer_count> m_buffers_vertex;
+        std::shared_ptr<RHI_Buffer> m_buffer_index_quads;
     };
 }
@@ -0,0 +1,116 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <cmath>
+#include <string>
+#include "Glyph.h"
+#include "../Math/Vector2.h"
+#include "../RHI/RHI_Vertex.h"
+//=================================
+
+// text layout, a string becomes one quad per visible glyph, written straight into the (mapped) vertex memory
+namespace spartan::font_layout
+{
+    const uint8_t ascii_tab      = 9;
+    const uint8_t ascii_new_line = 10;
+    const uint8_t ascii_space    = 32;
+
+    static bool is_visible(const uint8_t code)
+    {
+        return code != ascii_tab && code != ascii_new_line && code != ascii_space;
+    }
+
+    // the number of quads a string needs, so that the whole of it can be reserved at once
+    static uint32_t count_quads(const std::string& text)
+    {
+        uint32_t quad_count = 0;
+        for (char character : text)
+        {
+            quad_count += is_visible(static_cast<uint8_t>(character)) ? 1 : 0;
+        }
+
+        return quad_count;
+    }
+
+    // lays out the text from the top left position, at most quad_count quads are written (fewer truncate the text), returns how many were
+    static uint32_t write_quads(
+        const GlyphTable& glyphs,
+        const std::string& text,
+        const math::Vector2& position,
+        const float scale,
+        const float line_height,
+        RHI_Vertex_PosTex* vertices,
+        const uint32_t quad_count
+    )
+    {
+        RHI_Vertex_PosTex* vertex     = vertices;
+        RHI_Vertex_PosTex* vertex_end = vertices + static_cast<size_t>(quad_count) * 4;
+        math::Vector2 cursor          = position;
+        for (char character : text)
+        {
+            const uint8_t code = static_cast<uint8_t>(character);
+            const Glyph& glyph = glyphs.Get(code);
+
+            if (code == ascii_tab)
+            {
+                const float space_offset = static_cast<float>(glyphs.Get(ascii_space).horizontal_advance) * scale;
+                const float tab_spacing  = space_offset * 4.0f;
+                float relative_x         = cursor.x - position.x;
+                float k                  = std::floor((relative_x + tab_spacing) / tab_spacing);
+                float next_tab_stop      = position.x + k * tab_spacing;
+                cursor.x                 = next_tab_stop;
+            }
+            else if (code == ascii_new_line)
+            {
+                cursor.x  = position.x;
+                cursor.y -= line_height;
+            }
+            else if (code == ascii_space)
+            {
+                cursor.x += glyph.horizontal_advance * scale;
+            }
+            else
+            {
+                if (vertex == vertex_end)
+                    break;
+
+                const float left   = cursor.x + glyph.offset_x * scale;
+                const float right  = left + glyph.width * scale;
+                const float top    = cursor.y + glyph.offset_y * scale;
+                const float bottom = top - glyph.height * scale;
+
+                // quad corners, in the order the shared index buffer expects
+                vertex[0] = { left,  top,    0.0f, glyph.uv_x_left,  glyph.uv_y_top };
+                vertex[1] = { right, bottom, 0.0f, glyph.uv_x_right, glyph.uv_y_bottom };
+                vertex[2] = { left,  bottom, 0.0f, glyph.uv_x_left,  glyph.uv_y_bottom };
+                vertex[3] = { right, top,    0.0f, glyph.uv_x_right, glyph.uv_y_top };
+                vertex   += 4;
+
+                cursor.x += glyph.horizontal_advance * scale;
+            }
+        }
+
+        return static_cast<uint32_t>((vertex - vertices) / 4);
+    }
+}
@@ -0,0 +1,302 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==============
+#include <vector>
+#include <fstream>
+#include <utility>
+#include "Glyph.h"
+#include "../IO/FileStream.h"
+//=========================
+
+// signed distance field font atlases, a single atlas serves every font size and outline width, since
+// the shader resolves the edge (and any outline band) from the distance instead of from coverage
+namespace spartan::font_sdf
+{
+    const uint32_t cache_magic   = 0x46445353; // "SSDF"
+    const uint32_t cache_version = 1;
+
+    // limits a cache file has to be within before anything is allocated for it
+    const uint32_t cache_dimension_max   = 16384;
+    const uint32_t cache_glyph_count_max = 65536;
+    const uint64_t cache_header_size     = 36; // magic, version, source hash, font size, spread, width, height and the pixel count
+    const uint64_t cache_glyph_size      = 40; // char code and the glyph fields, as written by save()
+
+    struct Atlas
+    {
+        uint32_t font_size = 0; // the size the glyphs were rasterized at, their metrics are in pixels of that size
+        uint32_t spread    = 0; // the distance, in pixels, that maps to the full [0, 1] range
+        uint32_t width     = 0;
+        uint32_t height    = 0;
+        std::vector<std::byte> pixels; // r8, 0.5 is the glyph edge, above is inside
+        std::vector<std::pair<uint32_t, Glyph>> glyphs;
+    };
+
+    // 1d squared euclidean distance transform (felzenszwalb & huttenlocher), in place, the scratch buffers hold count + 1 elements
+    static void distance_transform_1d(float* f, const uint32_t count, const uint32_t stride, float* d, uint32_t* v, float* z)
+    {
+        const float inf = 1e20f;
+
+        uint32_t k = 0;
+        v[0]       = 0;
+        z[0]       = -inf;
+        z[1]       = inf;
+        for (uint32_t q = 1; q < count; q++)
+        {
+            // intersection of the parabola at q with the lower envelope, z[0] is -inf so this stops at the first parabola
+            const float fq = f[q * stride] + static_cast<float>(q * q);
+            float s        = 0.0f;
+            while (true)
+            {
+                const uint32_t r = v[k];
+                s = (fq - (f[r * stride] + static_cast<float>(r * r))) / static_cast<float>(2 * q - 2 * r);
+                if (s > z[k])
+                    break;
+                k--;
+            }
+
+            k++;
+            v[k]     = q;
+            z[k]     = s;
+            z[k + 1] = inf;
+        }
+
+        k = 0;
+        for (uint32_t q = 0; q < count; q++)
+        {
+            while (z[k + 1] < static_cast<float>(q))
+            {
+                k++;
+            }
+
+            const float delta = static_cast<float>(q) - static_cast<float>(v[k]);
+            d[q]              = delta * delta + f[v[k] * stride];
+        }
+
+        for (uint32_t q = 0; q < count; q++)
+        {
+            f[q * stride] = d[q];
+        }
+    }
+
+    // squared distance, for every pixel, to the nearest pixel which is marked as 0
+    static void distance_transform_2d(std::vector<float>& grid, const uint32_t width, const uint32_t height)
+    {
+        const uint32_t size = std::max(width, height) + 1;
+        std::vector<float> d(size);
+        std::vector<float> z(size + 1);
+        std::vector<uint32_t> v(size);
+
+        for (uint32_t x = 0; x < width; x++)
+        {
+            distance_transform_1d(&grid[x], height, width, d.data(), v.data(), z.data());
+        }
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            distance_transform_1d(&grid[y * width], width, 1, d.data(), v.data(), z.data());
+        }
+    }
+
+    // converts an 8-bit coverage bitmap to a distance field, the output is larger by spread on every side
+    // and is written to a region of the destination, so glyphs can be processed in parallel into one atlas
+    static void generate(const uint8_t* coverage, const uint32_t width, const uint32_t height, const uint32_t spread, std::byte* destination, const uint32_t destination_pitch)
+    {
+        const uint32_t padded_width  = width  + spread * 2;
+        const uint32_t padded_height = height + spread * 2;
+        const size_t pixel_count     = static_cast<size_t>(padded_width) * padded_height;
+        const float inf              = 1e20f;
+
+        // squared distance to the inside (for outside pixels) and to the outside (for inside pixels), the padding is outside
+        std::vector<float> to_inside(pixel_count, inf);
+        std::vector<float> to_outside(pixel_count, 0.0f);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t value = coverage[y * width + x];
+                if (value == 0)
+                    continue;
+
+                const size_t index = static_cast<size_t>(y + spread) * padded_width + (x + spread);
+                if (value == 255)
+                {
+                    to_inside[index]  = 0.0f;
+                    to_outside[index] = inf;
+                }
+                else
+                {
+                    // partially covered, the coverage says how far the edge is from the pixel center
+                    const float offset = 0.5f - static_cast<float>(value) / 255.0f;
+                    to_inside[index]   = offset > 0.0f ? offset * offset : 0.0f;
+                    to_outside[index]  = offset < 0.0f ? offset * offset : 0.0f;
+                }
+            }
+        }
+
+        distance_transform_2d(to_inside,  padded_width, padded_height);
+        distance_transform_2d(to_outside, padded_width, padded_height);
+
+        const float scale = 0.5f / static_cast<float>(spread);
+        for (uint32_t y = 0; y < padded_height; y++)
+        {
+            for (uint32_t x = 0; x < padded_width; x++)
+            {
+                const size_t index   = static_cast<size_t>(y) * padded_width + x;
+                const float distance = std::sqrt(to_inside[index]) - std::sqrt(to_outside[index]); // positive outside
+                const float value    = std::clamp(0.5f - distance * scale, 0.0f, 1.0f);
+
+                destination[static_cast<size_t>(y) * destination_pitch + x] = static_cast<std::byte>(static_cast<uint8_t>(value * 255.0f + 0.5f));
+            }
+        }
+    }
+
+    // identifies the source font and the settings the atlas was generated with, a cache only applies when it matches
+    static uint64_t compute_source_hash(const std::string& font_path, const uint32_t settings)
+    {
+        // fnv-1a over the file contents
+        uint64_t hash = 14695981039346656037ull;
+        auto mix      = [&hash](const uint8_t byte) { hash = (hash ^ byte) * 1099511628211ull; };
+
+        std::ifstream file(font_path, std::ios::binary);
+        char buffer[4096];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+        {
+            for (std::streamsize i = 0; i < file.gcount(); i++)
+            {
+                mix(static_cast<uint8_t>(buffer[i]));
+            }
+        }
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            mix(static_cast<uint8_t>(settings >> (i * 8)));
+        }
+
+        return hash;
+    }
+
+    static bool save(const Atlas& atlas, const std::string& path, const uint64_t source_hash)
+    {
+        FileStream stream(path, FileStream_Write);
+        if (!stream.IsOpen())
+            return false;
+
+        stream.Write(cache_magic);
+        stream.Write(cache_version);
+        stream.Write(source_hash);
+        stream.Write(atlas.font_size);
+        stream.Write(atlas.spread);
+        stream.Write(atlas.width);
+        stream.Write(atlas.height);
+        stream.Write(atlas.pixels);
+        stream.Write(static_cast<uint32_t>(atlas.glyphs.size()));
+        for (const auto& [char_code, glyph] : atlas.glyphs)
+        {
+            stream.Write(char_code);
+            stream.Write(static_cast<int>(glyph.offset_x));
+            stream.Write(static_cast<int>(glyph.offset_y));
+            stream.Write(glyph.width);
+            stream.Write(glyph.height);
+            stream.Write(glyph.horizontal_advance);
+            stream.Write(glyph.uv_x_left);
+            stream.Write(glyph.uv_x_right);
+            stream.Write(glyph.uv_y_top);
+            stream.Write(glyph.uv_y_bottom);
+        }
+
+        return true;
+    }
+
+    // fails (without touching the atlas) if the file is missing, from another version, for another source or malformed
+    static bool load(Atlas& atlas, const std::string& path, const uint64_t source_hash)
+    {
+        // validate the sizes the file claims against its actual size, so that a truncated or corrupt file can't make us allocate
+        uint64_t file_size = 0;
+        uint32_t width     = 0;
+        uint32_t height    = 0;
+        uint32_t pixels    = 0;
+        {
+            std::ifstream probe(path, std::ios::binary | std::ios::ate);
+            if (!probe.good())
+                return false;
+
+            file_size = static_cast<uint64_t>(probe.tellg());
+            if (file_size < cache_header_size + sizeof(uint32_t))
+                return false;
+
+            probe.seekg(24);
+            probe.read(reinterpret_cast<char*>(&width),  sizeof(width));
+            probe.read(reinterpret_cast<char*>(&height), sizeof(height));
+            probe.read(reinterpret_cast<char*>(&pixels), sizeof(pixels));
+            if (!probe.good())
+                return false;
+        }
+
+        if (width == 0 || height == 0 || width > cache_dimension_max || height > cache_dimension_max)
+            return false;
+
+        const uint64_t pixel_count = static_cast<uint64_t>(width) * height;
+        if (pixels != pixel_count || file_size < cache_header_size + pixel_count + sizeof(uint32_t))
+            return false;
+
+        FileStream stream(path, FileStream_Read);
+        if (!stream.IsOpen())
+            return false;
+
+        if (stream.ReadAs<uint32_t>() != cache_magic || stream.ReadAs<uint32_t>() != cache_version || stream.ReadAs<uint64_t>() != source_hash)
+            return false;
+
+        Atlas loaded;
+        stream.Read(&loaded.font_size);
+        stream.Read(&loaded.spread);
+        stream.Read(&loaded.width);
+        stream.Read(&loaded.height);
+        stream.Read(&loaded.pixels);
+        if (loaded.width != width || loaded.height != height || loaded.pixels.size() != pixel_count)
+            return false;
+
+        // the glyphs have a fixed size, so their count has to account for exactly the rest of the file
+        const uint32_t glyph_count = stream.ReadAs<uint32_t>();
+        if (glyph_count > cache_glyph_count_max || file_size != cache_header_size + pixel_count + sizeof(uint32_t) + glyph_count * cache_glyph_size)
+            return false;
+
+        loaded.glyphs.resize(glyph_count);
+        for (auto& [char_code, glyph] : loaded.glyphs)
+        {
+            stream.Read(&char_code);
+            glyph.offset_x = stream.ReadAs<int>();
+            glyph.offset_y = stream.ReadAs<int>();
+            stream.Read(&glyph.width);
+            stream.Read(&glyph.height);
+            stream.Read(&glyph.horizontal_advance);
+            stream.Read(&glyph.uv_x_left);
+            stream.Read(&glyph.uv_x_right);
+            stream.Read(&glyph.uv_y_top);
+            stream.Read(&glyph.uv_y_bottom);
+        }
+
+        atlas = std::move(loaded);
+        return true;
+    }
+}
@@ -21,6 +21,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+//= INCLUDES ==============
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+//=========================
+
 namespace spartan
 {
     struct Glyph
@@ -35,4 +41,46 @@ namespace spartan
         float uv_y_top              = 0.0f;
         float uv_y_bottom           = 0.0f;
     };
+
+    // glyphs of the ascii range are looked up directly, anything else falls back to a map
+    class GlyphTable
+    {
+    public:
+        static const uint32_t ascii_count = 128;
+
+        void Set(const uint32_t char_code, const Glyph& glyph)
+        {
+            if (char_code < ascii_count)
+            {
+                m_ascii[char_code] = glyph;
+            }
+            else
+            {
+                m_extended[char_code] = glyph;
+            }
+
+            m_max_width  = glyph.width  > m_max_width  ? glyph.width  : m_max_width;
+            m_max_height = glyph.height > m_max_height ? glyph.height : m_max_height;
+        }
+
+        // unknown code points return an empty glyph (no size, no advance)
+        const Glyph& Get(const uint32_t char_code) const
+        {
+            if (char_code < ascii_count)
+                return m_ascii[char_code];
+
+            auto it = m_extended.find(char_code);
+            return it != m_extended.end() ? it->second : m_empty;
+        }
+
+        uint32_t GetMaxWidth() const  { return m_max_width; }
+        uint32_t GetMaxHeight() const { return m_max_height; }
+
+    private:
+        std::array<Glyph, ascii_count> m_ascii;
+        std::unordered_map<uint32_t, Glyph> m_extended;
+        Glyph m_empty;
+        uint32_t m_max_width  = 0;
+        uint32_t m_max_height = 0;
+    };
 }
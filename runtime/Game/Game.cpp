@@ -29,6 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Physics.h"
 #include "../World/Components/AudioSource.h"
 #include "../World/Components/Terrain.h"
+#include "../World/Hlod.h"
+#include "../World/StaticBatching.h"
 #include "../Core/ThreadPool.h"
 #include "../Core/ProgressTracker.h"
 #include "../Rendering/Mesh.h"
@@ -753,6 +755,9 @@ namespace spartan
                     material->SetProperty(MaterialProperty::WindAnimation, 1.0f);
                 }
             }
+
+            // thousands of small meshes share a handful of materials
+            StaticBatching::Build();
         }
 
         void create_minecraft()
@@ -807,6 +812,8 @@ namespace spartan
                         physics_body->SetBodyType(BodyType::Mesh);
                     }
                 }
+
+                StaticBatching::Build();
             }
         }
 
@@ -923,14 +930,8 @@ namespace spartan
                     terrain->Generate();
 
                     // add physics so we can walk on it
-                    for(Entity* entity : terrain->GetEntity()->GetChildren())
-                    {
-                        if (entity->GetActive() && entity->GetComponent<Renderable>() != nullptr)
-                        {
-                            Physics* physics_body = entity->AddComponent<Physics>();
-                            physics_body->SetBodyType(BodyType::Mesh);
-                        }
-                    }
+                    Physics* physics_body = terrain->GetEntity()->AddComponent<Physics>();
+                    physics_body->SetBodyType(BodyType::Terrain);
                 }
 
                 // water
@@ -1037,6 +1038,9 @@ namespace spartan
                         }
                     }
                 }
+
+                // merge distant trees and rocks into per cell proxies
+                Hlod::Build();
                 
                 // grass
                 {
@@ -0,0 +1,157 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "../Math/Vector3.h"
+#include "../Math/Matrix.h"
+#include "../Math/Frustum.h"
+//=============================
+
+namespace spartan
+{
+    // a cluster (meshlet) of up to 124 triangles, stored contiguously in the index buffer of a mesh lod
+    struct MeshCluster
+    {
+        uint32_t index_offset = 0;   // relative to the index offset of the lod
+        uint32_t index_count  = 0;
+        math::Vector3 sphere_center; // bounding sphere, in mesh space
+        float sphere_radius   = 0.0f;
+        math::Vector3 cone_apex;     // normal cone, in mesh space
+        math::Vector3 cone_axis;
+        float cone_cutoff     = 1.0f; // cos(angle/2), a value of 1.0 disables backface culling for the cluster
+    };
+
+    // a contiguous range of indices to be drawn
+    struct MeshIndexRange
+    {
+        uint32_t index_offset = 0;
+        uint32_t index_count  = 0;
+    };
+
+    static const uint32_t mesh_cluster_max_vertices    = 64;
+    static const uint32_t mesh_cluster_max_triangles   = 124;
+    static const uint32_t mesh_cluster_min_index_count = mesh_cluster_max_triangles * 3 * 16; // meshes smaller than this are not worth clustering
+}
+
+namespace spartan::geometry_culling
+{
+    struct ClusterCullingParameters
+    {
+        math::Matrix transform      = math::Matrix::Identity; // mesh to world
+        math::Frustum frustum;                                // world space
+        math::Vector3 camera_position;                        // world space
+        float max_distance          = FLT_MAX;                // clusters beyond this distance are culled
+        bool cull_frustum           = true;
+        bool cull_backfaces         = true;                   // only valid if the material culls back faces
+    };
+
+    struct ClusterCullingStats
+    {
+        uint32_t clusters_visible   = 0;
+        uint32_t clusters_frustum   = 0; // culled by the frustum test
+        uint32_t clusters_backface  = 0; // culled by the normal cone test
+        uint32_t clusters_distance  = 0; // culled by the distance test
+    };
+
+    // tests every cluster against the frustum, its normal cone and the max distance, and emits the surviving
+    // clusters as index ranges, adjacent clusters are merged so that a mostly visible mesh still costs only a few draws
+    static ClusterCullingStats cull_clusters(
+        const std::vector<MeshCluster>& clusters,
+        const uint32_t lod_index_offset,
+        const ClusterCullingParameters& parameters,
+        std::vector<MeshIndexRange>& ranges
+    )
+    {
+        using namespace math;
+
+        ranges.clear();
+        ClusterCullingStats stats;
+
+        // bring the bounds into world space, the radius is scaled by the largest axis so that it stays conservative
+        const Matrix& transform = parameters.transform;
+        const Vector3 scale     = transform.GetScale();
+        const float scale_max   = std::max(std::max(std::abs(scale.x), std::abs(scale.y)), std::abs(scale.z));
+        const float scale_min   = std::min(std::min(std::abs(scale.x), std::abs(scale.y)), std::abs(scale.z));
+
+        // normal cones are skewed by non-uniform scale, so only trust them when the scale is (nearly) uniform
+        const bool cull_backfaces   = parameters.cull_backfaces && (scale_max - scale_min) <= scale_max * 0.01f;
+        const float max_distance_sq = parameters.max_distance * parameters.max_distance;
+
+        for (const MeshCluster& cluster : clusters)
+        {
+            const Vector3 center = cluster.sphere_center * transform;
+            const float radius   = std::max(cluster.sphere_radius * scale_max, FLT_MIN);
+
+            // distance
+            if (parameters.max_distance != FLT_MAX)
+            {
+                const float distance = std::max(Vector3::Distance(parameters.camera_position, center) - radius, 0.0f);
+                if (distance * distance > max_distance_sq)
+                {
+                    stats.clusters_distance++;
+                    continue;
+                }
+            }
+
+            // frustum
+            if (parameters.cull_frustum && !parameters.frustum.IsVisible(center, radius))
+            {
+                stats.clusters_frustum++;
+                continue;
+            }
+
+            // backface, see meshopt_computeClusterBounds() for the derivation
+            if (cull_backfaces && cluster.cone_cutoff < 1.0f)
+            {
+                const Vector3 apex = cluster.cone_apex * transform;
+                const Vector3 axis = ((cluster.cone_apex + cluster.cone_axis) * transform - apex).Normalized();
+                const Vector3 view = (apex - parameters.camera_position).Normalized();
+                if (Vector3::Dot(view, axis) >= cluster.cone_cutoff)
+                {
+                    stats.clusters_backface++;
+                    continue;
+                }
+            }
+
+            // emit, merging with the previous range when contiguous
+            const uint32_t index_offset = lod_index_offset + cluster.index_offset;
+            if (!ranges.empty() && ranges.back().index_offset + ranges.back().index_count == index_offset)
+            {
+                ranges.back().index_count += cluster.index_count;
+            }
+            else
+            {
+                ranges.push_back({ index_offset, cluster.index_count });
+            }
+
+            stats.clusters_visible++;
+        }
+
+        return stats;
+    }
+}
@@ -0,0 +1,174 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include <unordered_map>
+#include "../Math/BoundingBox.h"
+#include "GeometryProcessing.h"
+//=================================
+
+// hierarchical lod (hlod) proxy generation
+// static geometry is grouped into a grid of cells and the lowest lods of everything in a cell are merged
+// into one simplified proxy mesh per material, so that distant cells can be drawn with a handful of draw calls
+// there are no engine dependencies (entities, gpu, etc.), so the build can run headless
+
+namespace spartan::geometry_hlod
+{
+    // a piece of static geometry that can be merged into a proxy
+    struct HlodPart
+    {
+        const std::vector<RHI_Vertex_PosTexNorTan>* vertices = nullptr; // mesh space, can be shared by many parts (e.g. instances)
+        const std::vector<uint32_t>* indices                 = nullptr;
+        math::Matrix transform                                = math::Matrix::Identity; // mesh to world
+        math::BoundingBox aabb;                                                       // world space
+        uint64_t material_id                                  = 0;
+        uint32_t member_index                                 = 0; // caller defined, identifies what the proxy replaces (e.g. a renderable or an instance group)
+    };
+
+    // the merged and simplified geometry of all parts in a cell which share a material
+    struct HlodProxy
+    {
+        uint64_t material_id = 0;
+        std::vector<RHI_Vertex_PosTexNorTan> vertices; // relative to the cell center
+        std::vector<uint32_t> indices;
+    };
+
+    struct HlodCell
+    {
+        math::BoundingBox aabb;                       // world space, encloses all the parts of the cell
+        math::Vector3 center = math::Vector3::Zero;   // world space, proxies are positioned here
+        std::vector<uint32_t> members;                // unique member indices of the parts in this cell
+        std::vector<HlodProxy> proxies;
+    };
+
+    struct HlodParameters
+    {
+        float cell_size         = 250.0f; // world units
+        float reduction         = 0.1f;   // target index count, as a fraction of the merged index count
+        uint32_t min_part_count = 4;      // cells with fewer parts are not worth a proxy
+    };
+
+    static void build_cells(const std::vector<HlodPart>& parts, const HlodParameters& parameters, std::vector<HlodCell>& cells)
+    {
+        cells.clear();
+        if (parts.empty() || parameters.cell_size <= 0.0f)
+            return;
+
+        // bin parts into cells, by the center of the bounds of the member they belong to, so that a member
+        // is never split across cells and can be swapped for a single proxy
+        std::vector<std::vector<uint32_t>> cell_parts;
+        {
+            std::unordered_map<uint32_t, math::BoundingBox> member_bounds;
+            for (const HlodPart& part : parts)
+            {
+                member_bounds[part.member_index].Merge(part.aabb);
+            }
+
+            std::unordered_map<uint64_t, uint32_t> cell_lookup;
+            for (uint32_t part_index = 0; part_index < static_cast<uint32_t>(parts.size()); part_index++)
+            {
+                const math::Vector3 center = member_bounds[parts[part_index].member_index].GetCenter();
+                const int32_t x            = static_cast<int32_t>(floor(center.x / parameters.cell_size));
+                const int32_t z            = static_cast<int32_t>(floor(center.z / parameters.cell_size));
+                const uint64_t key         = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+
+                auto it = cell_lookup.find(key);
+                if (it == cell_lookup.end())
+                {
+                    it = cell_lookup.emplace(key, static_cast<uint32_t>(cell_parts.size())).first;
+                    cell_parts.emplace_back();
+                }
+                cell_parts[it->second].push_back(part_index);
+            }
+        }
+
+        // drop cells which are not worth it
+        cell_parts.erase(
+            std::remove_if(cell_parts.begin(), cell_parts.end(), [&parameters](const std::vector<uint32_t>& indices) { return indices.size() < parameters.min_part_count; }),
+            cell_parts.end()
+        );
+        cells.resize(cell_parts.size());
+
+        // merge and simplify, cells are independent so they can be built in parallel
+        auto build_cell = [&](uint32_t start, uint32_t end)
+        {
+            for (uint32_t cell_index = start; cell_index < end; cell_index++)
+            {
+                HlodCell& cell = cells[cell_index];
+
+                // bounds and members
+                for (uint32_t part_index : cell_parts[cell_index])
+                {
+                    cell.aabb.Merge(parts[part_index].aabb);
+                    cell.members.push_back(parts[part_index].member_index);
+                }
+                cell.center = cell.aabb.GetCenter();
+                std::sort(cell.members.begin(), cell.members.end());
+                cell.members.erase(std::unique(cell.members.begin(), cell.members.end()), cell.members.end());
+
+                // one proxy per material, in order of first appearance
+                for (uint32_t part_index : cell_parts[cell_index])
+                {
+                    const HlodPart& part = parts[part_index];
+
+                    HlodProxy* proxy = nullptr;
+                    for (HlodProxy& existing : cell.proxies)
+                    {
+                        if (existing.material_id == part.material_id)
+                        {
+                            proxy = &existing;
+                            break;
+                        }
+                    }
+
+                    if (!proxy)
+                    {
+                        proxy              = &cell.proxies.emplace_back();
+                        proxy->material_id = part.material_id;
+                    }
+
+                    geometry_processing::append_transformed(*part.vertices, *part.indices, part.transform, cell.center, proxy->vertices, proxy->indices);
+                }
+
+                for (HlodProxy& proxy : cell.proxies)
+                {
+                    size_t target_index_count = static_cast<size_t>(static_cast<float>(proxy.indices.size()) * parameters.reduction);
+                    target_index_count        = std::max<size_t>(target_index_count - target_index_count % 3, 3);
+                    geometry_processing::simplify(proxy.indices, proxy.vertices, target_index_count, false); // also compacts the vertices
+                    meshopt_optimizeVertexCache(proxy.indices.data(), proxy.indices.data(), proxy.indices.size(), proxy.vertices.size());
+                }
+            }
+        };
+
+        const uint32_t cell_count = static_cast<uint32_t>(cells.size());
+        if (cell_count > 1)
+        {
+            ThreadPool::ParallelLoop(build_cell, cell_count);
+        }
+        else
+        {
+            build_cell(0, cell_count);
+        }
+    }
+}
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include "../RHI/RHI_Vertex.h"
 #include "../Core/ThreadPool.h"
+#include "GeometryCulling.h"
 SP_WARNINGS_OFF
 #include "meshoptimizer/meshoptimizer.h"
 SP_WARNINGS_ON
@@ -47,6 +48,50 @@ namespace spartan::geometry_processing
         registered = true;
     }
 
+    // locks the vertices which lie on the xz bounding box perimeter, so that neighbouring terrain tiles keep meeting after simplification
+    static void compute_edge_locks(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<unsigned char>& vertex_locks)
+    {
+        vertex_locks.assign(vertices.size(), 0); // 0 = unlocked, 1 = locked
+
+        // compute tile bounding box
+        float min_x = std::numeric_limits<float>::max();
+        float max_x = std::numeric_limits<float>::lowest();
+        float min_z = std::numeric_limits<float>::max();
+        float max_z = std::numeric_limits<float>::lowest();
+        for (const auto& vertex : vertices)
+        {
+            min_x = std::min(min_x, vertex.pos[0]);
+            max_x = std::max(max_x, vertex.pos[0]);
+            min_z = std::min(min_z, vertex.pos[2]);
+            max_z = std::max(max_z, vertex.pos[2]);
+        }
+
+        // lock vertices near bounding box edges
+        const float edge_tolerance = 0.01f;
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            float x = vertices[i].pos[0];
+            float z = vertices[i].pos[2];
+            if (std::abs(x - min_x) < edge_tolerance || std::abs(x - max_x) < edge_tolerance ||
+                std::abs(z - min_z) < edge_tolerance || std::abs(z - max_z) < edge_tolerance)
+            {
+                vertex_locks[i] = 1; // lock vertex on tile boundary
+            }
+        }
+    }
+
+    // packs the uvs as float2 per vertex, the attribute stream that meshopt_simplifyWithAttributes() weighs against position error
+    static void compute_uv_attributes(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<float>& attributes)
+    {
+        attributes.clear();
+        attributes.reserve(vertices.size() * 2); // 2 components per uv
+        for (const auto& v : vertices)
+        {
+            attributes.push_back(v.tex[0]);
+            attributes.push_back(v.tex[1]);
+        }
+    }
+
     static void simplify(
         std::vector<uint32_t>& indices,
         std::vector<RHI_Vertex_PosTexNorTan>& vertices,
@@ -77,45 +122,12 @@ namespace spartan::geometry_processing
         size_t                     vertex_count = vertices.size();
         if (preserve_edges)
         {
-            vertex_locks.resize(vertex_count, 0); // 0 = unlocked, 1 = locked
-    
-            // compute tile bounding box
-            float min_x = std::numeric_limits<float>::max();
-            float max_x = std::numeric_limits<float>::lowest();
-            float min_z = std::numeric_limits<float>::max();
-            float max_z = std::numeric_limits<float>::lowest();
-            for (const auto& vertex : vertices)
-            {
-                min_x = std::min(min_x, vertex.pos[0]);
-                max_x = std::max(max_x, vertex.pos[0]);
-                min_z = std::min(min_z, vertex.pos[2]);
-                max_z = std::max(max_z, vertex.pos[2]);
-            }
-    
-            // lock vertices near bounding box edges
-            const float edge_tolerance = 0.01f;
-            size_t      locked_count   = 0;
-            for (size_t i = 0; i < vertex_count; ++i)
-            {
-                float x = vertices[i].pos[0];
-                float z = vertices[i].pos[2];
-                if (std::abs(x - min_x) < edge_tolerance || std::abs(x - max_x) < edge_tolerance ||
-                    std::abs(z - min_z) < edge_tolerance || std::abs(z - max_z) < edge_tolerance)
-                {
-                    vertex_locks[i] = 1; // lock vertex on tile boundary
-                    locked_count++;
-                }
-            }
+            compute_edge_locks(vertices, vertex_locks);
         }
     
         // prepare attribute buffer for uvs (packed as float2 per vertex)
         std::vector<float> attr_buffer;
-        attr_buffer.reserve(vertex_count * 2); // 2 components per uv
-        for (const auto& v : vertices)
-        {
-            attr_buffer.push_back(v.tex[0]);
-            attr_buffer.push_back(v.tex[1]);
-        }
+        compute_uv_attributes(vertices, attr_buffer);
         const float* vertex_attributes = attr_buffer.data();
         size_t       attr_stride       = sizeof(float) * 2; // packed float2
     
@@ -268,6 +280,239 @@ namespace spartan::geometry_processing
         meshopt_optimizeVertexFetch(vertices.data(), indices.data(), index_count, vertices.data(), vertex_count, sizeof(RHI_Vertex_PosTexNorTan));
     }
 
+    // appends geometry to the end of another, transformed (e.g. to world space) and then offset by -origin to keep precision
+    static void append_transformed(
+        const std::vector<RHI_Vertex_PosTexNorTan>& vertices_source,
+        const std::vector<uint32_t>& indices_source,
+        const math::Matrix& transform,
+        const math::Vector3& origin,
+        std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+        std::vector<uint32_t>& indices
+    )
+    {
+        // tangents are transformed without translation, the row-major matrix keeps w at 1, normals are transformed
+        // by the inverse transpose instead, so that they stay perpendicular to the surface under non-uniform scale
+        math::Matrix rotation_scale = transform;
+        rotation_scale.m30          = 0.0f;
+        rotation_scale.m31          = 0.0f;
+        rotation_scale.m32          = 0.0f;
+        const math::Matrix normal_transform = rotation_scale.Inverted().Transposed();
+
+        const uint32_t base_vertex = static_cast<uint32_t>(vertices.size());
+        vertices.reserve(vertices.size() + vertices_source.size());
+        for (const RHI_Vertex_PosTexNorTan& vertex : vertices_source)
+        {
+            const math::Vector3 position = math::Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]) * transform - origin;
+            const math::Vector3 normal   = (math::Vector3(vertex.nor[0], vertex.nor[1], vertex.nor[2]) * normal_transform).Normalized();
+            const math::Vector3 tangent  = (math::Vector3(vertex.tan[0], vertex.tan[1], vertex.tan[2]) * rotation_scale).Normalized();
+            vertices.emplace_back(position, math::Vector2(vertex.tex[0], vertex.tex[1]), normal, tangent);
+        }
+
+        indices.reserve(indices.size() + indices_source.size());
+        for (uint32_t index : indices_source)
+        {
+            indices.push_back(base_vertex + index);
+        }
+    }
+
+    struct LodLevel
+    {
+        std::vector<RHI_Vertex_PosTexNorTan> vertices; // compacted, only the vertices referenced by the indices
+        std::vector<uint32_t> indices;
+        float error = 0.0f;                            // object space deviation from lod 0, in the same units as the vertex positions
+    };
+
+    // builds lod 1 onwards, every level is simplified from the previous one with an explicit error budget, so the work
+    // shrinks with each level and the resulting error is known, the attribute stream and the locks are built only once
+    static void build_lod_chain(
+        const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+        const std::vector<uint32_t>& indices,
+        const uint32_t lod_count,        // including lod 0
+        const bool exponential_dropoff,
+        const bool preserve_edges,
+        std::vector<LodLevel>& lods
+    )
+    {
+        register_meshoptimizer();
+
+        lods.clear();
+
+        // early exit if mesh is too small, few vertices can collapse to nothing
+        if (vertices.size() <= 16 || indices.size() <= 64)
+            return;
+
+        // per-vertex inputs, shared by all levels since every level indexes the same (lod 0) vertex buffer
+        std::vector<unsigned char> vertex_locks;
+        if (preserve_edges)
+        {
+            compute_edge_locks(vertices, vertex_locks);
+        }
+        const unsigned char* locks = vertex_locks.empty() ? nullptr : vertex_locks.data();
+
+        std::vector<float> attributes;
+        compute_uv_attributes(vertices, attributes);
+        static constexpr float uv_weights[2] = { 0.5f, 0.5f };
+
+        // converts the relative error that meshoptimizer reports to object space
+        const float error_scale = meshopt_simplifyScale(&vertices[0].pos[0], vertices.size(), sizeof(RHI_Vertex_PosTexNorTan));
+
+        // relative error budget per level, doubling with every level
+        const float error_budget_base = 0.01f;
+
+        std::vector<uint32_t> indices_previous = indices;
+        std::vector<uint32_t> indices_simplified(indices.size());
+        float error_accumulated                = 0.0f;
+        for (uint32_t lod_level = 1; lod_level < lod_count; lod_level++)
+        {
+            // only simplify if the geometry is complex enough
+            if (indices_previous.size() <= 64)
+                break;
+
+            // compute target index count based on the previous level
+            float t = static_cast<float>(lod_level) / static_cast<float>(lod_count);
+            if (exponential_dropoff)
+            {
+                t = t * t;
+            }
+            const size_t target_index_count = std::max(static_cast<size_t>(3), static_cast<size_t>(indices_previous.size() * (1.0f - t)));
+            const float target_error        = error_budget_base * static_cast<float>(1u << (lod_level - 1));
+
+            float result_error = 0.0f;
+            size_t index_count = meshopt_simplifyWithAttributes(
+                indices_simplified.data(),
+                indices_previous.data(),
+                indices_previous.size(),
+                &vertices[0].pos[0],
+                vertices.size(),
+                sizeof(RHI_Vertex_PosTexNorTan),
+                attributes.data(),
+                sizeof(float) * 2,
+                uv_weights,
+                2,
+                locks,
+                target_index_count,
+                target_error,
+                0,
+                &result_error
+            );
+
+            // topology preserving simplification got stuck (e.g. lots of seams), the sloppy simplifier ignores topology
+            // and attributes, so it's not an option for terrain tiles which must keep their edges
+            const bool reduced_enough = index_count <= indices_previous.size() - indices_previous.size() / 10;
+            if (!reduced_enough && !preserve_edges)
+            {
+                float result_error_sloppy = 0.0f;
+                size_t index_count_sloppy = meshopt_simplifySloppy(
+                    indices_simplified.data(),
+                    indices_previous.data(),
+                    indices_previous.size(),
+                    &vertices[0].pos[0],
+                    vertices.size(),
+                    sizeof(RHI_Vertex_PosTexNorTan),
+                    target_index_count,
+                    target_error,
+                    &result_error_sloppy
+                );
+
+                if (index_count_sloppy != 0 && index_count_sloppy < indices_previous.size())
+                {
+                    index_count  = index_count_sloppy;
+                    result_error = result_error_sloppy;
+                }
+            }
+
+            // stop if simplification didn't reduce the index count
+            if (index_count == 0 || index_count >= indices_previous.size())
+                break;
+
+            indices_previous.assign(indices_simplified.begin(), indices_simplified.begin() + index_count);
+            error_accumulated += result_error * error_scale; // errors of consecutive levels add up in the worst case
+
+            // emit the level with its own compacted vertex buffer
+            LodLevel& lod = lods.emplace_back();
+            lod.error     = error_accumulated;
+            lod.indices   = indices_previous;
+            meshopt_optimizeVertexCache(lod.indices.data(), lod.indices.data(), lod.indices.size(), vertices.size());
+            lod.vertices.resize(vertices.size());
+            size_t vertex_count = meshopt_optimizeVertexFetch(lod.vertices.data(), lod.indices.data(), lod.indices.size(), vertices.data(), vertices.size(), sizeof(RHI_Vertex_PosTexNorTan));
+            lod.vertices.resize(vertex_count);
+        }
+    }
+
+    static void build_clusters(std::vector<uint32_t>& indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<MeshCluster>& clusters)
+    {
+        register_meshoptimizer();
+
+        clusters.clear();
+        if (indices.size() < mesh_cluster_min_index_count)
+            return;
+
+        // build meshlets
+        const float cone_weight = 0.25f; // favour clusters with tight normal cones, so that backface culling rejects more of them
+        size_t meshlet_count_max = meshopt_buildMeshletsBound(indices.size(), mesh_cluster_max_vertices, mesh_cluster_max_triangles);
+        std::vector<meshopt_Meshlet> meshlets(meshlet_count_max);
+        std::vector<unsigned int> meshlet_vertices(meshlet_count_max * mesh_cluster_max_vertices);
+        std::vector<unsigned char> meshlet_triangles(meshlet_count_max * mesh_cluster_max_triangles * 3);
+        size_t meshlet_count = meshopt_buildMeshlets(
+            meshlets.data(),
+            meshlet_vertices.data(),
+            meshlet_triangles.data(),
+            indices.data(),
+            indices.size(),
+            &vertices[0].pos[0],
+            vertices.size(),
+            sizeof(RHI_Vertex_PosTexNorTan),
+            mesh_cluster_max_vertices,
+            mesh_cluster_max_triangles,
+            cone_weight
+        );
+
+        // rewrite the index buffer in meshlet order, so that every cluster is a contiguous index range which can be drawn
+        // with a plain indexed draw, this doesn't require mesh shaders and keeps the vertex buffer untouched
+        std::vector<uint32_t> indices_clustered;
+        indices_clustered.reserve(indices.size());
+        clusters.reserve(meshlet_count);
+        for (size_t i = 0; i < meshlet_count; i++)
+        {
+            const meshopt_Meshlet& meshlet = meshlets[i];
+            meshopt_optimizeMeshlet(&meshlet_vertices[meshlet.vertex_offset], &meshlet_triangles[meshlet.triangle_offset], meshlet.triangle_count, meshlet.vertex_count);
+
+            meshopt_Bounds bounds = meshopt_computeMeshletBounds(
+                &meshlet_vertices[meshlet.vertex_offset],
+                &meshlet_triangles[meshlet.triangle_offset],
+                meshlet.triangle_count,
+                &vertices[0].pos[0],
+                vertices.size(),
+                sizeof(RHI_Vertex_PosTexNorTan)
+            );
+
+            MeshCluster cluster;
+            cluster.index_offset  = static_cast<uint32_t>(indices_clustered.size());
+            cluster.index_count   = meshlet.triangle_count * 3;
+            cluster.sphere_center = math::Vector3(bounds.center[0], bounds.center[1], bounds.center[2]);
+            cluster.sphere_radius = bounds.radius;
+            cluster.cone_apex     = math::Vector3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]);
+            cluster.cone_axis     = math::Vector3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+            cluster.cone_cutoff   = bounds.cone_cutoff;
+            clusters.push_back(cluster);
+
+            for (uint32_t j = 0; j < meshlet.triangle_count * 3; j++)
+            {
+                uint32_t index_local = meshlet_triangles[meshlet.triangle_offset + j];
+                indices_clustered.push_back(meshlet_vertices[meshlet.vertex_offset + index_local]);
+            }
+        }
+
+        // the clusterizer keeps every triangle, but if that ever changes, fall back to drawing the lod as a whole
+        if (indices_clustered.size() != indices.size())
+        {
+            clusters.clear();
+            return;
+        }
+
+        indices = std::move(indices_clustered);
+    }
+
     static void split_surface_into_tiles(
     const std::vector<RHI_Vertex_PosTexNorTan>& terrain_vertices,
     const std::vector<uint32_t>& terrain_indices,
@@ -399,4 +644,94 @@ namespace spartan::geometry_processing
             }
         }
     }
+
+    // a specialization of split_surface_into_tiles for surfaces which are a regular grid of width x height vertices (row major), where
+    // every quad is split into the triangles (bottom right, bottom left, top left) and (bottom right, top left, top right), since the
+    // tile of a quad and the place of its vertices in the tile are known up front, every tile is written directly, in parallel,
+    // each tile owns a rectangle of quads and the vertices on the border between two tiles are in both of them
+    static void split_grid_into_tiles(
+        const std::vector<RHI_Vertex_PosTexNorTan>& grid_vertices,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t tile_count,
+        std::vector<std::vector<RHI_Vertex_PosTexNorTan>>& tiled_vertices,
+        std::vector<std::vector<uint32_t>>& tiled_indices,
+        std::vector<math::Vector3>& tile_offsets
+    )
+    {
+        SP_ASSERT(width > 1 && height > 1 && grid_vertices.size() == static_cast<size_t>(width) * height);
+
+        const uint32_t total_tiles = tile_count * tile_count;
+        tiled_vertices.assign(total_tiles, {});
+        tiled_indices.assign(total_tiles, {});
+        tile_offsets.assign(total_tiles, math::Vector3::Zero);
+
+        // the quads are split as evenly as possible, tiles are empty when there are more tiles than quads
+        auto get_quad_start = [tile_count](const uint32_t quad_count, const uint32_t tile)
+        {
+            return static_cast<uint32_t>((static_cast<uint64_t>(quad_count) * tile) / tile_count);
+        };
+
+        auto process_tiles = [&](uint32_t start_tile, uint32_t end_tile)
+        {
+            for (uint32_t tile_index = start_tile; tile_index < end_tile; tile_index++)
+            {
+                const uint32_t tx          = tile_index % tile_count;
+                const uint32_t tz          = tile_index / tile_count;
+                const uint32_t x_start     = get_quad_start(width - 1, tx);
+                const uint32_t z_start     = get_quad_start(height - 1, tz);
+                const uint32_t quads_x     = get_quad_start(width - 1, tx + 1) - x_start;
+                const uint32_t quads_z     = get_quad_start(height - 1, tz + 1) - z_start;
+                const uint32_t tile_width  = quads_x + 1;
+                if (quads_x == 0 || quads_z == 0)
+                    continue;
+
+                // the offset is the center of the tile
+                const RHI_Vertex_PosTexNorTan& corner_min = grid_vertices[static_cast<size_t>(z_start) * width + x_start];
+                const RHI_Vertex_PosTexNorTan& corner_max = grid_vertices[static_cast<size_t>(z_start + quads_z) * width + x_start + quads_x];
+                const float center_x                      = (corner_min.pos[0] + corner_max.pos[0]) * 0.5f;
+                const float center_z                      = (corner_min.pos[2] + corner_max.pos[2]) * 0.5f;
+                tile_offsets[tile_index]                  = math::Vector3(center_x, 0.0f, center_z);
+
+                // vertices, row by row
+                std::vector<RHI_Vertex_PosTexNorTan>& vertices = tiled_vertices[tile_index];
+                vertices.resize(static_cast<size_t>(tile_width) * (quads_z + 1));
+                for (uint32_t z = 0; z <= quads_z; z++)
+                {
+                    const RHI_Vertex_PosTexNorTan* source = &grid_vertices[static_cast<size_t>(z_start + z) * width + x_start];
+                    RHI_Vertex_PosTexNorTan* destination  = &vertices[static_cast<size_t>(z) * tile_width];
+                    for (uint32_t x = 0; x < tile_width; x++)
+                    {
+                        destination[x]         = source[x];
+                        destination[x].pos[0] -= center_x;
+                        destination[x].pos[2] -= center_z;
+                    }
+                }
+
+                // indices
+                std::vector<uint32_t>& indices = tiled_indices[tile_index];
+                indices.resize(static_cast<size_t>(quads_x) * quads_z * 6);
+                uint32_t k = 0;
+                for (uint32_t z = 0; z < quads_z; z++)
+                {
+                    for (uint32_t x = 0; x < quads_x; x++)
+                    {
+                        const uint32_t bottom_left  = z * tile_width + x;
+                        const uint32_t bottom_right = bottom_left + 1;
+                        const uint32_t top_left     = bottom_left + tile_width;
+                        const uint32_t top_right    = top_left + 1;
+
+                        indices[k++] = bottom_right;
+                        indices[k++] = bottom_left;
+                        indices[k++] = top_left;
+                        indices[k++] = bottom_right;
+                        indices[k++] = top_left;
+                        indices[k++] = top_right;
+                    }
+                }
+            }
+        };
+
+        ThreadPool::ParallelLoop(process_tiles, total_tiles);
+    }
 }
@@ -0,0 +1,249 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include "../Math/Vector3.h"
+#include "../Math/Matrix.h"
+//=============================
+
+// poisson disk sampling over a grid of tiles, no two samples are closer than a radius, which spreads them evenly
+// without clumps, a tile depends only on its seed and on the samples of its neighbours from earlier phases, so
+// tiles of the same phase can be sampled on any thread, in any order, and always produce the same samples
+namespace spartan::geometry_scatter
+{
+    // tiles are sampled in four phases, tiles of the same phase are never adjacent, so they can't affect each other
+    static const uint32_t phase_count = 4;
+
+    // a square grid of tiles over the area to sample
+    struct Tiling
+    {
+        float origin_x   = 0.0f;
+        float origin_z   = 0.0f;
+        float tile_size  = 0.0f;
+        float radius     = 0.0f; // the minimum distance between samples
+        float overhang   = 0.0f; // how far outside of its tile a sample of the tile can be
+        uint32_t tiles_x = 0;
+        uint32_t tiles_z = 0;
+
+        uint32_t GetTileCount() const { return tiles_x * tiles_z; }
+        float GetMargin() const       { return radius + overhang; } // how far outside of a tile samples can affect it
+        float GetCellSize() const     { return radius / std::sqrt(2.0f); } // a cell can only hold a single sample
+
+        uint32_t GetTileIndex(const float x, const float z) const
+        {
+            const uint32_t tile_x = static_cast<uint32_t>(std::clamp((x - origin_x) / tile_size, 0.0f, static_cast<float>(tiles_x - 1)));
+            const uint32_t tile_z = static_cast<uint32_t>(std::clamp((z - origin_z) / tile_size, 0.0f, static_cast<float>(tiles_z - 1)));
+            return tile_z * tiles_x + tile_x;
+        }
+
+        uint32_t GetPhase(const uint32_t tile_index) const
+        {
+            return ((tile_index % tiles_x) & 1) | (((tile_index / tiles_x) & 1) << 1);
+        }
+    };
+
+    // a cell of the grid a tile is sampled against, it holds a single sample at most
+    struct Cell
+    {
+        float x = std::numeric_limits<float>::infinity(); // infinity when empty
+        float z = 0.0f;
+    };
+
+    // splitmix64, a well distributed seed for every tile (or any other index) out of a single seed
+    static uint64_t hash(const uint64_t seed, const uint64_t index)
+    {
+        uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // covers a rectangle with enough tiles to spread over the threads, and small enough tiles that their grids stay small,
+    // tiles are at least large enough for a sample to never reach past the neighbouring tiles
+    static Tiling create_tiling(const float min_x, const float min_z, const float max_x, const float max_z, const float radius, const float overhang)
+    {
+        const float tiles_min = 16.0f;   // per axis, for the larger axis
+        const float cells_max = 1024.0f; // per axis, in the grid of a tile
+
+        const float extent = std::max(std::max(max_x - min_x, max_z - min_z), radius);
+
+        Tiling tiling;
+        tiling.origin_x  = min_x;
+        tiling.origin_z  = min_z;
+        tiling.radius    = radius;
+        tiling.overhang  = overhang;
+        tiling.tile_size = std::min(extent / tiles_min, cells_max * tiling.GetCellSize() - 2.0f * tiling.GetMargin());
+        tiling.tile_size = std::max(tiling.tile_size, radius + 2.0f * overhang);
+        tiling.tiles_x   = std::max(static_cast<uint32_t>(std::ceil((max_x - min_x) / tiling.tile_size)), 1u);
+        tiling.tiles_z   = std::max(static_cast<uint32_t>(std::ceil((max_z - min_z) / tiling.tile_size)), 1u);
+
+        return tiling;
+    }
+
+    // splits a count over tiles in proportion to their weights, the targets always add up to the count
+    static void distribute(const uint64_t count, const std::vector<uint32_t>& weights, std::vector<uint32_t>& targets)
+    {
+        uint64_t weight_total = 0;
+        for (const uint32_t weight : weights)
+        {
+            weight_total += weight;
+        }
+
+        targets.assign(weights.size(), 0);
+        if (weight_total == 0)
+            return;
+
+        uint64_t weight_sum = 0;
+        uint64_t assigned   = 0;
+        for (size_t i = 0; i < weights.size(); i++)
+        {
+            weight_sum          += weights[i];
+            const uint64_t total = static_cast<uint64_t>((static_cast<double>(count) * weight_sum) / weight_total);
+            targets[i]           = static_cast<uint32_t>(total - assigned);
+            assigned             = total;
+        }
+    }
+
+    // where a sample is, a sample can be anything with a position, or a transform
+    template<typename Sample>
+    static math::Vector3 get_position(const Sample& sample)        { return sample.position; }
+    static math::Vector3 get_position(const math::Matrix& transform) { return transform.GetTranslation(); }
+
+    // dart throwing against a grid of the samples around the tile, the candidate function picks a position somewhere in
+    // the tile (within the overhang), or returns false if the tile has nowhere to place one, the accept function turns the
+    // last candidate into a sample, so rejected candidates cost nothing more, samples are written straight into the range
+    // of the tile, tile_offsets[i] is where the range of tile i starts and has room for its target count, returns how many
+    // samples were placed, the grid is scratch memory which can be reused across tiles
+    template<typename Sample, typename Candidate, typename Accept>
+    static uint32_t sample_tile(
+        const Tiling& tiling,
+        const uint32_t tile_index,
+        const uint32_t target_count,
+        const uint32_t attempt_count,
+        Sample* samples,                           // the samples of all tiles
+        const std::vector<uint32_t>& tile_offsets,
+        const std::vector<uint32_t>& tile_counts,  // how many samples every tile has, only neighbours from earlier phases are read
+        Candidate&& candidate,
+        Accept&& accept,
+        std::vector<Cell>& grid
+    )
+    {
+        if (target_count == 0)
+            return 0;
+
+        const uint32_t tile_x  = tile_index % tiling.tiles_x;
+        const uint32_t tile_z  = tile_index / tiling.tiles_x;
+        const float cell_size  = tiling.GetCellSize();
+        const float margin     = tiling.GetMargin();
+        const float grid_min_x = tiling.origin_x + static_cast<float>(tile_x) * tiling.tile_size - margin;
+        const float grid_min_z = tiling.origin_z + static_cast<float>(tile_z) * tiling.tile_size - margin;
+        const int32_t cells    = static_cast<int32_t>(std::ceil((tiling.tile_size + 2.0f * margin) / cell_size));
+        const float radius_sq  = tiling.radius * tiling.radius;
+        grid.assign(static_cast<size_t>(cells) * cells, Cell());
+
+        auto get_cell = [&](const float x, const float z, int32_t& cell_x, int32_t& cell_z)
+        {
+            cell_x = static_cast<int32_t>(std::floor((x - grid_min_x) / cell_size));
+            cell_z = static_cast<int32_t>(std::floor((z - grid_min_z) / cell_size));
+            return cell_x >= 0 && cell_z >= 0 && cell_x < cells && cell_z < cells;
+        };
+
+        auto insert = [&](const float x, const float z)
+        {
+            int32_t cell_x, cell_z;
+            if (get_cell(x, z, cell_x, cell_z))
+            {
+                grid[static_cast<size_t>(cell_z) * cells + cell_x] = { x, z };
+            }
+        };
+
+        // two cells in every direction cover the radius
+        auto is_free = [&](const float x, const float z)
+        {
+            int32_t cell_x, cell_z;
+            if (!get_cell(x, z, cell_x, cell_z))
+                return false;
+
+            if (grid[static_cast<size_t>(cell_z) * cells + cell_x].x != std::numeric_limits<float>::infinity())
+                return false;
+
+            for (int32_t z_neighbour = std::max(cell_z - 2, 0); z_neighbour <= std::min(cell_z + 2, cells - 1); z_neighbour++)
+            {
+                for (int32_t x_neighbour = std::max(cell_x - 2, 0); x_neighbour <= std::min(cell_x + 2, cells - 1); x_neighbour++)
+                {
+                    const Cell& cell = grid[static_cast<size_t>(z_neighbour) * cells + x_neighbour];
+                    const float dx   = cell.x - x;
+                    const float dz   = cell.z - z;
+                    if (dx * dx + dz * dz < radius_sq)
+                        return false;
+                }
+            }
+
+            return true;
+        };
+
+        // the samples of neighbours which were sampled in earlier phases
+        const uint32_t phase = tiling.GetPhase(tile_index);
+        for (int32_t dz = -1; dz <= 1; dz++)
+        {
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                const int32_t x = static_cast<int32_t>(tile_x) + dx;
+                const int32_t z = static_cast<int32_t>(tile_z) + dz;
+                if ((dx == 0 && dz == 0) || x < 0 || z < 0 || x >= static_cast<int32_t>(tiling.tiles_x) || z >= static_cast<int32_t>(tiling.tiles_z))
+                    continue;
+
+                const uint32_t neighbour = static_cast<uint32_t>(z) * tiling.tiles_x + static_cast<uint32_t>(x);
+                if (tiling.GetPhase(neighbour) >= phase)
+                    continue;
+
+                for (uint32_t i = 0; i < tile_counts[neighbour]; i++)
+                {
+                    const math::Vector3 position = get_position(samples[tile_offsets[neighbour] + i]);
+                    insert(position.x, position.z);
+                }
+            }
+        }
+
+        Sample* tile_samples = samples + tile_offsets[tile_index];
+        uint32_t count       = 0;
+        for (uint32_t attempt = 0; attempt < attempt_count && count < target_count; attempt++)
+        {
+            math::Vector3 position;
+            if (!candidate(position))
+                break;
+
+            if (!is_free(position.x, position.z))
+                continue;
+
+            insert(position.x, position.z);
+            tile_samples[count++] = accept(position);
+        }
+
+        return count;
+    }
+}
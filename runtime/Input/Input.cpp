@@ -61,7 +61,7 @@ namespace spartan
 
     void Input::OnEvent(sp_variant data)
     {
-        SDL_Event* event_sdl = static_cast<SDL_Event*>(get<void*>(data));
+        SDL_Event* event_sdl = get<SDL_Event*>(data);
 
         OnEventMouse(event_sdl);
         OnEventGamepad(event_sdl);
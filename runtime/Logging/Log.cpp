@@ -34,86 +34,282 @@ namespace spartan
 {
     namespace
     {
-        vector<LogCmd> logs;
-        string log_file_name = "log.txt";
-        ILogger* logger      = nullptr;
-        bool log_to_file     = true;
+        // records are fixed size so that producers never allocate, longer texts bypass the ring
+        const uint32_t ring_capacity    = 4096; // power of two
+        const uint32_t record_text_size = 512;
+        const uint32_t history_capacity = 1024; // what is replayed to a logger that is set late
 
-        void write_to_file(string text, const LogType type)
+        // a slot of the ring, the sequence tells producers and the consumer whose turn it is (vyukov's bounded queue)
+        struct Record
         {
-            const string prefix = (type == LogType::Info) ? "Info:" : (type == LogType::Warning) ? "Warning:" : "Error:";
-            text = prefix + " " + text;
+            atomic<uint64_t> sequence = 0;
+            time_t time               = 0;
+            LogType type              = LogType::Info;
+            bool to_file              = false;
+            uint32_t length           = 0;
+            char text[record_text_size];
+        };
+
+        Record ring[ring_capacity];
+        alignas(64) atomic<uint64_t> enqueue_position = 0;
+        alignas(64) atomic<uint64_t> dequeue_position = 0; // only advanced while holding consumer_mutex
+
+        // consumer side, recursive since a logger can log while it's being invoked
+        recursive_mutex consumer_mutex;
+        deque<LogCmd> history;
+        ofstream file;
+        bool file_truncated = false;
+        string file_batch;
+        time_t time_formatted_last = -1;
+        char time_formatted[16]    = {};
+
+        // writer thread
+        thread writer;
+        mutex writer_mutex;
+        condition_variable writer_condition;
+        atomic<bool> writer_running = false;
+
+        string log_file_name     = "log.txt";
+        atomic<ILogger*> logger  = nullptr;
+        atomic<bool> log_to_file = true;
+
+        once_flag ring_initialized;
+
+        void initialize_ring()
+        {
+            // thread-safe, since logging can happen before Log::Initialize()
+            call_once(ring_initialized, []()
+            {
+                for (uint64_t i = 0; i < ring_capacity; i++)
+                {
+                    ring[i].sequence.store(i, memory_order_relaxed);
+                }
+            });
+        }
+
+        // returns false when the ring is full, otherwise the position the record was written to
+        bool enqueue(const char* text, const uint32_t length, const time_t time, const LogType type, const bool to_file, uint64_t* position_out)
+        {
+            uint64_t position = enqueue_position.load(memory_order_relaxed);
+            Record* record    = nullptr;
+            while (true)
+            {
+                record                  = &ring[position & (ring_capacity - 1)];
+                const uint64_t sequence = record->sequence.load(memory_order_acquire);
+                const int64_t delta     = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+                if (delta == 0)
+                {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                        break;
+                }
+                else if (delta < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = enqueue_position.load(memory_order_relaxed);
+                }
+            }
+
+            record->time    = time;
+            record->type    = type;
+            record->to_file = to_file;
+            record->length  = length;
+            memcpy(record->text, text, length);
+            record->sequence.store(position + 1, memory_order_release);
+            *position_out = position;
+
+            return true;
+        }
+
+        const char* format_time(const time_t time)
+        {
+            if (time != time_formatted_last)
+            {
+                tm tm_struct{};
+                localtime_s(&tm_struct, &time);
+                strftime(time_formatted, sizeof(time_formatted), "[%H:%M:%S]: ", &tm_struct);
+                time_formatted_last = time;
+            }
+
+            return time_formatted;
+        }
+
+        // hands a record to the file batch, the history and the logger, expects consumer_mutex to be held
+        void process(const char* text, const uint32_t length, const time_t time, const LogType type, const bool to_file)
+        {
+            string final_text = format_time(time);
+            final_text.append(text, length);
+
+            if (to_file)
+            {
+                file_batch += (type == LogType::Info) ? "Info: " : (type == LogType::Warning) ? "Warning: " : "Error: ";
+                file_batch += final_text;
+                file_batch += '\n';
+            }
+
+            if (ILogger* logger_current = logger.load(memory_order_acquire))
+            {
+                logger_current->Log(final_text, static_cast<uint32_t>(type));
+            }
+            else
+            {
+                history.emplace_back(final_text, type);
+                if (history.size() > history_capacity)
+                {
+                    history.pop_front();
+                }
+            }
+        }
+
+        // one write for everything that was batched, the file is kept open and replaced on the first write
+        void write_batch()
+        {
+            if (file_batch.empty())
+                return;
+
+            if (!file.is_open())
+            {
+                file.open(log_file_name, ofstream::out | (file_truncated ? ofstream::app : ofstream::trunc));
+                file_truncated = true;
+            }
+
+            if (file.is_open())
+            {
+                file.write(file_batch.data(), static_cast<streamsize>(file_batch.size()));
+                file.flush();
+            }
+
+            file_batch.clear();
+        }
+
+        // consumes everything that is in the ring, can be called by the writer thread or by any producer that has to wait
+        void drain()
+        {
+            lock_guard<recursive_mutex> lock(consumer_mutex);
 
-            // delete the previous log file (if it exists)
-            static bool is_first_log = true;
-            if (is_first_log)
+            while (true)
             {
-                FileSystem::Delete(log_file_name);
-                is_first_log = false;
+                const uint64_t position = dequeue_position.load(memory_order_relaxed);
+                Record& record          = ring[position & (ring_capacity - 1)];
+                if (record.sequence.load(memory_order_acquire) != position + 1)
+                    break; // empty, or the producer that claimed the slot hasn't finished writing it yet
+
+                // copied out and released before it's processed, a logger that logs re-enters here and must find the slot consumed
+                char text[record_text_size];
+                const uint32_t length = record.length;
+                const time_t time     = record.time;
+                const LogType type    = record.type;
+                const bool to_file    = record.to_file;
+                memcpy(text, record.text, length);
+                record.sequence.store(position + ring_capacity, memory_order_release);
+                dequeue_position.store(position + 1, memory_order_relaxed);
+
+                process(text, length, time, type, to_file);
             }
 
-            // open/create a log file to write the log into
-            static ofstream fout;
-            fout.open(log_file_name, ofstream::out | ofstream::app);
+            write_batch();
+        }
 
-            if (fout.is_open())
+        void writer_loop()
+        {
+            while (writer_running.load(memory_order_acquire))
             {
-                // write out the error message
-                fout << text << endl;
+                drain();
 
-                // close the file
-                fout.close();
+                // wake up periodically, or earlier if the ring is filling up
+                unique_lock<mutex> lock(writer_mutex);
+                writer_condition.wait_for(lock, chrono::milliseconds(10));
             }
+
+            drain();
+        }
+
+        void writer_stop()
+        {
+            if (!writer.joinable())
+                return;
+
+            writer_running.store(false, memory_order_release);
+            writer_condition.notify_one();
+            writer.join();
         }
+
+        // in case the engine didn't shut down, a joinable thread can't be destroyed
+        struct WriterGuard
+        {
+            ~WriterGuard() { writer_stop(); }
+        } writer_guard;
     }
 
     void Log::Initialize()
     {
+        initialize_ring();
+
+        if (!writer.joinable())
+        {
+            writer_running.store(true, memory_order_release);
+            writer = thread(writer_loop);
+        }
+
         SP_SUBSCRIBE_TO_EVENT(EventType::RendererOnFirstFrameCompleted, SP_EVENT_HANDLER_EXPRESSION_STATIC( SetLogToFile(false); ));
         SP_SUBSCRIBE_TO_EVENT(EventType::RendererOnShutdown,            SP_EVENT_HANDLER_EXPRESSION_STATIC( SetLogToFile(true);  ));
     }
 
+    void Log::Shutdown()
+    {
+        // anything logged after this point is written synchronously
+        writer_stop();
+
+        lock_guard<recursive_mutex> lock(consumer_mutex);
+        file.close();
+    }
+
+    void Log::Flush()
+    {
+        drain();
+    }
+
     void Log::SetLogger(ILogger* logger_in)
     {
-        logger = logger_in;
+        // pending records go to the previous logger, and the consumer can't be using it once this returns
+        drain();
+        lock_guard<recursive_mutex> lock(consumer_mutex);
+
+        logger.store(logger_in, memory_order_release);
 
         // flush the log buffer, if needed
-        if (logger && !logs.empty())
+        if (logger_in)
         {
-            if (!logs.empty())
+            for (const LogCmd& log : history)
             {
-                for (const LogCmd& log : logs)
-                {
-                    logger->Log(log.text, static_cast<uint32_t>(log.type));
-                }
-                logs.clear();
+                logger_in->Log(log.text, static_cast<uint32_t>(log.type));
             }
+            history.clear();
         }
     }
 
     void Log::SetLogToFile(const bool log)
     {
-        log_to_file = log;
+        log_to_file.store(log, memory_order_relaxed);
     }
 
     void Log::Clear()
     {
-        // lock mutex to ensure thread safety
-        static std::mutex log_mutex;
-        std::lock_guard<std::mutex> guard(log_mutex);
+        drain();
+        lock_guard<recursive_mutex> lock(consumer_mutex);
 
         // clear the in-memory logs
-        logs.clear();
+        history.clear();
 
         // clear the file if logging to file is enabled
         if (log_to_file || Debugging::IsLoggingToFileEnabled())
         {
-            // open the file in truncate mode to clear its contents
-            std::ofstream file("log.txt", std::ios::out | std::ios::trunc);
-            if (file.is_open())
-            {
-                file.close();
-            }
+            // reopen the file in truncate mode to clear its contents
+            file.close();
+            file.open(log_file_name, ofstream::out | ofstream::trunc);
+            file_truncated = true;
         }
     }
 
@@ -121,30 +317,47 @@ namespace spartan
     void Log::Write(const char* text, const LogType type)
     {
         SP_ASSERT_MSG(text != nullptr, "Text is null");
-    
-        // lock mutex
-        static mutex log_mutex;
-        lock_guard<mutex> guard(log_mutex);
-    
-        // add time to the text
-        auto t = time(nullptr);
-        tm tm_struct{};
-        localtime_s(&tm_struct, &t);
-    
-        ostringstream oss;
-        oss << put_time(&tm_struct, "[%H:%M:%S]");
-        const string final_text = oss.str() + ": " + string(text);
-    
+
+        initialize_ring();
+
+        const time_t time     = ::time(nullptr);
+        const uint32_t length = static_cast<uint32_t>(strlen(text));
+
         // log to file if requested or if an in-engine logger is not available
-        if (log_to_file || !logger || Debugging::IsLoggingToFileEnabled())
+        const bool to_file = log_to_file.load(memory_order_relaxed) || !logger.load(memory_order_relaxed) || Debugging::IsLoggingToFileEnabled();
+
+        const bool is_writer_running = writer_running.load(memory_order_acquire);
+        if (length >= record_text_size || !is_writer_running)
+        {
+            // too long for a record (e.g. callstacks), or there is no writer, so write in place, after what is queued
+            lock_guard<recursive_mutex> lock(consumer_mutex);
+            drain();
+            process(text, length, time, type, to_file);
+            write_batch();
+            return;
+        }
+
+        // the ring is full, help the writer instead of dropping the message
+        uint64_t position = 0;
+        while (!enqueue(text, length, time, type, to_file, &position))
         {
-            logs.emplace_back(final_text, type);
-            write_to_file(final_text, type);
+            drain();
+        }
+
+        // errors can precede a crash, so they (and everything before them) are written before returning, draining stops
+        // at a slot that another producer claimed but hasn't finished writing, so keep at it until our record is through
+        if (type == LogType::Error)
+        {
+            drain();
+            while (dequeue_position.load(memory_order_acquire) <= position)
+            {
+                this_thread::yield();
+                drain();
+            }
         }
-    
-        if (logger)
+        else if (enqueue_position.load(memory_order_relaxed) - dequeue_position.load(memory_order_relaxed) > ring_capacity / 2)
         {
-            logger->Log(final_text, static_cast<uint32_t>(type));
+            writer_condition.notify_one();
         }
     }
 
@@ -71,6 +71,8 @@ namespace spartan
 
         // misc
         static void Initialize();
+        static void Shutdown();
+        static void Flush(); // blocks until everything that was logged so far has been written
         static void SetLogger(ILogger* logger);
         static void SetLogToFile(const bool log_to_file);
         static void Clear();
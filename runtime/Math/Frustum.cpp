@@ -89,6 +89,11 @@ namespace spartan::math
         return CheckCube(center, extent, ignore_depth) != Intersection::Outside;
     }
 
+    bool Frustum::IsVisible(const Vector3& center, const float radius, bool ignore_depth /*= false*/) const
+    {
+        return CheckSphere(center, radius, ignore_depth) != Intersection::Outside;
+    }
+
     Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent, float ignore_depth /*= false*/) const
     {
         Intersection result = Intersection::Inside;
@@ -130,6 +135,8 @@ namespace spartan::math
     {
         SP_ASSERT(!center.IsNaN() && radius > 0.0f);
 
+        Intersection result = Intersection::Inside;
+
         // calculate our distances to each of the planes
         for (size_t i = 0; i < 6; i++)
         {
@@ -146,12 +153,14 @@ namespace spartan::math
             if (distance < -radius)
                 return Intersection::Outside;
 
-            // else if the distance is between +- radius, then we intersect
+            // else if the distance is between +- radius, then we intersect, but keep testing the
+            // remaining planes as the sphere can still be fully outside one of them
             if (static_cast<float>(abs(distance)) < radius)
-                return Intersection::Intersects;
+            {
+                result = Intersection::Intersects;
+            }
         }
 
-        // otherwise we are fully in view
-        return Intersection::Inside;
+        return result;
     }
 }
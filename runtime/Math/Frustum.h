@@ -37,6 +37,7 @@ namespace spartan::math
         ~Frustum() = default;
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_depth = false) const;
+        bool IsVisible(const Vector3& center, const float radius, bool ignore_depth = false) const;
 
     private:
         Intersection CheckCube(const Vector3& center, const Vector3& extent, float ignore_depth = false) const;
@@ -0,0 +1,288 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "pch.h"
+#include "PhysicsCooking.h"
+#include "PhysicsWorld.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Resource/ResourceCache.h"
+#include "../Geometry/GeometryProcessing.h"
+SP_WARNINGS_OFF
+#ifdef DEBUG
+    #define _DEBUG 1
+    #undef NDEBUG
+#else
+    #define NDEBUG 1
+    #undef _DEBUG
+#endif
+#define PX_PHYSX_STATIC_LIB
+#include <physx/PxPhysicsAPI.h>
+SP_WARNINGS_ON
+//==============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+using namespace physx;
+//============================
+
+namespace spartan::physics_cooking
+{
+    namespace
+    {
+        const uint32_t cache_magic            = 0x4B505053; // "SPPK"
+        const uint32_t cache_version          = 1;          // increment when the simplification or the cooking changes
+        const float simplification_ratio      = 0.1f;       // keep 10% of the original indices
+        const size_t simplification_index_min = 512;        // prevent over-simplification
+
+        struct CacheHeader
+        {
+            uint32_t magic   = cache_magic;
+            uint32_t version = cache_version;
+            uint64_t key     = 0;
+            uint64_t size    = 0; // of the cooked data, which follows
+        };
+
+        atomic<uint32_t> temporary_file_id = 0;
+
+        PxCookingParams get_params()
+        {
+            PxTolerancesScale scale;
+            scale.length                          = 1.0f;                         // 1 unit = 1 meter
+            scale.speed                           = PhysicsWorld::GetGravity().y; // gravity is in meters per second
+            PxCookingParams params(scale);
+            params.areaTestEpsilon                = 0.06f * scale.length * scale.length;
+            params.planeTolerance                 = 0.0007f;
+            params.convexMeshCookingType          = PxConvexMeshCookingType::eQUICKHULL;
+            params.suppressTriangleMeshRemapTable = false;
+            params.buildTriangleAdjacencies       = true;
+            params.buildGPUData                   = false;
+            params.meshPreprocessParams          |= PxMeshPreprocessingFlag::eWELD_VERTICES;
+            params.meshWeldTolerance              = 0.01f;
+            params.meshAreaMinLimit               = 0.0f;
+            params.meshEdgeLengthMaxLimit         = 500.0f;
+            params.gaussMapLimit                  = 32;
+            params.maxWeightRatioInTet            = FLT_MAX;
+
+            return params;
+        }
+
+        void* create_mesh(const uint8_t* data, const uint32_t size, const bool is_static)
+        {
+            PxPhysics* physics = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+            PxDefaultMemoryInputData stream(const_cast<PxU8*>(data), size);
+            if (is_static)
+                return physics->createTriangleMesh(stream);
+
+            return physics->createConvexMesh(stream);
+        }
+
+        // written to a temporary file first, so that the same mesh being cooked twice at once can't leave a mix of both behind
+        void save(const uint64_t key, PxDefaultMemoryOutputStream& stream)
+        {
+            error_code error;
+            filesystem::create_directories(get_directory(), error);
+
+            const string path           = get_path(key);
+            const string path_temporary = path + "." + to_string(temporary_file_id++);
+            {
+                CacheHeader header;
+                header.key  = key;
+                header.size = stream.getSize();
+
+                ofstream file(path_temporary, ios::binary);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+                file.write(reinterpret_cast<const char*>(stream.getData()), stream.getSize());
+                if (!file.good())
+                {
+                    file.close();
+                    filesystem::remove(path_temporary, error);
+                    return;
+                }
+            }
+
+            filesystem::rename(path_temporary, path, error);
+            if (error)
+            {
+                filesystem::remove(path_temporary, error);
+                return;
+            }
+
+            evict();
+        }
+    }
+
+    uint64_t compute_key(const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<uint32_t>& indices, const Vector3& scale, const bool is_static)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix      = [&hash](const void* data, const size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+
+        const uint32_t values[] = { cache_version, PX_PHYSICS_VERSION, static_cast<uint32_t>(simplification_index_min), static_cast<uint32_t>(is_static) };
+        const float values_float[] = { simplification_ratio, scale.x, scale.y, scale.z, PhysicsWorld::GetGravity().y };
+        mix(vertices.data(), vertices.size() * sizeof(RHI_Vertex_PosTexNorTan));
+        mix(indices.data(), indices.size() * sizeof(uint32_t));
+        mix(values, sizeof(values));
+        mix(values_float, sizeof(values_float));
+
+        return hash;
+    }
+
+    string get_directory()
+    {
+        return ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "/physics";
+    }
+
+    string get_path(const uint64_t key)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return get_directory() + "/" + name;
+    }
+
+    void evict(const uint64_t size_max)
+    {
+        struct Entry
+        {
+            filesystem::path path;
+            filesystem::file_time_type time;
+            uint64_t size = 0;
+        };
+
+        error_code error;
+        vector<Entry> entries;
+        uint64_t size_total = 0;
+        for (const auto& entry : filesystem::directory_iterator(get_directory(), error))
+        {
+            if (!entry.is_regular_file(error) || entry.path().extension() != ".bin")
+                continue;
+
+            Entry& cached = entries.emplace_back();
+            cached.path   = entry.path();
+            cached.time   = entry.last_write_time(error);
+            cached.size   = entry.file_size(error);
+            size_total   += cached.size;
+        }
+
+        if (size_total <= size_max)
+            return;
+
+        sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+        for (const Entry& entry : entries)
+        {
+            if (size_total <= size_max)
+                break;
+
+            // another worker may have evicted it already
+            if (filesystem::remove(entry.path, error))
+            {
+                size_total -= entry.size;
+            }
+        }
+    }
+
+    void* load(const uint64_t key, const bool is_static)
+    {
+        ifstream file(get_path(key), ios::binary);
+        if (!file.is_open())
+            return nullptr;
+
+        CacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader));
+        if (!file.good() || header.magic != cache_magic || header.version != cache_version || header.key != key || header.size == 0 || header.size > UINT32_MAX)
+            return nullptr;
+
+        vector<uint8_t> data(header.size);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<streamsize>(data.size()));
+        if (!file.good())
+            return nullptr;
+
+        error_code error;
+        filesystem::last_write_time(get_path(key), filesystem::file_time_type::clock::now(), error);
+
+        return create_mesh(data.data(), static_cast<uint32_t>(data.size()), is_static);
+    }
+
+    void* get_mesh(vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices, const Vector3& scale, const bool is_static)
+    {
+        const uint64_t key = compute_key(vertices, indices, scale, is_static);
+        if (void* mesh = load(key, is_static))
+            return mesh;
+
+        // simplify geometry
+        size_t target_index_count = static_cast<size_t>(indices.size() * simplification_ratio);
+        target_index_count        = max<size_t>(target_index_count, simplification_index_min);
+        geometry_processing::simplify(indices, vertices, target_index_count, false);
+
+        // convert vertices to physx format
+        vector<PxVec3> px_vertices;
+        px_vertices.reserve(vertices.size());
+        for (const auto& vertex : vertices)
+        {
+            px_vertices.emplace_back(vertex.pos[0] * scale.x, vertex.pos[1] * scale.y, vertex.pos[2] * scale.z);
+        }
+
+        const PxCookingParams params = get_params();
+        PxDefaultMemoryOutputStream stream;
+        if (is_static) // static: triangle mesh
+        {
+            PxTriangleMeshDesc mesh_desc;
+            mesh_desc.points.count     = static_cast<PxU32>(px_vertices.size());
+            mesh_desc.points.stride    = sizeof(PxVec3);
+            mesh_desc.points.data      = px_vertices.data();
+            mesh_desc.triangles.count  = static_cast<PxU32>(indices.size() / 3);
+            mesh_desc.triangles.stride = 3 * sizeof(PxU32);
+            mesh_desc.triangles.data   = indices.data();
+
+            PxTriangleMeshCookingResult::Enum condition;
+            if (!PxCookTriangleMesh(params, mesh_desc, stream, &condition) || condition != PxTriangleMeshCookingResult::eSUCCESS)
+            {
+                SP_LOG_ERROR("Failed to cook triangle mesh: %d", condition);
+                return nullptr;
+            }
+        }
+        else // dynamic: convex mesh
+        {
+            PxConvexMeshDesc mesh_desc;
+            mesh_desc.points.count  = static_cast<PxU32>(px_vertices.size());
+            mesh_desc.points.stride = sizeof(PxVec3);
+            mesh_desc.points.data   = px_vertices.data();
+            mesh_desc.flags         = PxConvexFlag::eCOMPUTE_CONVEX;
+
+            PxConvexMeshCookingResult::Enum condition;
+            if (!PxCookConvexMesh(params, mesh_desc, stream, &condition) || condition != PxConvexMeshCookingResult::eSUCCESS)
+            {
+                SP_LOG_ERROR("Failed to cook convex mesh: %d", condition);
+                return nullptr;
+            }
+        }
+
+        save(key, stream);
+        return create_mesh(stream.getData(), stream.getSize(), is_static);
+    }
+}
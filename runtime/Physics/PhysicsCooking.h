@@ -0,0 +1,57 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===============
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../Math/Vector3.h"
+//==========================
+
+namespace spartan
+{
+    struct RHI_Vertex_PosTexNorTan;
+}
+
+// cooked meshes are cached to disk, keyed by everything that affects them, so that a mesh
+// is only simplified and cooked the first time it's loaded, later loads only deserialize it
+namespace spartan::physics_cooking
+{
+    const uint64_t cache_size_max = 256ull * 1024 * 1024; // least recently used meshes are evicted past this
+
+    // fnv-1a over the source geometry, the scale it's baked with, the body type and the versions of the cache and physx
+    uint64_t compute_key(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, const std::vector<uint32_t>& indices, const math::Vector3& scale, const bool is_static);
+
+    // the cache lives in the project's cache directory, a file per mesh
+    std::string get_directory();
+    std::string get_path(const uint64_t key);
+
+    // creates the mesh (a PxTriangleMesh when static, a PxConvexMesh otherwise) from the cache, null when it's not cached
+    void* load(const uint64_t key, const bool is_static);
+
+    // deletes the least recently used files until the cache fits, loads touch the write time of the file they read
+    void evict(const uint64_t size_max = cache_size_max);
+
+    // loads the mesh from the cache, or simplifies, cooks and caches it, the geometry is consumed
+    void* get_mesh(std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices, const math::Vector3& scale, const bool is_static);
+}
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Input/Input.h"
 #include "../World/Components/Camera.h"
 #include "../World/World.h"
+#include "../Core/ThreadPool.h"
 SP_WARNINGS_OFF
 #ifdef DEBUG
     #define _DEBUG 1
@@ -76,17 +77,51 @@ namespace spartan
         }
     };
 
+    // runs the simulation tasks on the engine's thread pool, instead of on a separate set of threads that would compete with it
+    class PhysXDispatcher : public physx::PxCpuDispatcher
+    {
+    public:
+        void submitTask(physx::PxBaseTask& task) override
+        {
+            // without workers, the task runs on the thread that submitted it (which is what physx does in that case as well)
+            if (ThreadPool::GetThreadCount() == 0)
+            {
+                task.run();
+                task.release();
+                return;
+            }
+
+            // urgent, since the main thread blocks on the results every frame and imports can have seconds of work queued
+            ThreadPool::AddTask([&task]()
+            {
+                task.run();
+                task.release();
+            }, true);
+        }
+
+        uint32_t getWorkerCount() const override
+        {
+            return ThreadPool::GetThreadCount();
+        }
+    };
+
     namespace
     {
         static PxDefaultAllocator allocator;
         static PhysXLogging logger;
-        static PxFoundation* foundation           = nullptr;
-        static PxPhysics* physics                 = nullptr;
-        static PxScene* scene                     = nullptr;
-        static PxDefaultCpuDispatcher* dispatcher = nullptr;
-        static PxRigidDynamic* picked_body        = nullptr;
-        static PxReal pick_distance               = 0.0f;
+        static PhysXDispatcher dispatcher;
+        static PxFoundation* foundation    = nullptr;
+        static PxPhysics* physics          = nullptr;
+        static PxScene* scene              = nullptr;
+        static PxRigidDynamic* picked_body = nullptr;
+        static PxReal pick_distance        = 0.0f;
         static PxVec3 pick_direction;
+
+        // fixed step simulation
+        static float accumulated_time      = 0.0f;
+        static uint32_t steps_remaining    = 0;     // steps of this frame that run after the first one
+        static bool is_simulating          = false; // a step was kicked off and its results haven't been fetched yet
+        static atomic<uint64_t> step_count = 0;
     }
 
     void PhysicsWorld::Initialize()
@@ -104,15 +139,12 @@ namespace spartan
         // scene
         PxSceneDesc scene_desc(physics->getTolerancesScale());
         scene_desc.gravity        = PxVec3(0.0f, settings::gravity, 0.0f);
-        scene_desc.cpuDispatcher  = PxDefaultCpuDispatcherCreate(2);
+        scene_desc.cpuDispatcher  = &dispatcher;
         scene_desc.filterShader   = PxDefaultSimulationFilterShader;
         scene_desc.flags         |= PxSceneFlag::eENABLE_CCD; // enable continuous collision detection to reduce tunneling
         scene = physics->createScene(scene_desc);
         SP_ASSERT(scene);
 
-        // store dispatcher
-        dispatcher = static_cast<PxDefaultCpuDispatcher*>(scene_desc.cpuDispatcher);
-
         // enable all debug visualization parameters
         scene->setVisualizationParameter(PxVisualizationParameter::eSCALE,               1.0f);
         scene->setVisualizationParameter(PxVisualizationParameter::eWORLD_AXES,          1.0f);
@@ -132,7 +164,6 @@ namespace spartan
     void PhysicsWorld::Shutdown()
     {
         PX_RELEASE(scene);
-        PX_RELEASE(dispatcher);
         PX_RELEASE(physics);
         PX_RELEASE(foundation);
     }
@@ -146,25 +177,6 @@ namespace spartan
 
         if (Engine::IsFlagSet(EngineMode::Playing))
         {
-            // simulation
-            {
-                const float  fixed_time_step  = 1.0f / settings::hz;
-                static float accumulated_time = 0.0f;
-
-                // accumulate delta time
-                accumulated_time += static_cast<float>(Timer::GetDeltaTimeSec());
-
-                // perform simulation steps
-                while (accumulated_time >= fixed_time_step)
-                {
-                    // simulate one fixed time step
-                    scene->simulate(fixed_time_step);
-                    scene->fetchResults(true); // block
-
-                    accumulated_time -= fixed_time_step;
-                }
-            }
-
             // object picking
             {
                 if (Input::GetKeyDown(KeyCode::Click_Left) && Input::GetMouseIsInViewport())
@@ -197,6 +209,57 @@ namespace spartan
         }
     }
 
+    void PhysicsWorld::Simulate()
+    {
+        SP_PROFILE_CPU();
+
+        if (ProgressTracker::IsLoading() || !Engine::IsFlagSet(EngineMode::Playing))
+            return;
+
+        const float fixed_time_step = 1.0f / settings::hz;
+        accumulated_time           += static_cast<float>(Timer::GetDeltaTimeSec());
+        if (accumulated_time < fixed_time_step)
+            return;
+
+        // kick off the first step and return, it runs on the workers while the renderer records the frame
+        const uint32_t step_count_frame = static_cast<uint32_t>(accumulated_time / fixed_time_step);
+        accumulated_time               -= fixed_time_step * static_cast<float>(step_count_frame);
+        steps_remaining                 = step_count_frame - 1;
+        is_simulating                   = true;
+        scene->simulate(fixed_time_step);
+    }
+
+    void PhysicsWorld::FetchResults()
+    {
+        SP_PROFILE_CPU();
+
+        if (!is_simulating)
+            return;
+
+        scene->fetchResults(true); // block
+        is_simulating = false;
+        step_count++;
+
+        // a frame that took longer than a step has to catch up, these steps have nothing to overlap with
+        const float fixed_time_step = 1.0f / settings::hz;
+        for (; steps_remaining > 0; steps_remaining--)
+        {
+            scene->simulate(fixed_time_step);
+            scene->fetchResults(true);
+            step_count++;
+        }
+    }
+
+    uint64_t PhysicsWorld::GetStepCount()
+    {
+        return step_count.load(memory_order_relaxed);
+    }
+
+    float PhysicsWorld::GetInterpolationFactor()
+    {
+        return clamp(accumulated_time * settings::hz, 0.0f, 1.0f);
+    }
+
     Vector3 PhysicsWorld::GetGravity()
     {
         PxVec3 g = scene->getGravity();
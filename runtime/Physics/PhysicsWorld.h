@@ -35,6 +35,12 @@ namespace spartan
         static void Shutdown();
         static void Tick();
 
+        // simulation, a step is kicked off before the renderer and fetched after it, so that the two overlap
+        static void Simulate();
+        static void FetchResults();
+        static uint64_t GetStepCount(); // incremented after every step, so that poses can be interpolated between the last two
+        static float GetInterpolationFactor();
+
         static math::Vector3 GetGravity();
         static void* GetScene();
         static void* GetPhysics();
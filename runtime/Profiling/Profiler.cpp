@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/ThreadPool.h"
 #include "../Core/Debugging.h"
 #include "../Rendering/Renderer.h"
+#include "../Rendering/GeometryPool.h"
 #include "../Display/Display.h"
 //====================================
 
@@ -106,6 +107,7 @@ namespace spartan
         string cpu_name           = "N/A";
         bool poll                 = false;
         bool allow_time_block_end = true;
+        thread::id main_thread_id; // time blocks form a single stack, other threads are only visible in the trace
 
         string get_cpu_name()
         {
@@ -156,7 +158,8 @@ namespace spartan
         m_time_blocks_write.reserve(max_timeblocks);
         m_time_blocks_write.resize(max_timeblocks);
 
-        cpu_name = get_cpu_name();
+        cpu_name       = get_cpu_name();
+        main_thread_id = this_thread::get_id();
     }
 
     void Profiler::PostTick()
@@ -204,6 +207,11 @@ namespace spartan
             m_fps = 1000.0f / time_frame_avg;
         }
 
+        // trace
+        Trace::Counter("frame_ms", time_frame_last);
+        Trace::Counter("threads_working", static_cast<double>(ThreadPool::GetWorkingThreadCount()));
+        Trace::Tick();
+
         // check whether we should profile or not
         time_since_profiling_sec += static_cast<float>(Timer::GetDeltaTimeSec());
         if (time_since_profiling_sec >= profiling_interval_sec)
@@ -279,7 +287,7 @@ namespace spartan
 
     void Profiler::TimeBlockStart(const char* func_name, TimeBlockType type, RHI_CommandList* cmd_list /*= nullptr*/)
     {
-        if (!Debugging::IsGpuTimingEnabled() || !poll)
+        if (!Debugging::IsGpuTimingEnabled() || !poll || this_thread::get_id() != main_thread_id)
             return;
 
         const bool can_profile_cpu = (type == TimeBlockType::Cpu) && profile_cpu;
@@ -298,6 +306,9 @@ namespace spartan
 
     void Profiler::TimeBlockEnd()
     {
+        if (this_thread::get_id() != main_thread_id)
+            return;
+
         if (TimeBlock* time_block = GetLastIncompleteTimeBlock(TimeBlockType::Cpu))
         {
             time_block->End();
@@ -423,6 +434,7 @@ namespace spartan
         if (metrics_time_since_last_update >= profiling_interval_sec)
         {
             metrics_time_since_last_update = 0.0f;
+            const GeometryPoolStats geometry_pool = GeometryPool::GetStats();
     
             snprintf(metrics_buffer, sizeof(metrics_buffer),
                 "FPS:\t\t\t%.1f\n"
@@ -459,7 +471,12 @@ namespace spartan
                 "Vertex buffer bindings:\t\t%u\n"
                 "Barriers:\t\t\t\t\t\t\t\t\t%u\n"
                 "Bindings from pipelines:\t%u/%u\n"
-                "Descriptor set capacity:\t%u/%u",
+                "Descriptor set capacity:\t%u/%u\n\n"
+                "Geometry pool\n"
+                "Vertices:\t\t\t\t%.1f/%.1f M - %.0f%% fragmented\n"
+                "Indices:\t\t\t\t\t%.1f/%.1f M - %.0f%% fragmented\n"
+                "Meshes:\t\t\t\t\t%u\n"
+                "Grows/defrags:\t%u/%u",
 
                 m_fps,
                 time_frame_avg,
@@ -497,7 +514,12 @@ namespace spartan
                 m_rhi_bindings_buffer_vertex,
                 m_rhi_pipeline_barriers,
                 m_rhi_bindings_pipeline, RHI_Device::GetPipelineCount(),
-                m_descriptor_set_count, rhi_max_descriptor_set_count
+                m_descriptor_set_count, rhi_max_descriptor_set_count,
+
+                geometry_pool.vertices.used / 1e6f, geometry_pool.vertices.capacity / 1e6f, geometry_pool.vertices.fragmentation * 100.0f,
+                geometry_pool.indices.used / 1e6f, geometry_pool.indices.capacity / 1e6f, geometry_pool.indices.fragmentation * 100.0f,
+                geometry_pool.vertices.allocation_count,
+                geometry_pool.grow_count, geometry_pool.defragmentation_count
             );
         }
     
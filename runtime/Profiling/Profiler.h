@@ -25,10 +25,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <vector>
 #include "TimeBlock.h"
+#include "Trace.h"
 //====================
 
-#define SP_PROFILE_CPU_START(name) spartan::Profiler::TimeBlockStart(name, spartan::TimeBlockType::Cpu, nullptr);
-#define SP_PROFILE_CPU_END()       spartan::Profiler::TimeBlockEnd();
+#define SP_PROFILE_CPU_START(name) spartan::Profiler::TimeBlockStart(name, spartan::TimeBlockType::Cpu, nullptr); spartan::Trace::Begin(name);
+#define SP_PROFILE_CPU_END()       spartan::Profiler::TimeBlockEnd(); spartan::Trace::End();
 #define SP_PROFILE_CPU()           ScopedTimeBlock time_block = ScopedTimeBlock(__FUNCTION__);
 
 namespace spartan
@@ -117,10 +118,12 @@ namespace spartan
         ScopedTimeBlock(const char* name = nullptr)
         {
             Profiler::TimeBlockStart(name, spartan::TimeBlockType::Cpu);
+            Trace::Begin(name);
         }
 
         ~ScopedTimeBlock()
         {
+            Trace::End();
             Profiler::TimeBlockEnd();
         }
     };
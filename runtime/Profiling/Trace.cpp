@@ -0,0 +1,350 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "Trace.h"
+#include "Profiler.h"
+#include "../Core/ThreadPool.h"
+#include "../Core/Debugging.h"
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        // a thread's ring, along with the storage behind it and what an export shows for the thread
+        struct ThreadBuffer
+        {
+            TraceRing ring;
+            vector<TraceEvent> events;
+            uint32_t id = 0;
+            string name;
+        };
+
+        struct ThreadSnapshot
+        {
+            uint32_t id = 0;
+            string name;
+            vector<TraceEvent> events;
+        };
+
+        // the main thread records most of the scopes, so it gets more room, at 24 bytes per event
+        const uint64_t capacity_main       = 256 * 1024;
+        const uint64_t capacity_other      = 32 * 1024;
+        const double stutter_dump_seconds  = 3.0;
+        const double stutter_dump_cooldown = 30.0;
+
+        mutex buffers_mutex;
+        vector<unique_ptr<ThreadBuffer>> buffers;
+        thread::id main_thread_id;
+        atomic<uint64_t> flow_id = 0;
+
+        // capture
+        uint64_t frame                 = 0;
+        uint32_t capture_frames_left   = 0;
+        uint64_t capture_start         = 0;
+        double time_since_stutter_dump = stutter_dump_cooldown;
+
+        // the clock is calibrated against the steady clock over the lifetime of the engine, when exporting
+        const chrono::steady_clock::time_point time_start = chrono::steady_clock::now();
+
+        double ticks_per_microsecond()
+        {
+            const double microseconds = chrono::duration<double, micro>(chrono::steady_clock::now() - time_start).count();
+            return microseconds > 0.0 ? static_cast<double>(Trace::GetTicks()) / microseconds : 1.0;
+        }
+
+        uint64_t ticks_seconds_ago(const double seconds)
+        {
+            const uint64_t ticks_elapsed = Trace::GetTicks();
+            const uint64_t ticks_window  = static_cast<uint64_t>(seconds * 1'000'000.0 * ticks_per_microsecond());
+            return ticks_elapsed > ticks_window ? ticks_elapsed - ticks_window : 0;
+        }
+
+        // copies the events, from every thread, that were recorded after the given tick
+        vector<ThreadSnapshot> snapshot(const uint64_t ticks_from)
+        {
+            lock_guard<mutex> lock(buffers_mutex);
+
+            vector<ThreadSnapshot> snapshots;
+            snapshots.reserve(buffers.size());
+            for (const unique_ptr<ThreadBuffer>& buffer : buffers)
+            {
+                const uint64_t capacity     = buffer->ring.mask + 1;
+                const uint64_t count_before = buffer->ring.count.load(memory_order_acquire);
+                uint64_t first              = count_before > capacity ? count_before - capacity : 0;
+
+                ThreadSnapshot& snapshot = snapshots.emplace_back();
+                snapshot.id              = buffer->id;
+                snapshot.name            = buffer->name;
+                snapshot.events.reserve(count_before - first);
+                for (uint64_t i = first; i < count_before; i++)
+                {
+                    snapshot.events.push_back(buffer->events[i & buffer->ring.mask]);
+                }
+
+                // drop what the writer overwrote while it was being copied, and what is older than requested,
+                // the slot at count_after may be mid-write too, so its previous occupant counts as overwritten
+                const uint64_t count_after = buffer->ring.count.load(memory_order_acquire);
+                const uint64_t overwritten = count_after + 1 > capacity ? count_after + 1 - capacity : 0;
+                size_t skip                = overwritten > first ? static_cast<size_t>(overwritten - first) : 0;
+                while (skip < snapshot.events.size() && snapshot.events[skip].timestamp < ticks_from)
+                {
+                    skip++;
+                }
+                snapshot.events.erase(snapshot.events.begin(), snapshot.events.begin() + min(skip, snapshot.events.size()));
+            }
+
+            return snapshots;
+        }
+
+        void append_escaped(string& json, const char* text)
+        {
+            for (const char* c = text ? text : "unnamed"; *c; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    json += '\\';
+                    json += *c;
+                }
+                else if (static_cast<unsigned char>(*c) >= 0x20)
+                {
+                    json += *c;
+                }
+            }
+        }
+
+        // chrome's trace event format, scopes are paired into complete events so a capture that
+        // starts or ends in the middle of a scope doesn't leave the viewer with unbalanced ones
+        bool write_json(const string& file_path, const vector<ThreadSnapshot>& snapshots, const double ticks_per_us)
+        {
+            string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            char buffer[256];
+            bool first  = true;
+            auto append = [&](const char* format, auto... arguments)
+            {
+                json += first ? "" : ",\n";
+                first = false;
+                snprintf(buffer, sizeof(buffer), format, arguments...);
+                json += buffer;
+            };
+            auto to_us = [ticks_per_us](const uint64_t ticks) { return static_cast<double>(ticks) / ticks_per_us; };
+
+            for (const ThreadSnapshot& snapshot : snapshots)
+            {
+                if (snapshot.events.empty())
+                    continue;
+
+                const uint32_t tid = snapshot.id;
+                append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", tid);
+                append_escaped(json, snapshot.name.c_str());
+                json += "\"}}";
+
+                vector<const TraceEvent*> stack;
+                auto complete = [&](const TraceEvent* begin, const uint64_t end)
+                {
+                    append("{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"", tid, to_us(begin->timestamp), to_us(end - begin->timestamp));
+                    append_escaped(json, begin->name);
+                    json += "\"}";
+                };
+
+                for (const TraceEvent& event : snapshot.events)
+                {
+                    const double ts = to_us(event.timestamp);
+                    switch (static_cast<TraceEventType>(event.type))
+                    {
+                        case TraceEventType::Begin:
+                            stack.push_back(&event);
+                            break;
+
+                        case TraceEventType::End:
+                            if (!stack.empty()) // the begin can be older than the capture
+                            {
+                                complete(stack.back(), event.timestamp);
+                                stack.pop_back();
+                            }
+                            break;
+
+                        case TraceEventType::Counter:
+                        {
+                            double value = 0.0;
+                            memcpy(&value, &event.value, sizeof(value));
+                            append("{\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%g},\"name\":\"", tid, ts, value);
+                            append_escaped(json, event.name);
+                            json += "\"}";
+                            break;
+                        }
+
+                        case TraceEventType::FlowBegin:
+                        case TraceEventType::FlowEnd:
+                        {
+                            const bool is_begin = static_cast<TraceEventType>(event.type) == TraceEventType::FlowBegin;
+                            append("{\"ph\":\"%s\",\"cat\":\"flow\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"id\":%llu,\"name\":\"", is_begin ? "s" : "f\",\"bp\":\"e", tid, ts, static_cast<unsigned long long>(event.value));
+                            append_escaped(json, event.name);
+                            json += "\"}";
+                            break;
+                        }
+
+                        case TraceEventType::Frame:
+                            append("{\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"name\":\"frame %llu\"}", tid, ts, static_cast<unsigned long long>(event.value));
+                            break;
+                    }
+                }
+
+                // scopes that were still open, end them with the capture
+                const uint64_t end = snapshot.events.back().timestamp;
+                while (!stack.empty())
+                {
+                    complete(stack.back(), end);
+                    stack.pop_back();
+                }
+            }
+
+            json += "\n]}\n";
+
+            ofstream file(file_path, ios::out | ios::binary | ios::trunc);
+            if (!file.is_open())
+                return false;
+
+            file.write(json.data(), static_cast<streamsize>(json.size()));
+            return file.good();
+        }
+
+        // the copy is made right away, formatting and writing happens on a worker
+        void export_async(const string& file_path, const uint64_t ticks_from)
+        {
+            auto snapshots     = make_shared<vector<ThreadSnapshot>>(snapshot(ticks_from));
+            const double ratio = ticks_per_microsecond();
+            ThreadPool::AddTask([file_path, snapshots, ratio]()
+            {
+                if (write_json(file_path, *snapshots, ratio))
+                {
+                    SP_LOG_INFO("Trace written to \"%s\"", file_path.c_str());
+                }
+                else
+                {
+                    SP_LOG_ERROR("Failed to write trace to \"%s\"", file_path.c_str());
+                }
+            });
+        }
+    }
+
+    const uint64_t Trace::ticks_start = Trace::GetTicksRaw();
+
+    TraceRing* Trace::RegisterThread()
+    {
+        lock_guard<mutex> lock(buffers_mutex);
+
+        const uint64_t capacity = (this_thread::get_id() == main_thread_id) ? capacity_main : capacity_other;
+
+        unique_ptr<ThreadBuffer> buffer = make_unique<ThreadBuffer>();
+        buffer->events.resize(capacity);
+        buffer->ring.events = buffer->events.data();
+        buffer->ring.mask   = capacity - 1;
+        buffer->id          = static_cast<uint32_t>(buffers.size()) + 1;
+        buffer->name        = "thread_" + to_string(buffer->id);
+
+        ring_local = &buffer->ring;
+        buffers.push_back(move(buffer));
+
+        return ring_local;
+    }
+
+    void Trace::Initialize()
+    {
+        main_thread_id = this_thread::get_id();
+        SetThreadName("main");
+    }
+
+    void Trace::Tick()
+    {
+        Record(TraceEventType::Frame, nullptr, frame);
+
+        if (capture_frames_left > 0 && --capture_frames_left == 0)
+        {
+            export_async("trace_" + to_string(frame) + ".json", capture_start);
+        }
+
+        // keep what lead to a stutter, but don't cause more of them by dumping every time
+        time_since_stutter_dump += Timer::GetDeltaTimeSec();
+        if (Debugging::IsTraceOnStutterEnabled() && Profiler::IsCpuStuttering() && time_since_stutter_dump >= stutter_dump_cooldown)
+        {
+            export_async("trace_stutter_" + to_string(frame) + ".json", ticks_seconds_ago(stutter_dump_seconds));
+            time_since_stutter_dump = 0.0;
+        }
+
+        frame++;
+    }
+
+    void Trace::SetThreadName(const string& name)
+    {
+        TraceRing* ring = ring_local ? ring_local : RegisterThread();
+
+        lock_guard<mutex> lock(buffers_mutex);
+        for (unique_ptr<ThreadBuffer>& buffer : buffers)
+        {
+            if (&buffer->ring == ring)
+            {
+                buffer->name = name;
+            }
+        }
+    }
+
+    void Trace::Counter(const char* name, const double value)
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        Record(TraceEventType::Counter, name, bits);
+    }
+
+    uint64_t Trace::FlowBegin(const char* name)
+    {
+        const uint64_t id = flow_id.fetch_add(1, memory_order_relaxed) + 1;
+        Record(TraceEventType::FlowBegin, name, id);
+        return id;
+    }
+
+    void Trace::FlowEnd(const char* name, const uint64_t id)
+    {
+        Record(TraceEventType::FlowEnd, name, id);
+    }
+
+    void Trace::CaptureFrames(const uint32_t frame_count)
+    {
+        capture_start       = Trace::GetTicks();
+        capture_frames_left = max(frame_count, 1u);
+    }
+
+    bool Trace::IsCapturing()
+    {
+        return capture_frames_left > 0;
+    }
+
+    bool Trace::Export(const string& file_path, const double seconds)
+    {
+        return write_json(file_path, snapshot(ticks_seconds_ago(seconds)), ticks_per_microsecond());
+    }
+}
@@ -0,0 +1,125 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+//===================
+
+namespace spartan
+{
+    enum class TraceEventType : uint8_t
+    {
+        Begin,
+        End,
+        Counter,
+        FlowBegin,
+        FlowEnd,
+        Frame
+    };
+
+    struct TraceEvent
+    {
+        uint64_t timestamp : 56; // ticks since startup
+        uint64_t type      : 8;
+        const char* name;
+        uint64_t value;          // the bits of a counter's value, a flow id or a frame number
+    };
+
+    // a ring that only its thread writes to, the count is published after an event is written, so a reader can
+    // copy the ring at any time and afterwards discard the part that the writer might have overwritten meanwhile
+    struct TraceRing
+    {
+        TraceEvent* events          = nullptr;
+        uint64_t mask               = 0;
+        std::atomic<uint64_t> count = 0;
+    };
+
+    // records scopes, counters and flows (e.g. a task from where it's queued to where it runs) from any thread into
+    // per-thread rolling buffers, so the last few seconds can be exported as a chrome trace (chrome://tracing, ui.perfetto.dev)
+    // names are stored as pointers, so they have to outlive the buffers (string literals or long-lived strings)
+    class Trace
+    {
+    public:
+        static void Initialize();
+        static void Tick(); // marks a frame, finishes captures and dumps on stutter
+
+        // recording
+        static void SetThreadName(const std::string& name);
+        static void Begin(const char* name) { Record(TraceEventType::Begin, name, 0); }
+        static void End()                   { Record(TraceEventType::End, nullptr, 0); }
+        static void Counter(const char* name, const double value);
+        static uint64_t FlowBegin(const char* name); // returns the id to pass to FlowEnd(), on the thread that continues the flow
+        static void FlowEnd(const char* name, const uint64_t id);
+
+        // export
+        static void CaptureFrames(const uint32_t frame_count); // writes trace_<frame>.json once the frames have been recorded
+        static bool IsCapturing();
+        static bool Export(const std::string& file_path, const double seconds); // the last n seconds, as far as the buffers reach
+
+        // ticks since startup, the clock that events are recorded with
+        static uint64_t GetTicks() { return GetTicksRaw() - ticks_start; }
+
+    private:
+        // scopes are everywhere, so recording is inline, only a thread's first event goes out of line to create its ring
+        static void Record(const TraceEventType type, const char* name, const uint64_t value)
+        {
+            TraceRing* ring      = ring_local ? ring_local : RegisterThread();
+            const uint64_t index = ring->count.load(std::memory_order_relaxed);
+            TraceEvent& event    = ring->events[index & ring->mask];
+            event.timestamp      = GetTicks();
+            event.type           = static_cast<uint64_t>(type);
+            event.name           = name;
+            event.value          = value;
+            ring->count.store(index + 1, std::memory_order_release);
+        }
+
+        static uint64_t GetTicksRaw()
+        {
+            #if defined(_M_X64) || defined(__x86_64__)
+            return __rdtsc();
+            #else
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            #endif
+        }
+
+        static TraceRing* RegisterThread();
+
+        static inline thread_local TraceRing* ring_local = nullptr;
+        static const uint64_t ticks_start;
+    };
+
+    class TraceScope
+    {
+    public:
+        TraceScope(const char* name) { Trace::Begin(name); }
+        ~TraceScope()                { Trace::End(); }
+    };
+}
@@ -44,4 +44,19 @@ namespace spartan
     {
 
     }
+
+    void RHI_Buffer::Upload(const void* data, const uint64_t offset, const uint64_t size)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_Buffer::Upload(const vector<RHI_BufferUpload>& uploads)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_Buffer::CopyFrom(RHI_Buffer* source, const vector<RHI_BufferCopyRegion>& regions)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
 }
@@ -322,22 +322,27 @@ namespace spartan
         return 0.0f;
     }
 
-    void RHI_CommandList::BeginOcclusionQuery(const uint64_t entity_id)
+    uint32_t RHI_CommandList::AllocateOcclusionQuery()
     {
-        return;
+        return RHI_QuerySlotAllocator::invalid_slot;
     }
 
-    void RHI_CommandList::EndOcclusionQuery()
+    void RHI_CommandList::FreeOcclusionQuery(const uint32_t slot)
     {
 
     }
 
-    bool RHI_CommandList::GetOcclusionQueryResult(const uint64_t entity_id)
+    bool RHI_CommandList::GetOcclusionQueryResult(const uint32_t slot)
     {
         return false;
     }
 
-    void RHI_CommandList::UpdateOcclusionQueries()
+    void RHI_CommandList::BeginOcclusionQuery(const uint32_t slot)
+    {
+
+    }
+
+    void RHI_CommandList::EndOcclusionQuery()
     {
 
     }
@@ -367,8 +372,19 @@ namespace spartan
 
     }
 
+    void RHI_CommandList::InsertBarrier(RHI_Texture* texture, const uint32_t mip_index, const uint32_t mip_range, const uint32_t array_length, const RHI_Image_Layout layout_new)
+    {
+
+    }
+
+    void RHI_CommandList::InsertBarrier(RHI_SwapChain* swapchain, const RHI_Image_Layout layout_new)
+    {
+
+    }
+
     void RHI_CommandList::InsertBarrier(
         void* image,
+        RHI_ImageLayouts& layouts,
         const RHI_Format format,
         const uint32_t mip_index,
         const uint32_t mip_range,
@@ -393,9 +409,4 @@ namespace spartan
     {
 
     }
-
-    RHI_Image_Layout RHI_CommandList::GetImageLayout(void* image, const uint32_t mip_index)
-    {
-        return RHI_Image_Layout::Max;
-    }
 }
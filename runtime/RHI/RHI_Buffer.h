@@ -38,6 +38,22 @@ namespace spartan
         Max
     };
 
+    struct RHI_BufferCopyRegion
+    {
+        uint64_t offset_source      = 0; // bytes
+        uint64_t offset_destination = 0; // bytes
+        uint64_t size               = 0; // bytes
+    };
+
+    class RHI_Buffer;
+    struct RHI_BufferUpload
+    {
+        RHI_Buffer* buffer = nullptr;
+        const void* data   = nullptr;
+        uint64_t offset    = 0; // bytes
+        uint64_t size      = 0; // bytes
+    };
+
     class RHI_Buffer : public SpartanObject
     {
     public:
@@ -72,6 +88,11 @@ namespace spartan
         void Update(RHI_CommandList* cmd_list, void* data_cpu, const uint32_t size = 0);
         void ResetOffset() { m_offset = 0; first_update = true; }
 
+        // device local (vertex and index) buffer updating, both block until the copy is done
+        void Upload(const void* data, const uint64_t offset, const uint64_t size);
+        static void Upload(const std::vector<RHI_BufferUpload>& uploads); // one staging buffer and one submission for all of them
+        void CopyFrom(RHI_Buffer* source, const std::vector<RHI_BufferCopyRegion>& regions);
+
         // propeties
         uint32_t GetStrideUnaligned() const { return m_stride_unaligned; }
         uint32_t GetStride() const          { return m_stride; }
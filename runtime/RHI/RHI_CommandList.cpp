@@ -71,7 +71,7 @@ namespace spartan
         Dispatch(thread_group_count_x, thread_group_count_y, thread_group_count_z);
 
         // synchronize writes to the texture
-        if (GetImageLayout(texture->GetRhiResource(), 0) == RHI_Image_Layout::General)
+        if (texture->GetLayout(0) == RHI_Image_Layout::General)
         { 
             InsertBarrierReadWrite(texture);
         }
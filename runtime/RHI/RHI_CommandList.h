@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <atomic>
 #include "RHI_Definitions.h"
 #include "RHI_PipelineState.h"
+#include "RHI_QuerySlots.h"
 #include "../Rendering/Renderer_Definitions.h"
 #include <SpartanObject.h>
 #include <stack>
@@ -128,11 +129,13 @@ namespace spartan
         void EndTimestamp();
         float GetTimestampResult(const uint32_t index_timestamp);
 
-        // occlusion queries
-        void BeginOcclusionQuery(const uint64_t entity_id);
+        // occlusion queries, a slot is owned by whoever allocates it (e.g. one per renderable) and its result is
+        // read back once the command list that recorded it has finished executing (when the command list begins again)
+        static uint32_t AllocateOcclusionQuery();
+        static void FreeOcclusionQuery(const uint32_t slot);
+        static bool GetOcclusionQueryResult(const uint32_t slot); // true if occluded
+        void BeginOcclusionQuery(const uint32_t slot);
         void EndOcclusionQuery();
-        bool GetOcclusionQueryResult(const uint64_t entity_id);
-        void UpdateOcclusionQueries();
 
         // timeblocks (cpu and gpu time measurement as well as gpu markers)
         void BeginTimeblock(const char* name, const bool gpu_marker = true, const bool gpu_timing = true);
@@ -142,14 +145,8 @@ namespace spartan
         void UpdateBuffer(RHI_Buffer* buffer, const uint64_t offset, const uint64_t size, const void* data);
 
         // memory barriers
-        void InsertBarrier(
-            void* image,
-            const RHI_Format format,
-            const uint32_t mip_index,
-            const uint32_t mip_range,
-            const uint32_t array_length,
-            const RHI_Image_Layout layout_new
-        );
+        void InsertBarrier(RHI_Texture* texture, const uint32_t mip_index, const uint32_t mip_range, const uint32_t array_length, const RHI_Image_Layout layout_new);
+        void InsertBarrier(RHI_SwapChain* swapchain, const RHI_Image_Layout layout_new);
         void InsertBarrierReadWrite(RHI_Texture* texture);
         void InsertBarrierReadWrite(RHI_Buffer* buffer);
         void InsertPendingBarrierGroup();
@@ -161,11 +158,16 @@ namespace spartan
         const RHI_CommandListState GetState() const        { return m_state; }
         RHI_Queue* GetQueue() const                        { return m_queue; }
 
-        // layouts
-        static void RemoveLayout(void* image);
-        static RHI_Image_Layout GetImageLayout(void* image, uint32_t mip_index);
-
     private:
+        void InsertBarrier(
+            void* image,
+            RHI_ImageLayouts& layouts,
+            const RHI_Format format,
+            const uint32_t mip_index,
+            const uint32_t mip_range,
+            const uint32_t array_length,
+            const RHI_Image_Layout layout_new
+        );
         void PreDraw();
         void RenderPassBegin();
 
@@ -175,6 +177,7 @@ namespace spartan
 
         // misc
         uint64_t m_buffer_id_vertex                          = 0;
+        uint64_t m_buffer_id_instance                        = 0;
         uint64_t m_buffer_id_index                           = 0;
         uint32_t m_timestamp_index                           = 0;
         RHI_Pipeline* m_pipeline                             = nullptr;
@@ -187,11 +190,17 @@ namespace spartan
         std::stack<const char*> m_debug_label_stack;
         std::mutex m_mutex_reset;
         RHI_PipelineState m_pso;
-        std::vector<ImageBarrierInfo> m_image_barriers;
+        std::array<ImageBarrierInfo, rhi_max_barrier_count> m_image_barriers;
+        uint32_t m_image_barrier_count = 0;
         RHI_Queue* m_queue = nullptr;
         bool m_load_depth_render_target = false;
         std::array<bool, rhi_max_render_target_count> m_load_color_render_targets = { false };
 
+        // occlusion queries
+        RHI_QueryRange m_occlusion_queries_written;
+        uint32_t m_occlusion_query_capacity = 0;
+        uint32_t m_occlusion_query_active   = RHI_QuerySlotAllocator::invalid_slot;
+
         // rhi resources
         void* m_rhi_resource                       = nullptr;
         void* m_rhi_cmd_pool_resource              = nullptr;
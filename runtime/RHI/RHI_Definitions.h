@@ -25,6 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cstdint>
 #include <cassert>
 #include <limits>
+#include <array>
+#include <atomic>
 #include "../Rendering/Color.h"
 //=============================
 
@@ -462,4 +464,38 @@ namespace spartan
     const uint32_t rhi_all_mips                  = std::numeric_limits<uint32_t>::max();
     const uint32_t rhi_dynamic_offset_empty      = std::numeric_limits<uint32_t>::max();
     const uint32_t rhi_max_buffer_update_size    = 65536; // vkCmdUpdateBuffer has a limit of 65536 bytes
+    const uint32_t rhi_max_barrier_count         = 64;    // pending (grouped) barriers per command list, they are flushed when full
+
+    // the current layout of every mip of an image, owned by the image itself (texture or swapchain)
+    // each mip is an atomic so that layouts can be queried and updated from any thread without locking
+    struct RHI_ImageLayouts
+    {
+        RHI_ImageLayouts() { Reset(); }
+        RHI_ImageLayouts(const RHI_ImageLayouts&)            = delete;
+        RHI_ImageLayouts& operator=(const RHI_ImageLayouts&) = delete;
+
+        void Reset()
+        {
+            for (std::atomic<RHI_Image_Layout>& layout : mips)
+            {
+                layout.store(RHI_Image_Layout::Max, std::memory_order_relaxed);
+            }
+        }
+
+        RHI_Image_Layout Get(const uint32_t mip) const
+        {
+            return mips[mip].load(std::memory_order_acquire);
+        }
+
+        void Set(const uint32_t mip_index, const uint32_t mip_range, const RHI_Image_Layout layout)
+        {
+            const uint32_t mip_end = mip_index + mip_range < rhi_max_mip_count ? mip_index + mip_range : rhi_max_mip_count;
+            for (uint32_t i = mip_index; i < mip_end; i++)
+            {
+                mips[i].store(layout, std::memory_order_release);
+            }
+        }
+
+        std::array<std::atomic<RHI_Image_Layout>, rhi_max_mip_count> mips;
+    };
 }
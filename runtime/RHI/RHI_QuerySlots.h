@@ -0,0 +1,97 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====
+#include <vector>
+#include <cstdint>
+//===============
+
+namespace spartan
+{
+    // hands out stable query slots, freed slots are recycled before the slot count grows
+    // so a query pool only has to be as large as the highest number of slots alive at once
+    class RHI_QuerySlotAllocator
+    {
+    public:
+        static constexpr uint32_t invalid_slot = UINT32_MAX;
+
+        uint32_t Allocate()
+        {
+            uint32_t slot = invalid_slot;
+            if (!m_slots_free.empty())
+            {
+                slot = m_slots_free.back();
+                m_slots_free.pop_back();
+            }
+            else
+            {
+                slot = m_slot_count++;
+                m_allocated.push_back(false);
+            }
+
+            m_allocated[slot] = true;
+            return slot;
+        }
+
+        void Free(const uint32_t slot)
+        {
+            if (!IsAllocated(slot))
+                return;
+
+            m_allocated[slot] = false;
+            m_slots_free.push_back(slot);
+        }
+
+        bool IsAllocated(const uint32_t slot) const { return slot < m_slot_count && m_allocated[slot]; }
+        uint32_t GetSlotCount() const               { return m_slot_count; } // the highest slot + 1, what a pool has to hold
+        uint32_t GetAllocatedCount() const          { return m_slot_count - static_cast<uint32_t>(m_slots_free.size()); }
+
+    private:
+        std::vector<uint32_t> m_slots_free;
+        std::vector<bool> m_allocated;
+        uint32_t m_slot_count = 0;
+    };
+
+    // the slots a command list wrote while recording, once its execution is complete, only this range
+    // is read back and reset, each command list keeps its own, so together they form a ring of frames in flight
+    struct RHI_QueryRange
+    {
+        uint32_t first = UINT32_MAX;
+        uint32_t last  = 0;
+
+        void Add(const uint32_t slot)
+        {
+            first = slot < first ? slot : first;
+            last  = slot > last  ? slot : last;
+        }
+
+        void Clear()
+        {
+            first = UINT32_MAX;
+            last  = 0;
+        }
+
+        bool IsEmpty() const      { return first > last; }
+        uint32_t GetCount() const { return IsEmpty() ? 0 : last - first + 1; }
+    };
+}
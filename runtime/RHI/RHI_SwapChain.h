@@ -68,6 +68,7 @@ namespace spartan
         RHI_Format GetFormat() const    { return m_format; }
         void* GetRhiRt() const          { return m_rhi_rt[m_image_index]; }
         void* GetRhiRtv() const         { return m_rhi_rtv[m_image_index]; }
+        RHI_ImageLayouts& GetImageLayouts() { return m_layouts[m_image_index]; }
 
         // misc
         RHI_SyncPrimitive* GetImageAcquiredSemaphore() const;
@@ -99,5 +100,6 @@ namespace spartan
         void* m_rhi_surface                       = nullptr;
         std::array<void*, buffer_count> m_rhi_rt  = { nullptr };
         std::array<void*, buffer_count> m_rhi_rtv = { nullptr };
+        std::array<RHI_ImageLayouts, buffer_count> m_layouts;
     };
 }
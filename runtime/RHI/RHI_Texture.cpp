@@ -27,6 +27,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IO/FileStream.h"
 #include "../Resource/Import/ImageImporter.h"
 #include "../Core/ProgressTracker.h"
+#include "../Resource/ResourceCache.h"
+#include "../Rendering/TextureStreaming.h"
 SP_WARNINGS_OFF
 #include "compressonator.h"
 SP_WARNINGS_ON
@@ -189,6 +191,24 @@ namespace spartan
         }
     }
 
+    namespace streaming
+    {
+        once_flag directory_cleared;
+
+        // spilled mips only live as long as their texture, so whatever a previous run left behind is removed first
+        string get_spill_path(const uint64_t id)
+        {
+            const string directory = ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "/texture_streaming/";
+            call_once(directory_cleared, [&directory]()
+            {
+                FileSystem::Delete(directory);
+                FileSystem::CreateDirectory_(directory);
+            });
+
+            return directory + to_string(id) + ".mips";
+        }
+    }
+
     RHI_Texture::RHI_Texture() : IResource(ResourceType::Texture)
     {
 
@@ -236,6 +256,12 @@ namespace spartan
 
     RHI_Texture::~RHI_Texture()
     {
+        if (IsStreamed())
+        {
+            TextureStreaming::Unregister(this);
+            FileSystem::Delete(m_streamed_file_path);
+        }
+
         RHI_DestroyResource();
     }
 
@@ -353,12 +379,12 @@ namespace spartan
             SP_ASSERT(mip_index + mip_range <= m_mip_count);
         }
     
-        cmd_list->InsertBarrier(m_rhi_resource, m_format, mip_index, mip_range, m_depth, new_layout);
+        cmd_list->InsertBarrier(this, mip_index, mip_range, m_depth, new_layout);
     }
 
     RHI_Image_Layout RHI_Texture::GetLayout(const uint32_t mip) const
     {
-        return m_rhi_resource ? RHI_CommandList::GetImageLayout(m_rhi_resource, mip) : RHI_Image_Layout::Max;
+        return m_rhi_resource ? m_layouts.Get(mip) : RHI_Image_Layout::Max;
     }
 
     array<RHI_Image_Layout, rhi_max_mip_count> RHI_Texture::GetLayouts()
@@ -378,6 +404,102 @@ namespace spartan
          m_slices.shrink_to_fit();
     }
 
+    vector<uint64_t> RHI_Texture::GetStreamedMipSizes() const
+    {
+        vector<uint64_t> sizes(m_streamed_mip_count);
+        for (uint32_t mip_index = 0; mip_index < m_streamed_mip_count; mip_index++)
+        {
+            const uint32_t mip_width  = max(1u, m_streamed_width >> mip_index);
+            const uint32_t mip_height = max(1u, m_streamed_height >> mip_index);
+            sizes[mip_index]          = CalculateMipSize(mip_width, mip_height, 1, m_format, m_bits_per_channel, m_channel_count);
+        }
+
+        return sizes;
+    }
+
+    shared_ptr<RHI_Texture> RHI_Texture::StageResidentMip(const uint32_t mip) const
+    {
+        SP_ASSERT(IsStreamed());
+
+        const uint32_t mip_resident = min(mip, m_streamed_mip_tail);
+
+        shared_ptr<RHI_Texture> staged = make_shared<RHI_Texture>();
+        staged->m_type                 = m_type;
+        staged->m_format               = m_format;
+        staged->m_flags                = m_flags & ~RHI_Texture_Streamed;
+        staged->m_bits_per_channel     = m_bits_per_channel;
+        staged->m_channel_count        = m_channel_count;
+        staged->m_object_name          = m_object_name;
+        staged->m_depth                = 1;
+        staged->m_width                = max(1u, m_streamed_width >> mip_resident);
+        staged->m_height               = max(1u, m_streamed_height >> mip_resident);
+        staged->m_mip_count            = m_streamed_mip_count - mip_resident;
+        staged->m_viewport             = RHI_Viewport(0, 0, static_cast<float>(staged->m_width), static_cast<float>(staged->m_height));
+
+        // the detail mips are read back from disk, they are stored one after the other, starting with mip 0
+        vector<RHI_Texture_Mip>& mips = staged->m_slices.emplace_back().mips;
+        if (mip_resident < m_streamed_mip_tail)
+        {
+            const vector<uint64_t> mip_sizes = GetStreamedMipSizes();
+
+            uint64_t offset = 0;
+            for (uint32_t mip_index = 0; mip_index < mip_resident; mip_index++)
+            {
+                offset += mip_sizes[mip_index];
+            }
+
+            ifstream file(m_streamed_file_path, ios::binary);
+            file.seekg(static_cast<streamoff>(offset));
+            for (uint32_t mip_index = mip_resident; mip_index < m_streamed_mip_tail && file; mip_index++)
+            {
+                vector<byte>& bytes = mips.emplace_back().bytes;
+                bytes.resize(mip_sizes[mip_index]);
+                file.read(reinterpret_cast<char*>(bytes.data()), static_cast<streamsize>(bytes.size()));
+            }
+
+            if (!file)
+            {
+                SP_LOG_ERROR("Failed to read the streamed mips of \"%s\" from \"%s\"", m_object_name.c_str(), m_streamed_file_path.c_str());
+                return nullptr;
+            }
+        }
+        mips.insert(mips.end(), m_streamed_tail.begin(), m_streamed_tail.end());
+
+        if (!staged->RHI_CreateResource())
+            return nullptr;
+
+        staged->ClearData();
+        staged->ComputeMemoryUsage();
+
+        return staged;
+    }
+
+    void RHI_Texture::ApplyResidentMip(RHI_Texture* staged, const uint32_t mip)
+    {
+        SP_ASSERT(IsStreamed() && staged != nullptr);
+
+        // trade resources, the staged texture leaves with the old one and releases it through the deletion queue
+        swap(m_rhi_resource, staged->m_rhi_resource);
+        swap(m_rhi_srv, staged->m_rhi_srv);
+        swap(m_rhi_srv_mips, staged->m_rhi_srv_mips);
+        swap(m_rhi_rtv, staged->m_rhi_rtv);
+        swap(m_rhi_dsv, staged->m_rhi_dsv);
+        swap(m_mapped_data, staged->m_mapped_data);
+        swap(m_width, staged->m_width);
+        swap(m_height, staged->m_height);
+        swap(m_mip_count, staged->m_mip_count);
+        swap(m_viewport, staged->m_viewport);
+        swap(m_object_size, staged->m_object_size);
+        for (uint32_t mip_index = 0; mip_index < rhi_max_mip_count; mip_index++)
+        {
+            const RHI_Image_Layout layout = m_layouts.Get(mip_index);
+            m_layouts.Set(mip_index, 1, staged->m_layouts.Get(mip_index));
+            staged->m_layouts.Set(mip_index, 1, layout);
+        }
+
+        m_mip_resident = min(mip, m_streamed_mip_tail);
+    }
+
     void RHI_Texture::PrepareForGpu()
     {
         SP_ASSERT_MSG(m_resource_state == ResourceState::Max, "Only unprepared textures can be prepared");
@@ -446,8 +568,52 @@ namespace spartan
                 }
             }
             
-            // upload to gpu
-            SP_ASSERT(RHI_CreateResource());
+            // upload to gpu, streamed textures spill their detail mips to disk and start with just the tail on the gpu
+            const bool is_streamable = (m_flags & RHI_Texture_Streamed) && m_type == RHI_Texture_Type::Type2D && m_depth == 1 && HasData() && !IsUav() && !IsRt();
+            const uint32_t mip_tail  = TextureResidency::ComputeTailMip(m_width, m_height, m_mip_count);
+            bool is_streamed         = false;
+            if (is_streamable && mip_tail > 0)
+            {
+                // the mips are read back by offset, so they have to be exactly the size their dimensions imply
+                const string file_path = streaming::get_spill_path(GetObjectId());
+                {
+                    ofstream file(file_path, ios::binary | ios::trunc);
+                    bool sizes_match = true;
+                    for (uint32_t mip_index = 0; mip_index < mip_tail && file && sizes_match; mip_index++)
+                    {
+                        const vector<byte>& bytes = m_slices[0].mips[mip_index].bytes;
+                        sizes_match               = bytes.size() == CalculateMipSize(max(1u, m_width >> mip_index), max(1u, m_height >> mip_index), 1, m_format, m_bits_per_channel, m_channel_count);
+                        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<streamsize>(bytes.size()));
+                    }
+                    is_streamed = file && sizes_match;
+                }
+
+                if (is_streamed)
+                {
+                    m_streamed_file_path = file_path;
+                    m_streamed_mip_tail  = mip_tail;
+                    m_streamed_width     = m_width;
+                    m_streamed_height    = m_height;
+                    m_streamed_mip_count = m_mip_count;
+                    m_streamed_tail.assign(make_move_iterator(m_slices[0].mips.begin() + mip_tail), make_move_iterator(m_slices[0].mips.end()));
+
+                    shared_ptr<RHI_Texture> staged = StageResidentMip(mip_tail);
+                    SP_ASSERT(staged != nullptr);
+                    ApplyResidentMip(staged.get(), mip_tail);
+                    TextureStreaming::Register(this);
+                    m_slices.clear();
+                }
+                else
+                {
+                    SP_LOG_WARNING("Failed to spill the mips of \"%s\" to \"%s\", it won't be streamed", m_object_name.c_str(), file_path.c_str());
+                    FileSystem::Delete(file_path);
+                }
+            }
+
+            if (!is_streamed)
+            {
+                SP_ASSERT(RHI_CreateResource());
+            }
         }
 
         // clear data
@@ -55,7 +55,8 @@ namespace spartan
         RHI_Texture_Compress          = 1U << 11,
         RHI_Texture_ExternalMemory    = 1U << 12,
         RHI_Texture_DontPrepareForGpu = 1U << 13,
-        RHI_Texture_Thumbnail         = 1U << 14
+        RHI_Texture_Thumbnail         = 1U << 14,
+        RHI_Texture_Streamed          = 1U << 15  // only the mips which are needed are on the gpu, see TextureStreaming
     };
 
     struct RHI_Texture_Mip
@@ -128,6 +129,17 @@ namespace spartan
         RHI_Texture_Slice& GetSlice(const uint32_t array_index);
         void AllocateMip();
 
+        // streaming, only the tail mips stay in system memory, the detail mips are spilled to disk and read back when they
+        // become resident, so the width, height and mip count above describe the gpu resource, while these describe the full chain
+        bool IsStreamed() const               { return m_streamed_mip_count != 0; }
+        uint32_t GetStreamedWidth() const     { return m_streamed_width; }
+        uint32_t GetStreamedHeight() const    { return m_streamed_height; }
+        uint32_t GetStreamedMipCount() const  { return m_streamed_mip_count; }
+        uint32_t GetResidentMip() const       { return m_mip_resident; }
+        std::vector<uint64_t> GetStreamedMipSizes() const;
+        std::shared_ptr<RHI_Texture> StageResidentMip(const uint32_t mip) const; // creates a resource with the mips from the given one down, on any thread
+        void ApplyResidentMip(RHI_Texture* staged, const uint32_t mip);           // takes over a staged resource, between frames
+
         // flags
         bool IsSrv() const             { return m_flags & RHI_Texture_Srv; }
         bool IsUav() const             { return m_flags & RHI_Texture_Uav; }
@@ -159,6 +171,7 @@ namespace spartan
         void SetLayout(const RHI_Image_Layout layout, RHI_CommandList* cmd_list, uint32_t mip_index = rhi_all_mips,  uint32_t mip_range = 0);
         RHI_Image_Layout GetLayout(const uint32_t mip) const;
         std::array<RHI_Image_Layout, rhi_max_mip_count> GetLayouts();
+        RHI_ImageLayouts& GetImageLayouts() { return m_layouts; }
 
         // viewport
         const auto& GetViewport() const { return m_viewport; }
@@ -193,9 +206,19 @@ namespace spartan
         std::array<void*, rhi_max_render_target_count> m_rhi_rtv = { nullptr };
         std::array<void*, rhi_max_render_target_count> m_rhi_dsv = { nullptr };
         void* m_rhi_resource                                     = nullptr;
+        RHI_ImageLayouts m_layouts;
         void* m_rhi_external_memory                              = nullptr;
         void* m_mapped_data                                      = nullptr;
 
+        // streaming
+        std::vector<RHI_Texture_Mip> m_streamed_tail; // the mips from m_streamed_mip_tail down
+        std::string m_streamed_file_path;             // the mips above the tail
+        uint32_t m_streamed_mip_tail  = 0;
+        uint32_t m_streamed_width     = 0;
+        uint32_t m_streamed_height    = 0;
+        uint32_t m_streamed_mip_count = 0;
+        uint32_t m_mip_resident       = 0;
+
     private:
         void ComputeMemoryUsage();
     };
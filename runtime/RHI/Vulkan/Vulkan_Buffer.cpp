@@ -55,12 +55,18 @@ namespace spartan
             bool vertex                     = m_type == RHI_Buffer_Type::Vertex || m_type == RHI_Buffer_Type::Instance;
             VkBufferUsageFlags flags_usage  = vertex ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
             flags_usage                    |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT; // AMD FidelityFX Brizelizer GI
+            flags_usage                    |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;   // CopyFrom(), when the geometry pool grows or defragments
 
             if (m_mappable)
             {
                 uint32_t flags_memory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
                 RHI_Device::MemoryBufferCreate(m_rhi_resource, m_object_size, flags_usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, flags_memory, data, m_object_name.c_str());
             }
+            else if (!data)
+            {
+                // no initial data (e.g. a pool that is filled later with Upload()), so there is nothing to stage
+                RHI_Device::MemoryBufferCreate(m_rhi_resource, m_object_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | flags_usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr, m_object_name.c_str());
+            }
             else
             {
                 // create staging buffer, it's slower but we can copy data in and out of it
@@ -120,6 +126,75 @@ namespace spartan
         RHI_Device::SetResourceName(m_rhi_resource, RHI_Resource_Type::Buffer, m_object_name.c_str());
     }
 
+    void RHI_Buffer::Upload(const void* data, const uint64_t offset, const uint64_t size)
+    {
+        Upload({ { this, data, offset, size } });
+    }
+
+    void RHI_Buffer::Upload(const vector<RHI_BufferUpload>& uploads)
+    {
+        // pack everything into a single staging buffer
+        uint64_t size_total = 0;
+        for (const RHI_BufferUpload& upload : uploads)
+        {
+            SP_ASSERT(upload.buffer != nullptr && upload.data != nullptr && upload.size != 0);
+            SP_ASSERT_MSG(upload.offset + upload.size <= upload.buffer->m_object_size, "Out of bounds");
+            SP_ASSERT_MSG(upload.buffer->m_type == RHI_Buffer_Type::Vertex || upload.buffer->m_type == RHI_Buffer_Type::Index, "Only vertex and index buffers are device local");
+            size_total += upload.size;
+        }
+        if (size_total == 0)
+            return;
+
+        void* staging_buffer = nullptr;
+        RHI_Device::MemoryBufferCreate(staging_buffer, size_total, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, nullptr, "staging_upload");
+        uint8_t* staging_data = static_cast<uint8_t*>(RHI_Device::MemoryGetMappedDataFromBuffer(staging_buffer));
+        SP_ASSERT(staging_data != nullptr);
+
+        // then copy each range out of it, all in one submission
+        RHI_CommandList* cmd_list = RHI_Device::CmdImmediateBegin(RHI_Queue_Type::Copy);
+        uint64_t offset_staging   = 0;
+        for (const RHI_BufferUpload& upload : uploads)
+        {
+            memcpy(staging_data + offset_staging, upload.data, upload.size);
+
+            VkBufferCopy copy_region = {};
+            copy_region.srcOffset    = offset_staging;
+            copy_region.dstOffset    = upload.offset;
+            copy_region.size         = upload.size;
+            vkCmdCopyBuffer(static_cast<VkCommandBuffer>(cmd_list->GetRhiResource()), static_cast<VkBuffer>(staging_buffer), static_cast<VkBuffer>(upload.buffer->m_rhi_resource), 1, &copy_region);
+
+            offset_staging += upload.size;
+        }
+        RHI_Device::CmdImmediateSubmit(cmd_list);
+        RHI_Device::MemoryBufferDestroy(staging_buffer);
+    }
+
+    void RHI_Buffer::CopyFrom(RHI_Buffer* source, const vector<RHI_BufferCopyRegion>& regions)
+    {
+        SP_ASSERT(source != nullptr && source != this);
+        if (regions.empty())
+            return;
+
+        vector<VkBufferCopy> copy_regions;
+        copy_regions.reserve(regions.size());
+        for (const RHI_BufferCopyRegion& region : regions)
+        {
+            SP_ASSERT_MSG(region.offset_source + region.size <= source->GetObjectSize(), "Out of bounds");
+            SP_ASSERT_MSG(region.offset_destination + region.size <= m_object_size,      "Out of bounds");
+            copy_regions.push_back({ region.offset_source, region.offset_destination, region.size });
+        }
+
+        RHI_CommandList* cmd_list = RHI_Device::CmdImmediateBegin(RHI_Queue_Type::Copy);
+        vkCmdCopyBuffer(
+            static_cast<VkCommandBuffer>(cmd_list->GetRhiResource()),
+            static_cast<VkBuffer>(source->GetRhiResource()),
+            static_cast<VkBuffer>(m_rhi_resource),
+            static_cast<uint32_t>(copy_regions.size()),
+            copy_regions.data()
+        );
+        RHI_Device::CmdImmediateSubmit(cmd_list);
+    }
+
     void RHI_Buffer::Update(RHI_CommandList* cmd_list, void* data_cpu, const uint32_t size)
     {
         SP_ASSERT(cmd_list);
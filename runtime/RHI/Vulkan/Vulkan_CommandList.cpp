@@ -86,51 +86,6 @@ namespace spartan
 
     namespace image_barrier
     {
-        static unordered_map<void*, array<RHI_Image_Layout, rhi_max_mip_count>> image_layouts;
-        static mutex image_layouts_mutex;
-
-        RHI_Image_Layout get_layout(void* image, uint32_t mip_index)
-        {
-            SP_ASSERT(image != nullptr);
-            lock_guard<mutex> lock(image_layouts_mutex);
-
-            auto it = image_layouts.find(image);
-            if (it == image_layouts.end())
-                return RHI_Image_Layout::Max;
-
-            SP_ASSERT(mip_index < rhi_max_mip_count);
-            return it->second[mip_index];
-        }
-
-       void set_layout(void* image, uint32_t mip_index, uint32_t mip_range, RHI_Image_Layout layout)
-        {
-            SP_ASSERT(image != nullptr);
-            SP_ASSERT(mip_index < rhi_max_mip_count);
-            SP_ASSERT(mip_index + mip_range <= rhi_max_mip_count);
-            lock_guard<mutex> lock(image_layouts_mutex);
-
-            auto it = image_layouts.find(image);
-            if (it == image_layouts.end())
-            {
-                array<RHI_Image_Layout, rhi_max_mip_count> layouts;
-                layouts.fill(RHI_Image_Layout::Max);
-                image_layouts[image] = layouts;
-                it = image_layouts.find(image);
-            }
-
-            uint32_t mip_end = min(mip_index + mip_range, rhi_max_mip_count);
-            for (uint32_t i = mip_index; i < mip_end; ++i)
-            {
-                it->second[i] = layout;
-            }
-        }
-
-        void remove_layout(void* image)
-        {
-            lock_guard<mutex> lock(image_layouts_mutex);
-            image_layouts.erase(image);
-        }
-
         tuple<VkPipelineStageFlags2, VkAccessFlags2> get_layout_sync_info(const VkImageLayout layout, const bool is_destination_mask, const bool is_depth, const RHI_PipelineState& pso)
         {   
             switch (layout)
@@ -361,34 +316,87 @@ namespace spartan
 
         namespace occlusion
         {
-            uint32_t index              = 0;
-            uint32_t index_active       = 0;
-            bool occlusion_query_active = false;
-            const uint32_t query_count  = 4096;
-            array<uint64_t, query_count> data;
-            unordered_map<uint64_t, uint32_t> id_to_index;
+            const uint32_t query_count_min  = 1024;       // pools grow (by doubling) past this
+            const uint64_t result_unknown   = UINT64_MAX; // no query has completed for the slot yet, treated as visible
+            mutex slots_mutex;
+            RHI_QuerySlotAllocator slots;
+            vector<uint64_t> results; // visible sample count, indexed by slot
 
-            void update(void* query_pool)
+            // reads back the queries a command list wrote, it has finished executing so no waiting is involved
+            void readback(void* query_pool, const RHI_QueryRange& written)
             {
+                if (!query_pool || written.IsEmpty())
+                    return;
+
+                lock_guard<mutex> lock(slots_mutex);
+
+                // slots in the range which weren't written are unavailable, without the wait and
+                // partial bits, vulkan leaves their results untouched, which is what we want
+                const uint32_t count = written.GetCount();
+                if (results.size() < written.first + count)
+                {
+                    results.resize(written.first + count, result_unknown);
+                }
                 vkGetQueryPoolResults(
-                    RHI_Context::device,                                 // device
-                    static_cast<VkQueryPool>(query_pool),                // queryPool
-                    0,                                                   // firstQuery
-                    query_count,                                         // queryCount
-                    query_count * sizeof(uint64_t),                      // dataSize
-                    data.data(),                                         // pData
-                    sizeof(uint64_t),                                    // stride
-                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_PARTIAL_BIT // flags
+                    RHI_Context::device,                  // device
+                    static_cast<VkQueryPool>(query_pool), // queryPool
+                    written.first,                        // firstQuery
+                    count,                                // queryCount
+                    count * sizeof(uint64_t),             // dataSize
+                    &results[written.first],              // pData
+                    sizeof(uint64_t),                     // stride
+                    VK_QUERY_RESULT_64_BIT                // flags
                 );
             }
 
-            void reset(void* cmd_list, void*& query_pool)
+            // makes sure the pool can hold every allocated slot, a new pool has to be reset as a whole before first use
+            void ensure_capacity(void*& query_pool, uint32_t& capacity, RHI_QueryRange& written)
             {
-                vkCmdResetQueryPool(static_cast<VkCommandBuffer>(cmd_list), static_cast<VkQueryPool>(query_pool), 0, query_count);
+                uint32_t slot_count = 0;
+                {
+                    lock_guard<mutex> lock(slots_mutex);
+                    slot_count = slots.GetSlotCount();
+                }
+
+                if (query_pool && slot_count <= capacity)
+                    return;
+
+                uint32_t capacity_new = max(capacity, query_count_min);
+                while (capacity_new < slot_count)
+                {
+                    capacity_new *= 2;
+                }
+
+                if (query_pool)
+                {
+                    RHI_Device::DeletionQueueAdd(RHI_Resource_Type::QueryPool, query_pool);
+                }
+
+                VkQueryPoolCreateInfo query_pool_info = {};
+                query_pool_info.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                query_pool_info.queryType             = VK_QUERY_TYPE_OCCLUSION;
+                query_pool_info.queryCount            = capacity_new;
+                SP_ASSERT_VK(vkCreateQueryPool(RHI_Context::device, &query_pool_info, nullptr, reinterpret_cast<VkQueryPool*>(&query_pool)));
+                RHI_Device::SetResourceName(query_pool, RHI_Resource_Type::QueryPool, "query_pool_occlusion");
+
+                // mark the whole pool as written, so that it's reset as a whole
+                capacity      = capacity_new;
+                written.first = 0;
+                written.last  = capacity - 1;
+            }
+
+            // queries need to be reset before they can be used again, only the ones that were written are
+            void reset(void* cmd_list, void* query_pool, RHI_QueryRange& written)
+            {
+                if (!written.IsEmpty())
+                {
+                    vkCmdResetQueryPool(static_cast<VkCommandBuffer>(cmd_list), static_cast<VkQueryPool>(query_pool), written.first, written.GetCount());
+                    written.Clear();
+                }
             }
         }
 
-        void initialize(void*& pool_timestamp, void*& pool_occlusion, void*& pool_pipeline_statistics)
+        void initialize(void*& pool_timestamp, void*& pool_pipeline_statistics)
         {
             // timestamps
             if (Debugging::IsGpuTimingEnabled())
@@ -405,19 +413,7 @@ namespace spartan
                 timestamp::data.fill(0);
             }
 
-            // occlusion
-            {
-                VkQueryPoolCreateInfo query_pool_info = {};
-                query_pool_info.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-                query_pool_info.queryType             = VK_QUERY_TYPE_OCCLUSION;
-                query_pool_info.queryCount            = occlusion::query_count;
-
-                auto query_pool = reinterpret_cast<VkQueryPool*>(&pool_occlusion);
-                SP_ASSERT_VK(vkCreateQueryPool(RHI_Context::device, &query_pool_info, nullptr, query_pool));
-                RHI_Device::SetResourceName(pool_occlusion, RHI_Resource_Type::QueryPool, "query_pool_occlusion");
-
-                occlusion::data.fill(0);
-            }
+            // occlusion pools are created (and grown) on demand, see occlusion::ensure_capacity()
         }
 
         void shutdown(void*& pool_timestamp, void*& pool_occlusion, void*& pool_pipeline_statistics)
@@ -453,7 +449,7 @@ namespace spartan
         m_rendering_complete_semaphore          = make_shared<RHI_SyncPrimitive>(RHI_SyncPrimitive_Type::Semaphore, (string(name) + "_binary").c_str());
         m_rendering_complete_semaphore_timeline = make_shared<RHI_SyncPrimitive>(RHI_SyncPrimitive_Type::SemaphoreTimeline, (string(name) + "timeline").c_str());
 
-        queries::initialize(m_rhi_query_pool_timestamps, m_rhi_query_pool_occlusion, m_rhi_query_pool_pipeline_statistics);
+        queries::initialize(m_rhi_query_pool_timestamps, m_rhi_query_pool_pipeline_statistics);
     }
 
     RHI_CommandList::~RHI_CommandList()
@@ -508,7 +504,15 @@ namespace spartan
             // also need to be reset after every use, so we just reset them always
             m_timestamp_index = 0;
             queries::timestamp::reset(m_rhi_resource, m_rhi_query_pool_timestamps);
-            queries::occlusion::reset(m_rhi_resource, m_rhi_query_pool_occlusion);
+        }
+
+        // occlusion queries, only the range written by the previous execution is read back and reset
+        if (m_queue->GetType() == RHI_Queue_Type::Graphics)
+        {
+            queries::occlusion::readback(m_rhi_query_pool_occlusion, m_occlusion_queries_written);
+            queries::occlusion::ensure_capacity(m_rhi_query_pool_occlusion, m_occlusion_query_capacity, m_occlusion_queries_written);
+            queries::occlusion::reset(m_rhi_resource, m_rhi_query_pool_occlusion, m_occlusion_queries_written);
+            m_occlusion_query_active = RHI_QuerySlotAllocator::invalid_slot;
         }
     }
 
@@ -602,8 +606,9 @@ namespace spartan
                 SetScissorRectangle(scissor_rect);
 
                 // vertex and index buffer state
-                m_buffer_id_index  = 0;
-                m_buffer_id_vertex = 0;
+                m_buffer_id_index    = 0;
+                m_buffer_id_vertex   = 0;
+                m_buffer_id_instance = 0;
             }
 
             if (Debugging::IsBreadcrumbsEnabled())
@@ -648,7 +653,7 @@ namespace spartan
             if (swapchain)
             {
                 // transition to the appropriate layout
-                InsertBarrier(swapchain->GetRhiRt(), swapchain->GetFormat(), 0, 1, 1, RHI_Image_Layout::Attachment);
+                InsertBarrier(swapchain, RHI_Image_Layout::Attachment);
     
                 VkRenderingAttachmentInfo color_attachment = {};
                 color_attachment.sType                     = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
@@ -1065,7 +1070,7 @@ namespace spartan
 
         // transition to blit appropriate layouts
         source->SetLayout(RHI_Image_Layout::Transfer_Source,           this);
-        InsertBarrier(destination->GetRhiRt(), destination->GetFormat(), 0, 1, 1, RHI_Image_Layout::Transfer_Destination);
+        InsertBarrier(destination, RHI_Image_Layout::Transfer_Destination);
 
         // deduce filter
         bool width_equal  = source->GetWidth() == destination->GetWidth();
@@ -1083,7 +1088,7 @@ namespace spartan
 
         // transition to the initial layouts
         source->SetLayout(source_layout_initial, this);
-        InsertBarrier(destination->GetRhiRt(), destination->GetFormat(), 0, 1, 1, RHI_Image_Layout::Present_Source);
+        InsertBarrier(destination, RHI_Image_Layout::Present_Source);
     }
 
     void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination, const bool blit_mips)
@@ -1167,7 +1172,7 @@ namespace spartan
         // transition to blit appropriate layouts
         RHI_Image_Layout layout_initial_source = source->GetLayout(0);
         source->SetLayout(RHI_Image_Layout::Transfer_Source, this);
-        InsertBarrier(destination->GetRhiRt(), destination->GetFormat(), 0, 1, 1, RHI_Image_Layout::Transfer_Destination);
+        InsertBarrier(destination, RHI_Image_Layout::Transfer_Destination);
 
         // blit
         vkCmdCopyImage(
@@ -1179,7 +1184,7 @@ namespace spartan
 
         // transition to the initial layout
         source->SetLayout(layout_initial_source, this);
-        InsertBarrier(destination->GetRhiRt(), destination->GetFormat(), 0, 1, 1, RHI_Image_Layout::Present_Source);
+        InsertBarrier(destination, RHI_Image_Layout::Present_Source);
     }
 
     void RHI_CommandList::SetViewport(const RHI_Viewport& viewport) const
@@ -1255,8 +1260,9 @@ namespace spartan
 
         VkDeviceSize offsets[2] = { 0, 0 };
     
-        // check if vertex buffer id has changed to trigger binding
-        if (m_buffer_id_vertex != vertex->GetObjectId())
+        // check if either buffer id has changed to trigger binding, meshes share the same vertex buffer
+        // (the geometry pool) so a different instance buffer alone has to rebind too
+        if (m_buffer_id_vertex != vertex->GetObjectId() || m_buffer_id_instance != instance->GetObjectId())
         {
             vkCmdBindVertexBuffers(
                 static_cast<VkCommandBuffer>(m_rhi_resource), // commandbuffer
@@ -1266,8 +1272,9 @@ namespace spartan
                 offsets                                       // poffsets
             );
     
-            // update cached vertex buffer id
-            m_buffer_id_vertex = vertex->GetObjectId();
+            // update cached buffer ids
+            m_buffer_id_vertex   = vertex->GetObjectId();
+            m_buffer_id_instance = instance->GetObjectId();
             Profiler::m_rhi_bindings_buffer_vertex++;
         }
     }
@@ -1513,17 +1520,43 @@ namespace spartan
         return clamp(duration_ms, 0.0f, numeric_limits<float>::max());
     }
 
-    void RHI_CommandList::BeginOcclusionQuery(const uint64_t entity_id)
+    uint32_t RHI_CommandList::AllocateOcclusionQuery()
     {
-        SP_ASSERT_MSG(m_pso.IsGraphics(), "Occlusion queries are only supported in graphics pipelines");
+        lock_guard<mutex> lock(queries::occlusion::slots_mutex);
 
-        queries::occlusion::index_active = queries::occlusion::id_to_index[entity_id];
-        if (queries::occlusion::index_active == 0)
+        const uint32_t slot = queries::occlusion::slots.Allocate();
+        if (slot < queries::occlusion::results.size())
         {
-            queries::occlusion::index_active           = ++queries::occlusion::index;
-            queries::occlusion::id_to_index[entity_id] = queries::occlusion::index;
+            queries::occlusion::results[slot] = queries::occlusion::result_unknown; // don't inherit the previous owner's result
         }
 
+        return slot;
+    }
+
+    void RHI_CommandList::FreeOcclusionQuery(const uint32_t slot)
+    {
+        lock_guard<mutex> lock(queries::occlusion::slots_mutex);
+        queries::occlusion::slots.Free(slot);
+    }
+
+    bool RHI_CommandList::GetOcclusionQueryResult(const uint32_t slot)
+    {
+        lock_guard<mutex> lock(queries::occlusion::slots_mutex);
+
+        if (slot >= queries::occlusion::results.size())
+            return false;
+
+        return queries::occlusion::results[slot] == 0; // visible sample count
+    }
+
+    void RHI_CommandList::BeginOcclusionQuery(const uint32_t slot)
+    {
+        SP_ASSERT_MSG(m_pso.IsGraphics(), "Occlusion queries are only supported in graphics pipelines");
+
+        // slots allocated after this command list began don't fit yet, the pool grows the next time it begins
+        if (slot >= m_occlusion_query_capacity)
+            return;
+
         if (!m_render_pass_active)
         {
             RenderPassBegin();
@@ -1532,41 +1565,26 @@ namespace spartan
         vkCmdBeginQuery(
             static_cast<VkCommandBuffer>(m_rhi_resource),
             static_cast<VkQueryPool>(m_rhi_query_pool_occlusion),
-            queries::occlusion::index_active,
+            slot,
             0
         );
 
-        queries::occlusion::occlusion_query_active = true;
+        m_occlusion_query_active = slot;
+        m_occlusion_queries_written.Add(slot);
     }
 
     void RHI_CommandList::EndOcclusionQuery()
     {
-        if (!queries::occlusion::occlusion_query_active)
+        if (m_occlusion_query_active == RHI_QuerySlotAllocator::invalid_slot)
             return;
 
         vkCmdEndQuery(
             static_cast<VkCommandBuffer>(m_rhi_resource),
             static_cast<VkQueryPool>(m_rhi_query_pool_occlusion),
-            queries::occlusion::index_active
+            m_occlusion_query_active
         );
 
-        queries::occlusion::occlusion_query_active = false;
-    }
-
-    bool RHI_CommandList::GetOcclusionQueryResult(const uint64_t entity_id)
-    {
-        if (queries::occlusion::id_to_index.find(entity_id) == queries::occlusion::id_to_index.end())
-            return false;
-
-        uint32_t index  = queries::occlusion::id_to_index[entity_id];
-        uint64_t result = queries::occlusion::data[index]; // visible pixel count
-
-        return result == 0;
-    }
-
-    void RHI_CommandList::UpdateOcclusionQueries()
-    {
-        queries::occlusion::update(m_rhi_query_pool_occlusion);
+        m_occlusion_query_active = RHI_QuerySlotAllocator::invalid_slot;
     }
 
     void RHI_CommandList::BeginTimeblock(const char* name, const bool gpu_marker, const bool gpu_timing)
@@ -1574,6 +1592,7 @@ namespace spartan
         SP_ASSERT(name != nullptr);
     
         // timing
+        Trace::Begin(name);
         Profiler::TimeBlockStart(name, TimeBlockType::Cpu, this);
         if (Debugging::IsGpuTimingEnabled() && gpu_timing)
         {
@@ -1608,6 +1627,7 @@ namespace spartan
             Profiler::TimeBlockEnd(); // gpu
         }
         Profiler::TimeBlockEnd(); // cpu
+        Trace::End();
     
         // pop the active time block
         m_active_timeblocks.pop();
@@ -1711,8 +1731,21 @@ namespace spartan
         }
     }
 
+    void RHI_CommandList::InsertBarrier(RHI_Texture* texture, const uint32_t mip_index, const uint32_t mip_range, const uint32_t array_length, const RHI_Image_Layout layout_new)
+    {
+        SP_ASSERT(texture != nullptr);
+        InsertBarrier(texture->GetRhiResource(), texture->GetImageLayouts(), texture->GetFormat(), mip_index, mip_range, array_length, layout_new);
+    }
+
+    void RHI_CommandList::InsertBarrier(RHI_SwapChain* swapchain, const RHI_Image_Layout layout_new)
+    {
+        SP_ASSERT(swapchain != nullptr);
+        InsertBarrier(swapchain->GetRhiRt(), swapchain->GetImageLayouts(), swapchain->GetFormat(), 0, 1, 1, layout_new);
+    }
+
     void RHI_CommandList::InsertBarrier(
         void* image,
+        RHI_ImageLayouts& layouts,
         const RHI_Format format,
         const uint32_t mip_index,
         const uint32_t mip_range,
@@ -1728,58 +1761,55 @@ namespace spartan
         bool is_depth        = format == RHI_Format::D16_Unorm || format == RHI_Format::D32_Float || format == RHI_Format::D32_Float_S8X24_Uint;
         uint32_t aspect_mask = get_aspect_mask(format);
     
-        // get layouts for all mips in the range
-        vector<RHI_Image_Layout> layouts(mip_range);
+        // get layouts for all mips in the range, they live in the image so no lookup or locking is involved
+        array<RHI_Image_Layout, rhi_max_mip_count> layouts_old;
         bool all_mips_same_layout     = true;
-        RHI_Image_Layout first_layout = image_barrier::get_layout(image, mip_index);
+        bool all_mips_match           = true;
+        RHI_Image_Layout first_layout = layouts.Get(mip_index);
         for (uint32_t i = 0; i < mip_range; i++)
         {
-            layouts[i] = image_barrier::get_layout(image, mip_index + i);
-            if (layouts[i] != first_layout)
+            layouts_old[i] = layouts.Get(mip_index + i);
+            if (layouts_old[i] != first_layout)
             {
                 all_mips_same_layout = false;
             }
-            if (layouts[i] == layout_new)
+            if (layouts_old[i] == layout_new)
             {
                 all_mips_same_layout = false;
             }
-        }
-    
-        // early exit if all mips match target layout
-        bool all_mips_match = true;
-        for (const auto& layout : layouts)
-        {
-            if (layout != layout_new)
+            else
             {
                 all_mips_match = false;
-                break;
             }
         }
+    
+        // early exit if all mips match target layout
         if (all_mips_match)
             return;
     
         // single barrier if all mips have the same layout
-        vector<VkImageMemoryBarrier2> barriers;
+        array<VkImageMemoryBarrier2, rhi_max_mip_count> barriers;
+        uint32_t barrier_count = 0;
         if (all_mips_same_layout)
         {
-            barriers.push_back(image_barrier::create(
+            barriers[barrier_count++] = image_barrier::create(
                 first_layout, layout_new, image, aspect_mask, mip_index, mip_range, array_length, is_depth, m_pso
-            ));
+            );
         }
         else
         {
             // separate barriers for differing layouts
             for (uint32_t i = 0; i < mip_range; i++)
             {
-                if (layouts[i] != layout_new)
+                if (layouts_old[i] != layout_new)
                 {
-                    barriers.push_back(image_barrier::create(
-                        layouts[i], layout_new, image, aspect_mask, mip_index + i, 1, array_length, is_depth, m_pso
-                    ));
+                    barriers[barrier_count++] = image_barrier::create(
+                        layouts_old[i], layout_new, image, aspect_mask, mip_index + i, 1, array_length, is_depth, m_pso
+                    );
                 }
             }
-        }   
-        if (barriers.empty())
+        }
+        if (barrier_count == 0)
             return;
     
         // defer barriers and group into one (if eligible)
@@ -1793,25 +1823,39 @@ namespace spartan
     
             if (!immediate_barrier)
             {
-                for (const auto& barrier : barriers)
+                for (uint32_t i = 0; i < barrier_count; i++)
                 {
-                    RHI_Image_Layout old_layout = layouts[barrier.subresourceRange.baseMipLevel - mip_index];
-                    m_image_barriers.emplace_back(image, aspect_mask, barrier.subresourceRange.baseMipLevel, barrier.subresourceRange.levelCount,array_length, old_layout, layout_new, is_depth);
+                    // the group has a fixed capacity, flush it when full
+                    if (m_image_barrier_count == rhi_max_barrier_count)
+                    {
+                        InsertPendingBarrierGroup();
+                    }
+
+                    const VkImageMemoryBarrier2& barrier = barriers[i];
+                    ImageBarrierInfo& info               = m_image_barriers[m_image_barrier_count++];
+                    info.image                           = image;
+                    info.aspect_mask                     = aspect_mask;
+                    info.mip_index                       = barrier.subresourceRange.baseMipLevel;
+                    info.mip_range                       = barrier.subresourceRange.levelCount;
+                    info.array_length                    = array_length;
+                    info.layout_old                      = layouts_old[barrier.subresourceRange.baseMipLevel - mip_index];
+                    info.layout_new                      = layout_new;
+                    info.is_depth                        = is_depth;
                 }
-                image_barrier::set_layout(image, mip_index, mip_range, layout_new);
+                layouts.Set(mip_index, mip_range, layout_new);
                 return;
             }
         }
     
         VkDependencyInfo dependency_info        = {};
         dependency_info.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
-        dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+        dependency_info.imageMemoryBarrierCount = barrier_count;
         dependency_info.pImageMemoryBarriers    = barriers.data();
     
         RenderPassEnd();
         vkCmdPipelineBarrier2(static_cast<VkCommandBuffer>(m_rhi_resource), &dependency_info);
         Profiler::m_rhi_pipeline_barriers++;
-        image_barrier::set_layout(image, mip_index, mip_range, layout_new);
+        layouts.Set(mip_index, mip_range, layout_new);
     }
 
     void RHI_CommandList::InsertBarrierReadWrite(RHI_Texture* texture)
@@ -1837,7 +1881,7 @@ namespace spartan
         { 
             for (uint32_t mip = 0; mip < texture->GetMipCount(); ++mip)
             {
-                RHI_Image_Layout layout = image_barrier::get_layout(texture->GetRhiResource(), mip);
+                RHI_Image_Layout layout = texture->GetLayout(mip);
 
                 barrier.oldLayout                     = vulkan_image_layout[static_cast<uint32_t>(layout)];
                 barrier.newLayout                     = vulkan_image_layout[static_cast<uint32_t>(layout)];
@@ -1852,7 +1896,7 @@ namespace spartan
         }
         else
         {
-            RHI_Image_Layout layout = image_barrier::get_layout(texture->GetRhiResource(), 0);
+            RHI_Image_Layout layout = texture->GetLayout(0);
 
             barrier.oldLayout                     = vulkan_image_layout[static_cast<uint32_t>(layout)];
             barrier.newLayout                     = vulkan_image_layout[static_cast<uint32_t>(layout)];
@@ -1892,10 +1936,10 @@ namespace spartan
 
     void RHI_CommandList::InsertPendingBarrierGroup()
     {
-        if (!m_image_barriers.empty())
+        if (m_image_barrier_count != 0)
         {
-            array<VkImageMemoryBarrier2, 32> vk_barriers;
-            for (uint32_t i = 0; i < static_cast<uint32_t>(m_image_barriers.size()); i++)
+            array<VkImageMemoryBarrier2, rhi_max_barrier_count> vk_barriers;
+            for (uint32_t i = 0; i < m_image_barrier_count; i++)
             {
                 const ImageBarrierInfo& barrier = m_image_barriers[i];
 
@@ -1914,26 +1958,16 @@ namespace spartan
 
             VkDependencyInfo dependency_info        = {};
             dependency_info.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
-            dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(m_image_barriers.size());
+            dependency_info.imageMemoryBarrierCount = m_image_barrier_count;
             dependency_info.pImageMemoryBarriers    = vk_barriers.data();
 
             RenderPassEnd();
             vkCmdPipelineBarrier2(static_cast<VkCommandBuffer>(m_rhi_resource), &dependency_info);
             Profiler::m_rhi_pipeline_barriers++;
-            m_image_barriers.clear();
+            m_image_barrier_count = 0;
         }
     }
 
-    void RHI_CommandList::RemoveLayout(void* image)
-    {
-        image_barrier::remove_layout(image);
-    }
-
-    RHI_Image_Layout RHI_CommandList::GetImageLayout(void* image, const uint32_t mip_index)
-    {
-        return image_barrier::get_layout(image, mip_index);
-    }
-
     void RHI_CommandList::PreDraw()
     {
         InsertPendingBarrierGroup();
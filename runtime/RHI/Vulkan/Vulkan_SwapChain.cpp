@@ -383,6 +383,9 @@ namespace spartan
         // create new image views
         for (uint32_t i = 0; i < m_buffer_count; i++)
         {
+            // the images are new, so their layout is unknown
+            m_layouts[i].Reset();
+
             // delete old one, if it exists
             if (m_rhi_rtv[i])
             { 
@@ -234,7 +234,7 @@ namespace spartan
                 RHI_Image_Layout layout = RHI_Image_Layout::Transfer_Destination;
 
                 // insert memory barrier
-                cmd_list->InsertBarrier(texture->GetRhiResource(), texture->GetFormat(), 0, texture->GetMipCount(), texture->GetDepth(), layout);
+                cmd_list->InsertBarrier(texture, 0, texture->GetMipCount(), texture->GetDepth(), layout);
 
                 // copy the staging buffer to the image
                 vkCmdCopyBufferToImage(
@@ -292,8 +292,7 @@ namespace spartan
         {
             uint32_t array_length = m_type == RHI_Texture_Type::Type3D ? 1 : m_depth;
             cmd_list->InsertBarrier(
-                m_rhi_resource,
-                m_format,
+                this,
                 0,            // mip start
                 m_mip_count,  // mip count
                 array_length, // array length
@@ -384,7 +383,7 @@ namespace spartan
         }
 
         // rhi resource
-        RHI_CommandList::RemoveLayout(m_rhi_resource);
+        m_layouts.Reset();
         RHI_Device::DeletionQueueAdd(RHI_Resource_Type::Image, m_rhi_resource);
         m_rhi_resource = nullptr;
     }
@@ -679,7 +679,7 @@ namespace spartan
 
             // instances
             unordered_set<uint64_t> static_instances;
-            vector<pair<const RHI_Buffer*, uint32_t>> instance_buffers;
+            vector<pair<uint64_t, uint32_t>> instance_buffers; // keyed by object id, the geometry pool can re-create its buffers at a recycled address
             unordered_map<uint64_t, shared_ptr<Entity>> entity_map;
             vector<FfxBrixelizerInstanceDescription> instances_to_create;
             vector<uint32_t> instances_to_delete;
@@ -724,7 +724,7 @@ namespace spartan
                 {
                     auto it = find_if(instance_buffers.begin(), instance_buffers.end(), [buffer](const auto& pair)
                     {
-                        return pair.first == buffer;
+                        return pair.first == buffer->GetObjectId();
                     });
 
                     if (it != instance_buffers.end())
@@ -740,7 +740,7 @@ namespace spartan
                     buffer_desc.outIndex                       = &index;
                     SP_ASSERT(ffxBrixelizerRegisterBuffers(&context, &buffer_desc, 1) == FFX_OK);
 
-                    instance_buffers.emplace_back(buffer, index);
+                    instance_buffers.emplace_back(buffer->GetObjectId(), index);
 
                     return index;
                 }
@@ -1293,7 +1293,7 @@ namespace spartan
     {
     #ifdef _WIN32
         // output is displayed in the viewport, so add a barrier to ensure any work is done before writing to it
-        cmd_list->InsertBarrier(tex_output->GetRhiResource(), tex_output->GetFormat(), 0, 1, 1, tex_output->GetLayout(0));
+        cmd_list->InsertBarrier(tex_output, 0, 1, 1, tex_output->GetLayout(0));
         cmd_list->InsertPendingBarrierGroup();
 
         // upscale
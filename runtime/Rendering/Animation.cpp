@@ -19,29 +19,705 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========
+//= INCLUDES ============
 #include "pch.h"
 #include "Animation.h"
-//====================
+#include "../IO/FileStream.h"
+//=======================
 
-//= NAMESPACES =====
+//= NAMESPACES ===============
 using namespace std;
-//==================
+using namespace spartan::math;
+//============================
 
 namespace spartan
 {
+    namespace
+    {
+        const uint32_t track_position = 0;
+        const uint32_t track_rotation = 1;
+        const uint32_t track_scale    = 2;
+        const uint32_t track_count    = 3;
+
+        const float time_max       = 65535.0f;
+        const float value_max      = 65535.0f;
+        const float rotation_max   = 32767.0f;    // 15 bits, the lowest bit of the first two values holds the index of the dropped component
+        const float rotation_range = 0.70710678f; // the three smallest components of a unit quaternion lie within [-1/sqrt(2), 1/sqrt(2)]
+        const uint32_t file_version = 1;
+
+        uint16_t quantize_time(const double time, const double duration)
+        {
+            const double normalized = duration > 0.0 ? clamp(time / duration, 0.0, 1.0) : 0.0;
+            return static_cast<uint16_t>(lround(normalized * time_max));
+        }
+
+        void encode_vector(const Vector3& value, const AnimationTrack& track, uint16_t* out)
+        {
+            const float values[3] = { value.x, value.y, value.z };
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const float normalized = track.extent[c] > 0.0f ? clamp((values[c] - track.min[c]) / track.extent[c], 0.0f, 1.0f) : 0.0f;
+                out[c]                 = static_cast<uint16_t>(lround(normalized * value_max));
+            }
+        }
+
+        Vector3 decode_vector(const uint16_t* in, const AnimationTrack& track)
+        {
+            return Vector3
+            (
+                track.min[0] + (in[0] / value_max) * track.extent[0],
+                track.min[1] + (in[1] / value_max) * track.extent[1],
+                track.min[2] + (in[2] / value_max) * track.extent[2]
+            );
+        }
+
+        // smallest three, the largest component is dropped and rebuilt from the unit length
+        void encode_rotation(const Quaternion& rotation, uint16_t* out)
+        {
+            const Quaternion q      = rotation.Normalized();
+            const float values[4]   = { q.x, q.y, q.z, q.w };
+            uint32_t largest        = 0;
+            for (uint32_t c = 1; c < 4; c++)
+            {
+                largest = fabs(values[c]) > fabs(values[largest]) ? c : largest;
+            }
+
+            // q and -q are the same rotation, so flip it to make the dropped component positive
+            const float sign = values[largest] < 0.0f ? -1.0f : 1.0f;
+            uint32_t index   = 0;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                if (c == largest)
+                    continue;
+
+                const float normalized = clamp(values[c] * sign / rotation_range, -1.0f, 1.0f) * 0.5f + 0.5f;
+                out[index++]           = static_cast<uint16_t>(lround(normalized * rotation_max) << 1);
+            }
+
+            out[0] |= largest & 1;
+            out[1] |= (largest >> 1) & 1;
+        }
+
+        Quaternion decode_rotation(const uint16_t* in)
+        {
+            const uint32_t largest = (in[0] & 1) | ((in[1] & 1) << 1);
+            float values[4]        = {};
+            float length_squared   = 0.0f;
+            uint32_t index         = 0;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                if (c == largest)
+                    continue;
+
+                values[c]       = ((in[index++] >> 1) / rotation_max * 2.0f - 1.0f) * rotation_range;
+                length_squared += values[c] * values[c];
+            }
+            values[largest] = sqrt(max(0.0f, 1.0f - length_squared));
+
+            return Quaternion(values[0], values[1], values[2], values[3]);
+        }
+
+        // finds the keys around a time (normalized) and the interpolation factor between them
+        void find_keys(const uint16_t* times, const uint32_t count, const float time_normalized, uint32_t* key_a, uint32_t* key_b, float* t)
+        {
+            const float time   = time_normalized * time_max;
+            const uint16_t* it = upper_bound(times, times + count, time, [](const float value, const uint16_t key) { return value < static_cast<float>(key); });
+            const uint32_t next = static_cast<uint32_t>(it - times);
+
+            if (next == 0 || next >= count)
+            {
+                *key_a = *key_b = next == 0 ? 0 : count - 1;
+                *t     = 0.0f;
+                return;
+            }
+
+            *key_a = next - 1;
+            *key_b = next;
+            *t     = (time - times[next - 1]) / static_cast<float>(times[next] - times[next - 1]);
+        }
+
+        Vector3 interpolate(const Vector3& a, const Vector3& b, const float t)            { return a + (b - a) * t; }
+        Quaternion interpolate(const Quaternion& a, const Quaternion& b, const float t)   { return Quaternion::Lerp(a, b, t); }
+        float key_error(const Vector3& a, const Vector3& b)                               { return (a - b).Length(); }
+
+        // the angle between two rotations, from the chord instead of the dot product, since acos is too imprecise near 1 for small tolerances
+        float key_error(const Quaternion& a, const Quaternion& b)
+        {
+            const Quaternion qa  = a.Normalized();
+            const Quaternion qb  = b.Normalized();
+            const float sign     = Quaternion::Dot(qa, qb) < 0.0f ? -1.0f : 1.0f;
+            const float dx       = qa.x - qb.x * sign;
+            const float dy       = qa.y - qb.y * sign;
+            const float dz       = qa.z - qb.z * sign;
+            const float dw       = qa.w - qb.w * sign;
+            const float chord    = sqrt(dx * dx + dy * dy + dz * dz + dw * dw);
+            return 4.0f * asin(min(chord * 0.5f, 1.0f));
+        }
+
+        // drops every key which interpolating its neighbours reproduces within the tolerance
+        template <typename Key>
+        vector<uint32_t> reduce_keys(const vector<Key>& keys, const float tolerance)
+        {
+            vector<uint32_t> kept;
+            if (keys.empty())
+                return kept;
+
+            kept.push_back(0);
+            uint32_t anchor = 0;
+            for (uint32_t end = 2; end < static_cast<uint32_t>(keys.size()); end++)
+            {
+                const double span = keys[end].time - keys[anchor].time;
+                bool fits         = true;
+                for (uint32_t k = anchor + 1; k < end && fits; k++)
+                {
+                    const float t = span > 0.0 ? static_cast<float>((keys[k].time - keys[anchor].time) / span) : 0.0f;
+                    fits          = key_error(interpolate(keys[anchor].value, keys[end].value, t), keys[k].value) <= tolerance;
+                }
+
+                if (!fits)
+                {
+                    anchor = end - 1;
+                    kept.push_back(anchor);
+                }
+            }
+
+            if (keys.size() > 1)
+            {
+                kept.push_back(static_cast<uint32_t>(keys.size()) - 1);
+            }
+
+            // a track which holds still only needs one key
+            if (kept.size() == 2 && key_error(keys[kept[0]].value, keys[kept[1]].value) <= tolerance)
+            {
+                kept.pop_back();
+            }
+
+            return kept;
+        }
+
+        // interpolates 8 bones at once (or one, without avx2), every property has its own factors
+        template <bool per_bone>
+        void lerp_bones(const AnimationPose& a, const AnimationPose& b, const float* t_position, const float* t_rotation, const float* t_scale, const float weight, AnimationPose& out)
+        {
+            const uint32_t count = a.GetPaddedCount();
+            uint32_t i           = 0;
+
+            #if defined(__AVX2__)
+            const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+            const __m256 weight_v  = _mm256_set1_ps(weight);
+            for (; i + AnimationPose::lane_count <= count; i += AnimationPose::lane_count)
+            {
+                const __m256 tp = per_bone ? _mm256_loadu_ps(t_position + i) : weight_v;
+                const __m256 tr = per_bone ? _mm256_loadu_ps(t_rotation + i) : weight_v;
+                const __m256 ts = per_bone ? _mm256_loadu_ps(t_scale + i)    : weight_v;
+
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    const __m256 pa = _mm256_loadu_ps(&a.position[c][i]);
+                    const __m256 pb = _mm256_loadu_ps(&b.position[c][i]);
+                    _mm256_storeu_ps(&out.position[c][i], _mm256_fmadd_ps(_mm256_sub_ps(pb, pa), tp, pa));
+
+                    const __m256 sa = _mm256_loadu_ps(&a.scale[c][i]);
+                    const __m256 sb = _mm256_loadu_ps(&b.scale[c][i]);
+                    _mm256_storeu_ps(&out.scale[c][i], _mm256_fmadd_ps(_mm256_sub_ps(sb, sa), ts, sa));
+                }
+
+                // shortest path, b is negated where the quaternions point away from each other
+                __m256 ra[4];
+                __m256 rb[4];
+                __m256 dot = _mm256_setzero_ps();
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    ra[c] = _mm256_loadu_ps(&a.rotation[c][i]);
+                    rb[c] = _mm256_loadu_ps(&b.rotation[c][i]);
+                    dot   = _mm256_fmadd_ps(ra[c], rb[c], dot);
+                }
+                const __m256 sign = _mm256_and_ps(dot, sign_mask);
+
+                __m256 r[4];
+                __m256 length_squared = _mm256_setzero_ps();
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    const __m256 b_signed = _mm256_xor_ps(rb[c], sign);
+                    r[c]                  = _mm256_fmadd_ps(_mm256_sub_ps(b_signed, ra[c]), tr, ra[c]);
+                    length_squared        = _mm256_fmadd_ps(r[c], r[c], length_squared);
+                }
+
+                const __m256 length_inverse = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(length_squared));
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    _mm256_storeu_ps(&out.rotation[c][i], _mm256_mul_ps(r[c], length_inverse));
+                }
+            }
+            #endif
+
+            for (; i < count; i++)
+            {
+                const float tp = per_bone ? t_position[i] : weight;
+                const float tr = per_bone ? t_rotation[i] : weight;
+                const float ts = per_bone ? t_scale[i]    : weight;
+
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    out.position[c][i] = a.position[c][i] + (b.position[c][i] - a.position[c][i]) * tp;
+                    out.scale[c][i]    = a.scale[c][i]    + (b.scale[c][i]    - a.scale[c][i])    * ts;
+                }
+
+                float dot = 0.0f;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    dot += a.rotation[c][i] * b.rotation[c][i];
+                }
+                const float sign = dot < 0.0f ? -1.0f : 1.0f;
+
+                float r[4];
+                float length_squared = 0.0f;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    r[c]            = a.rotation[c][i] + (b.rotation[c][i] * sign - a.rotation[c][i]) * tr;
+                    length_squared += r[c] * r[c];
+                }
+
+                const float length_inverse = 1.0f / sqrt(length_squared);
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    out.rotation[c][i] = r[c] * length_inverse;
+                }
+            }
+        }
+
+        void set_bone(AnimationPose& pose, const uint32_t bone, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+        {
+            pose.position[0][bone] = position.x;
+            pose.position[1][bone] = position.y;
+            pose.position[2][bone] = position.z;
+            pose.rotation[0][bone] = rotation.x;
+            pose.rotation[1][bone] = rotation.y;
+            pose.rotation[2][bone] = rotation.z;
+            pose.rotation[3][bone] = rotation.w;
+            pose.scale[0][bone]    = scale.x;
+            pose.scale[1][bone]    = scale.y;
+            pose.scale[2][bone]    = scale.z;
+        }
+    }
+
+    uint32_t Skeleton::AddBone(const string& name, const int32_t parent, const Matrix& inverse_bind_, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+    {
+        SP_ASSERT(parent < static_cast<int32_t>(names.size()));
+
+        names.push_back(name);
+        parents.push_back(parent);
+        inverse_bind.push_back(inverse_bind_);
+        bind_position.push_back(position);
+        bind_rotation.push_back(rotation);
+        bind_scale.push_back(scale);
+
+        return static_cast<uint32_t>(names.size()) - 1;
+    }
+
+    int32_t Skeleton::GetBoneIndex(const string& name) const
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(names.size()); i++)
+        {
+            if (names[i] == name)
+                return static_cast<int32_t>(i);
+        }
+
+        return -1;
+    }
+
+    void SkinWeights::Add(const uint32_t bone, const float weight)
+    {
+        // keep the strongest influences, replacing the weakest one once all slots are taken
+        uint32_t weakest = 0;
+        for (uint32_t i = 1; i < bone_count; i++)
+        {
+            weakest = weights[i] < weights[weakest] ? i : weakest;
+        }
+
+        if (weight > weights[weakest])
+        {
+            bones[weakest]   = bone;
+            weights[weakest] = weight;
+        }
+    }
+
+    void SkinWeights::Normalize()
+    {
+        const float sum = weights[0] + weights[1] + weights[2] + weights[3];
+        if (sum <= 0.0f)
+            return;
+
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            weights[i] /= sum;
+        }
+    }
+
+    void AnimationPose::Resize(const uint32_t bone_count_)
+    {
+        if (bone_count == bone_count_ && !position[0].empty())
+            return;
+
+        // the padding holds identity transforms, so that it stays well defined through any operation
+        bone_count           = bone_count_;
+        const uint32_t count = max(((bone_count + lane_count - 1) / lane_count) * lane_count, lane_count);
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            position[c].assign(count, 0.0f);
+            scale[c].assign(count, 1.0f);
+        }
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            rotation[c].assign(count, c == 3 ? 1.0f : 0.0f);
+        }
+    }
+
     Animation::Animation(): IResource(ResourceType::Animation)
     {
 
     }
 
-    void Animation::LoadFromFile(const string& filePath)
+    void Animation::LoadFromFile(const string& file_path)
+    {
+        FileStream stream(file_path, FileStream_Read);
+        if (!stream.IsOpen())
+            return;
+
+        if (stream.ReadAs<uint32_t>() != file_version)
+        {
+            SP_LOG_ERROR("\"%s\" was saved with an incompatible version", file_path.c_str());
+            return;
+        }
+
+        stream.Read(&m_duration);
+        stream.Read(&m_ticks_per_sec);
+
+        // skeleton
+        m_skeleton                 = make_shared<Skeleton>();
+        const uint32_t bone_count  = stream.ReadAs<uint32_t>();
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            const string name = stream.ReadAs<string>();
+            const int parent  = stream.ReadAs<int>();
+            float m[16];
+            for (uint32_t j = 0; j < 16; j++)
+            {
+                stream.Read(&m[j]);
+            }
+            const Matrix inverse_bind(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+            Vector3 position;
+            Quaternion rotation;
+            Vector3 scale;
+            stream.Read(&position);
+            stream.Read(&rotation);
+            stream.Read(&scale);
+            m_skeleton->AddBone(name, parent, inverse_bind, position, rotation, scale);
+        }
+
+        // tracks
+        m_tracks.resize(stream.ReadAs<uint32_t>());
+        for (AnimationTrack& track : m_tracks)
+        {
+            stream.Read(&track.key_offset);
+            stream.Read(&track.key_count);
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                stream.Read(&track.min[c]);
+                stream.Read(&track.extent[c]);
+            }
+        }
+
+        // keys
+        m_key_times.resize(stream.ReadAs<uint32_t>());
+        for (uint16_t& time : m_key_times)
+        {
+            stream.Read(&time);
+        }
+        m_key_values.resize(stream.ReadAs<uint32_t>());
+        for (uint16_t& value : m_key_values)
+        {
+            stream.Read(&value);
+        }
+    }
+
+    void Animation::SaveToFile(const string& file_path)
+    {
+        if (!m_skeleton)
+            return;
+
+        FileStream stream(file_path, FileStream_Write);
+        if (!stream.IsOpen())
+            return;
+
+        stream.Write(file_version);
+        stream.Write(m_duration);
+        stream.Write(m_ticks_per_sec);
+
+        // skeleton
+        stream.Write(m_skeleton->GetBoneCount());
+        for (uint32_t i = 0; i < m_skeleton->GetBoneCount(); i++)
+        {
+            stream.Write(m_skeleton->names[i]);
+            stream.Write(static_cast<int>(m_skeleton->parents[i]));
+            for (uint32_t j = 0; j < 16; j++)
+            {
+                stream.Write(m_skeleton->inverse_bind[i].Data()[j]);
+            }
+            stream.Write(m_skeleton->bind_position[i]);
+            stream.Write(m_skeleton->bind_rotation[i]);
+            stream.Write(m_skeleton->bind_scale[i]);
+        }
+
+        // tracks
+        stream.Write(static_cast<uint32_t>(m_tracks.size()));
+        for (const AnimationTrack& track : m_tracks)
+        {
+            stream.Write(track.key_offset);
+            stream.Write(track.key_count);
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                stream.Write(track.min[c]);
+                stream.Write(track.extent[c]);
+            }
+        }
+
+        // keys
+        stream.Write(static_cast<uint32_t>(m_key_times.size()));
+        for (const uint16_t time : m_key_times)
+        {
+            stream.Write(time);
+        }
+        stream.Write(static_cast<uint32_t>(m_key_values.size()));
+        for (const uint16_t value : m_key_values)
+        {
+            stream.Write(value);
+        }
+    }
+
+    void Animation::Compress(const shared_ptr<Skeleton>& skeleton, const vector<AnimationNode>& channels, const AnimationCompressionSettings& settings)
+    {
+        SP_ASSERT(skeleton != nullptr);
+
+        m_skeleton = skeleton;
+        m_tracks.assign(static_cast<size_t>(skeleton->GetBoneCount()) * track_count, AnimationTrack());
+        m_key_times.clear();
+        m_key_values.clear();
+        m_stats = AnimationCompressionStats();
+
+        auto add_vector_track = [this](const vector<KeyVector>& keys, AnimationTrack& track, const float tolerance)
+        {
+            const vector<uint32_t> kept = reduce_keys(keys, tolerance);
+            if (kept.empty())
+                return;
+
+            Vector3 min = keys[kept[0]].value;
+            Vector3 max = min;
+            for (const uint32_t k : kept)
+            {
+                min = Vector3::Min(min, keys[k].value);
+                max = Vector3::Max(max, keys[k].value);
+            }
+
+            track.key_offset = static_cast<uint32_t>(m_key_times.size());
+            track.key_count  = static_cast<uint32_t>(kept.size());
+            track.min[0]     = min.x;
+            track.min[1]     = min.y;
+            track.min[2]     = min.z;
+            track.extent[0]  = max.x - min.x;
+            track.extent[1]  = max.y - min.y;
+            track.extent[2]  = max.z - min.z;
+
+            for (const uint32_t k : kept)
+            {
+                uint16_t value[3];
+                encode_vector(keys[k].value, track, value);
+                m_key_times.push_back(quantize_time(keys[k].time, m_duration));
+                m_key_values.insert(m_key_values.end(), value, value + 3);
+            }
+
+            m_stats.key_count_source += static_cast<uint32_t>(keys.size());
+            m_stats.key_count        += track.key_count;
+            m_stats.size_source      += keys.size() * sizeof(KeyVector);
+        };
+
+        auto add_rotation_track = [this](const vector<KeyQuaternion>& keys, AnimationTrack& track, const float tolerance)
+        {
+            const vector<uint32_t> kept = reduce_keys(keys, tolerance);
+            if (kept.empty())
+                return;
+
+            track.key_offset = static_cast<uint32_t>(m_key_times.size());
+            track.key_count  = static_cast<uint32_t>(kept.size());
+            for (const uint32_t k : kept)
+            {
+                uint16_t value[3];
+                encode_rotation(keys[k].value, value);
+                m_key_times.push_back(quantize_time(keys[k].time, m_duration));
+                m_key_values.insert(m_key_values.end(), value, value + 3);
+            }
+
+            m_stats.key_count_source += static_cast<uint32_t>(keys.size());
+            m_stats.key_count        += track.key_count;
+            m_stats.size_source      += keys.size() * sizeof(KeyQuaternion);
+        };
+
+        for (const AnimationNode& channel : channels)
+        {
+            const int32_t bone = skeleton->GetBoneIndex(channel.name);
+            if (bone < 0)
+                continue;
+
+            AnimationTrack* tracks = &m_tracks[static_cast<size_t>(bone) * track_count];
+            add_vector_track(channel.positionFrames,   tracks[track_position], settings.tolerance_position);
+            add_rotation_track(channel.rotationFrames, tracks[track_rotation], settings.tolerance_rotation);
+            add_vector_track(channel.scaleFrames,      tracks[track_scale],    settings.tolerance_scale);
+        }
+
+        m_stats.size = m_tracks.size() * sizeof(AnimationTrack) + m_key_times.size() * sizeof(uint16_t) + m_key_values.size() * sizeof(uint16_t);
+
+        // measure the error at the source keys
+        for (const AnimationNode& channel : channels)
+        {
+            const int32_t bone = skeleton->GetBoneIndex(channel.name);
+            if (bone < 0)
+                continue;
+
+            const AnimationTrack* tracks = &m_tracks[static_cast<size_t>(bone) * track_count];
+            auto sample_track = [this](const AnimationTrack& track, const double time, uint32_t* key_a, uint32_t* key_b, float* t)
+            {
+                const float time_normalized = m_duration > 0.0 ? static_cast<float>(time / m_duration) : 0.0f;
+                find_keys(&m_key_times[track.key_offset], track.key_count, time_normalized, key_a, key_b, t);
+                *key_a += track.key_offset;
+                *key_b += track.key_offset;
+            };
+
+            uint32_t key_a = 0;
+            uint32_t key_b = 0;
+            float t        = 0.0f;
+            for (const KeyVector& key : channel.positionFrames)
+            {
+                const AnimationTrack& track = tracks[track_position];
+                sample_track(track, key.time, &key_a, &key_b, &t);
+                const Vector3 value    = interpolate(decode_vector(&m_key_values[key_a * 3], track), decode_vector(&m_key_values[key_b * 3], track), t);
+                m_stats.error_position = max(m_stats.error_position, key_error(value, key.value));
+            }
+
+            for (const KeyQuaternion& key : channel.rotationFrames)
+            {
+                sample_track(tracks[track_rotation], key.time, &key_a, &key_b, &t);
+                const Quaternion value = interpolate(decode_rotation(&m_key_values[key_a * 3]), decode_rotation(&m_key_values[key_b * 3]), t);
+                m_stats.error_rotation = max(m_stats.error_rotation, key_error(value, key.value));
+            }
+
+            for (const KeyVector& key : channel.scaleFrames)
+            {
+                const AnimationTrack& track = tracks[track_scale];
+                sample_track(track, key.time, &key_a, &key_b, &t);
+                const Vector3 value = interpolate(decode_vector(&m_key_values[key_a * 3], track), decode_vector(&m_key_values[key_b * 3], track), t);
+                m_stats.error_scale = max(m_stats.error_scale, key_error(value, key.value));
+            }
+        }
+    }
+
+    void Animation::Sample(const float time, const bool loop, AnimationPose& pose) const
     {
+        if (!m_skeleton)
+            return;
+
+        // the keys around the time are decoded into two poses, which are then interpolated for all bones at once
+        thread_local AnimationPose pose_a;
+        thread_local AnimationPose pose_b;
+        thread_local vector<float> factors;
+
+        const uint32_t bone_count = m_skeleton->GetBoneCount();
+        pose.Resize(bone_count);
+        pose_a.Resize(bone_count);
+        pose_b.Resize(bone_count);
+        const uint32_t padded_count = pose.GetPaddedCount();
+        factors.assign(static_cast<size_t>(padded_count) * track_count, 0.0f);
+        float* t_position = &factors[0];
+        float* t_rotation = &factors[padded_count];
+        float* t_scale    = &factors[static_cast<size_t>(padded_count) * 2];
+
+        const float duration  = GetDurationSec();
+        float time_normalized = duration > 0.0f ? time / duration : 0.0f;
+        time_normalized       = loop ? time_normalized - floor(time_normalized) : clamp(time_normalized, 0.0f, 1.0f);
+
+        for (uint32_t bone = 0; bone < bone_count; bone++)
+        {
+            const AnimationTrack* tracks = &m_tracks[static_cast<size_t>(bone) * track_count];
+            set_bone(pose_a, bone, m_skeleton->bind_position[bone], m_skeleton->bind_rotation[bone], m_skeleton->bind_scale[bone]);
+            set_bone(pose_b, bone, m_skeleton->bind_position[bone], m_skeleton->bind_rotation[bone], m_skeleton->bind_scale[bone]);
 
+            uint32_t key_a = 0;
+            uint32_t key_b = 0;
+            for (uint32_t type = 0; type < track_count; type++)
+            {
+                const AnimationTrack& track = tracks[type];
+                if (track.key_count == 0)
+                    continue;
+
+                float* t = type == track_position ? t_position : (type == track_rotation ? t_rotation : t_scale);
+                find_keys(&m_key_times[track.key_offset], track.key_count, time_normalized, &key_a, &key_b, &t[bone]);
+                const uint16_t* value_a = &m_key_values[(static_cast<size_t>(track.key_offset) + key_a) * 3];
+                const uint16_t* value_b = &m_key_values[(static_cast<size_t>(track.key_offset) + key_b) * 3];
+
+                if (type == track_rotation)
+                {
+                    const Quaternion a = decode_rotation(value_a);
+                    const Quaternion b = decode_rotation(value_b);
+                    pose_a.rotation[0][bone] = a.x; pose_a.rotation[1][bone] = a.y; pose_a.rotation[2][bone] = a.z; pose_a.rotation[3][bone] = a.w;
+                    pose_b.rotation[0][bone] = b.x; pose_b.rotation[1][bone] = b.y; pose_b.rotation[2][bone] = b.z; pose_b.rotation[3][bone] = b.w;
+                }
+                else
+                {
+                    vector<float>* target_a = type == track_position ? pose_a.position : pose_a.scale;
+                    vector<float>* target_b = type == track_position ? pose_b.position : pose_b.scale;
+                    const Vector3 a         = decode_vector(value_a, track);
+                    const Vector3 b         = decode_vector(value_b, track);
+                    target_a[0][bone] = a.x; target_a[1][bone] = a.y; target_a[2][bone] = a.z;
+                    target_b[0][bone] = b.x; target_b[1][bone] = b.y; target_b[2][bone] = b.z;
+                }
+            }
+        }
+
+        animation::pose_lerp(pose_a, pose_b, t_position, t_rotation, t_scale, pose);
     }
 
-    void Animation::SaveToFile(const string& filePath)
+    namespace animation
     {
+        void pose_lerp(const AnimationPose& a, const AnimationPose& b, const float* t_position, const float* t_rotation, const float* t_scale, AnimationPose& out)
+        {
+            SP_ASSERT(a.GetPaddedCount() == b.GetPaddedCount());
+            out.Resize(a.GetBoneCount()); // no-op when out is one of the inputs
+            lerp_bones<true>(a, b, t_position, t_rotation, t_scale, 0.0f, out);
+        }
+
+        void pose_blend(const AnimationPose& a, const AnimationPose& b, const float weight, AnimationPose& out)
+        {
+            SP_ASSERT(a.GetPaddedCount() == b.GetPaddedCount());
+            out.Resize(a.GetBoneCount()); // no-op when out is one of the inputs
+            lerp_bones<false>(a, b, nullptr, nullptr, nullptr, weight, out);
+        }
+
+        void pose_to_palette(const Skeleton& skeleton, const AnimationPose& pose, Matrix* palette)
+        {
+            thread_local vector<Matrix> model;
+
+            const uint32_t bone_count = skeleton.GetBoneCount();
+            model.resize(bone_count);
+            for (uint32_t bone = 0; bone < bone_count; bone++)
+            {
+                const Vector3 position(pose.position[0][bone], pose.position[1][bone], pose.position[2][bone]);
+                const Quaternion rotation(pose.rotation[0][bone], pose.rotation[1][bone], pose.rotation[2][bone], pose.rotation[3][bone]);
+                const Vector3 scale(pose.scale[0][bone], pose.scale[1][bone], pose.scale[2][bone]);
+                const Matrix local    = Matrix(position, rotation, scale);
+                const int32_t parent  = skeleton.parents[bone];
 
+                model[bone]   = parent < 0 ? local : local * model[parent];
+                palette[bone] = skeleton.inverse_bind[bone] * model[bone];
+            }
+        }
     }
 }
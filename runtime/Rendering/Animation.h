@@ -28,19 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace spartan
 {
-    struct AnimationVertexWeight
-    {
-        uint32_t vertexID;
-        float weight;
-    };
-
-    struct AnimationBone
-    {
-        std::string name;
-        std::vector<AnimationVertexWeight> vertexWeights;
-        math::Matrix offset;
-    };
-
+    // source keys, as imported, they are compressed into an animation
     struct KeyVector
     {
         double time;
@@ -61,6 +49,76 @@ namespace spartan
         std::vector<KeyVector> scaleFrames;
     };
 
+    // the bones of a model, parents always precede their children, so the hierarchy resolves in a single pass
+    struct Skeleton
+    {
+        uint32_t AddBone(const std::string& name, const int32_t parent, const math::Matrix& inverse_bind, const math::Vector3& position, const math::Quaternion& rotation, const math::Vector3& scale);
+        int32_t GetBoneIndex(const std::string& name) const;
+        uint32_t GetBoneCount() const { return static_cast<uint32_t>(names.size()); }
+
+        std::vector<std::string> names;
+        std::vector<int32_t> parents;               // -1 for roots
+        std::vector<math::Matrix> inverse_bind;     // model space to bone space, at bind time
+        std::vector<math::Vector3> bind_position;   // local rest transform, for bones that an animation doesn't drive
+        std::vector<math::Quaternion> bind_rotation;
+        std::vector<math::Vector3> bind_scale;
+    };
+
+    // the bones that deform a vertex, the weights sum to one, a vertex without weights stays in its bind pose
+    struct SkinWeights
+    {
+        static const uint32_t bone_count = 4;
+
+        void Add(const uint32_t bone, const float weight);
+        void Normalize();
+
+        uint32_t bones[bone_count] = { 0, 0, 0, 0 };
+        float weights[bone_count]  = { 0.0f, 0.0f, 0.0f, 0.0f };
+    };
+
+    // local bone transforms as a structure of arrays, padded so that sampling and blending can process 8 bones at once
+    struct AnimationPose
+    {
+        static const uint32_t lane_count = 8;
+
+        void Resize(const uint32_t bone_count);
+        uint32_t GetBoneCount() const   { return bone_count; }
+        uint32_t GetPaddedCount() const { return static_cast<uint32_t>(position[0].size()); }
+
+        uint32_t bone_count = 0;
+        std::vector<float> position[3];
+        std::vector<float> rotation[4];
+        std::vector<float> scale[3];
+    };
+
+    struct AnimationCompressionSettings
+    {
+        float tolerance_position = 0.001f; // units
+        float tolerance_rotation = 0.001f; // radians
+        float tolerance_scale    = 0.001f;
+    };
+
+    // the error is measured at the source keys, against the source values
+    struct AnimationCompressionStats
+    {
+        uint32_t key_count_source = 0;
+        uint32_t key_count        = 0;
+        uint64_t size_source      = 0; // bytes
+        uint64_t size             = 0; // bytes
+        float error_position      = 0.0f;
+        float error_rotation      = 0.0f; // radians
+        float error_scale         = 0.0f;
+    };
+
+    // the keys of one property (position, rotation or scale) of one bone, a track without keys leaves the bone at its bind transform
+    struct AnimationTrack
+    {
+        uint32_t key_offset = 0;
+        uint32_t key_count  = 0;
+        float min[3]        = { 0.0f, 0.0f, 0.0f }; // quantization range, for positions and scales
+        float extent[3]     = { 0.0f, 0.0f, 0.0f };
+    };
+
     class Animation : public IResource
     {
     public:
@@ -68,19 +126,39 @@ namespace spartan
         ~Animation() = default;
 
         // iresource
-        void LoadFromFile(const std::string& filePath) override;
-        void SaveToFile(const std::string& filePath) override;
+        void LoadFromFile(const std::string& file_path) override;
+        void SaveToFile(const std::string& file_path) override;
 
-        void SetObjectName(const std::string& name)   { m_object_name = name; }
-        void SetDuration(double duration)       { m_duration = duration; }
-        void SetTicksPerSec(double ticksPerSec) { m_ticksPerSec = ticksPerSec; }
+        // compresses the channels (matched to the bones by name) with key reduction and quantization (smallest three for rotations)
+        void Compress(const std::shared_ptr<Skeleton>& skeleton, const std::vector<AnimationNode>& channels, const AnimationCompressionSettings& settings = AnimationCompressionSettings());
+        const AnimationCompressionStats& GetCompressionStats() const { return m_stats; }
 
-    private:
-        std::string m_object_name;
-        double m_duration    = 0;
-        double m_ticksPerSec = 0;
+        // time is in seconds, when looping it wraps, otherwise it clamps
+        void Sample(const float time, const bool loop, AnimationPose& pose) const;
+
+        // properties
+        void SetDuration(double duration)                  { m_duration = duration; }
+        void SetTicksPerSec(double ticks_per_sec)          { m_ticks_per_sec = ticks_per_sec; }
+        float GetDurationSec() const                       { return m_ticks_per_sec > 0.0 ? static_cast<float>(m_duration / m_ticks_per_sec) : 0.0f; }
+        const std::shared_ptr<Skeleton>& GetSkeleton() const { return m_skeleton; }
 
-        // Each channel controls a single node
-        std::vector<AnimationNode> m_channels;
+    private:
+        double m_duration      = 0;
+        double m_ticks_per_sec = 0;
+        std::shared_ptr<Skeleton> m_skeleton;
+        std::vector<AnimationTrack> m_tracks; // 3 per bone: position, rotation, scale
+        std::vector<uint16_t> m_key_times;  // normalized to the duration
+        std::vector<uint16_t> m_key_values; // 3 per key
+        AnimationCompressionStats m_stats;
     };
+
+    namespace animation
+    {
+        // per bone out = a + (b - a) * t, rotations take the shortest path and are renormalized
+        void pose_lerp(const AnimationPose& a, const AnimationPose& b, const float* t_position, const float* t_rotation, const float* t_scale, AnimationPose& out);
+        void pose_blend(const AnimationPose& a, const AnimationPose& b, const float weight, AnimationPose& out);
+
+        // local transforms to skinning matrices (inverse bind * model space), one per bone
+        void pose_to_palette(const Skeleton& skeleton, const AnimationPose& pose, math::Matrix* palette);
+    }
 }
@@ -0,0 +1,300 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "Animator.h"
+#include "../RHI/RHI_Buffer.h"
+#include "../Core/ThreadPool.h"
+//=============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        const uint32_t buffer_count      = 3; // frames in flight, plus the one being written
+        const uint32_t palette_count_min = 4096;
+
+        struct Layer
+        {
+            shared_ptr<Animation> animation;
+            float time = 0.0f;
+            bool loop  = true;
+        };
+
+        struct Instance
+        {
+            shared_ptr<Skeleton> skeleton;
+            Layer current;
+            Layer previous;                 // faded out over the blend duration
+            float blend_time        = 0.0f;
+            float blend_duration    = 0.0f;
+            float speed             = 1.0f;
+            uint32_t palette_offset = 0;
+            bool alive              = false;
+            bool evaluated          = false; // palette_offset is only meaningful once the instance went through a tick
+        };
+
+        vector<Instance> instances;
+        vector<uint32_t> instance_ids_free;
+        vector<uint32_t> instances_alive; // compacted every tick, this is what the jobs iterate over
+        array<shared_ptr<RHI_Buffer>, buffer_count> buffers;
+        uint32_t buffer_index = 0;
+        uint32_t bone_count   = 0;
+        float evaluation_ms   = 0.0f;
+        mutex instances_mutex;
+
+        void advance(Layer& layer, const float delta_time)
+        {
+            if (!layer.animation)
+                return;
+
+            layer.time += delta_time;
+            const float duration = layer.animation->GetDurationSec();
+            if (!layer.loop && duration > 0.0f)
+            {
+                layer.time = min(layer.time, duration);
+            }
+        }
+
+        void evaluate(Instance& instance, Matrix* palette)
+        {
+            thread_local AnimationPose pose;
+            thread_local AnimationPose pose_previous;
+
+            const Skeleton& skeleton = *instance.skeleton;
+            pose.Resize(skeleton.GetBoneCount());
+
+            if (instance.current.animation)
+            {
+                instance.current.animation->Sample(instance.current.time, instance.current.loop, pose);
+            }
+            else
+            {
+                // bind pose
+                for (uint32_t bone = 0; bone < skeleton.GetBoneCount(); bone++)
+                {
+                    pose.position[0][bone] = skeleton.bind_position[bone].x;
+                    pose.position[1][bone] = skeleton.bind_position[bone].y;
+                    pose.position[2][bone] = skeleton.bind_position[bone].z;
+                    pose.rotation[0][bone] = skeleton.bind_rotation[bone].x;
+                    pose.rotation[1][bone] = skeleton.bind_rotation[bone].y;
+                    pose.rotation[2][bone] = skeleton.bind_rotation[bone].z;
+                    pose.rotation[3][bone] = skeleton.bind_rotation[bone].w;
+                    pose.scale[0][bone]    = skeleton.bind_scale[bone].x;
+                    pose.scale[1][bone]    = skeleton.bind_scale[bone].y;
+                    pose.scale[2][bone]    = skeleton.bind_scale[bone].z;
+                }
+            }
+
+            // cross-fade from the previous animation
+            if (instance.previous.animation && instance.blend_time < instance.blend_duration)
+            {
+                instance.previous.animation->Sample(instance.previous.time, instance.previous.loop, pose_previous);
+                animation::pose_blend(pose_previous, pose, instance.blend_time / instance.blend_duration, pose);
+            }
+
+            animation::pose_to_palette(skeleton, pose, palette);
+        }
+    }
+
+    void Animator::Tick()
+    {
+        lock_guard<mutex> lock(instances_mutex);
+
+        const Stopwatch timer;
+        const float delta_time = static_cast<float>(Timer::GetDeltaTimeSec());
+
+        // lay out the palettes
+        instances_alive.clear();
+        bone_count = 0;
+        for (uint32_t id = 0; id < static_cast<uint32_t>(instances.size()); id++)
+        {
+            Instance& instance = instances[id];
+            if (!instance.alive)
+                continue;
+
+            instance.palette_offset = bone_count;
+            instance.evaluated      = true;
+            bone_count             += instance.skeleton->GetBoneCount();
+            instances_alive.push_back(id);
+        }
+
+        if (instances_alive.empty())
+        {
+            evaluation_ms = 0.0f;
+            return;
+        }
+
+        // the next buffer in the ring is no longer read by the gpu, grow it if needed (by doubling)
+        buffer_index                   = (buffer_index + 1) % buffer_count;
+        shared_ptr<RHI_Buffer>& buffer = buffers[buffer_index];
+        if (!buffer || buffer->GetElementCount() < bone_count)
+        {
+            uint32_t capacity = buffer ? buffer->GetElementCount() : palette_count_min;
+            while (capacity < bone_count)
+            {
+                capacity *= 2;
+            }
+            buffer = make_shared<RHI_Buffer>(RHI_Buffer_Type::Storage, sizeof(Matrix), capacity, nullptr, true, "animation_palettes");
+        }
+        SP_ASSERT_MSG(buffer->GetStride() == sizeof(Matrix), "Palettes are written as a contiguous array");
+        Matrix* palettes = static_cast<Matrix*>(buffer->GetMappedData());
+
+        // evaluate, every instance writes to its own range of the buffer
+        auto evaluate_instances = [delta_time, palettes](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                Instance& instance = instances[instances_alive[i]];
+                const float delta  = delta_time * instance.speed;
+                advance(instance.current, delta);
+                advance(instance.previous, delta);
+                instance.blend_time += delta;
+                if (instance.blend_time >= instance.blend_duration)
+                {
+                    instance.previous = Layer();
+                }
+
+                evaluate(instance, palettes + instance.palette_offset);
+            }
+        };
+        const uint32_t instance_count = static_cast<uint32_t>(instances_alive.size());
+        if (instance_count > 1)
+        {
+            ThreadPool::ParallelLoop(evaluate_instances, instance_count);
+        }
+        else
+        {
+            evaluate_instances(0, instance_count);
+        }
+
+        evaluation_ms = static_cast<float>(timer.GetElapsedTimeMs());
+    }
+
+    void Animator::Shutdown()
+    {
+        lock_guard<mutex> lock(instances_mutex);
+
+        instances.clear();
+        instance_ids_free.clear();
+        instances_alive.clear();
+        buffers.fill(nullptr);
+        bone_count = 0;
+    }
+
+    uint32_t Animator::AddInstance(const shared_ptr<Skeleton>& skeleton)
+    {
+        SP_ASSERT(skeleton != nullptr);
+
+        lock_guard<mutex> lock(instances_mutex);
+
+        uint32_t id = 0;
+        if (!instance_ids_free.empty())
+        {
+            id = instance_ids_free.back();
+            instance_ids_free.pop_back();
+        }
+        else
+        {
+            id = static_cast<uint32_t>(instances.size());
+            instances.emplace_back();
+        }
+
+        instances[id]          = Instance();
+        instances[id].skeleton = skeleton;
+        instances[id].alive    = true;
+
+        return id;
+    }
+
+    void Animator::RemoveInstance(const uint32_t instance_id)
+    {
+        lock_guard<mutex> lock(instances_mutex);
+
+        if (instance_id >= instances.size() || !instances[instance_id].alive)
+            return;
+
+        instances[instance_id] = Instance();
+        instance_ids_free.push_back(instance_id);
+    }
+
+    void Animator::Play(const uint32_t instance_id, const shared_ptr<Animation>& animation, const float blend_duration, const bool loop)
+    {
+        lock_guard<mutex> lock(instances_mutex);
+
+        if (instance_id >= instances.size() || !instances[instance_id].alive)
+            return;
+
+        Instance& instance = instances[instance_id];
+        SP_ASSERT_MSG(!animation || !animation->GetSkeleton() || animation->GetSkeleton()->GetBoneCount() == instance.skeleton->GetBoneCount(), "The animation targets a different skeleton");
+
+        instance.previous       = instance.current;
+        instance.current        = { animation, 0.0f, loop };
+        instance.blend_time     = 0.0f;
+        instance.blend_duration = instance.previous.animation ? blend_duration : 0.0f;
+    }
+
+    void Animator::SetSpeed(const uint32_t instance_id, const float speed)
+    {
+        lock_guard<mutex> lock(instances_mutex);
+
+        if (instance_id < instances.size() && instances[instance_id].alive)
+        {
+            instances[instance_id].speed = speed;
+        }
+    }
+
+    RHI_Buffer* Animator::GetPaletteBuffer()
+    {
+        return buffers[buffer_index].get();
+    }
+
+    uint32_t Animator::GetPaletteOffset(const uint32_t instance_id)
+    {
+        lock_guard<mutex> lock(instances_mutex);
+
+        if (instance_id >= instances.size() || !instances[instance_id].alive || !instances[instance_id].evaluated)
+            return invalid_instance;
+
+        return instances[instance_id].palette_offset;
+    }
+
+    uint32_t Animator::GetInstanceCount()
+    {
+        return static_cast<uint32_t>(instances_alive.size());
+    }
+
+    uint32_t Animator::GetBoneCount()
+    {
+        return bone_count;
+    }
+
+    float Animator::GetEvaluationTimeMs()
+    {
+        return evaluation_ms;
+    }
+}
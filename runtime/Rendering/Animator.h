@@ -0,0 +1,59 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==========
+#include <memory>
+#include "Animation.h"
+//=====================
+
+namespace spartan
+{
+    class RHI_Buffer;
+
+    // plays animations on skeleton instances, all instances are evaluated in parallel every frame
+    // and their skinning palettes are written into a single buffer, one per frame in flight
+    class Animator
+    {
+    public:
+        static constexpr uint32_t invalid_instance = UINT32_MAX;
+
+        static void Tick();
+        static void Shutdown();
+
+        // instances
+        static uint32_t AddInstance(const std::shared_ptr<Skeleton>& skeleton);
+        static void RemoveInstance(const uint32_t instance_id);
+        static void Play(const uint32_t instance_id, const std::shared_ptr<Animation>& animation, const float blend_duration = 0.2f, const bool loop = true);
+        static void SetSpeed(const uint32_t instance_id, const float speed);
+
+        // palettes of the last evaluated frame, the offset is in matrices, it's invalid_instance until the instance has been evaluated once
+        static RHI_Buffer* GetPaletteBuffer();
+        static uint32_t GetPaletteOffset(const uint32_t instance_id);
+
+        // stats
+        static uint32_t GetInstanceCount();
+        static uint32_t GetBoneCount();
+        static float GetEvaluationTimeMs();
+    };
+}
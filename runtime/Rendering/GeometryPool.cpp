@@ -0,0 +1,298 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "pch.h"
+#include "GeometryPool.h"
+#include "Renderer.h"
+#include "../RHI/RHI_Buffer.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Core/ProgressTracker.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        // initial capacities, the pool grows (by doubling) when they are exceeded
+        const uint64_t capacity_vertices = 1024 * 1024;
+        const uint64_t capacity_indices  = 4 * 1024 * 1024;
+
+        // defragment once the free space is scattered enough that large meshes might not fit
+        const float defragmentation_threshold = 0.5f;
+
+        // the graphics queue alternates between two command lists and waits for the older one before reusing it,
+        // so once this many frames have started, nothing recorded in the frame something was retired in can still be executing
+        const uint64_t frames_in_flight = 2;
+
+        // a pool of elements backed by a single gpu buffer
+        struct Pool
+        {
+            Pool(const RHI_Buffer_Type type, const uint32_t stride, const char* name) : type(type), stride(stride), name(name) {}
+
+            FreeListAllocator allocator;
+            shared_ptr<RHI_Buffer> buffer;
+            atomic<RHI_Buffer*> buffer_current = nullptr; // read by the renderer without locking
+            RHI_Buffer_Type type               = RHI_Buffer_Type::Max;
+            uint32_t stride                    = 0;
+            const char* name                   = nullptr;
+        };
+
+        Pool pool_vertices(RHI_Buffer_Type::Vertex, sizeof(RHI_Vertex_PosTexNorTan), "geometry_pool_vertices");
+        Pool pool_indices(RHI_Buffer_Type::Index,   sizeof(uint32_t),                "geometry_pool_indices");
+        // freed ranges and replaced buffers, tagged with the frame they were retired in, are kept until no
+        // frame in flight can reference them, otherwise a new upload could overwrite geometry the gpu is still reading
+        struct RetiredAllocation
+        {
+            GeometryAllocation allocation;
+            uint64_t frame = 0;
+        };
+
+        struct RetiredBuffer
+        {
+            shared_ptr<RHI_Buffer> buffer;
+            uint64_t frame = 0;
+        };
+
+        vector<RetiredAllocation> allocations_retired;
+        vector<RetiredBuffer> buffers_retired;
+        recursive_mutex pool_mutex;
+        atomic<uint32_t> generation      = 0;
+        bool defragmentation_requested   = false;
+        uint32_t defragmentation_count   = 0;
+        uint32_t grow_count              = 0;
+
+        // replaces the buffer of a pool with a new one, copying the given regions over
+        void replace_buffer(Pool& pool, const uint64_t capacity, const vector<RHI_BufferCopyRegion>& regions)
+        {
+            shared_ptr<RHI_Buffer> buffer = make_shared<RHI_Buffer>(pool.type, pool.stride, static_cast<uint32_t>(capacity), nullptr, false, pool.name);
+            if (pool.buffer)
+            {
+                buffer->CopyFrom(pool.buffer.get(), regions);
+                buffers_retired.push_back({ pool.buffer, Renderer::GetFrameNumber() });
+            }
+            pool.buffer = buffer;
+            pool.buffer_current.store(buffer.get(), memory_order_release);
+        }
+
+        uint32_t allocate(Pool& pool, const uint64_t count, const uint64_t capacity_initial)
+        {
+            if (!pool.buffer)
+            {
+                pool.allocator.Reset(max(capacity_initial, count));
+                replace_buffer(pool, pool.allocator.GetCapacity(), {});
+            }
+
+            uint32_t id = pool.allocator.Allocate(count);
+            if (id == FreeListAllocator::invalid_id)
+            {
+                // grow, offsets don't change so the existing contents are copied as a whole
+                const uint64_t capacity_old = pool.allocator.GetCapacity();
+                const uint64_t capacity_new = max(capacity_old * 2, capacity_old + count);
+                replace_buffer(pool, capacity_new, { { 0, 0, capacity_old * pool.stride } });
+                pool.allocator.Grow(capacity_new);
+                grow_count++;
+
+                id = pool.allocator.Allocate(count);
+                SP_ASSERT(id != FreeListAllocator::invalid_id);
+            }
+
+            return id;
+        }
+
+        void defragment(Pool& pool)
+        {
+            if (!pool.buffer)
+                return;
+
+            vector<FreeListAllocator::Move> moves;
+            const uint64_t used = pool.allocator.GetStats().used;
+            pool.allocator.Defragment(moves);
+            if (moves.empty())
+                return;
+
+            // everything before the first move is already packed, copy it as one region
+            vector<RHI_BufferCopyRegion> regions;
+            regions.reserve(moves.size() + 1);
+            const uint64_t packed = moves.front().offset_destination;
+            if (packed > 0)
+            {
+                regions.push_back({ 0, 0, packed * pool.stride });
+            }
+            for (const FreeListAllocator::Move& move : moves)
+            {
+                regions.push_back({ move.offset_source * pool.stride, move.offset_destination * pool.stride, move.size * pool.stride });
+            }
+
+            replace_buffer(pool, pool.allocator.GetCapacity(), regions);
+            SP_LOG_INFO("Defragmented %s, moved %u allocations, %llu elements in use", pool.name, static_cast<uint32_t>(moves.size()), used);
+        }
+
+        bool is_retirement_complete(const uint64_t frame)
+        {
+            return frame + frames_in_flight <= Renderer::GetFrameNumber();
+        }
+
+        bool release_retired()
+        {
+            bool freed = false;
+            for (size_t i = 0; i < allocations_retired.size();)
+            {
+                if (is_retirement_complete(allocations_retired[i].frame))
+                {
+                    pool_vertices.allocator.Free(allocations_retired[i].allocation.vertex_id);
+                    pool_indices.allocator.Free(allocations_retired[i].allocation.index_id);
+                    allocations_retired[i] = allocations_retired.back();
+                    allocations_retired.pop_back();
+                    freed = true;
+                }
+                else
+                {
+                    i++;
+                }
+            }
+
+            // dropping the last reference sends the gpu memory through the device deletion queue
+            buffers_retired.erase(remove_if(buffers_retired.begin(), buffers_retired.end(), [](const RetiredBuffer& retired)
+            {
+                return is_retirement_complete(retired.frame);
+            }), buffers_retired.end());
+
+            return freed;
+        }
+
+        bool needs_defragmentation(const Pool& pool)
+        {
+            const FreeListAllocator::Stats stats = pool.allocator.GetStats();
+            return stats.free_block_count > 1 && stats.fragmentation > defragmentation_threshold;
+        }
+    }
+
+    void GeometryPool::Tick()
+    {
+        lock_guard<recursive_mutex> lock(pool_mutex);
+
+        // this runs once the frame's command list is available, so the frames that could reference what was retired have completed
+        if (release_retired())
+        {
+            defragmentation_requested |= needs_defragmentation(pool_vertices) || needs_defragmentation(pool_indices);
+        }
+
+        // loading can allocate from other threads, so wait until it's done
+        if (defragmentation_requested && !ProgressTracker::IsLoading())
+        {
+            defragment(pool_vertices);
+            defragment(pool_indices);
+            defragmentation_requested = false;
+            defragmentation_count++;
+            generation++;
+        }
+    }
+
+    void GeometryPool::Shutdown()
+    {
+        lock_guard<recursive_mutex> lock(pool_mutex);
+
+        allocations_retired.clear();
+        buffers_retired.clear();
+        pool_vertices.buffer = nullptr;
+        pool_indices.buffer  = nullptr;
+        pool_vertices.buffer_current.store(nullptr, memory_order_release);
+        pool_indices.buffer_current.store(nullptr, memory_order_release);
+        pool_vertices.allocator.Reset(0);
+        pool_indices.allocator.Reset(0);
+        generation++;
+    }
+
+    GeometryAllocation GeometryPool::Allocate(const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<uint32_t>& indices)
+    {
+        SP_ASSERT(!vertices.empty() && !indices.empty());
+
+        lock_guard<recursive_mutex> lock(pool_mutex);
+
+        GeometryAllocation allocation;
+        allocation.vertex_id = allocate(pool_vertices, vertices.size(), capacity_vertices);
+        allocation.index_id  = allocate(pool_indices,  indices.size(),  capacity_indices);
+
+        // both uploads go out in one submission, after any growth so they land in the current buffers
+        RHI_Buffer::Upload({
+            { pool_vertices.buffer.get(), vertices.data(), pool_vertices.allocator.GetOffset(allocation.vertex_id) * pool_vertices.stride, vertices.size() * pool_vertices.stride },
+            { pool_indices.buffer.get(),  indices.data(),  pool_indices.allocator.GetOffset(allocation.index_id)   * pool_indices.stride,  indices.size()  * pool_indices.stride  }
+        });
+
+        return allocation;
+    }
+
+    void GeometryPool::Free(GeometryAllocation& allocation)
+    {
+        if (!allocation.IsValid())
+            return;
+
+        lock_guard<recursive_mutex> lock(pool_mutex);
+
+        // the ranges return to the allocator once the frames that might be drawing them are done
+        allocations_retired.push_back({ allocation, Renderer::GetFrameNumber() });
+        allocation = GeometryAllocation();
+    }
+
+    uint32_t GeometryPool::GetVertexOffset(const GeometryAllocation& allocation)
+    {
+        lock_guard<recursive_mutex> lock(pool_mutex);
+        return pool_vertices.allocator.IsAllocated(allocation.vertex_id) ? static_cast<uint32_t>(pool_vertices.allocator.GetOffset(allocation.vertex_id)) : 0;
+    }
+
+    uint32_t GeometryPool::GetIndexOffset(const GeometryAllocation& allocation)
+    {
+        lock_guard<recursive_mutex> lock(pool_mutex);
+        return pool_indices.allocator.IsAllocated(allocation.index_id) ? static_cast<uint32_t>(pool_indices.allocator.GetOffset(allocation.index_id)) : 0;
+    }
+
+    uint32_t GeometryPool::GetGeneration()
+    {
+        return generation.load(memory_order_acquire);
+    }
+
+    RHI_Buffer* GeometryPool::GetVertexBuffer()
+    {
+        return pool_vertices.buffer_current.load(memory_order_acquire);
+    }
+
+    RHI_Buffer* GeometryPool::GetIndexBuffer()
+    {
+        return pool_indices.buffer_current.load(memory_order_acquire);
+    }
+
+    GeometryPoolStats GeometryPool::GetStats()
+    {
+        lock_guard<recursive_mutex> lock(pool_mutex);
+
+        GeometryPoolStats stats;
+        stats.vertices              = pool_vertices.allocator.GetStats();
+        stats.indices               = pool_indices.allocator.GetStats();
+        stats.defragmentation_count = defragmentation_count;
+        stats.grow_count            = grow_count;
+        return stats;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../Core/FreeListAllocator.h"
+//===================================
+
+namespace spartan
+{
+    class RHI_Buffer;
+    struct RHI_Vertex_PosTexNorTan;
+
+    // where a mesh lives in the pool, the offsets can change when the pool defragments
+    struct GeometryAllocation
+    {
+        uint32_t vertex_id = FreeListAllocator::invalid_id;
+        uint32_t index_id  = FreeListAllocator::invalid_id;
+
+        bool IsValid() const { return vertex_id != FreeListAllocator::invalid_id && index_id != FreeListAllocator::invalid_id; }
+    };
+
+    struct GeometryPoolStats
+    {
+        FreeListAllocator::Stats vertices; // in vertices
+        FreeListAllocator::Stats indices;  // in indices
+        uint32_t defragmentation_count = 0;
+        uint32_t grow_count            = 0;
+    };
+
+    // all mesh geometry lives in one large vertex buffer and one large index buffer, so draws don't have to
+    // rebind buffers and can address any mesh with a base vertex and a first index (a prerequisite for multi-draw indirect)
+    class GeometryPool
+    {
+    public:
+        static void Tick(); // releases geometry no frame in flight can reference and defragments (if needed)
+        static void Shutdown();
+
+        // allocation
+        static GeometryAllocation Allocate(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, const std::vector<uint32_t>& indices);
+        static void Free(GeometryAllocation& allocation);
+        static uint32_t GetVertexOffset(const GeometryAllocation& allocation);
+        static uint32_t GetIndexOffset(const GeometryAllocation& allocation);
+
+        // incremented whenever allocations move, so that offsets can be cached
+        static uint32_t GetGeneration();
+
+        // buffers
+        static RHI_Buffer* GetVertexBuffer();
+        static RHI_Buffer* GetIndexBuffer();
+
+        // stats
+        static GeometryPoolStats GetStats();
+    };
+}
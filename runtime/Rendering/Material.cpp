@@ -79,6 +79,24 @@ namespace spartan
                 }
             }
         }
+
+        // the textures of a material file, with the type, name and path they were saved with
+        void for_each_texture(const pugi::xml_node& node_material, const function<void(MaterialTextureType, const string&, const string&)>& callback)
+        {
+            pugi::xml_node node_textures = node_material.child("textures");
+            uint32_t texture_count       = node_textures.attribute("count").as_uint();
+            for (uint32_t i = 0; i < texture_count; ++i)
+            {
+                string node_name            = "texture_" + to_string(i);
+                pugi::xml_node node_texture = node_textures.child(node_name.c_str());
+
+                callback(
+                    static_cast<MaterialTextureType>(node_texture.attribute("texture_type").as_uint()),
+                    node_texture.attribute("texture_name").as_string(),
+                    node_texture.attribute("texture_path").as_string()
+                );
+            }
+        }
     }
 
     namespace texture_processing
@@ -279,31 +297,57 @@ namespace spartan
             m_properties[i] = node_material.child(attribute_name).text().as_float();
         }
 
-        // load textures
-        uint32_t texture_count = node_material.child("textures").attribute("count").as_uint();
-        for (uint32_t i = 0; i < texture_count; ++i)
+        // load textures, all of them are requested first so that they decode in parallel, a material which is loaded through a
+        // request that depends on them (see GetTexturePathsToLoad()) finds them cached or done, so nothing is waited for
+        vector<pair<MaterialTextureType, ResourceHandle<RHI_Texture>>> texture_requests;
+        for_each_texture(node_material, [this, &texture_requests](const MaterialTextureType tex_type, const string& tex_name, const string& tex_path)
         {
-            string node_name            = "texture_" + to_string(i);
-            pugi::xml_node node_texture = node_material.child("textures").child(node_name.c_str());
-
-            MaterialTextureType tex_type = static_cast<MaterialTextureType>(node_texture.attribute("texture_type").as_uint());
-            string tex_name              = node_texture.attribute("texture_name").as_string();
-            string tex_path              = node_texture.attribute("texture_path").as_string();
-
             // If the texture happens to be loaded, get a reference to it
-            auto texture = ResourceCache::GetByName<RHI_Texture>(tex_name);
+            if (shared_ptr<RHI_Texture> texture = ResourceCache::GetByName<RHI_Texture>(tex_name))
+            {
+                SetTexture(tex_type, texture);
+                return;
+            }
+
             // If there is not texture (it's not loaded yet), load it
-            if (!texture)
+            if (!tex_path.empty())
             {
-                texture = ResourceCache::Load<RHI_Texture>(tex_path);
+                texture_requests.emplace_back(tex_type, ResourceCache::LoadAsync<RHI_Texture>(tex_path));
             }
+            else
+            {
+                SetTexture(tex_type, nullptr);
+            }
+        });
 
-            SetTexture(tex_type, texture);
+        for (const auto& [tex_type, texture] : texture_requests)
+        {
+            SetTexture(tex_type, texture.Wait());
         }
 
         m_object_size = sizeof(*this);
     }
 
+    vector<string> Material::GetTexturePathsToLoad(const string& file_path)
+    {
+        vector<string> paths;
+
+        pugi::xml_document doc;
+        if (!doc.load_file(file_path.c_str()))
+            return paths;
+
+        // the same textures LoadFromFile() would request
+        for_each_texture(doc.child("Material"), [&paths](const MaterialTextureType, const string& tex_name, const string& tex_path)
+        {
+            if (!tex_path.empty() && !ResourceCache::GetByName<RHI_Texture>(tex_name))
+            {
+                paths.push_back(tex_path);
+            }
+        });
+
+        return paths;
+    }
+
     void Material::SaveToFile(const string& file_path)
     {
         SetResourceFilePath(file_path);
@@ -620,6 +664,7 @@ namespace spartan
                 if (texture && texture->GetResourceState() == ResourceState::Max)
                 {
                     texture->SetFlag(RHI_Texture_DontPrepareForGpu, false);
+                    texture->SetFlag(RHI_Texture_Streamed);
                     texture->PrepareForGpu();
                 }
             }
@@ -109,6 +109,7 @@ namespace spartan
         bool HasTextureOfType(const MaterialTextureType texture_type) const;
         std::string GetTexturePathByType(const MaterialTextureType texture_type, const uint8_t slot = 0);
         std::vector<std::string> GetTexturePaths();
+        static std::vector<std::string> GetTexturePathsToLoad(const std::string& file_path); // the uncached textures a material file references, to load ahead of it
         RHI_Texture* GetTexture(const MaterialTextureType texture_type, const uint8_t slot = 0);
 
         // index of refraction
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ================================
 #include "pch.h"
 #include "Mesh.h"
+#include "Animator.h"
 #include "../RHI/RHI_Buffer.h"
 #include "../World/Entity.h"
 #include "../IO/FileStream.h"
@@ -128,8 +129,8 @@ namespace spartan
 
     Mesh::~Mesh()
     {
-        m_index_buffer  = nullptr;
-        m_vertex_buffer = nullptr;
+        GeometryPool::Free(m_geometry_allocation);
+        Animator::RemoveInstance(m_animator_instance);
     }
 
     void Mesh::Clear()
@@ -174,10 +175,10 @@ namespace spartan
 
         // compute memory usage
         {
-            if (m_vertex_buffer && m_index_buffer)
+            if (m_geometry_allocation.IsValid())
             {
-                m_object_size = m_vertex_buffer->GetObjectSize();
-                m_object_size += m_index_buffer->GetObjectSize();
+                m_object_size  = m_vertices.size() * sizeof(RHI_Vertex_PosTexNorTan);
+                m_object_size += m_indices.size() * sizeof(uint32_t);
             }
         }
 
@@ -197,6 +198,31 @@ namespace spartan
         file->Close();
     }
 
+    uint32_t Mesh::GetPoolVertexOffset()
+    {
+        UpdatePoolOffsets();
+        return m_pool_vertex_offset;
+    }
+
+    uint32_t Mesh::GetPoolIndexOffset()
+    {
+        UpdatePoolOffsets();
+        return m_pool_index_offset;
+    }
+
+    void Mesh::UpdatePoolOffsets()
+    {
+        // offsets only change when the pool defragments, so they are cached per pool generation
+        const uint32_t generation = GeometryPool::GetGeneration();
+        if (m_pool_generation == generation)
+            return;
+
+        // read the generation first, if the pool changes in between, the next call refreshes again
+        m_pool_generation    = generation;
+        m_pool_vertex_offset = GeometryPool::GetVertexOffset(m_geometry_allocation);
+        m_pool_index_offset  = GeometryPool::GetIndexOffset(m_geometry_allocation);
+    }
+
     uint32_t Mesh::GetMemoryUsage() const
     {
         uint32_t size  = 0;
@@ -206,11 +232,12 @@ namespace spartan
         return size;
     }
 
-    void Mesh::GetGeometry(uint32_t sub_mesh_index, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices)
+    void Mesh::GetGeometry(uint32_t sub_mesh_index, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices, const uint32_t lod_index)
     {
         SP_ASSERT_MSG(indices != nullptr || vertices != nullptr, "Indices and vertices vectors can't both be null");
 
-        const MeshLod& lod = GetSubMesh(sub_mesh_index).lods[0];
+        const SubMesh& sub_mesh = GetSubMesh(sub_mesh_index);
+        const MeshLod& lod      = sub_mesh.lods[min(lod_index, static_cast<uint32_t>(sub_mesh.lods.size()) - 1)];
 
         if (indices)
         {
@@ -231,26 +258,37 @@ namespace spartan
         }
     }
 
-    void Mesh::AddLod(vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices, const uint32_t sub_mesh_index)
+    void Mesh::AddLod(vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices, const uint32_t sub_mesh_index, const float error, const vector<MeshCluster>* clusters)
     {
         // build lod
         MeshLod lod;
-        lod.vertex_offset = static_cast<uint32_t>(m_vertices.size());
-        lod.vertex_count  = static_cast<uint32_t>(vertices.size());
-        lod.index_offset  = static_cast<uint32_t>(m_indices.size());
-        lod.index_count   = static_cast<uint32_t>(indices.size());
-        lod.aabb          = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
+        if (clusters)
+        {
+            lod.clusters = *clusters;
+        }
+        else
+        {
+            geometry_processing::build_clusters(indices, vertices, lod.clusters); // reorders the indices so that each cluster is contiguous
+        }
+        lod.vertex_count = static_cast<uint32_t>(vertices.size());
+        lod.index_count  = static_cast<uint32_t>(indices.size());
+        lod.aabb         = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
+        lod.error        = error;
 
         // append geometry
         {
             lock_guard lock(m_mutex);
 
+            // the offsets are taken under the lock, other sub-meshes can be appending at the same time
+            lod.vertex_offset = static_cast<uint32_t>(m_vertices.size());
+            lod.index_offset  = static_cast<uint32_t>(m_indices.size());
+
             // append geometry to mesh buffers
             m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
             m_indices.insert(m_indices.end(), indices.begin(), indices.end());
 
             // add lod to the specified sub-mesh
-            m_sub_meshes[sub_mesh_index].lods.push_back(lod);
+            m_sub_meshes[sub_mesh_index].lods.push_back(move(lod));
         }
     }
 
@@ -277,65 +315,120 @@ namespace spartan
         }
     
         // generate additional LODs if requested
-        if (generate_lods && !(m_flags & static_cast<uint32_t>(MeshFlags::PostProcessDontGenerateLods)))
+        if (generate_lods)
+        {
+            GenerateLods(current_sub_mesh_index, vertices, indices);
+        }
+
+        // return the sub-mesh index if requested
+        if (sub_mesh_index)
         {
-            // store the original index count (for reference, but we'll base targets on previous LOD)
-            size_t original_index_count = indices.size();
-            
-            // start with the original geometry for LOD 1 onwards
-            vector<RHI_Vertex_PosTexNorTan> prev_vertices = vertices;
-            vector<uint32_t> prev_indices                 = indices;
-            
-            for (uint32_t lod_level = 1; lod_level < mesh_lod_count; lod_level++)
+            *sub_mesh_index = current_sub_mesh_index;
+        }
+    }
+
+    void Mesh::AddGeometry(vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices, const vector<MeshCluster>& clusters, uint32_t* sub_mesh_index)
+    {
+        uint32_t current_sub_mesh_index = static_cast<uint32_t>(m_sub_meshes.size());
+        m_sub_meshes.emplace_back();
+
+        AddLod(vertices, indices, current_sub_mesh_index, 0.0f, &clusters);
+        m_sub_meshes[current_sub_mesh_index].is_solid = is_solid(*this, current_sub_mesh_index);
+
+        if (sub_mesh_index)
+        {
+            *sub_mesh_index = current_sub_mesh_index;
+        }
+    }
+
+    void Mesh::AddGeometry(vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices, const vector<SkinWeights>& skin_weights, uint32_t* sub_mesh_index)
+    {
+        SP_ASSERT(skin_weights.size() == vertices.size());
+
+        uint32_t current_sub_mesh_index = static_cast<uint32_t>(m_sub_meshes.size());
+        m_sub_meshes.emplace_back();
+
+        // no clusters either, their bounds would only hold for the bind pose
+        const vector<MeshCluster> clusters;
+        AddLod(vertices, indices, current_sub_mesh_index, 0.0f, &clusters);
+        m_sub_meshes[current_sub_mesh_index].is_solid = is_solid(*this, current_sub_mesh_index);
+
+        // the weights go to the same place in their parallel array as the vertices did
+        {
+            lock_guard lock(m_mutex);
+
+            const uint32_t vertex_offset = m_sub_meshes[current_sub_mesh_index].lods[0].vertex_offset;
+            if (m_skin_weights.size() < m_vertices.size())
             {
-                // use the previous LOD's geometry for simplification
-                vector<RHI_Vertex_PosTexNorTan> lod_vertices = prev_vertices;
-                vector<uint32_t> lod_indices                 = prev_indices;
-            
-                // only simplify if the geometry is complex enough
-                if (lod_indices.size() > 64)
-                {
-                    // compute target fraction based on LOD level
-                    float t = static_cast<float>(lod_level) / static_cast<float>(mesh_lod_count);
-                    if (m_lod_dropoff == MeshLodDropoff::Exponential)
-                    {
-                        t = pow(t, 2.0f);
-                    }
-                    float target_fraction = 1.0f - t;
-                    
-                    // compute target index count based on the previous LOD's actual index count
-                    size_t target_index_count = max(static_cast<size_t>(3), static_cast<size_t>(prev_indices.size() * target_fraction));
-            
-                    // simplify geometry
-                    bool preserve_edges = m_flags & static_cast<uint32_t>(MeshFlags::PostProcessPreserveTerrainEdges);
-                    geometry_processing::simplify(lod_indices, lod_vertices, target_index_count, preserve_edges);
-            
-                    // check if simplification reduced the index count; if not, stop
-                    if (lod_indices.size() >= prev_indices.size())
-                        break;
-            
-                    // Add the simplified geometry as a new LOD
-                    AddLod(lod_vertices, lod_indices, current_sub_mesh_index);
-            
-                    // Update previous geometry for the next iteration
-                    prev_vertices = move(lod_vertices);
-                    prev_indices  = move(lod_indices);
-                }
-                else
-                {
-                    // If too simple to simplify further, stop generating LODs
-                    break;
-                }
+                m_skin_weights.resize(m_vertices.size());
             }
+            copy(skin_weights.begin(), skin_weights.end(), m_skin_weights.begin() + vertex_offset);
         }
 
-        // return the sub-mesh index if requested
         if (sub_mesh_index)
         {
             *sub_mesh_index = current_sub_mesh_index;
         }
     }
 
+    void Mesh::SetSkeleton(const shared_ptr<Skeleton>& skeleton)
+    {
+        Animator::RemoveInstance(m_animator_instance);
+        m_animator_instance = skeleton ? Animator::AddInstance(skeleton) : Animator::invalid_instance;
+    }
+
+    void Mesh::GenerateLods(const uint32_t sub_mesh_index, const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<uint32_t>& indices)
+    {
+        if (m_flags & static_cast<uint32_t>(MeshFlags::PostProcessDontGenerateLods))
+            return;
+
+        bool exponential_dropoff = m_lod_dropoff == MeshLodDropoff::Exponential;
+        bool preserve_edges      = m_flags & static_cast<uint32_t>(MeshFlags::PostProcessPreserveTerrainEdges);
+
+        vector<geometry_processing::LodLevel> lods;
+        geometry_processing::build_lod_chain(vertices, indices, mesh_lod_count, exponential_dropoff, preserve_edges, lods);
+
+        for (geometry_processing::LodLevel& lod : lods)
+        {
+            AddLod(lod.vertices, lod.indices, sub_mesh_index, lod.error);
+        }
+    }
+
+    void Mesh::GenerateLods(const vector<uint32_t>& sub_mesh_indices)
+    {
+        // copy lod 0 of every sub-mesh upfront, as the shared buffers will grow (and reallocate) while lods are being added
+        const uint32_t count = static_cast<uint32_t>(sub_mesh_indices.size());
+        vector<vector<uint32_t>> indices(count);
+        vector<vector<RHI_Vertex_PosTexNorTan>> vertices(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            GetGeometry(sub_mesh_indices[i], &indices[i], &vertices[i]);
+        }
+
+        // each sub-mesh only appends to its own lod list (and to the shared buffers under the mutex), so they can be processed independently
+        auto generate = [this, &sub_mesh_indices, &indices, &vertices](uint32_t index_start, uint32_t index_end)
+        {
+            for (uint32_t i = index_start; i < index_end; i++)
+            {
+                GenerateLods(sub_mesh_indices[i], vertices[i], indices[i]);
+
+                // release the copy as soon as possible, large models can have a lot of geometry
+                vector<uint32_t>().swap(indices[i]);
+                vector<RHI_Vertex_PosTexNorTan>().swap(vertices[i]);
+            }
+        };
+
+        // imports call this from a worker, which is fine since the calling thread processes sub-meshes as well instead of only waiting
+        if (count > 1)
+        {
+            ThreadPool::ParallelLoop(generate, count);
+        }
+        else
+        {
+            generate(0, count);
+        }
+    }
+
     uint32_t Mesh::GetVertexCount() const
     {
         return static_cast<uint32_t>(m_vertices.size());
@@ -356,21 +449,28 @@ namespace spartan
 
     void Mesh::CreateGpuBuffers()
     {
-        m_vertex_buffer = make_shared<RHI_Buffer>(RHI_Buffer_Type::Vertex,
-            sizeof(m_vertices[0]),
-            static_cast<uint32_t>(m_vertices.size()),
-            static_cast<void*>(&m_vertices[0]),
-            false,
-            (string("mesh_vertex_buffer_") + m_object_name).c_str()
-        );
-
-        m_index_buffer = make_shared<RHI_Buffer>(RHI_Buffer_Type::Index,
-            sizeof(m_indices[0]),
-            static_cast<uint32_t>(m_indices.size()),
-            static_cast<void*>(&m_indices[0]),
-            false,
-            (string("mesh_index_buffer_") + m_object_name).c_str()
-        );
+        // re-creating (e.g. after adding geometry) releases the previous range of the pool
+        GeometryPool::Free(m_geometry_allocation);
+        m_geometry_allocation = GeometryPool::Allocate(m_vertices, m_indices);
+        m_pool_generation     = UINT32_MAX; // force the offsets to be looked up again
+        UpdatePoolOffsets();
+
+        // skinning reads the bind pose from here, since the pool range is overwritten every frame, the layout is what the skinning
+        // shader expects, the vertex followed by its bones and weights, it's a vertex buffer since those are never padded per element
+        m_skin_source = nullptr;
+        if (!m_skin_weights.empty())
+        {
+            m_skin_weights.resize(m_vertices.size());
+
+            const size_t stride = sizeof(RHI_Vertex_PosTexNorTan) + sizeof(SkinWeights);
+            vector<byte> source(m_vertices.size() * stride);
+            for (size_t i = 0; i < m_vertices.size(); i++)
+            {
+                memcpy(&source[i * stride],                                   &m_vertices[i],     sizeof(RHI_Vertex_PosTexNorTan));
+                memcpy(&source[i * stride + sizeof(RHI_Vertex_PosTexNorTan)], &m_skin_weights[i], sizeof(SkinWeights));
+            }
+            m_skin_source = make_shared<RHI_Buffer>(RHI_Buffer_Type::Vertex, stride, static_cast<uint32_t>(m_vertices.size()), source.data(), false, "skin_source");
+        }
 
         // normalize scale
         if (m_flags & static_cast<uint32_t>(MeshFlags::PostProcessNormalizeScale))
@@ -21,13 +21,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES =========================
 #include <vector>
 #include <mutex>
 #include "../RHI/RHI_Vertex.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
-//================================
+#include "../Geometry/GeometryCulling.h"
+#include "GeometryPool.h"
+#include "Animation.h"
+//====================================
 
 namespace spartan
 {
@@ -68,6 +71,8 @@ namespace spartan
         uint32_t index_offset;  // starting offset in m_indices
         uint32_t index_count;   // number of indices for this LOD
         math::BoundingBox aabb; // bounding box of this LOD
+        float error = 0.0f;     // object space simplification error relative to LOD 0, used for screen space error LOD selection
+        std::vector<MeshCluster> clusters; // meshlets of this LOD, only present for large meshes (see mesh_cluster_min_index_count)
     };
     static const uint32_t mesh_lod_count = 5;
 
@@ -89,10 +94,13 @@ namespace spartan
 
         // geometry
         void Clear();
-        void GetGeometry(uint32_t sub_mesh_index, std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices);
+        void GetGeometry(uint32_t sub_mesh_index, std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices, const uint32_t lod_index = 0);
         uint32_t GetMemoryUsage() const;
-        void AddLod(std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<uint32_t>& indices, const uint32_t sub_mesh_index);
+        void AddLod(std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<uint32_t>& indices, const uint32_t sub_mesh_index, const float error = 0.0f, const std::vector<MeshCluster>* clusters = nullptr);
         void AddGeometry(std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<uint32_t>& indices, const bool generate_lods, uint32_t* sub_mesh_index = nullptr);
+        void AddGeometry(std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<uint32_t>& indices, const std::vector<MeshCluster>& clusters, uint32_t* sub_mesh_index = nullptr); // clusters are provided (e.g. the parts of a static batch), the index order is kept and no lods are generated
+        void AddGeometry(std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<uint32_t>& indices, const std::vector<SkinWeights>& skin_weights, uint32_t* sub_mesh_index = nullptr); // skinned, the vertex order is kept so that the weights line up and no lods are generated
+        void GenerateLods(const std::vector<uint32_t>& sub_mesh_indices); // generates the lods of many sub-meshes in parallel
         std::vector<RHI_Vertex_PosTexNorTan>& GetVertices()   { return m_vertices; }
         std::vector<uint32_t>& GetIndices()                   { return m_indices; }
         const SubMesh& GetSubMesh(const uint32_t index) const { return m_sub_meshes[index]; }
@@ -106,10 +114,18 @@ namespace spartan
         uint32_t GetVertexCount() const;
         uint32_t GetIndexCount() const;
 
-        // gpu buffers
+        // gpu buffers, the geometry lives in the shared geometry pool
         void CreateGpuBuffers();
-        RHI_Buffer* GetIndexBuffer()  { return m_index_buffer.get();  }
-        RHI_Buffer* GetVertexBuffer() { return m_vertex_buffer.get(); }
+        RHI_Buffer* GetIndexBuffer()  { return GeometryPool::GetIndexBuffer();  }
+        RHI_Buffer* GetVertexBuffer() { return GeometryPool::GetVertexBuffer(); }
+        uint32_t GetPoolVertexOffset(); // where m_vertices starts in the pool vertex buffer
+        uint32_t GetPoolIndexOffset();  // where m_indices starts in the pool index buffer
+
+        // skinning, the vertices are deformed on the gpu every frame, in place in the geometry pool, by an animator instance
+        void SetSkeleton(const std::shared_ptr<Skeleton>& skeleton);
+        bool IsSkinned() const                  { return m_animator_instance != UINT32_MAX; }
+        uint32_t GetAnimatorInstance() const    { return m_animator_instance; }
+        RHI_Buffer* GetSkinSourceBuffer() const { return m_skin_source.get(); }
 
         // root entity
         std::weak_ptr<Entity> GetRootEntity() { return m_root_entity; }
@@ -124,14 +140,24 @@ namespace spartan
         static uint32_t GetDefaultFlags();
 
     private:
+        void GenerateLods(const uint32_t sub_mesh_index, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, const std::vector<uint32_t>& indices);
+
         // geometry
         std::vector<RHI_Vertex_PosTexNorTan> m_vertices; // all vertices of a model file
         std::vector<uint32_t> m_indices;                 // all indices of a model file
         std::vector<SubMesh> m_sub_meshes;               // tracks sub-meshes and lods within the above vectors
 
         // gpu buffers
-        std::shared_ptr<RHI_Buffer> m_vertex_buffer;
-        std::shared_ptr<RHI_Buffer> m_index_buffer;
+        void UpdatePoolOffsets();
+        GeometryAllocation m_geometry_allocation;
+        uint32_t m_pool_vertex_offset = 0;
+        uint32_t m_pool_index_offset  = 0;
+        uint32_t m_pool_generation    = UINT32_MAX;
+
+        // skinning
+        std::vector<SkinWeights> m_skin_weights; // parallel to m_vertices, empty if nothing is skinned
+        std::shared_ptr<RHI_Buffer> m_skin_source;
+        uint32_t m_animator_instance = UINT32_MAX;
 
         // misc
         std::mutex m_mutex;
@@ -24,6 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderer.h"
 #include "Material.h"
 #include "ThreadPool.h"
+#include "GeometryPool.h"
+#include "Animator.h"
+#include "TextureStreaming.h"
 #include "../Profiling/RenderDoc.h"
 #include "../Profiling/Profiler.h"
 #include "../Core/Debugging.h"
@@ -161,6 +164,7 @@ namespace spartan
             SetOption(Renderer_Option::PerformanceMetrics,          1.0f);
             SetOption(Renderer_Option::Dithering,                   0.0f);
             SetOption(Renderer_Option::Gamma,                       Display::GetGamma());
+            SetOption(Renderer_Option::TextureStreamingBudget,      RHI_Device::GetPrimaryPhysicalDevice()->GetMemory() * 0.5f); // in mb, the memory streamed textures can take on the gpu
 
             SetWind(Vector3(1.0f, 0.0f, 0.5f) * 2.5f);
         }
@@ -252,8 +256,8 @@ namespace spartan
         {
             // subscribe
             SP_SUBSCRIBE_TO_EVENT(EventType::WindowFullScreenToggled, SP_EVENT_HANDLER_STATIC(OnFullScreenToggled));
-            SP_SUBSCRIBE_TO_EVENT(EventType::MaterialOnChanged,       SP_EVENT_HANDLER_EXPRESSION_STATIC( m_bindless_materials_dirty = true; ));
-            SP_SUBSCRIBE_TO_EVENT(EventType::LightOnChanged,          SP_EVENT_HANDLER_EXPRESSION_STATIC( m_bindless_lights_dirty    = true; ));
+            SP_SUBSCRIBE_TO_EVENT_MAIN_THREAD(EventType::MaterialOnChanged, SP_EVENT_HANDLER_EXPRESSION_STATIC( m_bindless_materials_dirty = true; ));
+            SP_SUBSCRIBE_TO_EVENT_MAIN_THREAD(EventType::LightOnChanged,    SP_EVENT_HANDLER_EXPRESSION_STATIC( m_bindless_lights_dirty    = true; ));
 
             // fire
             SP_FIRE_EVENT(EventType::RendererOnInitialized);
@@ -270,6 +274,9 @@ namespace spartan
         // manually destroy everything so that RHI_Device::ParseDeletionQueue() frees memory
         {
             DestroyResources();
+            GeometryPool::Shutdown();
+            TextureStreaming::Shutdown();
+            Animator::Shutdown();
             swapchain             = nullptr;
             m_lines_vertex_buffer = nullptr;
         }
@@ -293,6 +300,10 @@ namespace spartan
         m_cmd_list_present        = queue_graphics->NextCommandList();
         m_cmd_list_present->Begin();
 
+        // after waiting for the command list (so retired geometry is no longer in use) and before any draws are recorded (since it can move geometry around)
+        GeometryPool::Tick();
+        Animator::Tick();
+
         // begin the secondary/compute command list
         //RHI_Queue* queue_compute          = RHI_Device::GetQueue(RHI_Queue_Type::Compute);
         //RHI_CommandList* cmd_list_compute = queue_compute->NextCommandList();
@@ -301,6 +312,12 @@ namespace spartan
         // build draw calls and determine occluders
         BuildDrawCallsAndOccluders(m_cmd_list_present);
 
+        // stream texture mips in and out, based on what the draw calls need (before the bindless textures are updated)
+        if (TextureStreaming::Tick())
+        {
+            m_bindless_materials_dirty = true;
+        }
+
         // update GPU buffers (needs to happen after draw call and occluder building)
         UpdateBuffers(m_cmd_list_present);
 
@@ -786,14 +803,14 @@ namespace spartan
 
     void Renderer::SubmitAndPresent()
     {
-        Profiler::TimeBlockStart("submit_and_present", TimeBlockType::Cpu, nullptr);
+        SP_PROFILE_CPU_START("submit_and_present");
         {
             SP_ASSERT(m_cmd_list_present->GetState() == RHI_CommandListState::Recording);
-            m_cmd_list_present->InsertBarrier(swapchain->GetRhiRt(), swapchain->GetFormat(), 0, 1, 1, RHI_Image_Layout::Present_Source);
+            m_cmd_list_present->InsertBarrier(swapchain.get(), RHI_Image_Layout::Present_Source);
             m_cmd_list_present->Submit(swapchain->GetImageAcquiredSemaphore(), false);
             swapchain->Present(m_cmd_list_present);
         }
-        Profiler::TimeBlockEnd();
+        SP_PROFILE_CPU_END();
     }
 
     RHI_Api_Type Renderer::GetRhiApiType()
@@ -1081,6 +1098,8 @@ namespace spartan
                         {
                             m_transparents_present = true;
                         }
+
+                        TextureStreaming::Request(renderable->GetMaterial(), renderable->GetProjectedSize());
                 
                         if (renderable->HasInstancing())
                         {
@@ -1100,7 +1119,7 @@ namespace spartan
                                 SP_ASSERT_MSG(instance_index < buffer_instance_count,                   "instance start index exceeds instance buffer capacity");
                                 SP_ASSERT_MSG(instance_index + instance_count <= buffer_instance_count, "instance range exceeds instance buffer capacity");
                                 
-                                if (instance_count == 0)
+                                if (instance_count == 0 || renderable->IsHidden(group_index))
                                     continue;
                                 
                                 Renderer_DrawCall& draw_call   = m_draw_calls[m_draw_call_count++];
@@ -1114,7 +1133,7 @@ namespace spartan
                                 draw_call.camera_visible       = renderable->IsVisible(group_index);
                             }
                         }
-                        else
+                        else if (!renderable->IsHidden())
                         {
                             Renderer_DrawCall& draw_call = m_draw_calls[m_draw_call_count++];
                             draw_call.renderable         = renderable;
@@ -66,6 +66,7 @@ namespace spartan
         VariableRateShading,
         ResolutionScale,
         DynamicResolution,
+        TextureStreamingBudget,
         Max
     };
 
@@ -132,15 +133,18 @@ namespace spartan
 
     enum class Renderer_BindingsUav
     {
-        tex         = 0,
-        tex2        = 1,
-        tex3        = 2,
-        tex4        = 3,
-        tex3d       = 4,
-        tex_sss     = 5,
-        visibility  = 6,
-        sb_spd      = 7,
-        tex_spd     = 8,
+        tex           = 0,
+        tex2          = 1,
+        tex3          = 2,
+        tex4          = 3,
+        tex3d         = 4,
+        tex_sss       = 5,
+        visibility    = 6,
+        sb_spd        = 7,
+        tex_spd       = 8, // an array of 12, so it takes up to 19
+        skin_source   = 20,
+        skin_palettes = 21,
+        skin_output   = 22,
     };
 
     enum class Renderer_Shader : uint8_t
@@ -193,6 +197,7 @@ namespace spartan
         icon_c,
         dithering_c,
         transparency_reflection_refraction_c,
+        skinning_c,
         max
     };
     
@@ -31,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_Buffer.h"
 #include "../RHI/RHI_Shader.h"
 #include "../Rendering/Material.h"
+#include "../Rendering/Animator.h"
 #include "../RHI/RHI_VendorTechnology.h"
 #include "../RHI/RHI_RasterizerState.h"
 #include "../Game/Game.h"
@@ -47,6 +48,36 @@ using namespace spartan::math;
 
 namespace spartan
 {
+    namespace
+    {
+        void draw_renderable(RHI_CommandList* cmd_list, const Renderer_DrawCall& draw_call)
+        {
+            Renderable* renderable = draw_call.renderable;
+
+            // large meshes only draw the clusters which survived culling
+            // the ranges are relative to the mesh, so they stay valid when the geometry pool moves it
+            if (const vector<MeshIndexRange>* ranges = renderable->GetClusterIndexRanges(draw_call.lod_index))
+            {
+                const uint32_t index_offset_pool = renderable->GetMesh()->GetPoolIndexOffset();
+                const uint32_t vertex_offset     = renderable->GetVertexOffset(draw_call.lod_index);
+                for (const MeshIndexRange& range : *ranges)
+                {
+                    cmd_list->DrawIndexed(range.index_count, range.index_offset + index_offset_pool, vertex_offset);
+                }
+
+                return;
+            }
+
+            cmd_list->DrawIndexed(
+                renderable->GetIndexCount(draw_call.lod_index),
+                renderable->GetIndexOffset(draw_call.lod_index),
+                renderable->GetVertexOffset(draw_call.lod_index),
+                renderable->HasInstancing() ? draw_call.instance_index : 0,
+                renderable->HasInstancing() ? draw_call.instance_count : 1
+            );
+        }
+    }
+
     array<Renderer_DrawCall, renderer_max_entities> Renderer::m_draw_calls;
     uint32_t Renderer::m_draw_call_count;
 
@@ -90,6 +121,9 @@ namespace spartan
         {
             Pass_VariableRateShading(cmd_list_graphics_present);
 
+            // deform skinned meshes before anything draws them
+            Pass_Skinning(cmd_list_graphics_present);
+
             // opaques
             {
                 bool is_transparent = false;
@@ -246,6 +280,10 @@ namespace spartan
                         // draw
                         {
                             cmd_list->SetCullMode(static_cast<RHI_CullMode>(material->GetProperty(MaterialProperty::CullMode)));
+                            if (RHI_Texture* texture = renderable->GetTerrainTexture())
+                            {
+                                cmd_list->SetTexture(Renderer_BindingsSrv::tex, texture); // terrain patches read their heights in the vertex shader
+                            }
                             cmd_list->SetBufferVertex(renderable->GetVertexBuffer(), renderable->GetInstanceBuffer());
                             cmd_list->SetBufferIndex(renderable->GetIndexBuffer());
 
@@ -395,6 +433,61 @@ namespace spartan
         }
     }
 
+    void Renderer::Pass_Skinning(RHI_CommandList* cmd_list)
+    {
+        // every skinned mesh is deformed once, no matter how many renderables draw it
+        static vector<Mesh*> meshes;
+        meshes.clear();
+        for (uint32_t i = 0; i < m_draw_call_count; i++)
+        {
+            Mesh* mesh = m_draw_calls[i].renderable->GetMesh();
+            if (mesh && mesh->IsSkinned() && mesh->GetSkinSourceBuffer() && find(meshes.begin(), meshes.end(), mesh) == meshes.end())
+            {
+                meshes.push_back(mesh);
+            }
+        }
+
+        RHI_Buffer* palettes      = Animator::GetPaletteBuffer();
+        RHI_Buffer* vertex_buffer = GeometryPool::GetVertexBuffer();
+        if (meshes.empty() || !palettes || !vertex_buffer)
+            return;
+
+        cmd_list->BeginTimeblock("skinning");
+        {
+            // the previous frame's draws have to be done reading the vertices
+            cmd_list->InsertBarrierReadWrite(vertex_buffer);
+
+            RHI_PipelineState pso;
+            pso.name             = "skinning";
+            pso.shaders[Compute] = GetShader(Renderer_Shader::skinning_c);
+            cmd_list->SetPipelineState(pso);
+
+            cmd_list->SetBuffer(Renderer_BindingsUav::skin_palettes, palettes);
+            cmd_list->SetBuffer(Renderer_BindingsUav::skin_output,   vertex_buffer);
+            for (Mesh* mesh : meshes)
+            {
+                // instances that were added this frame have no palette until the animator's next tick
+                const uint32_t palette_offset = Animator::GetPaletteOffset(mesh->GetAnimatorInstance());
+                if (palette_offset == Animator::invalid_instance)
+                    continue;
+
+                // passed as raw bits, since offsets into a pool that big don't survive a conversion to float
+                const uint32_t vertex_count  = mesh->GetVertexCount();
+                const uint32_t vertex_offset = mesh->GetPoolVertexOffset();
+                m_pcb_pass_cpu.set_f4_value(*reinterpret_cast<const float*>(&vertex_count), *reinterpret_cast<const float*>(&vertex_offset), *reinterpret_cast<const float*>(&palette_offset), 0.0f);
+                cmd_list->PushConstants(m_pcb_pass_cpu);
+                cmd_list->SetBuffer(Renderer_BindingsUav::skin_source, mesh->GetSkinSourceBuffer());
+
+                // dispatch: ceil(vertex_count / 256) thread groups
+                cmd_list->Dispatch((vertex_count + 255) / 256, 1, 1);
+            }
+
+            // and the draws of this frame have to see the deformed vertices
+            cmd_list->InsertBarrierReadWrite(vertex_buffer);
+        }
+        cmd_list->EndTimeblock();
+    }
+
     void Renderer::Pass_Depth_Prepass(RHI_CommandList* cmd_list)
     {
         // acquire resources
@@ -460,16 +553,13 @@ namespace spartan
                     RHI_CullMode cull_mode = static_cast<RHI_CullMode>(material->GetProperty(MaterialProperty::CullMode));
                     cull_mode              = (pso.rasterizer_state->GetPolygonMode() == RHI_PolygonMode::Wireframe) ? RHI_CullMode::None : cull_mode;
                     cmd_list->SetCullMode(cull_mode);
+                    if (RHI_Texture* texture = renderable->GetTerrainTexture())
+                    {
+                        cmd_list->SetTexture(Renderer_BindingsSrv::tex, texture); // terrain patches read their heights in the vertex shader
+                    }
                     cmd_list->SetBufferVertex(renderable->GetVertexBuffer(), renderable->GetInstanceBuffer());
                     cmd_list->SetBufferIndex(renderable->GetIndexBuffer());
-
-                    cmd_list->DrawIndexed(
-                        renderable->GetIndexCount(draw_call.lod_index),
-                        renderable->GetIndexOffset(draw_call.lod_index),
-                        renderable->GetVertexOffset(draw_call.lod_index),
-                        renderable->HasInstancing() ? draw_call.instance_index : 0,
-                        renderable->HasInstancing() ? draw_call.instance_count : 1
-                    );
+                    draw_renderable(cmd_list, draw_call);
 
                     // at this point, we don't want clear in case another render pass is implicitly started
                     pso.clear_depth = rhi_depth_load;
@@ -558,16 +648,13 @@ namespace spartan
                 // draw
                 {
                     cmd_list->SetCullMode(GetOption<bool>(Renderer_Option::Wireframe) ? RHI_CullMode::None : static_cast<RHI_CullMode>(material->GetProperty(MaterialProperty::CullMode)));
+                    if (RHI_Texture* texture = renderable->GetTerrainTexture())
+                    {
+                        cmd_list->SetTexture(Renderer_BindingsSrv::tex, texture); // terrain patches read their heights in the vertex shader
+                    }
                     cmd_list->SetBufferVertex(renderable->GetVertexBuffer(), renderable->GetInstanceBuffer());
                     cmd_list->SetBufferIndex(renderable->GetIndexBuffer());
-    
-                    cmd_list->DrawIndexed(
-                        renderable->GetIndexCount(draw_call.lod_index),
-                        renderable->GetIndexOffset(draw_call.lod_index),
-                        renderable->GetVertexOffset(draw_call.lod_index),
-                        renderable->HasInstancing() ? draw_call.instance_index : 0,
-                        renderable->HasInstancing() ? draw_call.instance_count : 1
-                    );
+                    draw_renderable(cmd_list, draw_call);
 
                     // at this point, we don't want clear in case another render pass is implicitly started
                     pso.clear_depth = rhi_depth_load;
@@ -1066,7 +1153,7 @@ namespace spartan
             cmd_list->Dispatch(tex_lut_brdf_specular);
 
             // for the lifetime of the engine, this will be read as an srv, so transition here
-            cmd_list->InsertBarrier(tex_lut_brdf_specular->GetRhiResource(), tex_lut_brdf_specular->GetFormat(), 0, 1, 1, RHI_Image_Layout::Shader_Read);
+            cmd_list->InsertBarrier(tex_lut_brdf_specular, 0, 1, 1, RHI_Image_Layout::Shader_Read);
         }
         cmd_list->EndTimeblock();
     }
@@ -1087,7 +1174,7 @@ namespace spartan
             cmd_list->Dispatch(tex_lut_atmosphere_scatter);
         
             // for the lifetime of the engine, this will be read as an srv, so transition here
-            cmd_list->InsertBarrier(tex_lut_atmosphere_scatter->GetRhiResource(), tex_lut_atmosphere_scatter->GetFormat(), 0, 1, tex_lut_atmosphere_scatter->GetDepth(), RHI_Image_Layout::Shader_Read);
+            cmd_list->InsertBarrier(tex_lut_atmosphere_scatter, 0, 1, tex_lut_atmosphere_scatter->GetDepth(), RHI_Image_Layout::Shader_Read);
         }
         cmd_list->EndTimeblock();
     }
@@ -1746,7 +1833,7 @@ namespace spartan
 
                     // this is to avoid out of order UAV access and flickering overlapping icons
                     // ideally, we batch all the icons in one buffer and do a single dispatch, but for now this works
-                    cmd_list->InsertBarrier(texture->GetRhiResource(), texture->GetFormat(), 0, 1, 1, texture->GetLayout(0));
+                    cmd_list->InsertBarrier(texture, 0, 1, 1, texture->GetLayout(0));
                 };
 
                 // dispatch all icons in m_icons
@@ -1801,9 +1888,10 @@ namespace spartan
         }
 
         cmd_list->SetCullMode(RHI_CullMode::Back);
-        cmd_list->SetBufferVertex(GetStandardMesh(MeshType::Quad)->GetVertexBuffer());
-        cmd_list->SetBufferIndex(GetStandardMesh(MeshType::Quad)->GetIndexBuffer());
-        cmd_list->DrawIndexed(6);
+        Mesh* mesh_quad = GetStandardMesh(MeshType::Quad).get();
+        cmd_list->SetBufferVertex(mesh_quad->GetVertexBuffer());
+        cmd_list->SetBufferIndex(mesh_quad->GetIndexBuffer());
+        cmd_list->DrawIndexed(6, mesh_quad->GetPoolIndexOffset(), mesh_quad->GetPoolVertexOffset());
 
         cmd_list->EndTimeblock();
     }
@@ -1943,7 +2031,7 @@ namespace spartan
 
         cmd_list->BeginTimeblock("text");
 
-        font->UpdateVertexAndIndexBuffers(cmd_list);
+        font->UpdateVertexAndIndexBuffers();
 
         // define pipeline state
         RHI_PipelineState pso;
@@ -1962,20 +2050,40 @@ namespace spartan
         cmd_list->SetBufferIndex(font->GetIndexBuffer());
         cmd_list->SetCullMode(RHI_CullMode::Back);
 
+        cmd_list->SetTexture(Renderer_BindingsSrv::tex, font->GetAtlas().get());
+
+        // the atlas is a distance field (0.5 is the edge), so both passes are bands of distance
+        const float distance_max = 2.0f; // above any value the atlas can hold
+        float inline_min         = 0.5f;
+
         // draw outline
-        if (font->GetOutline() != Font_Outline_None && font->GetOutlineSize() != 0)
+        const float outline = font->GetOutline() != Font_Outline_None ? font->GetOutlineWidthDistance() : 0.0f;
+        if (outline > 0.0f)
         {
+            float outline_min = 0.5f - outline; // positive, grows outwards
+            float outline_max = distance_max;
+            if (font->GetOutline() == Font_Outline_Edge)
+            {
+                outline_min = 0.5f - outline * 0.5f;
+                inline_min  = 0.5f + outline * 0.5f;
+            }
+            else if (font->GetOutline() == Font_Outline_Negative)
+            {
+                outline_min = 0.5f;
+                inline_min  = 0.5f + outline;
+            }
+
             m_pcb_pass_cpu.set_f4_value(font->GetColorOutline());
+            m_pcb_pass_cpu.set_f3_value(outline_min, outline_max);
             cmd_list->PushConstants(m_pcb_pass_cpu);
-            cmd_list->SetTexture(Renderer_BindingsSrv::tex, font->GetAtlasOutline().get());
             cmd_list->DrawIndexed(font->GetIndexCount());
         }
 
         // draw inline
         {
             m_pcb_pass_cpu.set_f4_value(font->GetColor());
+            m_pcb_pass_cpu.set_f3_value(inline_min, distance_max);
             cmd_list->PushConstants(m_pcb_pass_cpu);
-            cmd_list->SetTexture(Renderer_BindingsSrv::tex, font->GetAtlas().get());
             cmd_list->DrawIndexed(font->GetIndexCount());
         }
 
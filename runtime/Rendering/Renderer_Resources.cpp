@@ -497,6 +497,10 @@ namespace spartan
         // dithering
         shader(Renderer_Shader::transparency_reflection_refraction_c) = make_shared<RHI_Shader>();
         shader(Renderer_Shader::transparency_reflection_refraction_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "transparency_reflection_refraction.hlsl", async);
+
+        // skinning
+        shader(Renderer_Shader::skinning_c) = make_shared<RHI_Shader>();
+        shader(Renderer_Shader::skinning_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "skinning.hlsl", async);
     }
 
     void Renderer::CreateFonts()
@@ -0,0 +1,240 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======================
+#include "pch.h"
+#include "TextureStreaming.h"
+#include "Renderer.h"
+#include "Material.h"
+#include "../RHI/RHI_Texture.h"
+#include "../Core/ThreadPool.h"
+#include "../Core/ProgressTracker.h"
+#include "../Resource/ResourceCache.h"
+//==================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        // a resource with a different set of mips, being created for a texture, usually on a worker thread
+        struct Staging
+        {
+            uint32_t mip = 0;
+            shared_ptr<RHI_Texture> staged;
+            bool done    = false;
+            future<void> task;
+        };
+
+        TextureResidency residency;
+        unordered_map<uint64_t, RHI_Texture*> textures;
+        unordered_map<uint64_t, uint32_t> mips_wanted; // residency changes which wait for the texture's current staging
+        unordered_map<uint64_t, Staging> stagings;
+        vector<TextureResidency::Change> changes;
+        mutex streaming_mutex; // textures register from loading threads and can be destroyed on any thread
+
+        void stage(RHI_Texture* texture_raw, const uint32_t mip)
+        {
+            const uint64_t id = texture_raw->GetObjectId();
+            Staging& staging  = stagings[id];
+            staging.mip       = mip;
+
+            // a texture which isn't cached has nothing to keep it alive off this thread, so it's staged right here
+            shared_ptr<RHI_Texture> texture = static_pointer_cast<RHI_Texture>(ResourceCache::GetById(id));
+            if (!texture)
+            {
+                staging.staged = texture_raw->StageResidentMip(mip);
+                staging.done   = true;
+                return;
+            }
+
+            // the task owns the only extra reference, so the texture can't be released while the mutex is held
+            staging.task = ThreadPool::AddTask([id, mip, texture = move(texture)]()
+            {
+                shared_ptr<RHI_Texture> staged = texture->StageResidentMip(mip);
+
+                lock_guard<mutex> lock(streaming_mutex);
+                auto it = stagings.find(id);
+                if (it != stagings.end())
+                {
+                    it->second.staged = move(staged);
+                    it->second.done   = true;
+                }
+            });
+        }
+    }
+
+    bool TextureStreaming::Tick()
+    {
+        // while loading, the bindless textures aren't updated, so they would keep pointing to the views of replaced resources
+        if (ProgressTracker::IsLoading())
+            return false;
+
+        lock_guard<mutex> lock(streaming_mutex);
+
+        // take over the resources which are ready
+        bool applied = false;
+        for (auto it = stagings.begin(); it != stagings.end();)
+        {
+            if (!it->second.done)
+            {
+                ++it;
+                continue;
+            }
+
+            auto it_texture = textures.find(it->first);
+            if (it_texture != textures.end())
+            {
+                if (it->second.staged)
+                {
+                    it_texture->second->ApplyResidentMip(it->second.staged.get(), it->second.mip);
+                    applied = true;
+                }
+                else
+                {
+                    // the residency thinks the mip is resident, so the texture stops streaming rather than go out of sync
+                    residency.Unregister(it->first);
+                    mips_wanted.erase(it->first);
+                    textures.erase(it_texture);
+                }
+            }
+
+            it = stagings.erase(it);
+        }
+
+        residency.SetBudget(static_cast<uint64_t>(Renderer::GetOption<float>(Renderer_Option::TextureStreamingBudget)) * 1024 * 1024);
+        residency.Update(changes);
+        for (const TextureResidency::Change& change : changes)
+        {
+            mips_wanted[change.id] = change.mip_to;
+        }
+
+        // a texture is staged once at a time, later changes wait for it and only the latest one is kept
+        for (auto it = mips_wanted.begin(); it != mips_wanted.end();)
+        {
+            if (stagings.count(it->first) != 0)
+            {
+                ++it;
+                continue;
+            }
+
+            auto it_texture = textures.find(it->first);
+            if (it_texture != textures.end() && it_texture->second->GetResidentMip() != it->second)
+            {
+                stage(it_texture->second, it->second);
+            }
+
+            it = mips_wanted.erase(it);
+        }
+
+        return applied;
+    }
+
+    void TextureStreaming::Shutdown()
+    {
+        vector<future<void>> tasks;
+        {
+            lock_guard<mutex> lock(streaming_mutex);
+
+            for (auto& [id, staging] : stagings)
+            {
+                tasks.push_back(move(staging.task));
+            }
+        }
+
+        // the tasks lock the mutex once they are done
+        for (future<void>& task : tasks)
+        {
+            if (task.valid())
+            {
+                task.wait();
+            }
+        }
+
+        lock_guard<mutex> lock(streaming_mutex);
+        for (const auto& [id, texture] : textures)
+        {
+            residency.Unregister(id);
+        }
+        textures.clear();
+        mips_wanted.clear();
+        stagings.clear();
+    }
+
+    void TextureStreaming::Register(RHI_Texture* texture)
+    {
+        lock_guard<mutex> lock(streaming_mutex);
+
+        textures[texture->GetObjectId()] = texture;
+        residency.Register(texture->GetObjectId(), texture->GetStreamedMipSizes(), texture->GetResidentMip());
+    }
+
+    void TextureStreaming::Unregister(RHI_Texture* texture)
+    {
+        lock_guard<mutex> lock(streaming_mutex);
+
+        textures.erase(texture->GetObjectId());
+        mips_wanted.erase(texture->GetObjectId());
+        stagings.erase(texture->GetObjectId());
+        residency.Unregister(texture->GetObjectId());
+    }
+
+    void TextureStreaming::Request(Material* material, const float projected_size)
+    {
+        if (!material || projected_size <= 0.0f)
+            return;
+
+        // the uv span of a mesh isn't known, so a texture is assumed to cover the renderable once per tile, world space
+        // uvs tile per meter rather than across the renderable, so they are requested at full detail
+        const bool world_space_uv = material->GetProperty(MaterialProperty::WorldSpaceUv) != 0.0f;
+        const float tiling        = max(material->GetProperty(MaterialProperty::TextureTilingX), material->GetProperty(MaterialProperty::TextureTilingY));
+
+        lock_guard<mutex> lock(streaming_mutex);
+
+        for (uint32_t type = 0; type < static_cast<uint32_t>(MaterialTextureType::Max); type++)
+        {
+            for (uint8_t slot = 0; slot < Material::slots_per_texture_type; slot++)
+            {
+                RHI_Texture* texture = material->GetTexture(static_cast<MaterialTextureType>(type), slot);
+                if (!texture || !texture->IsStreamed())
+                    continue;
+
+                const uint32_t mip = world_space_uv ? 0 : TextureResidency::ComputeMip(
+                    texture->GetStreamedWidth(),
+                    texture->GetStreamedHeight(),
+                    texture->GetStreamedMipCount(),
+                    projected_size,
+                    tiling
+                );
+                residency.Request(texture->GetObjectId(), mip);
+            }
+        }
+    }
+
+    TextureResidency::Stats TextureStreaming::GetStats()
+    {
+        lock_guard<mutex> lock(streaming_mutex);
+        return residency.GetStats();
+    }
+}
@@ -0,0 +1,325 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+//=====================
+
+namespace spartan
+{
+    // decides which mips of streamed textures are resident on the gpu, under a memory budget, it's pure cpu logic
+    // that identifies textures by id and only knows the size of their mips, so it can be driven without a device
+    // - the tail mips (the ones up to tail_size) are always resident
+    // - every frame, each texture is requested at the most detailed mip it's seen at, the most detailed request wins
+    // - detail which isn't needed anymore stays resident until the memory is needed, least recently requested first
+    class TextureResidency
+    {
+    public:
+        static constexpr uint32_t tail_size_default = 128;
+        static constexpr uint32_t no_request        = UINT32_MAX;
+
+        // the resident mip of a texture changed, a lower mip is more detail
+        struct Change
+        {
+            uint64_t id       = 0;
+            uint32_t mip_from = 0;
+            uint32_t mip_to   = 0;
+        };
+
+        struct Stats
+        {
+            uint64_t budget         = 0;
+            uint64_t resident       = 0;
+            uint64_t resident_tails = 0; // the part of resident which can't be evicted
+            uint64_t wanted         = 0; // what would be resident if every request of the last update was honored
+            uint32_t texture_count  = 0;
+            uint32_t upgrades       = 0; // in the last update
+            uint32_t downgrades     = 0; // in the last update
+        };
+
+        // the first mip whose largest side is at most tail_size
+        static uint32_t ComputeTailMip(const uint32_t width, const uint32_t height, const uint32_t mip_count, const uint32_t tail_size = tail_size_default)
+        {
+            uint32_t mip = 0;
+            while (mip + 1 < mip_count && std::max(width >> mip, height >> mip) > tail_size)
+            {
+                mip++;
+            }
+
+            return mip;
+        }
+
+        // the mip which gives about one texel per pixel, for a texture repeated tiling times across projected_size pixels
+        static uint32_t ComputeMip(const uint32_t width, const uint32_t height, const uint32_t mip_count, const float projected_size, const float tiling = 1.0f)
+        {
+            if (mip_count == 0)
+                return 0;
+
+            if (projected_size <= 0.0f)
+                return mip_count - 1;
+
+            // rounded down, so a texture is never sampled at less than a texel per pixel
+            const float texels_per_pixel = static_cast<float>(std::max(width, height)) * std::max(tiling, 0.0f) / projected_size;
+            const float mip              = texels_per_pixel > 1.0f ? std::floor(std::log2(texels_per_pixel)) : 0.0f;
+
+            return std::min(static_cast<uint32_t>(mip), mip_count - 1);
+        }
+
+        // mip_sizes holds the size (in bytes) of every mip, returns the mip the texture starts at (its tail)
+        uint32_t Register(const uint64_t id, const std::vector<uint64_t>& mip_sizes, const uint32_t mip_tail)
+        {
+            Unregister(id);
+
+            Texture& texture = m_textures[id];
+            texture.size_from.resize(mip_sizes.size() + 1, 0);
+            for (size_t i = mip_sizes.size(); i > 0; i--)
+            {
+                texture.size_from[i - 1] = texture.size_from[i] + mip_sizes[i - 1];
+            }
+            texture.mip_tail     = std::min(mip_tail, static_cast<uint32_t>(mip_sizes.size()) - 1);
+            texture.mip_resident = texture.mip_tail;
+
+            m_resident       += texture.size(texture.mip_resident);
+            m_resident_tails += texture.size(texture.mip_tail);
+
+            return texture.mip_resident;
+        }
+
+        void Unregister(const uint64_t id)
+        {
+            auto it = m_textures.find(id);
+            if (it == m_textures.end())
+                return;
+
+            m_resident       -= it->second.size(it->second.mip_resident);
+            m_resident_tails -= it->second.size(it->second.mip_tail);
+            m_textures.erase(it);
+        }
+
+        // asks for the texture to be resident at (at least) the given mip, until the next update
+        void Request(const uint64_t id, const uint32_t mip)
+        {
+            auto it = m_textures.find(id);
+            if (it == m_textures.end())
+                return;
+
+            Texture& texture      = it->second;
+            texture.mip_requested = std::min(std::min(texture.mip_requested, mip), texture.mip_tail);
+            texture.frame_used    = m_frame;
+        }
+
+        // resolves the requests since the last update into residency changes, within the budget and the upload limit
+        void Update(std::vector<Change>& changes)
+        {
+            changes.clear();
+            m_stats.upgrades   = 0;
+            m_stats.downgrades = 0;
+            m_stats.wanted     = 0;
+
+            // textures which could give up detail, least recently requested first
+            std::vector<std::pair<uint64_t, Texture*>> victims;
+            std::vector<std::pair<uint64_t, Texture*>> upgrades;
+            uint64_t evictable = 0;
+            for (auto& [id, texture] : m_textures)
+            {
+                const uint32_t mip_floor = texture.floor(m_frame);
+                m_stats.wanted          += texture.size(mip_floor);
+
+                if (texture.mip_resident < mip_floor)
+                {
+                    victims.emplace_back(id, &texture);
+                    evictable += texture.size(texture.mip_resident) - texture.size(mip_floor);
+                }
+                else if (texture.mip_requested < texture.mip_resident)
+                {
+                    upgrades.emplace_back(id, &texture);
+                }
+            }
+            std::sort(victims.begin(), victims.end(), [](const auto& a, const auto& b)
+            {
+                return a.second->frame_used != b.second->frame_used ? a.second->frame_used < b.second->frame_used : a.first < b.first;
+            });
+
+            // the textures which are the furthest from what they need go first, ties go to the cheaper upgrade
+            std::sort(upgrades.begin(), upgrades.end(), [](const auto& a, const auto& b)
+            {
+                const uint32_t deficit_a = a.second->mip_resident - a.second->mip_requested;
+                const uint32_t deficit_b = b.second->mip_resident - b.second->mip_requested;
+                if (deficit_a != deficit_b)
+                    return deficit_a > deficit_b;
+
+                const uint64_t cost_a = a.second->size(a.second->mip_requested) - a.second->size(a.second->mip_resident);
+                const uint64_t cost_b = b.second->size(b.second->mip_requested) - b.second->size(b.second->mip_resident);
+                return cost_a != cost_b ? cost_a < cost_b : a.first < b.first;
+            });
+
+            size_t victim_index = 0;
+            auto evict_until = [&](const uint64_t needed)
+            {
+                while (m_resident + needed > m_budget && victim_index < victims.size())
+                {
+                    auto& [id, texture]      = victims[victim_index++];
+                    const uint32_t mip_floor = texture->floor(m_frame);
+                    evictable               -= texture->size(texture->mip_resident) - texture->size(mip_floor);
+                    set_resident(id, *texture, mip_floor, changes);
+                }
+            };
+
+            // a smaller budget first takes back detail which isn't needed, then detail which is, one mip at a time from the largest
+            evict_until(0);
+            while (m_resident > m_budget)
+            {
+                Texture* largest    = nullptr;
+                uint64_t largest_id = 0;
+                for (auto& [id, texture] : m_textures)
+                {
+                    if (texture.mip_resident < texture.mip_tail && (!largest || texture.size(texture.mip_resident) > largest->size(largest->mip_resident)))
+                    {
+                        largest    = &texture;
+                        largest_id = id;
+                    }
+                }
+
+                if (!largest)
+                    break;
+
+                set_resident(largest_id, *largest, largest->mip_resident + 1, changes);
+            }
+
+            // upgrades, as close to the request as the budget allows, a change uploads the whole chain from the new mip down
+            // so the upload limit is on that, but the first upgrade of a frame always goes through, so large textures can't stall
+            uint64_t uploaded = 0;
+            for (auto& [id, texture] : upgrades)
+            {
+                uint32_t mip_target = texture->mip_requested;
+                for (; mip_target < texture->mip_resident; mip_target++)
+                {
+                    const uint64_t cost   = texture->size(mip_target) - texture->size(texture->mip_resident);
+                    const bool fits       = m_resident + cost <= m_budget + evictable;
+                    const bool can_upload = uploaded == 0 || uploaded + texture->size(mip_target) <= m_upload_limit;
+                    if (fits && can_upload)
+                        break;
+                }
+
+                if (mip_target < texture->mip_resident)
+                {
+                    evict_until(texture->size(mip_target) - texture->size(texture->mip_resident));
+                    uploaded += texture->size(mip_target);
+                    set_resident(id, *texture, mip_target, changes);
+                }
+            }
+
+            // requests only last for a frame
+            for (auto& [id, texture] : m_textures)
+            {
+                texture.mip_requested = no_request;
+            }
+            m_frame++;
+        }
+
+        void SetBudget(const uint64_t bytes)      { m_budget = bytes; }
+        uint64_t GetBudget() const                { return m_budget; }
+        void SetUploadLimit(const uint64_t bytes) { m_upload_limit = bytes; }
+
+        uint32_t GetResidentMip(const uint64_t id) const
+        {
+            auto it = m_textures.find(id);
+            return it != m_textures.end() ? it->second.mip_resident : no_request;
+        }
+
+        Stats GetStats() const
+        {
+            Stats stats          = m_stats;
+            stats.budget         = m_budget;
+            stats.resident       = m_resident;
+            stats.resident_tails = m_resident_tails;
+            stats.texture_count  = static_cast<uint32_t>(m_textures.size());
+            return stats;
+        }
+
+    private:
+        struct Texture
+        {
+            std::vector<uint64_t> size_from; // the size of the mips from a given mip to the end
+            uint32_t mip_tail      = 0;
+            uint32_t mip_resident  = 0;
+            uint32_t mip_requested = no_request;
+            uint64_t frame_used    = 0;
+
+            uint64_t size(const uint32_t mip) const { return size_from[mip]; }
+
+            // the least detail the texture can have without hurting what's on screen
+            uint32_t floor(const uint64_t frame) const
+            {
+                return frame_used == frame && mip_requested != no_request ? mip_requested : mip_tail;
+            }
+        };
+
+        void set_resident(const uint64_t id, Texture& texture, const uint32_t mip, std::vector<Change>& changes)
+        {
+            if (mip == texture.mip_resident)
+                return;
+
+            m_resident += texture.size(mip);
+            m_resident -= texture.size(texture.mip_resident);
+            (mip < texture.mip_resident ? m_stats.upgrades : m_stats.downgrades)++;
+            changes.push_back({ id, texture.mip_resident, mip });
+            texture.mip_resident = mip;
+        }
+
+        std::unordered_map<uint64_t, Texture> m_textures;
+        uint64_t m_budget         = 1024ull * 1024 * 1024;
+        uint64_t m_upload_limit   = 32ull * 1024 * 1024;
+        uint64_t m_resident       = 0;
+        uint64_t m_resident_tails = 0;
+        uint64_t m_frame          = 1;
+        Stats m_stats;
+    };
+
+    class RHI_Texture;
+    class Material;
+
+    // drives a TextureResidency with the textures the renderer draws, and applies its decisions to the gpu resources
+    class TextureStreaming
+    {
+    public:
+        // resolves the requests of the frame, the new resources are created on worker threads and taken over by a later
+        // tick, returns true if any texture took one over (so bindless textures are stale)
+        static bool Tick();
+        static void Shutdown();
+
+        // streamed textures register themselves once they are on the gpu
+        static void Register(RHI_Texture* texture);
+        static void Unregister(RHI_Texture* texture);
+
+        // asks for the textures of a material at the detail needed to span projected_size pixels on screen
+        static void Request(Material* material, const float projected_size);
+
+        // stats
+        static TextureResidency::Stats GetStats();
+    };
+}
@@ -24,8 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FontImporter.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Font/Font.h"
+#include "../Font/FontSdf.h"
+#include "../Core/ThreadPool.h"
 SP_WARNINGS_OFF
-#include <freetype/ftstroke.h>
 #include <freetype/freetype.h>
 #include <freetype/ftglyph.h>
 SP_WARNINGS_ON
@@ -43,34 +44,20 @@ namespace spartan
         // properties of the texture font atlas which holds all visible ASCII characters
         uint32_t GLYPH_START = 32;
         uint32_t GLYPH_END   = 127;
-        uint32_t ATLAS_WIDTH = 512;
+        uint32_t ATLAS_WIDTH = 1024;
+
+        // the glyphs are rasterized once, large enough for the distance field to hold detail, and scaled to any size from there
+        const uint32_t sdf_font_size = 32;
+        const uint32_t sdf_spread    = 8; // pixels, also the widest outline the atlas can represent (at sdf_font_size)
 
         FT_UInt32 g_glyph_load_flags = 0;
 
         FT_LibraryRec_* library = nullptr;
-        FT_StrokerRec_* stroker = nullptr;
     }
 
     // FreeType has questionable a design, but it's free, so we just write this helper namespace and forget about it
     namespace ft_helper
     {
-        struct ft_bitmap
-        {
-            ~ft_bitmap()
-            {
-                if (buffer)
-                {
-                    delete buffer;
-                    buffer = nullptr;
-                }
-            }
-
-            uint32_t width           = 0;
-            uint32_t height          = 0;
-            unsigned char pixel_mode = 0;
-            unsigned char* buffer    = nullptr;
-        };
-
         bool handle_error(int error_code)
         {
             if (error_code == FT_Err_Ok)
@@ -214,172 +201,156 @@ namespace spartan
             return ft_helper::handle_error(FT_Load_Char(face, char_code, flags));
         }
 
-        void get_character_max_dimensions(uint32_t* max_width, uint32_t* max_height, FT_Face& face, const uint32_t outline_size)
-        {
-            uint32_t width  = 0;
-            uint32_t height = 0;
-
-            for (uint32_t char_code = GLYPH_START; char_code < GLYPH_END; char_code++)
-            {
-                if (!load_glyph(face, char_code))
-                    continue;
-
-                FT_Bitmap* bitmap = &face->glyph->bitmap;
-                width             = max(width,  bitmap->width);
-                height            = max(height, bitmap->rows);
-            }
-
-            *max_width  = width  + outline_size * 2;
-            *max_height = height + outline_size * 2;
-        }
-
-        void get_texture_atlas_dimensions(uint32_t* atlas_width, uint32_t* atlas_height, uint32_t* atlas_cell_width, uint32_t* atlas_cell_height, FT_Face& face, const uint32_t outline_size)
+        // a glyph as rasterized by FreeType, kept so the distance fields can be generated in parallel
+        struct rasterized_glyph
         {
-            uint32_t max_width  = 0;
-            uint32_t max_height = 0;
-            get_character_max_dimensions(&max_width, &max_height, face, outline_size);
-
-            const uint32_t glyph_count    = GLYPH_END - GLYPH_START;
-            const uint32_t glyphs_per_row = ATLAS_WIDTH / max_width;
-            const uint32_t row_count      = static_cast<uint32_t>(ceil(float(glyph_count) / float(glyphs_per_row)));
-
-            *atlas_width        = ATLAS_WIDTH;
-            *atlas_height       = max_height * row_count;
-            *atlas_cell_width   = max_width;
-            *atlas_cell_height  = max_height;
-        }
+            uint32_t char_code = 0;
+            uint32_t width     = 0;
+            uint32_t height    = 0;
+            std::vector<uint8_t> coverage;
+            Glyph glyph;
+        };
 
-        void get_bitmap(ft_bitmap* bitmap, const Font* font, const FT_Stroker& stroker, FT_Face& ft_font, const uint32_t char_code)
+        bool rasterize(const FT_Face& ft_font, const uint32_t char_code, rasterized_glyph* rasterized)
         {
-            // load glyph
-            if (!load_glyph(ft_font, char_code, stroker ? FT_LOAD_NO_BITMAP : g_glyph_load_flags))
-                return;
+            if (!load_glyph(ft_font, char_code))
+                return false;
 
-            FT_Bitmap* bitmap_temp = nullptr; // will deallocate it's buffer the moment will load another glyph
+            const FT_GlyphSlot slot   = ft_font->glyph;
+            const FT_Bitmap& bitmap   = slot->bitmap;
+            rasterized->char_code     = char_code;
 
-            // get bitmap
-            if (!stroker)
-            {
-                bitmap_temp = &ft_font->glyph->bitmap;
-            }
-            else
+            // whitespace characters don't have a bitmap, they only advance the cursor
+            if (bitmap.buffer && bitmap.width > 0 && bitmap.rows > 0)
             {
-                if (ft_font->glyph->format == FT_GLYPH_FORMAT_OUTLINE)
+                if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
                 {
-                    FT_Glyph glyph;
-                    if (handle_error(FT_Get_Glyph(ft_font->glyph, &glyph)))
-                    {
-                        bool stroked = false;
-
-                        if (font->GetOutline() == Font_Outline_Edge)
-                        {
-                            stroked = handle_error(FT_Glyph_Stroke(&glyph, stroker, true));
-                        }
-                        else if (font->GetOutline() == Font_Outline_Positive)
-                        {
-                            stroked = handle_error(FT_Glyph_StrokeBorder(&glyph, stroker, false, true));
-                        }
-                        else if (font->GetOutline() == Font_Outline_Negative)
-                        {
-                            stroked = handle_error(FT_Glyph_StrokeBorder(&glyph, stroker, true, true));
-                        }
-
-                        if (stroked)
-                        {
-                            if (handle_error(FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, true)))
-                            {
-                                bitmap_temp = &reinterpret_cast<FT_BitmapGlyph>(glyph)->bitmap;
-                            }
-                        }
-                    }
+                    SP_LOG_ERROR("Font uses unsupported pixel format");
+                    return false;
                 }
-                else
+
+                rasterized->width  = bitmap.width;
+                rasterized->height = bitmap.rows;
+                rasterized->coverage.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+                for (uint32_t y = 0; y < bitmap.rows; y++)
                 {
-                    SP_LOG_ERROR("Can't apply outline as the glyph doesn't have an outline format");
-                    bitmap_temp = &ft_font->glyph->bitmap;
+                    memcpy(&rasterized->coverage[static_cast<size_t>(y) * bitmap.width], bitmap.buffer + static_cast<ptrdiff_t>(y) * bitmap.pitch, bitmap.width);
                 }
             }
 
-            // copy bitmap
-            if (bitmap_temp && bitmap_temp->buffer)
-            { 
-                bitmap->width        = bitmap_temp->width;
-                bitmap->height       = bitmap_temp->rows;
-                bitmap->pixel_mode   = bitmap_temp->pixel_mode;
-                bitmap->buffer       = new unsigned char[bitmap->width * bitmap->height];
-                memcpy(bitmap->buffer, bitmap_temp->buffer, bitmap->width * bitmap->height);
+            // the distance field extends the bitmap by the spread on every side
+            Glyph& glyph             = rasterized->glyph;
+            glyph.offset_x           = slot->bitmap_left - static_cast<int32_t>(sdf_spread);
+            glyph.offset_y           = slot->bitmap_top  + static_cast<int32_t>(sdf_spread);
+            glyph.width              = rasterized->width  > 0 ? rasterized->width  + sdf_spread * 2 : 0;
+            glyph.height             = rasterized->height > 0 ? rasterized->height + sdf_spread * 2 : 0;
+            glyph.horizontal_advance = slot->metrics.horiAdvance >> 6;
+
+            // Kerning is the process of adjusting the position of two subsequent glyph images 
+            // in a string of text in order to improve the general appearance of text. 
+            // For example, if a glyph for an uppercase ‘A’ is followed by a glyph for an 
+            // uppercase ‘V’, the space between the two glyphs can be slightly reduced to 
+            // avoid extra ‘diagonal whitespace’.
+            if (char_code >= 1 && FT_HAS_KERNING(ft_font))
+            {
+                FT_Vector kerningVec;
+                FT_Get_Kerning(ft_font, char_code - 1, char_code, FT_KERNING_DEFAULT, &kerningVec);
+                glyph.horizontal_advance += kerningVec.x >> 6;
             }
+
+            return true;
         }
 
-        void copy_to_atlas(vector<std::byte>& atlas, const ft_bitmap& bitmap, const Vector2& pen, const uint32_t atlas_width, const uint32_t outline_size)
+        bool generate_atlas(const Font* font, const string& file_path, font_sdf::Atlas* atlas)
         {
-            for (uint32_t glyph_y = 0; glyph_y < bitmap.height; glyph_y++)
+            // load font (called face)
+            FT_Face ft_font = nullptr;
+            if (!ft_helper::handle_error(FT_New_Face(library, file_path.c_str(), 0, &ft_font)))
             {
-                for (uint32_t glyph_x = 0; glyph_x < bitmap.width; glyph_x++)
-                {
-                    // Compute 
-                    uint32_t atlas_x = static_cast<uint32_t>(pen.x + glyph_x);
-                    uint32_t atlas_y = static_cast<uint32_t>(pen.y + glyph_y);
+                ft_helper::handle_error(FT_Done_Face(ft_font));
+                return false;
+            }
 
-                    // In case there is an outline, the text has to offset away from the outline's edge
-                    atlas_x += outline_size;
-                    atlas_y += outline_size;
+            // set font size
+            if (!ft_helper::handle_error(FT_Set_Char_Size(
+                ft_font,            // handle to face object
+                0,                  // char_width in 1/64th of points 
+                sdf_font_size * 64, // char_height in 1/64th of points
+                96,                 // horizontal device resolution
+                96)))               // vertical device resolution
+            {
+                ft_helper::handle_error(FT_Done_Face(ft_font));
+                return false;
+            }
 
-                    // Ensure we are not doing any wrong math
-                    const uint32_t atlas_pos = atlas_x + atlas_y * atlas_width;
-                    SP_ASSERT(atlas.size() > atlas_pos);
+            g_glyph_load_flags = ft_helper::get_load_flags(font);
 
-                    switch (bitmap.pixel_mode)
-                    {
-                    case FT_PIXEL_MODE_MONO: {
-                        // implement if it's ever needed
-                    } break;
+            // rasterize, FreeType faces can't be shared across threads, so this part is serial
+            vector<rasterized_glyph> glyphs;
+            glyphs.reserve(GLYPH_END - GLYPH_START);
+            for (uint32_t char_code = GLYPH_START; char_code < GLYPH_END; char_code++)
+            {
+                rasterized_glyph rasterized;
+                if (rasterize(ft_font, char_code, &rasterized))
+                {
+                    glyphs.push_back(move(rasterized));
+                }
+            }
 
-                    case FT_PIXEL_MODE_GRAY: {
-                        atlas[atlas_pos] = static_cast<std::byte>(bitmap.buffer[glyph_x + glyph_y * bitmap.width]);
-                    } break;
+            ft_helper::handle_error(FT_Done_Face(ft_font));
 
-                    case FT_PIXEL_MODE_BGRA: {
-                        // implement if it's ever needed
-                    } break;
+            // pack into rows of uniform cells
+            uint32_t cell_width  = 1;
+            uint32_t cell_height = 1;
+            for (const rasterized_glyph& rasterized : glyphs)
+            {
+                cell_width  = max(cell_width,  rasterized.glyph.width);
+                cell_height = max(cell_height, rasterized.glyph.height);
+            }
 
-                    default:
-                        SP_LOG_ERROR("Font uses unsupported pixel format");
-                        break;
-                    }
-                }
+            const uint32_t glyphs_per_row = max(ATLAS_WIDTH / cell_width, 1u);
+            vector<uint32_t> cells(glyphs.size(), 0);
+            uint32_t cell_count = 0;
+            for (size_t i = 0; i < glyphs.size(); i++)
+            {
+                cells[i]    = cell_count;
+                cell_count += glyphs[i].coverage.empty() ? 0 : 1;
             }
-        }
+            const uint32_t row_count = max((cell_count + glyphs_per_row - 1) / glyphs_per_row, 1u);
 
-        Glyph get_glyph(const FT_Face& ft_font, const uint32_t char_code, const Vector2& pen, const uint32_t atlas_width, const uint32_t atlas_height, const uint32_t outline_size)
-        {
-            // The glyph metrics refer to whatever the last loaded glyph was, this is up to the caller of the function
-            FT_Glyph_Metrics& metrics = ft_font->glyph->metrics; 
-
-            Glyph glyph                 = {};
-            glyph.offset_x              = metrics.horiBearingX >> 6;
-            glyph.offset_y              = metrics.horiBearingY >> 6;
-            glyph.width                 = (metrics.width >> 6) + outline_size * 2;
-            glyph.height                = (metrics.height >> 6) + outline_size * 2;
-            glyph.horizontal_advance    = metrics.horiAdvance >> 6;
-            glyph.uv_x_left             = static_cast<float>(pen.x)                 / static_cast<float>(atlas_width);
-            glyph.uv_x_right            = static_cast<float>(pen.x + glyph.width)   / static_cast<float>(atlas_width);
-            glyph.uv_y_top              = static_cast<float>(pen.y)                 / static_cast<float>(atlas_height);
-            glyph.uv_y_bottom           = static_cast<float>(pen.y + glyph.height)  / static_cast<float>(atlas_height);
+            atlas->font_size = sdf_font_size;
+            atlas->spread    = sdf_spread;
+            atlas->width     = max(ATLAS_WIDTH, cell_width);
+            atlas->height    = row_count * cell_height;
+            atlas->pixels.assign(static_cast<size_t>(atlas->width) * atlas->height, std::byte(0));
+            atlas->glyphs.resize(glyphs.size());
 
-            // Kerning is the process of adjusting the position of two subsequent glyph images 
-            // in a string of text in order to improve the general appearance of text. 
-            // For example, if a glyph for an uppercase ‘A’ is followed by a glyph for an 
-            // uppercase ‘V’, the space between the two glyphs can be slightly reduced to 
-            // avoid extra ‘diagonal whitespace’.
-            if (char_code >= 1 && FT_HAS_KERNING(ft_font))
+            // generate the distance fields, every glyph writes to its own cell
+            auto generate = [&glyphs, &cells, &atlas, glyphs_per_row, cell_width, cell_height](uint32_t start, uint32_t end)
             {
-                FT_Vector kerningVec;
-                FT_Get_Kerning(ft_font, char_code - 1, char_code, FT_KERNING_DEFAULT, &kerningVec);
-                glyph.horizontal_advance += kerningVec.x >> 6;
-            }
+                for (uint32_t i = start; i < end; i++)
+                {
+                    rasterized_glyph& rasterized = glyphs[i];
+                    Glyph& glyph                 = rasterized.glyph;
+                    if (!rasterized.coverage.empty())
+                    {
+                        const uint32_t x = (cells[i] % glyphs_per_row) * cell_width;
+                        const uint32_t y = (cells[i] / glyphs_per_row) * cell_height;
+                        std::byte* destination = &atlas->pixels[static_cast<size_t>(y) * atlas->width + x];
+                        font_sdf::generate(rasterized.coverage.data(), rasterized.width, rasterized.height, sdf_spread, destination, atlas->width);
+
+                        glyph.uv_x_left   = static_cast<float>(x)                / static_cast<float>(atlas->width);
+                        glyph.uv_x_right  = static_cast<float>(x + glyph.width)  / static_cast<float>(atlas->width);
+                        glyph.uv_y_top    = static_cast<float>(y)                / static_cast<float>(atlas->height);
+                        glyph.uv_y_bottom = static_cast<float>(y + glyph.height) / static_cast<float>(atlas->height);
+                    }
+
+                    atlas->glyphs[i] = { rasterized.char_code, glyph };
+                }
+            };
+            ThreadPool::ParallelLoop(generate, static_cast<uint32_t>(glyphs.size()));
 
-            return glyph;
+            return true;
         }
     }
 
@@ -389,10 +360,6 @@ namespace spartan
         if (!ft_helper::handle_error(FT_Init_FreeType(&library)))
             return;
 
-        // initialize stroker
-        if (!ft_helper::handle_error(FT_Stroker_New(library, &stroker)))
-            return;
-
         // get version
         FT_Int major;
         FT_Int minor;
@@ -403,124 +370,40 @@ namespace spartan
 
     void FontImporter::Shutdown()
     {
-        FT_Stroker_Done(stroker);
         ft_helper::handle_error(FT_Done_FreeType(library));
     }
 
     bool FontImporter::LoadFromFile(Font* font, const string& file_path)
     {
-        // load font (called face)
-        FT_Face ft_font = nullptr;
-        if (!ft_helper::handle_error(FT_New_Face(library, file_path.c_str(), 0, &ft_font)))
-        {
-            ft_helper::handle_error(FT_Done_Face(ft_font));
-            return false;
-        }
-
-        // set font size
-        if (!ft_helper::handle_error(FT_Set_Char_Size(
-            ft_font,              // handle to face object
-            0,                    // char_width in 1/64th of points 
-            font->GetSize() * 64, // char_height in 1/64th of points
-            96,                   // horizontal device resolution
-            96)))                 // vertical device resolution
+        // the atlas doesn't depend on the font size or the outline, only on the font file and how it's hinted
+        const uint32_t settings = (sdf_font_size << 16) | (sdf_spread << 8) | (static_cast<uint32_t>(font->GetHinting()) << 1) | (font->GetForceAutohint() ? 1 : 0);
+        const uint64_t hash     = font_sdf::compute_source_hash(file_path, settings);
+        const string cache_path = file_path + ".sdf";
+
+        // load the atlas from the cache, or generate it and cache it
+        font_sdf::Atlas atlas;
+        if (!font_sdf::load(atlas, cache_path, hash))
         {
-            ft_helper::handle_error(FT_Done_Face(ft_font));
-            return false;
-        }
-
-        // set outline size
-        const uint32_t outline_size   = (font->GetOutline() != Font_Outline_None) ? font->GetOutlineSize() : 0;
-        const bool outline            = outline_size != 0;
-        if (outline)
-        {
-            FT_Stroker_Set(stroker, outline_size * 64, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
-        }
-
-        g_glyph_load_flags = ft_helper::get_load_flags(font);
+            if (!ft_helper::generate_atlas(font, file_path, &atlas))
+                return false;
 
-        // get the size of the font atlas texture (if an outline is requested, it accounts for a big enough atlas)
-        uint32_t atlas_width       = 0;
-        uint32_t atlas_height      = 0;
-        uint32_t atlas_cell_width  = 0;
-        uint32_t atlas_cell_height = 0;
-        ft_helper::get_texture_atlas_dimensions(&atlas_width, &atlas_height, &atlas_cell_width, &atlas_cell_height, ft_font, outline_size);
-
-        // atlas for text
-        vector<RHI_Texture_Slice> texture_data_atlas;
-        vector<std::byte>& mip_atlas = texture_data_atlas.emplace_back().mips.emplace_back().bytes;
-        mip_atlas.resize(atlas_width * atlas_height);
-        mip_atlas.reserve(mip_atlas.size());
-
-        // atlas for outline (if needed)
-        vector<RHI_Texture_Slice> texture_data_atlas_outline;
-        vector<std::byte>& mip_atlas_outline = texture_data_atlas_outline.emplace_back().mips.emplace_back().bytes;
-        if (outline_size != 0)
-        {
-            mip_atlas_outline.resize(mip_atlas.size());
-            mip_atlas_outline.reserve(mip_atlas.size());
-        }
-
-        // go through each glyph
-        Vector2 pen = 0.0f;
-        bool writting_started = false;
-        for (uint32_t char_code = GLYPH_START; char_code < GLYPH_END; char_code++)
-        {
-            // load text bitmap
-            ft_helper::ft_bitmap bitmap_text;
-            ft_helper::get_bitmap(&bitmap_text, font, nullptr, ft_font, char_code);
-
-            // load glyph bitmap (if needeD)
-            ft_helper::ft_bitmap bitmap_outline;
-            if (outline)
+            if (!font_sdf::save(atlas, cache_path, hash))
             {
-                ft_helper::get_bitmap(&bitmap_outline, font, stroker, ft_font, char_code);
+                SP_LOG_WARNING("Failed to cache the font atlas to \"%s\"", cache_path.c_str());
             }
-
-            // advance pen
-            // whitespace characters don't have a buffer and don't write on the atlas, hence no need to advance the pen in these cases.
-            if (bitmap_text.buffer && writting_started)
-            {
-                // advance column
-                pen.x += atlas_cell_width;
-
-                // advance row
-                if (pen.x + atlas_cell_width > atlas_width)
-                {
-                    pen.x = 0;
-                    pen.y += atlas_cell_height;
-                }
-            }
-
-            // copy to atlas buffers
-            if (bitmap_text.buffer)
-            {
-                ft_helper::copy_to_atlas(mip_atlas, bitmap_text, pen, atlas_width, outline_size);
-
-                if (bitmap_outline.buffer)
-                {
-                    ft_helper::copy_to_atlas(mip_atlas_outline, bitmap_outline, pen, atlas_width, 0);
-                }
-
-                writting_started = true;
-            }
-
-            // set glyph
-            font->SetGlyph(char_code, ft_helper::get_glyph(ft_font, char_code, pen, atlas_width, atlas_height, outline_size));
         }
 
-        // free face
-        ft_helper::handle_error(FT_Done_Face(ft_font));
-
-        // create a texture with of font atlas and a texture of the font outline atlas
+        for (const auto& [char_code, glyph] : atlas.glyphs)
         {
-            font->SetAtlas(make_shared<RHI_Texture>(RHI_Texture_Type::Type2D, atlas_width, atlas_height, 1, 1, RHI_Format::R8_Unorm, RHI_Texture_Srv, "font_atlas", texture_data_atlas));
-
-            if (outline_size != 0)
-            {
-                font->SetAtlasOutline(make_shared<RHI_Texture>(RHI_Texture_Type::Type2D, atlas_width, atlas_height, 1, 1, RHI_Format::R8_Unorm, RHI_Texture_Srv, "font_atlas_outline", texture_data_atlas_outline));
-            }
+            font->SetGlyph(char_code, glyph);
         }
+        font->SetAtlasFontSize(atlas.font_size);
+        font->SetAtlasSpread(atlas.spread);
+
+        // create a texture of the font atlas
+        vector<RHI_Texture_Slice> texture_data_atlas;
+        texture_data_atlas.emplace_back().mips.emplace_back().bytes = move(atlas.pixels);
+        font->SetAtlas(make_shared<RHI_Texture>(RHI_Texture_Type::Type2D, atlas.width, atlas.height, 1, 1, RHI_Format::R8_Unorm, RHI_Texture_Srv, "font_atlas", texture_data_atlas));
 
         return true;
     }
@@ -509,6 +509,49 @@ namespace spartan
         FreeImage_Unload(bitmap);
     }
 
+    bool ImageImporter::LoadThumbnail(const string& file_path, const uint32_t size_max, vector<byte>& pixels, uint32_t& width, uint32_t& height)
+    {
+        FREE_IMAGE_FORMAT format = FreeImage_GetFileType(file_path.c_str(), 0);
+        format                   = format == FIF_UNKNOWN ? FreeImage_GetFIFFromFilename(file_path.c_str()) : format;
+
+        // freeimage can't read every dds, and a block compressed one isn't worth decoding for a thumbnail
+        if (format == FIF_DDS || !FreeImage_FIFSupportsReading(format))
+            return false;
+
+        // the jpeg and raw decoders can decode at a reduced size directly, when it's requested in the upper 16 bits of the flags
+        const int flags  = (format == FIF_JPEG || format == FIF_RAW) ? static_cast<int>(size_max << 16) : 0;
+        FIBITMAP* bitmap = FreeImage_Load(format, file_path.c_str(), flags);
+        if (!bitmap)
+            return false;
+
+        // downscale (high dynamic range and 16 bit images are tone mapped/converted to 8 bits) and expand to 32 bits
+        FIBITMAP* thumbnail = FreeImage_MakeThumbnail(bitmap, static_cast<int>(size_max), TRUE);
+        FreeImage_Unload(bitmap);
+        if (!thumbnail)
+            return false;
+        thumbnail = convert_to_32bits(thumbnail);
+
+        // freeimage stores bgra (on little endian) and bottom-up
+        width  = FreeImage_GetWidth(thumbnail);
+        height = FreeImage_GetHeight(thumbnail);
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            const BYTE* source = FreeImage_GetScanLine(thumbnail, height - 1 - y);
+            byte* destination  = &pixels[static_cast<size_t>(y) * width * 4];
+            for (uint32_t x = 0; x < width; x++, source += 4, destination += 4)
+            {
+                destination[0] = static_cast<byte>(source[FI_RGBA_RED]);
+                destination[1] = static_cast<byte>(source[FI_RGBA_GREEN]);
+                destination[2] = static_cast<byte>(source[FI_RGBA_BLUE]);
+                destination[3] = static_cast<byte>(source[FI_RGBA_ALPHA]);
+            }
+        }
+
+        FreeImage_Unload(thumbnail);
+        return true;
+    }
+
     void ImageImporter::Save(const string& file_path, const uint32_t width, const uint32_t height, const uint32_t channel_count, const uint32_t bits_per_channel, void* data)
     {
         uint32_t bytes_per_pixel = (bits_per_channel / 8) * channel_count;
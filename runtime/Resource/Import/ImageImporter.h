@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ====
 #include <string>
+#include <vector>
 //===============
 
 namespace spartan
@@ -35,6 +36,7 @@ namespace spartan
         static void Initialize();
         static void Shutdown();
         static void Load(const std::string& file_path, const uint32_t slice_index, RHI_Texture* texture);
+        static bool LoadThumbnail(const std::string& file_path, const uint32_t size_max, std::vector<std::byte>& pixels, uint32_t& width, uint32_t& height); // rgba8, top-down, aspect ratio preserved
         static void Save(const std::string& file_path, const uint32_t width, const uint32_t height, const uint32_t channel_count, const uint32_t bits_per_channel, void* data);
     };
 }
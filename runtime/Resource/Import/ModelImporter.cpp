@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Core/ProgressTracker.h"
 #include "../../RHI/RHI_Texture.h"
 #include "../../Rendering/Animation.h"
+#include "../../Rendering/Animator.h"
 #include "../../Rendering/Mesh.h"
 #include "../../Rendering/Material.h"
 #include "../../World/World.h"
@@ -53,7 +54,9 @@ namespace spartan
         string model_file_path;
         string model_name;
         Mesh* mesh               = nullptr;
+        vector<uint32_t> sub_mesh_indices; // sub-meshes whose lods are generated once all nodes are parsed
         bool model_has_animation = false;
+        shared_ptr<Skeleton> skeleton;
         const aiScene* scene     = nullptr;
         mutex mutex_assimp;
 
@@ -215,14 +218,22 @@ namespace spartan
             return "";
         }
 
-        bool load_material_texture(
-            Mesh* mesh,
+        // a material texture which is loading, resolved once all of the material's textures have been requested
+        struct MaterialTextureLoad
+        {
+            MaterialTextureType texture_type = MaterialTextureType::Max;
+            aiTextureType type_assimp        = aiTextureType_NONE;
+            shared_ptr<RHI_Texture> cached;
+            ResourceHandle<RHI_Texture> request;
+        };
+
+        bool request_material_texture(
             const string& file_path,
-            shared_ptr<Material> material,
             const aiMaterial* material_assimp,
             const MaterialTextureType texture_type,
             const aiTextureType texture_type_assimp_pbr,
-            const aiTextureType texture_type_assimp_legacy
+            const aiTextureType texture_type_assimp_legacy,
+            vector<MaterialTextureLoad>& loads
         )
         {
             // determine if this is a pbr material or not
@@ -244,26 +255,28 @@ namespace spartan
             if (!FileSystem::IsSupportedImageFile(deduced_path))
                 return false;
 
-            // load the texture and set it to the material
-            {
-                // try to get the texture
-                const string tex_name = FileSystem::GetFileNameWithoutExtensionFromFilePath(deduced_path);
-                shared_ptr<RHI_Texture> texture = ResourceCache::GetByName<RHI_Texture>(tex_name);
+            MaterialTextureLoad& load = loads.emplace_back();
+            load.texture_type         = texture_type;
+            load.type_assimp          = type_assimp;
 
-                if (texture)
-                {
-                    // set cached texture
-                    material->SetTexture(texture_type, texture);
-                }
-                else
-                {
-                    // load new texture
-                    material->SetTexture(texture_type, deduced_path);
-                }
+            // use the cached texture, or start loading a new one
+            const string tex_name = FileSystem::GetFileNameWithoutExtensionFromFilePath(deduced_path);
+            load.cached           = ResourceCache::GetByName<RHI_Texture>(tex_name);
+            if (!load.cached)
+            {
+                load.request = ResourceCache::LoadAsync<RHI_Texture>(deduced_path, ResourceLoadPriority::Normal, {}, RHI_Texture_Srv | RHI_Texture_Compress | RHI_Texture_DontPrepareForGpu);
             }
 
+            return true;
+        }
+
+        void apply_material_texture(shared_ptr<Material> material, const MaterialTextureLoad& load)
+        {
+            const MaterialTextureType texture_type = load.texture_type;
+            material->SetTexture(texture_type, load.cached ? load.cached : load.request.Wait());
+
             // FIX: materials that have a diffuse texture should not be tinted black/gray
-            if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
+            if (load.type_assimp == aiTextureType_BASE_COLOR || load.type_assimp == aiTextureType_DIFFUSE)
             {
                 material->SetProperty(MaterialProperty::ColorR, 1.0f);
                 material->SetProperty(MaterialProperty::ColorG, 1.0f);
@@ -287,24 +300,29 @@ namespace spartan
                     }
                 }
             }
-
-            return true;
         }
 
-        shared_ptr<Material> load_material(Mesh* mesh, const string& file_path, const aiMaterial* material_assimp)
+        shared_ptr<Material> load_material(const string& file_path, const aiMaterial* material_assimp)
         {
             SP_ASSERT(material_assimp != nullptr);
             shared_ptr<Material> material = make_shared<Material>();
 
-            //                                                                         texture type,           texture type assimp (pbr),       texture type assimp (legacy/fallback)
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Color,      aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE);
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Roughness,  aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS); // use specular as fallback
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Metalness,  aiTextureType_METALNESS,         aiTextureType_NONE);
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Normal,     aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS);
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Occlusion,  aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP);
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Emission,   aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE);
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::Height,     aiTextureType_HEIGHT,            aiTextureType_NONE);
-            load_material_texture(mesh, file_path, material, material_assimp, MaterialTextureType::AlphaMask,  aiTextureType_OPACITY,           aiTextureType_NONE);
+            // request every texture first, so that they decode in parallel, then apply them in order, the material is built in memory
+            // rather than loaded from a file, so it can't be a request that depends on them, and the fixes below need the textures
+            vector<MaterialTextureLoad> loads;
+            //                                                             texture type,           texture type assimp (pbr),       texture type assimp (legacy/fallback)
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Color,      aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE,    loads);
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Roughness,  aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS,  loads); // use specular as fallback
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Metalness,  aiTextureType_METALNESS,         aiTextureType_NONE,       loads);
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Normal,     aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS,    loads);
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Occlusion,  aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP,   loads);
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Emission,   aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE,   loads);
+            request_material_texture(file_path, material_assimp, MaterialTextureType::Height,     aiTextureType_HEIGHT,            aiTextureType_NONE,       loads);
+            request_material_texture(file_path, material_assimp, MaterialTextureType::AlphaMask,  aiTextureType_OPACITY,           aiTextureType_NONE,       loads);
+            for (const MaterialTextureLoad& load : loads)
+            {
+                apply_material_texture(material, load);
+            }
 
             // gltf detection
             bool is_gltf = FileSystem::GetExtensionFromFilePath(file_path) == ".gltf";
@@ -430,6 +448,7 @@ namespace spartan
         model_name      = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
         mesh            = mesh_in;
         mesh->SetObjectName(model_name);
+        sub_mesh_indices.clear();
 
         // set up the importer
         Importer importer;
@@ -492,20 +511,31 @@ namespace spartan
 
             model_has_animation = scene->mNumAnimations != 0;
 
+            // the skeleton comes first, so that the meshes can map their bone weights to it
+            skeleton = nullptr;
+            if (model_has_animation)
+            {
+                ParseSkeleton();
+            }
+
             // recursively parse nodes
             ParseNode(scene->mRootNode);
 
-            // update model geometry
+            // update model geometry, nodes are parsed on this thread, so every sub-mesh has been added by now
             {
-                while (ProgressTracker::GetProgress(ProgressType::ModelImporter).GetFraction() != 1.0f)
-                {
-                    SP_LOG_INFO("Waiting for node processing threads to finish before creating GPU buffers...");
-                    this_thread::sleep_for(std::chrono::milliseconds(16));
-                }
+                // generate the lods of all sub-meshes in parallel
+                mesh->GenerateLods(sub_mesh_indices);
 
                 mesh->CreateGpuBuffers();
             }
 
+            // animations, the first one plays
+            if (skeleton)
+            {
+                mesh->SetSkeleton(skeleton);
+                ParseAnimations();
+            }
+
             // make the root entity active since it's now thread-safe
             mesh->GetRootEntity().lock()->SetActive(true);
             World::Resolve();
@@ -713,9 +743,45 @@ namespace spartan
             }
         }
 
-        // add vertex and index data to the mesh
+        // bone weights
+        vector<SkinWeights> skin_weights;
+        if (skeleton && assimp_mesh->HasBones())
+        {
+            skin_weights.resize(vertex_count);
+            for (uint32_t i = 0; i < assimp_mesh->mNumBones; i++)
+            {
+                const aiBone* bone       = assimp_mesh->mBones[i];
+                const int32_t bone_index = skeleton->GetBoneIndex(bone->mName.C_Str());
+                if (bone_index < 0)
+                    continue;
+
+                for (uint32_t j = 0; j < bone->mNumWeights; j++)
+                {
+                    const aiVertexWeight& weight = bone->mWeights[j];
+                    if (weight.mVertexId < vertex_count)
+                    {
+                        skin_weights[weight.mVertexId].Add(static_cast<uint32_t>(bone_index), weight.mWeight);
+                    }
+                }
+            }
+
+            for (SkinWeights& weights : skin_weights)
+            {
+                weights.Normalize();
+            }
+        }
+
+        // add vertex and index data to the mesh, skinned geometry keeps its vertex order and gets no lods
         uint32_t sub_mesh_index = 0;
-        mesh->AddGeometry(vertices, indices, true, &sub_mesh_index);
+        if (skin_weights.empty())
+        {
+            mesh->AddGeometry(vertices, indices, false, &sub_mesh_index);
+            sub_mesh_indices.push_back(sub_mesh_index);
+        }
+        else
+        {
+            mesh->AddGeometry(vertices, indices, skin_weights, &sub_mesh_index);
+        }
 
         // set the geometry
         entity_parent->AddComponent<Renderable>()->SetMesh(mesh, sub_mesh_index);
@@ -727,7 +793,7 @@ namespace spartan
             const aiMaterial* assimp_material = scene->mMaterials[assimp_mesh->mMaterialIndex];
 
             // convert it and add it to the model
-            shared_ptr<Material> material = load_material(mesh, model_file_path, assimp_material);
+            shared_ptr<Material> material = load_material(model_file_path, assimp_material);
 
             // generate normal from albedo if no normal map is provided
             if (!material->HasTextureOfType(MaterialTextureType::Normal))
@@ -742,98 +808,126 @@ namespace spartan
             // add a renderable and set the material to it
             entity_parent->AddComponent<Renderable>()->SetMaterial(material);
         }
+    }
+
+    void ModelImporter::ParseSkeleton()
+    {
+
+        // the offset (inverse bind) matrices of the bones, across all meshes
+        unordered_map<string, Matrix> bones;
+        for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+        {
+            const aiMesh* assimp_mesh = scene->mMeshes[i];
+            for (uint32_t j = 0; j < assimp_mesh->mNumBones; j++)
+            {
+                bones.emplace(assimp_mesh->mBones[j]->mName.C_Str(), to_matrix(assimp_mesh->mBones[j]->mOffsetMatrix));
+            }
+        }
+
+        if (bones.empty())
+            return;
+
+        // the bones and every node above them form the hierarchy, so that model space transforms are exact
+        unordered_set<const aiNode*> nodes;
+        for (const auto& [name, offset] : bones)
+        {
+            for (const aiNode* node = scene->mRootNode->FindNode(name.c_str()); node; node = node->mParent)
+            {
+                if (!nodes.insert(node).second)
+                    break;
+            }
+        }
+
+        // depth first, so that parents precede their children
+        skeleton = make_shared<Skeleton>();
+        function<void(const aiNode*, int32_t)> add_bone = [&](const aiNode* node, const int32_t parent)
+        {
+            if (nodes.find(node) == nodes.end())
+                return;
+
+            const Matrix local        = to_matrix(node->mTransformation);
+            const auto it             = bones.find(node->mName.C_Str());
+            const Matrix inverse_bind = it != bones.end() ? it->second : Matrix::Identity;
+            const int32_t index       = static_cast<int32_t>(skeleton->AddBone(node->mName.C_Str(), parent, inverse_bind, local.GetTranslation(), local.GetRotation(), local.GetScale()));
 
-        // Bones
-        ParseNodes(assimp_mesh);
+            for (uint32_t i = 0; i < node->mNumChildren; i++)
+            {
+                add_bone(node->mChildren[i], index);
+            }
+        };
+        add_bone(scene->mRootNode, -1);
     }
 
     void ModelImporter::ParseAnimations()
     {
+        // without a skeleton, there is nothing the channels can drive
+        if (!skeleton)
+            return;
+
         for (uint32_t i = 0; i < scene->mNumAnimations; i++)
         {
             const auto assimp_animation = scene->mAnimations[i];
             auto animation = make_shared<Animation>();
 
-            // Basic properties
-            animation->SetObjectName(assimp_animation->mName.C_Str());
+            // basic properties
             animation->SetDuration(assimp_animation->mDuration);
             animation->SetTicksPerSec(assimp_animation->mTicksPerSecond != 0.0f ? assimp_animation->mTicksPerSecond : 25.0f);
 
-            // Animation channels
+            // animation channels, each one drives a single node
+            vector<AnimationNode> channels;
             for (uint32_t j = 0; j < static_cast<uint32_t>(assimp_animation->mNumChannels); j++)
             {
                 const aiNodeAnim* assimp_node_anim = assimp_animation->mChannels[j];
-                AnimationNode animation_node;
-
-                animation_node.name = assimp_node_anim->mNodeName.C_Str();
+                AnimationNode& animation_node      = channels.emplace_back();
+                animation_node.name                = assimp_node_anim->mNodeName.C_Str();
 
-                // Position keys
+                // position keys
                 for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumPositionKeys); k++)
                 {
-                    const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+                    const auto time  = assimp_node_anim->mPositionKeys[k].mTime;
                     const auto value = to_vector3(assimp_node_anim->mPositionKeys[k].mValue);
 
                     animation_node.positionFrames.emplace_back(KeyVector{ time, value });
                 }
 
-                // Rotation keys
+                // rotation keys
                 for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumRotationKeys); k++)
                 {
-                    const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+                    const auto time  = assimp_node_anim->mRotationKeys[k].mTime;
                     const auto value = to_quaternion(assimp_node_anim->mRotationKeys[k].mValue);
 
                     animation_node.rotationFrames.emplace_back(KeyQuaternion{ time, value });
                 }
 
-                // Scaling keys
+                // scaling keys
                 for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumScalingKeys); k++)
                 {
-                    const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+                    const auto time  = assimp_node_anim->mScalingKeys[k].mTime;
                     const auto value = to_vector3(assimp_node_anim->mScalingKeys[k].mValue);
 
                     animation_node.scaleFrames.emplace_back(KeyVector{ time, value });
                 }
             }
-        }
-    }
 
-    void ModelImporter::ParseNodes(const aiMesh* assimp_mesh)
-    {
-        // Maximum number of bones per mesh
-        // Must not be higher than same const in skinning shader
-        constexpr uint8_t MAX_BONES = 64;
-        // Maximum number of bones per vertex
-        constexpr uint8_t MAX_BONES_PER_VERTEX = 4;
-
-        //for (uint32_t i = 0; i < assimp_mesh->mNumBones; i++)
-        //{
-        //    uint32_t index = 0;
-
-        //    assert(assimp_mesh->mNumBones <= MAX_BONES);
-
-        //    string name = assimp_mesh->mBones[i]->mName.data;
-
-        //    if (boneMapping.find(name) == boneMapping.end())
-        //    {
-        //        // Bone not present, add new one
-        //        index = numBones;
-        //        numBones++;
-        //        BoneInfo bone;
-        //        boneInfo.push_back(bone);
-        //        boneInfo[index].offset = pMesh->mBones[i]->mOffsetMatrix;
-        //        boneMapping[name] = index;
-        //    }
-        //    else
-        //    {
-        //        index = boneMapping[name];
-        //    }
-
-        //    for (uint32_t j = 0; j < assimp_mesh->mBones[i]->mNumWeights; j++)
-        //    {
-        //        uint32_t vertexID = vertexOffset + pMesh->mBones[i]->mWeights[j].mVertexId;
-        //        Bones[vertexID].add(index, pMesh->mBones[i]->mWeights[j].mWeight);
-        //    }
-        //}
-        //boneTransforms.resize(numBones);
+            animation->Compress(skeleton, channels);
+
+            // name it after the model when the file doesn't, then cache it
+            string name = assimp_animation->mName.C_Str();
+            name        = name.empty() ? model_name + "_animation_" + to_string(i) : FileSystem::RemoveIllegalCharacters(name);
+            animation->SetResourceFilePath(FileSystem::GetDirectoryFromFilePath(model_file_path) + name + EXTENSION_ANIMATION);
+
+            const AnimationCompressionStats& stats = animation->GetCompressionStats();
+            SP_LOG_INFO("Animation \"%s\": %u -> %u keys, %.1f -> %.1f KB, max error %.4f units, %.4f rad",
+                animation->GetObjectName().c_str(), stats.key_count_source, stats.key_count,
+                stats.size_source / 1024.0f, stats.size / 1024.0f, max(stats.error_position, stats.error_scale), stats.error_rotation);
+
+            animation = ResourceCache::Cache(animation);
+
+            // the model starts out playing its first animation
+            if (i == 0)
+            {
+                Animator::Play(mesh->GetAnimatorInstance(), animation);
+            }
+        }
     }
 }
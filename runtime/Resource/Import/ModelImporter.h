@@ -45,6 +45,6 @@ namespace spartan
         static void ParseNodeLight(const aiNode* node, std::shared_ptr<Entity> new_entity);
         static void ParseAnimations();
         static void ParseMesh(aiMesh* mesh, std::shared_ptr<Entity> entity_parent);
-        static void ParseNodes(const aiMesh* mesh);
+        static void ParseSkeleton();
     };
 }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ResourceCache.h"
 #include "../Rendering/Mesh.h"
 #include "../RHI/RHI_Texture.h"
+#include <shared_mutex>
 SP_WARNINGS_OFF
 #include "../IO/pugixml.hpp"
 SP_WARNINGS_ON
@@ -38,12 +39,81 @@ namespace spartan
 {
     namespace
     {
-        array<string, 6> m_standard_resource_directories;
+        array<string, 7> m_standard_resource_directories;
         string m_project_directory;
-        vector<shared_ptr<IResource>> m_resources;
-        mutex m_mutex;
         bool use_root_shader_directory = false;
 
+        // resources are indexed by path and by id, each index is split into shards with their own reader/writer lock,
+        // so lookups from import threads don't serialize, the path index is the owner and decides what gets cached
+        const uint32_t shard_count = 16;
+
+        struct Entry
+        {
+            shared_ptr<IResource> resource;
+            uint64_t sequence = 0; // insertion order, so that listing and saving stay deterministic
+        };
+
+        struct ShardPath
+        {
+            shared_mutex mutex;
+            unordered_map<string, Entry> resources;
+        };
+
+        struct ShardId
+        {
+            shared_mutex mutex;
+            unordered_map<uint64_t, string> paths; // the path a resource was cached with, it can change afterwards
+        };
+
+        array<ShardPath, shard_count> shards_path;
+        array<ShardId, shard_count> shards_id;
+        atomic<uint64_t> sequence = 0;
+
+        // asynchronous loads which haven't completed yet, by normalized path, so that concurrent requests share one load
+        mutex requests_mutex;
+        unordered_map<string, shared_ptr<ResourceRequest>> requests;
+
+        // paths are stored relative to the working directory, lookups can come with either kind of path or separator
+        string normalize_path(const string& path)
+        {
+            string normalized = FileSystem::GetRelativePath(path);
+            replace(normalized.begin(), normalized.end(), '\\', '/');
+            return normalized;
+        }
+
+        ShardPath& get_shard(const string& path_normalized)
+        {
+            return shards_path[hash<string>{}(path_normalized) % shard_count];
+        }
+
+        ShardId& get_shard(const uint64_t id)
+        {
+            return shards_id[hash<uint64_t>{}(id) % shard_count];
+        }
+
+        // visits every resource, in insertion order
+        template <typename Function>
+        void for_each_resource(Function&& function)
+        {
+            vector<const Entry*> entries;
+            vector<shared_lock<shared_mutex>> locks;
+            locks.reserve(shard_count);
+            for (ShardPath& shard : shards_path)
+            {
+                locks.emplace_back(shard.mutex);
+                for (const auto& [path, entry] : shard.resources)
+                {
+                    entries.push_back(&entry);
+                }
+            }
+
+            sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->sequence < b->sequence; });
+            for (const Entry* entry : entries)
+            {
+                function(entry->resource);
+            }
+        }
+
         const char* resource_type_to_string(const ResourceType type)
         {
             switch (type)
@@ -81,6 +151,7 @@ namespace spartan
 
         // add engine standard resource directories
         const string data_dir = "data\\";
+        AddResourceDirectory(ResourceDirectory::Cache,          m_project_directory + "cache");
         AddResourceDirectory(ResourceDirectory::Environment,    m_project_directory + "environment");
         AddResourceDirectory(ResourceDirectory::Fonts,          data_dir + "fonts");
         AddResourceDirectory(ResourceDirectory::Icons,          data_dir + "icons");
@@ -92,58 +163,178 @@ namespace spartan
         SP_SUBSCRIBE_TO_EVENT(EventType::WorldClear, SP_EVENT_HANDLER_STATIC(Shutdown));
     }
     
-	shared_ptr<IResource>& ResourceCache::GetByName(const string& name, const ResourceType type)
+    shared_ptr<IResource> ResourceCache::GetByName(const string& name, const ResourceType type)
     {
-        lock_guard<mutex> guard(m_mutex);
-
-        for (shared_ptr<IResource>& resource : m_resources)
+        // names can change after caching, so they aren't indexed, a single pass keeps the earliest match, as a listing would
+        shared_ptr<IResource> found;
+        uint64_t found_sequence = numeric_limits<uint64_t>::max();
+        for (ShardPath& shard : shards_path)
         {
-            if (name == resource->GetObjectName())
-                return resource;
+            shared_lock<shared_mutex> lock(shard.mutex);
+            for (const auto& [path, entry] : shard.resources)
+            {
+                if (entry.sequence < found_sequence && name == entry.resource->GetObjectName())
+                {
+                    found          = entry.resource;
+                    found_sequence = entry.sequence;
+                }
+            }
         }
 
-        static shared_ptr<IResource> empty;
-        return empty;
+        return found;
     }
 
     vector<shared_ptr<IResource>> ResourceCache::GetByType(const ResourceType type /*= ResourceType::Unknown*/)
     {
-        lock_guard<mutex> guard(m_mutex);
-
         vector<shared_ptr<IResource>> resources;
-        for (shared_ptr<IResource>& resource : m_resources)
+        for_each_resource([type, &resources](const shared_ptr<IResource>& resource)
         {
             if (resource->GetResourceType() == type || type == ResourceType::Max)
             {
                 resources.emplace_back(resource);
             }
-        }
+        });
 
         return resources;
     }
 
+    shared_ptr<IResource> ResourceCache::GetByPath(const string& path)
+    {
+        const string path_normalized = normalize_path(path);
+        ShardPath& shard             = get_shard(path_normalized);
+
+        shared_lock<shared_mutex> lock(shard.mutex);
+        auto it = shard.resources.find(path_normalized);
+        return it != shard.resources.end() ? it->second.resource : nullptr;
+    }
+
+    shared_ptr<IResource> ResourceCache::GetById(const uint64_t id)
+    {
+        string path;
+        {
+            ShardId& shard = get_shard(id);
+            shared_lock<shared_mutex> lock(shard.mutex);
+            auto it = shard.paths.find(id);
+            if (it == shard.paths.end())
+                return nullptr;
+
+            path = it->second;
+        }
+
+        ShardPath& shard = get_shard(path);
+        shared_lock<shared_mutex> lock(shard.mutex);
+        auto it = shard.resources.find(path);
+        return (it != shard.resources.end() && it->second.resource->GetObjectId() == id) ? it->second.resource : nullptr;
+    }
+
+    shared_ptr<IResource> ResourceCache::Cache(const shared_ptr<IResource>& resource)
+    {
+        if (!resource)
+            return nullptr;
+
+        const string path_normalized = normalize_path(resource->GetResourceFilePath());
+        ShardPath& shard             = get_shard(path_normalized);
+
+        // insert if absent, under the writer lock, so two threads caching the same path end up with the same resource
+        unique_lock<shared_mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.resources.try_emplace(path_normalized);
+        if (!inserted)
+            return it->second.resource;
+
+        it->second.resource = resource;
+        it->second.sequence = sequence.fetch_add(1, memory_order_relaxed);
+
+        // the id index is always locked after the path index, never the other way around
+        ShardId& shard_id = get_shard(resource->GetObjectId());
+        unique_lock<shared_mutex> lock_id(shard_id.mutex);
+        shard_id.paths[resource->GetObjectId()] = path_normalized;
+
+        return resource;
+    }
+
+    shared_ptr<ResourceRequest> ResourceCache::LoadAsync(const string& file_path, const ResourceLoadPriority priority, const vector<shared_ptr<ResourceRequest>>& dependencies, ResourceRequest::Creator&& create)
+    {
+        const string path_normalized = normalize_path(file_path);
+        shared_ptr<ResourceRequest> request;
+        {
+            lock_guard<mutex> lock(requests_mutex);
+
+            auto it = requests.find(path_normalized);
+            if (it != requests.end())
+                return it->second;
+
+            request = make_shared<ResourceRequest>(file_path, priority, move(create));
+
+            if (shared_ptr<IResource> existing = GetByPath(path_normalized))
+            {
+                request->Complete(ResourceLoadState::Loaded, existing);
+                return request;
+            }
+
+            requests[path_normalized] = request;
+        }
+
+        // forget the request once it's done, whatever the outcome, a later request for the path starts over (or hits the cache)
+        ResourceRequest* request_raw = request.get();
+        request->Then([path_normalized, request_raw](const shared_ptr<IResource>&)
+        {
+            lock_guard<mutex> lock(requests_mutex);
+            auto it = requests.find(path_normalized);
+            if (it != requests.end() && it->second.get() == request_raw)
+            {
+                requests.erase(it);
+            }
+        });
+
+        request->Schedule(dependencies);
+
+        return request;
+    }
+
+    void ResourceCache::Remove(const shared_ptr<IResource>& resource)
+    {
+        if (!resource)
+            return;
+
+        string path;
+        {
+            ShardId& shard = get_shard(resource->GetObjectId());
+            unique_lock<shared_mutex> lock(shard.mutex);
+            auto it = shard.paths.find(resource->GetObjectId());
+            if (it == shard.paths.end())
+                return;
+
+            path = move(it->second);
+            shard.paths.erase(it);
+        }
+
+        ShardPath& shard = get_shard(path);
+        unique_lock<shared_mutex> lock(shard.mutex);
+        auto it = shard.resources.find(path);
+        if (it != shard.resources.end() && it->second.resource == resource)
+        {
+            shard.resources.erase(it);
+        }
+    }
+
     uint64_t ResourceCache::GetMemoryUsage(ResourceType type /*= Resource_Unknown*/)
     {
-        lock_guard<mutex> guard(m_mutex);
 
         uint64_t size = 0;
-        for (shared_ptr<IResource>& resource : m_resources)
+        for_each_resource([type, &size](const shared_ptr<IResource>& resource)
         {
             if (resource->GetResourceType() == type || type == ResourceType::Max)
             {
-                if (SpartanObject* object = dynamic_cast<SpartanObject*>(resource.get()))
-                {
-                    size += object->GetObjectSize();
-                }
+                size += resource->GetObjectSize();
             }
-        }
+        });
 
         return size;
     }
 
     void ResourceCache::Save(pugi::xml_node& node)
     {
-        for (const auto& resource : GetResources())
+        for (const auto& resource : GetByType())
         {
             // skip resources without a file path (e.g., procedural/in-memory only)
             if (resource->GetResourceFilePath().empty())
@@ -159,6 +350,9 @@ namespace spartan
     {
         Shutdown();
 
+        // everything loads on the thread pool, a material once the textures it references are done, so that it finds them cached
+        // instead of loading them itself, dependencies are listed before their dependents so that waiting in order never stalls
+        vector<shared_ptr<ResourceRequest>> loads;
         for (pugi::xml_node res_node = node.child("Resource"); res_node; res_node = res_node.next_sibling("Resource"))
         {
             std::string type_str = res_node.attribute("type").as_string();
@@ -174,18 +368,69 @@ namespace spartan
             // load based on type
             switch (type)
             {
-                case ResourceType::Texture:  Load<RHI_Texture>(path); break;
-                case ResourceType::Material: Load<Material>(path);    break;
+                case ResourceType::Texture:
+                {
+                    loads.push_back(LoadAsync<RHI_Texture>(path));
+                    break;
+                }
+                case ResourceType::Material:
+                {
+                    vector<shared_ptr<ResourceRequest>> textures;
+                    for (const string& texture_path : Material::GetTexturePathsToLoad(path))
+                    {
+                        textures.push_back(LoadAsync<RHI_Texture>(texture_path));
+                    }
+                    loads.insert(loads.end(), textures.begin(), textures.end());
+                    loads.push_back(LoadAsync<Material>(path, ResourceLoadPriority::Normal, textures));
+                    break;
+                }
                 //case ResourceType::Mesh:     Load<Mesh>(path);        break;
                 default: SP_LOG_WARNING("Unsupported resource type: %s", type_str.c_str()); break;
             }
         }
+
+        // the entities which are deserialized next look the resources up
+        for (const shared_ptr<ResourceRequest>& load : loads)
+        {
+            load->Wait();
+        }
     }
     
     void ResourceCache::Shutdown()
     {
-        uint32_t resource_count = static_cast<uint32_t>(m_resources.size());
-        m_resources.clear();
+        // this also runs when a world is loaded, with the thread pool alive, so loads which didn't start are cancelled (which
+        // releases anyone waiting on them) and the ones already running are waited for, they would otherwise cache into the cleared cache
+        vector<shared_ptr<ResourceRequest>> requests_pending;
+        {
+            lock_guard<mutex> lock(requests_mutex);
+            for (const auto& [path, request] : requests)
+            {
+                requests_pending.push_back(request);
+            }
+        }
+        for (const shared_ptr<ResourceRequest>& request : requests_pending)
+        {
+            if (!request->Cancel())
+            {
+                request->Wait();
+            }
+        }
+
+        // resources are released after the locks are, in case their destructors use the cache
+        vector<unordered_map<string, Entry>> resources(shard_count);
+        uint32_t resource_count = 0;
+        for (uint32_t i = 0; i < shard_count; i++)
+        {
+            {
+                unique_lock<shared_mutex> lock(shards_path[i].mutex);
+                resource_count += static_cast<uint32_t>(shards_path[i].resources.size());
+                resources[i].swap(shards_path[i].resources);
+            }
+
+            unique_lock<shared_mutex> lock(shards_id[i].mutex);
+            shards_id[i].paths.clear();
+        }
+        resources.clear();
 
         if (resource_count != 0)
         { 
@@ -195,7 +440,17 @@ namespace spartan
 
     uint32_t ResourceCache::GetResourceCount(const ResourceType type)
     {
-        return static_cast<uint32_t>(GetByType(type).size());
+        if (type != ResourceType::Max)
+            return static_cast<uint32_t>(GetByType(type).size());
+
+        uint32_t count = 0;
+        for (ShardPath& shard : shards_path)
+        {
+            shared_lock<shared_mutex> lock(shard.mutex);
+            count += static_cast<uint32_t>(shard.resources.size());
+        }
+
+        return count;
     }
 
     void ResourceCache::AddResourceDirectory(const ResourceDirectory type, const string& directory)
@@ -243,16 +498,6 @@ namespace spartan
         return "Data";
     }
 
-    vector<shared_ptr<IResource>>& ResourceCache::GetResources()
-    {
-        return m_resources;
-    }
-
-    mutex& ResourceCache::GetMutex()
-    {
-        return m_mutex;
-    }
-
     bool ResourceCache::GetUseRootShaderDirectory()
     {
         return use_root_shader_directory;
@@ -23,8 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include "IResource.h"
+#include "ResourceRequest.h"
 #include "../Logging/Log.h"
-#include <mutex>
 #include "../Rendering/Material.h"
 //================================
 
@@ -37,6 +37,7 @@ namespace spartan
 {
     enum class ResourceDirectory
     {
+        Cache,
         Environment,
         Fonts,
         Icons,
@@ -52,7 +53,7 @@ namespace spartan
         static void Shutdown();
 
         // get by name
-        static std::shared_ptr<IResource>& GetByName(const std::string& name, ResourceType type);
+        static std::shared_ptr<IResource> GetByName(const std::string& name, ResourceType type);
         template <class T> 
         static std::shared_ptr<T> GetByName(const std::string& name) 
         { 
@@ -63,32 +64,22 @@ namespace spartan
         static std::vector<std::shared_ptr<IResource>> GetByType(ResourceType type = ResourceType::Max);
 
         // get by path
+        static std::shared_ptr<IResource> GetByPath(const std::string& path);
         template <class T>
         static std::shared_ptr<T> GetByPath(const std::string& path)
         {
-            for (std::shared_ptr<IResource>& resource : GetResources())
-            {
-                if (path == resource->GetResourceFilePath())
-                    return std::static_pointer_cast<T>(resource);
-            }
-
-            return nullptr;
+            return std::static_pointer_cast<T>(GetByPath(path));
         }
 
+        // get by id
+        static std::shared_ptr<IResource> GetById(const uint64_t id);
+
         // caches resource, or replaces with existing cached resource
+        static std::shared_ptr<IResource> Cache(const std::shared_ptr<IResource>& resource);
         template <class T>
         static std::shared_ptr<T> Cache(const std::shared_ptr<T> resource)
         {
-            if (!resource)
-                return nullptr;
-
-            // return cached resource if it already exists
-            if (std::shared_ptr<T> existing = GetByPath<T>(resource->GetResourceFilePath()))
-                return existing;
-
-            // if not, cache it and return the cached resource
-            std::lock_guard<std::mutex> guard(GetMutex());
-            return std::static_pointer_cast<T>(GetResources().emplace_back(resource));
+            return std::static_pointer_cast<T>(Cache(std::static_pointer_cast<IResource>(resource)));
         }
 
         // loads a resource and adds it to the resource cache
@@ -102,7 +93,6 @@ namespace spartan
             }
 
             // return cached resource if it already exists
-            const std::string name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
             if (std::shared_ptr<T> existing = GetByPath<T>(file_path))
                 return existing;
 
@@ -114,25 +104,31 @@ namespace spartan
             }
             resource->SetResourceFilePath(file_path);
             resource->LoadFromFile(file_path);
-            return Cache<T>(resource); // cache and return
+            return Cache<T>(resource); // cache and return, if another thread was faster, its resource is returned
+        }
+
+        // loads a resource on the thread pool, once all of the dependencies are done (e.g. a material can wait for its textures)
+        // a path which is already cached completes right away and a path which is already loading shares the request (and its dependencies)
+        static std::shared_ptr<ResourceRequest> LoadAsync(const std::string& file_path, const ResourceLoadPriority priority, const std::vector<std::shared_ptr<ResourceRequest>>& dependencies, ResourceRequest::Creator&& create);
+        template <class T>
+        static ResourceHandle<T> LoadAsync(const std::string& file_path, const ResourceLoadPriority priority = ResourceLoadPriority::Normal, const std::vector<std::shared_ptr<ResourceRequest>>& dependencies = {}, uint32_t flags = 0)
+        {
+            return ResourceHandle<T>(LoadAsync(file_path, priority, dependencies, [flags]() -> std::shared_ptr<IResource>
+            {
+                std::shared_ptr<T> resource = std::make_shared<T>();
+                if (flags != 0)
+                {
+                    resource->SetFlags(flags);
+                }
+                return resource;
+            }));
         }
 
+        static void Remove(const std::shared_ptr<IResource>& resource);
         template <class T>
         static void Remove(std::shared_ptr<T>& resource)
         {
-            if (!resource)
-                return;
-
-            GetResources().erase
-            (
-                std::remove_if
-                (
-                    GetResources().begin(),
-                    GetResources().end(),
-                    [](std::shared_ptr<IResource> resource) { return dynamic_cast<SpartanObject*>(resource.get())->GetObjectId() == resource->GetObjectId(); }
-                ),
-                GetResources().end()
-            );
+            Remove(std::static_pointer_cast<IResource>(resource));
         }
 
         // memory
@@ -148,8 +144,6 @@ namespace spartan
         static std::string GetDataDirectory();
 
         // misc
-        static std::vector<std::shared_ptr<IResource>>& GetResources();
-        static std::mutex& GetMutex();
         static bool GetUseRootShaderDirectory();
         static void SetUseRootShaderDirectory(const bool use_root_shader_directory);
 
@@ -0,0 +1,209 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "ResourceRequest.h"
+#include "ResourceCache.h"
+#include "../Core/ThreadPool.h"
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        // requests which are ready to load, a heap ordered by priority and then by age, a worker task is added per
+        // request but takes whichever request is at the top when it runs, so urgent loads overtake the ones already queued
+        mutex queue_mutex;
+        vector<shared_ptr<ResourceRequest>> queue;
+        uint64_t queue_sequence = 0;
+    }
+
+    ResourceRequest::ResourceRequest(const string& file_path, const ResourceLoadPriority priority, Creator&& create)
+    {
+        m_file_path = file_path;
+        m_priority  = priority;
+        m_create    = move(create);
+    }
+
+    shared_ptr<IResource> ResourceRequest::GetResource()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return m_resource;
+    }
+
+    void ResourceRequest::Wait()
+    {
+        // load it here rather than idle, this also keeps workers which wait on each other from stalling the pool,
+        // the worker task which later pops the request from the queue finds it started and skips it
+        if (m_dependencies_pending.load(memory_order_acquire) == 0)
+        {
+            Run();
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_settled; });
+    }
+
+    bool ResourceRequest::Cancel()
+    {
+        ResourceLoadState expected = ResourceLoadState::Queued;
+        if (!m_state.compare_exchange_strong(expected, ResourceLoadState::Cancelled, memory_order_acq_rel))
+            return false;
+
+        Complete(ResourceLoadState::Cancelled, nullptr);
+        return true;
+    }
+
+    void ResourceRequest::Then(Continuation&& continuation)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            if (!IsDone())
+            {
+                m_continuations.push_back(move(continuation));
+                return;
+            }
+        }
+
+        continuation(GetResource());
+    }
+
+    void ResourceRequest::Schedule(const vector<shared_ptr<ResourceRequest>>& dependencies)
+    {
+        // the count starts at one, so that dependencies which complete while this loop runs can't queue the request early
+        m_dependencies_pending.fetch_add(static_cast<uint32_t>(dependencies.size()), memory_order_acq_rel);
+
+        for (const shared_ptr<ResourceRequest>& dependency : dependencies)
+        {
+            if (dependency)
+            {
+                lock_guard<mutex> lock(dependency->m_mutex);
+                if (!dependency->IsDone())
+                {
+                    dependency->m_dependents.push_back(shared_from_this());
+                    continue;
+                }
+            }
+
+            DependencyDone();
+        }
+
+        DependencyDone();
+    }
+
+    void ResourceRequest::DependencyDone()
+    {
+        if (m_dependencies_pending.fetch_sub(1, memory_order_acq_rel) != 1)
+            return;
+
+        static auto compare = [](const shared_ptr<ResourceRequest>& a, const shared_ptr<ResourceRequest>& b)
+        {
+            if (a->m_priority != b->m_priority)
+                return a->m_priority < b->m_priority;
+
+            return a->m_sequence > b->m_sequence;
+        };
+
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            m_sequence = queue_sequence++;
+            queue.push_back(shared_from_this());
+            push_heap(queue.begin(), queue.end(), compare);
+        }
+
+        ThreadPool::AddTask([]()
+        {
+            shared_ptr<ResourceRequest> request;
+            {
+                lock_guard<mutex> lock(queue_mutex);
+                pop_heap(queue.begin(), queue.end(), compare);
+                request = move(queue.back());
+                queue.pop_back();
+            }
+
+            request->Run();
+        });
+    }
+
+    void ResourceRequest::Run()
+    {
+        // a cancelled request, or one a waiter already loaded, is still in the queue, it's simply skipped
+        ResourceLoadState expected = ResourceLoadState::Queued;
+        if (!m_state.compare_exchange_strong(expected, ResourceLoadState::Loading, memory_order_acq_rel))
+            return;
+
+        // a synchronous load of the same path could have been faster
+        shared_ptr<IResource> resource = ResourceCache::GetByPath(m_file_path);
+        if (!resource)
+        {
+            if (!FileSystem::Exists(m_file_path))
+            {
+                SP_LOG_ERROR("\"%s\" doesn't exist.", m_file_path.c_str());
+                Complete(ResourceLoadState::Failed, nullptr);
+                return;
+            }
+
+            resource = m_create();
+            resource->SetResourceFilePath(m_file_path);
+            resource->LoadFromFile(m_file_path);
+            resource = ResourceCache::Cache(resource);
+        }
+
+        Complete(ResourceLoadState::Loaded, resource);
+    }
+
+    void ResourceRequest::Complete(const ResourceLoadState state, shared_ptr<IResource> resource)
+    {
+        vector<Continuation> continuations;
+        vector<shared_ptr<ResourceRequest>> dependents;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_resource = move(resource);
+            m_create   = nullptr;
+            m_state.store(state, memory_order_release);
+            continuations.swap(m_continuations);
+            dependents.swap(m_dependents);
+        }
+
+        for (Continuation& continuation : continuations)
+        {
+            continuation(m_resource);
+        }
+
+        // waiters are released after the continuations, so they can rely on their side effects
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_settled = true;
+        }
+        m_condition.notify_all();
+
+        // dependents are queued whatever the outcome, they can check the state of what they depend on
+        for (const shared_ptr<ResourceRequest>& dependent : dependents)
+        {
+            dependent->DependencyDone();
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ================
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include "IResource.h"
+//===========================
+
+namespace spartan
+{
+    enum class ResourceLoadState : uint8_t
+    {
+        Queued,    // waiting for its dependencies or for a worker
+        Loading,
+        Loaded,
+        Failed,    // the file doesn't exist
+        Cancelled
+    };
+
+    enum class ResourceLoadPriority : uint8_t
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    // the state of an asynchronous load, shared by the scheduler and every handle to it
+    // requests for a path which is already loading share it, so cancelling affects all of them
+    class ResourceRequest : public std::enable_shared_from_this<ResourceRequest>
+    {
+    public:
+        using Creator      = std::function<std::shared_ptr<IResource>()>;
+        using Continuation = std::function<void(const std::shared_ptr<IResource>&)>;
+
+        ResourceRequest(const std::string& file_path, const ResourceLoadPriority priority, Creator&& create);
+
+        ResourceLoadState GetState() const       { return m_state.load(std::memory_order_acquire); }
+        bool IsDone() const                      { return GetState() >= ResourceLoadState::Loaded; }
+        ResourceLoadPriority GetPriority() const { return m_priority; }
+        const std::string& GetFilePath() const   { return m_file_path; }
+        std::shared_ptr<IResource> GetResource();
+
+        // blocks until the request is done and its continuations have run, a request which is ready but hasn't been picked up
+        // by a worker is loaded on the calling thread, one which still waits for its dependencies can't be, so prefer Then() there
+        void Wait();
+
+        // succeeds only if loading hasn't started yet
+        bool Cancel();
+
+        // runs once the request is done (in any state), on the thread that completed it, or right away if it already is
+        void Then(Continuation&& continuation);
+
+    private:
+        friend class ResourceCache;
+
+        // queues the request once all of the dependencies are done
+        void Schedule(const std::vector<std::shared_ptr<ResourceRequest>>& dependencies);
+        void DependencyDone();
+        void Run();
+        void Complete(const ResourceLoadState state, std::shared_ptr<IResource> resource);
+
+        std::string m_file_path;
+        ResourceLoadPriority m_priority              = ResourceLoadPriority::Normal;
+        std::atomic<ResourceLoadState> m_state       = ResourceLoadState::Queued;
+        std::atomic<uint32_t> m_dependencies_pending = 1;     // held at one until the request is scheduled
+        uint64_t m_sequence                          = 0;     // loads of the same priority run in the order they were queued
+        bool m_settled                               = false; // done and the continuations have run
+        Creator m_create;
+        std::shared_ptr<IResource> m_resource;
+        std::vector<Continuation> m_continuations;
+        std::vector<std::shared_ptr<ResourceRequest>> m_dependents;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+    };
+
+    // a typed view of a request, it can be passed wherever a request is expected (e.g. as a dependency)
+    template <class T>
+    class ResourceHandle
+    {
+    public:
+        ResourceHandle() = default;
+        ResourceHandle(std::shared_ptr<ResourceRequest> request) : m_request(std::move(request)) {}
+
+        bool IsValid() const                 { return m_request != nullptr; }
+        bool IsDone() const                  { return m_request && m_request->IsDone(); }
+        ResourceLoadState GetState() const   { return m_request ? m_request->GetState() : ResourceLoadState::Cancelled; }
+        bool Cancel() const                  { return m_request && m_request->Cancel(); }
+        std::shared_ptr<T> Get() const       { return m_request ? std::static_pointer_cast<T>(m_request->GetResource()) : nullptr; }
+        const std::shared_ptr<ResourceRequest>& GetRequest() const { return m_request; }
+        operator const std::shared_ptr<ResourceRequest>&() const   { return m_request; }
+
+        std::shared_ptr<T> Wait() const
+        {
+            if (!m_request)
+                return nullptr;
+
+            m_request->Wait();
+            return Get();
+        }
+
+        void Then(std::function<void(const std::shared_ptr<T>&)>&& continuation) const
+        {
+            m_request->Then([continuation = std::move(continuation)](const std::shared_ptr<IResource>& resource)
+            {
+                continuation(std::static_pointer_cast<T>(resource));
+            });
+        }
+
+    private:
+        std::shared_ptr<ResourceRequest> m_request;
+    };
+}
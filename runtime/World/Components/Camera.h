@@ -134,6 +134,7 @@ namespace spartan
         // frustum
         bool IsInViewFrustum(const math::BoundingBox& bounding_box) const;
         bool IsInViewFrustum(std::shared_ptr<Renderable> renderable) const;
+        const math::Frustum& GetFrustum() const { return m_frustum; }
 
         // flags
         bool GetFlag(const CameraFlags flag) { return m_flags & flag; }
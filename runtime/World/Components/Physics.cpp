@@ -24,11 +24,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Physics.h"
 #include "Renderable.h"
 #include "Camera.h"
+#include "Terrain.h"
 #include "../Entity.h"
 #include "../../RHI/RHI_Vertex.h"
 #include "../../IO/FileStream.h"
+#include "../../Resource/ResourceCache.h"
 #include "../../Physics/PhysicsWorld.h"
-#include "../../Geometry/GeometryProcessing.h"
+#include "../../Physics/PhysicsCooking.h"
+#include "../../Core/ThreadPool.h"
+#include "../../Core/Stopwatch.h"
 SP_WARNINGS_OFF
 #ifdef DEBUG
     #define _DEBUG 1
@@ -58,6 +62,90 @@ namespace spartan
         const float crouch_height       = 0.7f;
 
         void* controller_manager = nullptr;
+
+        // terrain colliders are height fields, they are built straight from the samples, without simplification or cooking,
+        // and take a fraction of the memory of triangle meshes (a sample is 4 bytes), tiles keep each field at a modest size
+        namespace height_field
+        {
+            const uint32_t tile_quads        = 256;                      // quads per side of a tile
+            const float slope_max            = 40.0f * math::deg_to_rad; // steeper quads get the slope material
+            const float slope_friction_scale = 0.5f;                     // steep ground is loose (scree), so it's slippery
+            const float level_sea            = 0.0f;                     // quads entirely below it get the underwater material
+
+            // indices into the materials of a tile's shape, a hit's face index can be resolved to them
+            enum MaterialIndex : uint8_t
+            {
+                Ground,
+                Slope,
+                Underwater,
+                Count
+            };
+
+            // a tile of count_x x count_z samples starting at sample (x0, z0), heights are quantized between the min and max of the tile
+            PxHeightField* create(const TerrainHeightField& field, const uint32_t x0, const uint32_t z0, const uint32_t count_x, const uint32_t count_z, float& height_min, float& height_scale)
+            {
+                auto get_height = [&field](const uint32_t x, const uint32_t z) { return field.heights[z * field.width + x]; };
+
+                height_min       = numeric_limits<float>::max();
+                float height_max = numeric_limits<float>::lowest();
+                for (uint32_t z = z0; z < z0 + count_z; z++)
+                {
+                    for (uint32_t x = x0; x < x0 + count_x; x++)
+                    {
+                        height_min = min(height_min, get_height(x, z));
+                        height_max = max(height_max, get_height(x, z));
+                    }
+                }
+                height_scale = max((height_max - height_min) / 32767.0f, PX_MIN_HEIGHTFIELD_Y_SCALE);
+
+                // physx rows run along x and columns along z, so the grid is transposed
+                const float slope_max_tangent = tan(slope_max);
+                vector<PxHeightFieldSample> samples(count_x * count_z);
+                for (uint32_t x = 0; x < count_x; x++)
+                {
+                    for (uint32_t z = 0; z < count_z; z++)
+                    {
+                        const uint32_t sample_x     = x0 + x;
+                        const uint32_t sample_z     = z0 + z;
+                        PxHeightFieldSample& sample = samples[x * count_z + z];
+                        sample.height               = static_cast<PxI16>((get_height(sample_x, sample_z) - height_min) / height_scale + 0.5f);
+
+                        // the material of the quad this sample is the corner of, both triangles share it
+                        uint8_t material = MaterialIndex::Ground;
+                        if (x + 1 < count_x && z + 1 < count_z)
+                        {
+                            const float h00     = get_height(sample_x,     sample_z);
+                            const float h10     = get_height(sample_x + 1, sample_z);
+                            const float h01     = get_height(sample_x,     sample_z + 1);
+                            const float h11     = get_height(sample_x + 1, sample_z + 1);
+                            const float slope_x = (h10 - h00 + h11 - h01) * 0.5f / field.spacing;
+                            const float slope_z = (h01 - h00 + h11 - h10) * 0.5f / field.spacing;
+                            if (max({ h00, h10, h01, h11 }) < level_sea)
+                            {
+                                material = MaterialIndex::Underwater;
+                            }
+                            else if (slope_x * slope_x + slope_z * slope_z > slope_max_tangent * slope_max_tangent)
+                            {
+                                material = MaterialIndex::Slope;
+                            }
+                        }
+
+                        // the tessellation flag stays clear, so quads split between (x + 1, z) and (x, z + 1) like the terrain mesh does
+                        sample.materialIndex0 = PxBitAndByte(material);
+                        sample.materialIndex1 = PxBitAndByte(material);
+                    }
+                }
+
+                PxHeightFieldDesc desc;
+                desc.format         = PxHeightFieldFormat::eS16_TM;
+                desc.nbRows         = count_x;
+                desc.nbColumns      = count_z;
+                desc.samples.data   = samples.data();
+                desc.samples.stride = sizeof(PxHeightFieldSample);
+
+                return PxCreateHeightField(desc);
+            }
+        }
     }
 
     Physics::Physics(Entity* entity) : Component(entity)
@@ -85,6 +173,10 @@ namespace spartan
 
     void Physics::OnRemove()
     {
+        // the worker writes the mesh, so it has to be done before anything is released
+        WaitForCooking();
+        m_bodies_pending = false;
+
         if (m_controller)
         {
             static_cast<PxController*>(m_controller)->release();
@@ -108,6 +200,7 @@ namespace spartan
             }
         }
         m_bodies.clear();
+        m_poses.clear();
 
         if (PxMaterial* material = static_cast<PxMaterial*>(m_material))
         {
@@ -118,6 +211,16 @@ namespace spartan
 
     void Physics::OnTick()
     {
+        // the mesh was loaded or cooked on a worker, create the bodies now that it's ready
+        if (m_bodies_pending && (!m_cooking.valid() || m_cooking.wait_for(chrono::seconds(0)) == future_status::ready))
+        {
+            m_bodies_pending = false;
+            if (m_mesh)
+            {
+                CreateBodies();
+            }
+        }
+
         // map transform from physx to engine and vice versa
         if (m_body_type == BodyType::Controller)
         {
@@ -143,32 +246,55 @@ namespace spartan
                 m_velocity = Vector3::Zero;
             }
         }
-        else if (!m_is_static)
+        else if (!IsStatic())
         {
             Renderable* renderable                = GetEntity()->GetComponent<Renderable>();
             const vector<math::Matrix>& instances = renderable ? renderable->GetInstances() : vector<math::Matrix>();
             bool has_instances                    = !instances.empty();
 
+            // the simulation steps at a fixed rate, so the poses of the last two steps are blended by how far the frame is into the next one
+            const uint64_t step_count = PhysicsWorld::GetStepCount();
+            const bool is_step_new    = step_count != m_step_count;
+            const bool is_step_single = step_count == m_step_count + 1; // otherwise the previous step was never read, so it snaps
+            const float interpolation = PhysicsWorld::GetInterpolationFactor();
+            m_step_count              = step_count;
+            m_poses.resize(m_bodies.size());
+
             for (size_t i = 0; i < m_bodies.size(); i++)
             {
                 PxRigidActor* actor = static_cast<PxRigidActor*>(m_bodies[i]);
 
                 if (Engine::IsFlagSet(EngineMode::Playing))
                 {
-                    PxTransform pose       = actor->getGlobalPose();
-                    math::Matrix transform = math::Matrix::CreateTranslation(Vector3(pose.p.x, pose.p.y, pose.p.z)) * math::Matrix::CreateRotation(Quaternion(pose.q.x, pose.q.y, pose.q.z, pose.q.w));
+                    PhysicsBodyPose& body_pose = m_poses[i];
+                    if (is_step_new || !body_pose.is_valid)
+                    {
+                        const bool is_continuous    = is_step_single && body_pose.is_valid;
+                        PxTransform pose            = actor->getGlobalPose();
+                        body_pose.position_previous = is_continuous ? body_pose.position : Vector3(pose.p.x, pose.p.y, pose.p.z);
+                        body_pose.rotation_previous = is_continuous ? body_pose.rotation : Quaternion(pose.q.x, pose.q.y, pose.q.z, pose.q.w);
+                        body_pose.position          = Vector3(pose.p.x, pose.p.y, pose.p.z);
+                        body_pose.rotation          = Quaternion(pose.q.x, pose.q.y, pose.q.z, pose.q.w);
+                        body_pose.is_valid          = true;
+                    }
+
+                    const Vector3 position    = Vector3::Lerp(body_pose.position_previous, body_pose.position, interpolation);
+                    const Quaternion rotation = Quaternion::Lerp(body_pose.rotation_previous, body_pose.rotation, interpolation);
+                    math::Matrix transform    = math::Matrix::CreateTranslation(position) * math::Matrix::CreateRotation(rotation);
                     if (has_instances && renderable && i < instances.size())
                     {
                         renderable->SetInstance(static_cast<uint32_t>(i), transform);
                     }
                     else if (i == 0)
                     {
-                        GetEntity()->SetPosition(Vector3(pose.p.x, pose.p.y, pose.p.z));
-                        GetEntity()->SetRotation(Quaternion(pose.q.x, pose.q.y, pose.q.z, pose.q.w));
+                        GetEntity()->SetPosition(position);
+                        GetEntity()->SetRotation(rotation);
                     }
                 }
                 else
                 {
+                    m_poses[i].is_valid = false; // the body is placed by the entity, don't blend from where the simulation left it
+
                     math::Matrix transform;
                     if (has_instances && i < instances.size())
                     {
@@ -197,7 +323,7 @@ namespace spartan
         }
 
         // distance-based activation/deactivation
-        if (m_body_type != BodyType::Controller && m_is_static)
+        if (m_body_type != BodyType::Controller && m_body_type != BodyType::Terrain && m_is_static)
         {
             if (Camera* camera = World::GetCamera())
             {
@@ -386,6 +512,13 @@ namespace spartan
                     volume = 0.0f;  // skip volume-based calculation
                     break;
                 }
+                case BodyType::Terrain:
+                {
+                    // height fields are static, they have no mass
+                    mass   = 0.0f;
+                    volume = 0.0f; // skip volume-based calculation
+                    break;
+                }
             }
     
             // calculate mass from volume if applicable
@@ -809,92 +942,112 @@ namespace spartan
                     return;
                 }
 
-                // simplify geometry
-                float simplification_ratio = 0.1f; // keep 10% of the original indices
-                size_t target_index_count  = static_cast<size_t>(indices.size() * simplification_ratio);
-                target_index_count         = max<size_t>(target_index_count, 512); // prevent over-simplification
-                geometry_processing::simplify(indices, vertices, target_index_count, false);
-
-                // convert vertices to physx format
-                vector<PxVec3> px_vertices;
-                px_vertices.reserve(vertices.size());
-                Vector3 scale = GetEntity()->GetScale();
-                for (const auto& vertex : vertices)
+                // the mesh is loaded from the cache or cooked on a worker, so that meshes which miss the cache
+                // cook in parallel, the bodies are created on the next tick after it's done
+                m_bodies_pending = true;
+                m_cooking        = ThreadPool::AddTask([this, indices = move(indices), vertices = move(vertices), scale = GetEntity()->GetScale(), is_static = IsStatic()]() mutable
                 {
-                    px_vertices.emplace_back(vertex.pos[0] * scale.x, vertex.pos[1] * scale.y, vertex.pos[2] * scale.z);
-                }
+                    m_mesh = physics_cooking::get_mesh(indices, vertices, scale, is_static);
+                });
 
-                // cooking parameters
-                PxTolerancesScale _scale;
-                _scale.length                          = 1.0f;                         // 1 unit = 1 meter
-                _scale.speed                           = PhysicsWorld::GetGravity().y; // gravity is in meters per second
-                PxCookingParams params(_scale);         
-                params.areaTestEpsilon                 = 0.06f * _scale.length * _scale.length;
-                params.planeTolerance                  = 0.0007f;
-                params.convexMeshCookingType           = PxConvexMeshCookingType::eQUICKHULL;
-                params.suppressTriangleMeshRemapTable  = false;
-                params.buildTriangleAdjacencies        = true;
-                params.buildGPUData                    = false;
-                params.meshPreprocessParams           |= PxMeshPreprocessingFlag::eWELD_VERTICES;
-                params.meshWeldTolerance               = 0.01f;
-                params.meshAreaMinLimit                = 0.0f;
-                params.meshEdgeLengthMaxLimit          = 500.0f;
-                params.gaussMapLimit                   = 32;
-                params.maxWeightRatioInTet             = FLT_MAX;
-
-                PxInsertionCallback* insertion_callback = PxGetStandaloneInsertionCallback();
-                if (IsStatic()) // static: triangle mesh
-                {
-                    PxTriangleMeshDesc mesh_desc;
-                    mesh_desc.points.count     = static_cast<PxU32>(px_vertices.size());
-                    mesh_desc.points.stride    = sizeof(PxVec3);
-                    mesh_desc.points.data      = px_vertices.data();
-                    mesh_desc.triangles.count  = static_cast<PxU32>(indices.size() / 3);
-                    mesh_desc.triangles.stride = 3 * sizeof(PxU32);
-                    mesh_desc.triangles.data   = indices.data();
-
-                    // create
-                    PxTriangleMeshCookingResult::Enum condition;
-                    m_mesh = PxCreateTriangleMesh(params, mesh_desc, *insertion_callback, &condition);
-                    if (condition != PxTriangleMeshCookingResult::eSUCCESS)
-                    {
-                        SP_LOG_ERROR("Failed to create triangle mesh: %d", condition);
-                        if (m_mesh)
-                        {
-                            static_cast<PxTriangleMesh*>(m_mesh)->release();
-                            m_mesh = nullptr;
-                        }
-                        return;
-                    }
-                }
-                else // dynamic: convex mesh
-                {
-                    PxConvexMeshDesc mesh_desc;
-                    mesh_desc.points.count  = static_cast<PxU32>(px_vertices.size());
-                    mesh_desc.points.stride = sizeof(PxVec3);
-                    mesh_desc.points.data   = px_vertices.data();
-                    mesh_desc.flags         = PxConvexFlag::eCOMPUTE_CONVEX;
-
-                    // create
-                    PxConvexMeshCookingResult::Enum condition;
-                    m_mesh = PxCreateConvexMesh(params, mesh_desc, *insertion_callback, &condition);
-                    if (!m_mesh || condition != PxConvexMeshCookingResult::eSUCCESS)
-                    {
-                        SP_LOG_ERROR("Failed to create convex mesh: %d", condition);
-                        if (m_mesh)
-                        {
-                            static_cast<PxConvexMesh*>(m_mesh)->release();
-                            m_mesh = nullptr;
-                        }
-                        return;
-                    }
-                }
+                return;
+            }
+
+            if (m_body_type == BodyType::Terrain)
+            {
+                CreateHeightFields();
+                return;
             }
 
             CreateBodies();
         }
     }
 
+    void Physics::WaitForCooking()
+    {
+        if (m_cooking.valid())
+        {
+            m_cooking.wait();
+        }
+    }
+
+    void Physics::CreateHeightFields()
+    {
+        Terrain* terrain = GetEntity()->GetComponent<Terrain>();
+        if (!terrain || terrain->GetHeightField().heights.empty())
+        {
+            SP_LOG_ERROR("No generated Terrain component found for terrain shape");
+            return;
+        }
+
+        PxPhysics* physics              = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+        PxScene* scene                  = static_cast<PxScene*>(PhysicsWorld::GetScene());
+        const TerrainHeightField& field = terrain->GetHeightField();
+        const Vector3 position          = GetEntity()->GetPosition();
+        const Quaternion rotation       = GetEntity()->GetRotation();
+        Vector3 scale                   = GetEntity()->GetScale();
+        const uint32_t tile_count_x     = (field.width  - 2) / height_field::tile_quads + 1;
+        const uint32_t tile_count_z     = (field.height - 2) / height_field::tile_quads + 1;
+        Stopwatch stopwatch;
+
+        // the scale is baked into the geometry and the rotation into the poses, but height fields can't be mirrored
+        if (scale.x <= 0.0f || scale.y <= 0.0f || scale.z <= 0.0f)
+        {
+            SP_LOG_WARNING("Terrain height fields can't be mirrored, the absolute scale will be used");
+            scale = Vector3(fabs(scale.x), fabs(scale.y), fabs(scale.z));
+        }
+
+        // the shapes hold on to the materials, ground is the component's material, the rest derive from it
+        PxMaterial* materials[height_field::MaterialIndex::Count] = {};
+        materials[height_field::MaterialIndex::Ground]     = static_cast<PxMaterial*>(m_material);
+        materials[height_field::MaterialIndex::Slope]      = physics->createMaterial(m_friction * height_field::slope_friction_scale, m_friction_rolling * height_field::slope_friction_scale, m_restitution);
+        materials[height_field::MaterialIndex::Underwater] = physics->createMaterial(m_friction, m_friction_rolling, m_restitution);
+
+        m_bodies.clear();
+        m_bodies.reserve(tile_count_x * tile_count_z);
+        for (uint32_t tile_z = 0; tile_z < tile_count_z; tile_z++)
+        {
+            for (uint32_t tile_x = 0; tile_x < tile_count_x; tile_x++)
+            {
+                // neighbouring tiles share their edge samples, so there are no gaps between them
+                const uint32_t x0      = tile_x * height_field::tile_quads;
+                const uint32_t z0      = tile_z * height_field::tile_quads;
+                const uint32_t count_x = min(height_field::tile_quads, field.width  - 1 - x0) + 1;
+                const uint32_t count_z = min(height_field::tile_quads, field.height - 1 - z0) + 1;
+
+                float height_min   = 0.0f;
+                float height_scale = 0.0f;
+                PxHeightField* tile = height_field::create(field, x0, z0, count_x, count_z, height_min, height_scale);
+                if (!tile)
+                {
+                    SP_LOG_ERROR("Failed to create terrain height field");
+                    continue;
+                }
+
+                // the tile's corner, in the entity's space and then in the world, the same way the terrain's vertices are transformed
+                const Vector3 corner = position + rotation * Vector3(
+                    (field.origin_x + static_cast<float>(x0) * field.spacing) * scale.x,
+                    height_min * scale.y,
+                    (field.origin_z + static_cast<float>(z0) * field.spacing) * scale.z
+                );
+                PxTransform pose(PxVec3(corner.x, corner.y, corner.z), PxQuat(rotation.x, rotation.y, rotation.z, rotation.w));
+                PxRigidStatic* actor = physics->createRigidStatic(pose);
+                PxHeightFieldGeometry geometry(tile, PxMeshGeometryFlags(), max(height_scale * scale.y, PX_MIN_HEIGHTFIELD_Y_SCALE), field.spacing * scale.x, field.spacing * scale.z);
+                PxRigidActorExt::createExclusiveShape(*actor, geometry, materials, height_field::MaterialIndex::Count);
+                tile->release(); // the shape holds on to it
+
+                actor->userData = reinterpret_cast<void*>(GetEntity());
+                scene->addActor(*actor);
+                m_bodies.push_back(actor);
+            }
+        }
+
+        materials[height_field::MaterialIndex::Slope]->release();
+        materials[height_field::MaterialIndex::Underwater]->release();
+
+        SP_LOG_INFO("Created %u terrain height field tiles in %.1f ms", static_cast<uint32_t>(m_bodies.size()), stopwatch.GetElapsedTimeMs());
+    }
+
     void Physics::CreateBodies()
     {
         PxPhysics* physics                    = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
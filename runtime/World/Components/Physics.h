@@ -21,17 +21,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==================
+//= INCLUDES =====================
 #include "Component.h"
 #include <vector>
-#include "../../Math/Vector3.h"
-//=============================
+#include <future>
+#include "../../Math/Quaternion.h"
+//================================
 
 namespace spartan
 {
     class Entity;
     class PhysicsWorld;
-    namespace math { class Quaternion; }
 
     enum class PhysicsForce
     {
@@ -48,6 +48,7 @@ namespace spartan
         Mesh,
         Controller,
         Water,
+        Terrain, // height fields built from the entity's terrain, always static
         Max
     };
 
@@ -57,6 +58,16 @@ namespace spartan
         std::vector<RHI_Vertex_PosTexNorTan> vertices;
     };
 
+    // the poses of the last two simulation steps, rendering blends between them since steps don't line up with frames
+    struct PhysicsBodyPose
+    {
+        math::Vector3 position_previous;
+        math::Vector3 position;
+        math::Quaternion rotation_previous;
+        math::Quaternion rotation;
+        bool is_valid = false;
+    };
+
     class Physics : public Component
     {
     public:
@@ -120,7 +131,7 @@ namespace spartan
         float GetCapsuleRadius();
 
         // static
-        bool IsStatic() const { return m_is_static; }
+        bool IsStatic() const { return m_is_static || m_body_type == BodyType::Terrain; }
         void SetStatic(bool is_static);
 
         // misc
@@ -130,6 +141,8 @@ namespace spartan
     private:
         void Create();
         void CreateBodies();
+        void CreateHeightFields();
+        void WaitForCooking();
 
         float m_mass                   = 0.001f;
         float m_friction               = 1.0f;
@@ -148,5 +161,9 @@ namespace spartan
         void* m_mesh                   = nullptr;
         std::vector<void*> m_bodies    = { nullptr };
         std::vector<PhysicsBodyMeshData> m_mesh_data;
+        std::future<void> m_cooking;           // the mesh is being loaded or cooked on a worker
+        bool m_bodies_pending          = false; // create the bodies once cooking is done
+        uint64_t m_step_count          = 0;     // the simulation step the poses were read at
+        std::vector<PhysicsBodyPose> m_poses;
     };
 }
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Camera.h"
 #include "../Entity.h"
 #include "../RHI/RHI_Buffer.h"
+#include "../RHI/RHI_CommandList.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Rendering/Renderer.h"
@@ -132,17 +133,8 @@ namespace spartan
             return renderable_name + "_" + to_string(std::hash<string>{}(hash));
         }
 
-        InstanceData& get_or_create_instance_data(const vector<math::Matrix>& transforms, const string& renderable_name)
+        InstanceData create_instance_data(const vector<math::Matrix>& transforms, const string& renderable_name)
         {
-            string key = generate_instance_key(transforms, renderable_name);
-            auto it = instance_cache.find(key);
-            if (it != instance_cache.end())
-            {
-                SP_LOG_INFO("Reusing instance data for %s (key: %s)", renderable_name.c_str(), key.c_str());
-                return it->second;
-            }
-
-            // create new instance data
             InstanceData data;
             data.transforms = transforms;
             grid_partitioning::reorder_instances_into_cell_chunks(data.transforms, data.group_end_indices);
@@ -165,6 +157,22 @@ namespace spartan
                 ("instance_buffer_" + renderable_name).c_str()
             );
 
+            return data;
+        }
+
+        InstanceData& get_or_create_instance_data(const vector<math::Matrix>& transforms, const string& renderable_name)
+        {
+            string key = generate_instance_key(transforms, renderable_name);
+            auto it = instance_cache.find(key);
+            if (it != instance_cache.end())
+            {
+                SP_LOG_INFO("Reusing instance data for %s (key: %s)", renderable_name.c_str(), key.c_str());
+                return it->second;
+            }
+
+            // create new instance data
+            InstanceData data = create_instance_data(transforms, renderable_name);
+
             // log
             SP_LOG_INFO("Created instance data for %s: instances=%zu, groups=%zu, buffer_size=%u", renderable_name.c_str(), data.transforms.size(), data.group_end_indices.size(), data.buffer->GetElementCount());
 
@@ -186,10 +194,31 @@ namespace spartan
 
     Renderable::~Renderable()
     {
+        OnRemove();
         m_mesh = nullptr;
         instancing::instance_cache.clear();
     }
 
+    void Renderable::OnInitialize()
+    {
+        Component::OnInitialize();
+
+        if (m_occlusion_query_slot == RHI_QuerySlotAllocator::invalid_slot)
+        {
+            m_occlusion_query_slot = RHI_CommandList::AllocateOcclusionQuery();
+        }
+    }
+
+    void Renderable::OnRemove()
+    {
+        // freed slots are recycled, so a world that keeps adding and removing renderables doesn't grow the query pools
+        if (m_occlusion_query_slot != RHI_QuerySlotAllocator::invalid_slot)
+        {
+            RHI_CommandList::FreeOcclusionQuery(m_occlusion_query_slot);
+            m_occlusion_query_slot = RHI_QuerySlotAllocator::invalid_slot;
+        }
+    }
+
     void Renderable::Serialize(FileStream* stream)
     {
         // mesh
@@ -300,6 +329,7 @@ namespace spartan
 
         UpdateFrustumAndDistanceCulling();
         UpdateLodIndices();
+        UpdateClusterCulling();
     }
 
     void Renderable::SetMesh(Mesh* mesh, const uint32_t sub_mesh_index)
@@ -328,12 +358,12 @@ namespace spartan
         SetMesh(Renderer::GetStandardMesh(type).get());
     }
 
-    void Renderable::GetGeometry(vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
+    void Renderable::GetGeometry(vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices, const uint32_t lod) const
     {
-        m_mesh->GetGeometry(m_sub_mesh_index, indices, vertices);
+        m_mesh->GetGeometry(m_sub_mesh_index, indices, vertices, lod);
     }
     
-    void Renderable::SetMaterial(const shared_ptr<Material>& material)
+    void Renderable::SetMaterial(const shared_ptr<Material>& material, const bool compute_world_dimensions)
     {
         SP_ASSERT(material != nullptr);
 
@@ -349,6 +379,7 @@ namespace spartan
         }
 
         // compute world dimensions
+        if (compute_world_dimensions)
         {
             // acquire vertices
             vector<RHI_Vertex_PosTexNorTan> vertices;
@@ -397,7 +428,7 @@ namespace spartan
 
     uint32_t Renderable::GetIndexOffset(const uint32_t lod) const
     {
-        return m_mesh->GetSubMesh(m_sub_mesh_index).lods[lod].index_offset;
+        return m_mesh->GetSubMesh(m_sub_mesh_index).lods[lod].index_offset + m_mesh->GetPoolIndexOffset();
     }
 
     uint32_t Renderable::GetIndexCount(const uint32_t lod) const
@@ -407,7 +438,7 @@ namespace spartan
 
     uint32_t Renderable::GetVertexOffset(const uint32_t lod) const
     {
-        return m_mesh->GetSubMesh(m_sub_mesh_index).lods[lod].vertex_offset;
+        return m_mesh->GetSubMesh(m_sub_mesh_index).lods[lod].vertex_offset + m_mesh->GetPoolVertexOffset();
     }
 
     uint32_t Renderable::GetVertexCount(const uint32_t lod) const
@@ -458,8 +489,27 @@ namespace spartan
         return end_index - start_index;
     }
 
-    void Renderable::SetInstances(const vector<Matrix>& transforms)
+    void Renderable::SetInstances(const vector<Matrix>& transforms, const bool cached)
     {
+        if (transforms.empty())
+        {
+            m_instances.clear();
+            m_instance_group_end_indices.clear();
+            m_instance_buffer    = nullptr;
+            m_bounding_box_dirty = true;
+            return;
+        }
+
+        if (!cached)
+        {
+            instancing::InstanceData instance_data = instancing::create_instance_data(transforms, GetEntity()->GetObjectName());
+            m_instances                            = move(instance_data.transforms);
+            m_instance_group_end_indices           = move(instance_data.group_end_indices);
+            m_instance_buffer                      = instance_data.buffer;
+            m_bounding_box_dirty                   = true;
+            return;
+        }
+
         instancing::InstanceData& instance_data = instancing::get_or_create_instance_data(transforms, GetEntity()->GetObjectName());
         m_instances                             = instance_data.transforms;
         m_instance_group_end_indices            = instance_data.group_end_indices;
@@ -549,8 +599,9 @@ namespace spartan
 
     void Renderable::UpdateLodIndices()
     {
-        // note: using projected angle for LOD selection, which is more perceptually accurate
-        // than screen height ratio, for example it will be more consistent across different resolutions
+        // note: lods generated by geometry_processing::build_lod_chain() carry their simplification error, in which case
+        // the coarsest lod whose error projects to less than a pixel is selected, otherwise (e.g. lods added by hand)
+        // the projected angle is used, which is more consistent across resolutions than the screen height ratio
     
         // thresholds for projected angle (defined in degrees, converted to radians)
         static const array<float, 4> lod_angle_thresholds =
@@ -560,9 +611,11 @@ namespace spartan
             5.7f  * math::deg_to_rad,
             2.9f  * math::deg_to_rad
         };
-        const uint32_t lod_count  = GetLodCount();
-        const uint32_t max_lod    = lod_count - 1;
-        Camera* camera            = World::GetCamera();
+        const float max_error_pixels = 1.0f;
+        const uint32_t lod_count     = GetLodCount();
+        const uint32_t max_lod       = lod_count - 1;
+        Camera* camera               = World::GetCamera();
+        m_projected_size             = 0.0f;
     
         // if no camera, use lowest detail lod for all
         if (!camera)
@@ -570,10 +623,20 @@ namespace spartan
             m_lod_indices.fill(max_lod);
             return;
         }
+
+        // screen space error needs a known error for every lod
+        const vector<MeshLod>& lods = m_mesh->GetSubMesh(m_sub_mesh_index).lods;
+        const bool has_lod_errors   = lod_count > 1 && lods[max_lod].error > 0.0f;
+
+        // pixels per unit of world space error at a distance of 1
+        const float screen_height     = Renderer::GetViewport().height;
+        const float pixels_per_radian = screen_height / (2.0f * tan(camera->GetFovVerticalRad() * 0.5f));
+        const Vector3 entity_scale    = GetEntity()->GetScale();
+        const float scale             = max(max(abs(entity_scale.x), abs(entity_scale.y)), abs(entity_scale.z));
     
-        // lambda to compute lod index using projected angle
+        // lambda to compute lod index
         const Vector3 camera_position = camera->GetEntity()->GetPosition();
-        auto compute_lod_index = [&](const BoundingBox& box, bool is_visible, uint32_t index)
+        auto compute_lod_index = [&](const BoundingBox& box, bool is_visible, uint32_t index, float error_scale)
         {
             // if not visible, use lowest detail lod
             if (!is_visible)
@@ -590,24 +653,44 @@ namespace spartan
             Vector3 to_closest    = closest_point - camera_position;
             float distance        = to_closest.Length();
 
+            // projected size, instance groups are made of instances of about the same size, so one of them stands for all
+            const float radius_texture = HasInstancing() ? m_bounding_box_mesh.GetExtents().Length() * error_scale : radius;
+            const float projected_size = box.Contains(camera_position) ? numeric_limits<float>::max() : (2.0f * radius_texture / max(distance, 0.001f)) * pixels_per_radian;
+            m_projected_size           = max(m_projected_size, projected_size);
+
             // if camera is inside or very close to the AABB, use highest detail lod
             if (box.Contains(camera_position))
             {
                 m_lod_indices[index] = 0;
                 return;
             }
-    
-            // compute projected angle (in radians) using the sphere approximation
-            float projected_angle = 2.0f * atan(radius / distance);
 
-            // determine lod index based on projected angle
             uint32_t lod_index = max_lod;
-            for (uint32_t i = 0; i < lod_count - 1; i++)
+            if (has_lod_errors)
+            {
+                // walk from the coarsest lod and stop at the first one whose projected error is acceptable
+                for (uint32_t i = max_lod; i > 0; i--)
+                {
+                    float error_pixels = (lods[i].error * error_scale / distance) * pixels_per_radian;
+                    if (error_pixels <= max_error_pixels)
+                        break;
+
+                    lod_index = i - 1;
+                }
+            }
+            else
             {
-                if (projected_angle > lod_angle_thresholds[i])
+                // compute projected angle (in radians) using the sphere approximation
+                float projected_angle = 2.0f * atan(radius / distance);
+
+                // determine lod index based on projected angle
+                for (uint32_t i = 0; i < lod_count - 1; i++)
                 {
-                    lod_index = i;
-                    break;
+                    if (projected_angle > lod_angle_thresholds[i])
+                    {
+                        lod_index = i;
+                        break;
+                    }
                 }
             }
     
@@ -618,14 +701,48 @@ namespace spartan
         {
             for (uint32_t group_index = 0; group_index < GetInstanceGroupCount(); group_index++)
             {
+                // instances of a group are assumed to be of similar scale, so the first one stands for all of them
+                const Vector3 instance_scale = m_instances[GetInstanceGroupStartIndex(group_index)].GetScale();
+                const float error_scale      = scale * max(max(abs(instance_scale.x), abs(instance_scale.y)), abs(instance_scale.z));
+
                 const BoundingBox& box = GetBoundingBoxInstanceGroup(group_index);
-                compute_lod_index(box, IsVisible(group_index), group_index);
+                compute_lod_index(box, IsVisible(group_index), group_index, error_scale);
             }
         }
         else
         {
             const BoundingBox& box = GetBoundingBox();
-            compute_lod_index(box, IsVisible(), 0);
+            compute_lod_index(box, IsVisible(), 0, scale);
         }
     }
+
+    void Renderable::UpdateClusterCulling()
+    {
+        m_cluster_ranges_valid = false;
+
+        // instances would need per-instance culling, which the instance groups already approximate
+        if (!m_mesh || HasInstancing() || !m_is_visible[0])
+            return;
+
+        Camera* camera = World::GetCamera();
+        Entity* entity = GetEntity();
+        if (!camera || !entity)
+            return;
+
+        const uint32_t lod_index = min(m_lod_indices[0], GetLodCount() - 1);
+        const MeshLod& lod       = m_mesh->GetSubMesh(m_sub_mesh_index).lods[lod_index];
+        if (lod.clusters.empty())
+            return;
+
+        geometry_culling::ClusterCullingParameters parameters;
+        parameters.transform       = entity->GetMatrix();
+        parameters.frustum         = camera->GetFrustum();
+        parameters.camera_position = camera->GetEntity()->GetPosition();
+        parameters.max_distance    = m_max_distance_render;
+        parameters.cull_backfaces  = m_material && static_cast<RHI_CullMode>(m_material->GetProperty(MaterialProperty::CullMode)) == RHI_CullMode::Back;
+        geometry_culling::cull_clusters(lod.clusters, lod.index_offset, parameters, m_cluster_ranges);
+
+        m_cluster_ranges_lod   = lod_index;
+        m_cluster_ranges_valid = true;
+    }
 }
@@ -28,11 +28,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Math/BoundingBox.h"
 #include "../Rendering/Mesh.h"
 #include "../Rendering/Renderer_Definitions.h"
+#include "../../RHI/RHI_QuerySlots.h"
 //============================================
 
 namespace spartan
 {
     class Material;
+    class RHI_Texture;
 
     enum RenderableFlags : uint32_t
     {
@@ -48,12 +50,15 @@ namespace spartan
         // icomponent
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
+        void OnInitialize() override;
+        void OnRemove() override;
         void OnTick() override;
 
         // mesh
         void SetMesh(Mesh* mesh, const uint32_t sub_mesh_index = 0);
         void SetMesh(const MeshType type);
-        void GetGeometry(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
+        Mesh* GetMesh() const { return m_mesh; }
+        void GetGeometry(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices, const uint32_t lod = 0) const;
         uint32_t GetLodCount() const;
         uint32_t GetLodIndex(const uint32_t instance_group_index = 0) const { return m_lod_indices[instance_group_index]; }
         uint32_t GetIndexOffset(const uint32_t lod = 0) const;
@@ -66,6 +71,9 @@ namespace spartan
         bool HasMesh() const { return m_mesh != nullptr; }
         bool IsSolid() const;
 
+        // clusters, for large non-instanced meshes, the index ranges of the clusters which survived culling, or nullptr if the lod should be drawn as a whole
+        const std::vector<MeshIndexRange>* GetClusterIndexRanges(const uint32_t lod) const { return (m_cluster_ranges_valid && m_cluster_ranges_lod == lod) ? &m_cluster_ranges : nullptr; }
+
         // bounding box
         const std::vector<uint32_t>& GetBoundingBoxGroupEndIndices() const               { return m_instance_group_end_indices; }
         uint32_t GetInstanceGroupCount() const                                           { return static_cast<uint32_t>(m_instance_group_end_indices.size()); }
@@ -74,7 +82,7 @@ namespace spartan
         const math::BoundingBox& GetBoundingBoxInstanceGroup(const uint32_t index) const { return m_bounding_box_instance_group.empty() ? math::BoundingBox::Unit : m_bounding_box_instance_group[index]; }
 
         // material
-        void SetMaterial(const std::shared_ptr<Material>& material);
+        void SetMaterial(const std::shared_ptr<Material>& material, const bool compute_world_dimensions = true); // proxies that share a material with what they replace should keep its dimensions
         void SetMaterial(const std::string& file_path);
         void SetDefaultMaterial();
         std::string GetMaterialName() const;
@@ -88,7 +96,7 @@ namespace spartan
         uint32_t GetInstanceCount()  const                      { return static_cast<uint32_t>(m_instances.size()); }
         uint32_t GetInstanceGroupStartIndex(uint32_t group_index) const;
         uint32_t GetInstanceGroupCount(uint32_t group_index) const;
-        void SetInstances(const std::vector<math::Matrix>& transforms);
+        void SetInstances(const std::vector<math::Matrix>& transforms, const bool cached = true); // uncached for transforms which change often (e.g. terrain patches)
         void SetInstance(const uint32_t index, const math::Matrix& transform);
 
         // render distance
@@ -104,6 +112,21 @@ namespace spartan
         bool IsVisible(const uint32_t instance_group_index = 0) const                { return m_is_visible[instance_group_index]; }
         void SetVisible(const bool visible, const uint32_t instance_group_index = 0) { m_is_visible[instance_group_index] = visible; }
 
+        // the largest size, in pixels, this renderable (or an instance of it) spans on screen, zero when not visible, it drives texture streaming
+        float GetProjectedSize() const { return m_projected_size; }
+
+        // hidden renderables (or instance groups) are not drawn, something else draws their geometry (an hlod proxy, a static batch)
+        bool IsHidden(const uint32_t instance_group_index = 0) const                 { return m_is_hidden[instance_group_index]; }
+        void SetHidden(const bool hidden, const uint32_t instance_group_index = 0)   { m_is_hidden[instance_group_index] = hidden; }
+
+        // the texture terrain patches displace themselves with, it's bound for the vertex shader when drawing, it's shared
+        // so that a terrain page which is evicted lives on for as long as a renderable still draws with it
+        RHI_Texture* GetTerrainTexture() const                       { return m_terrain_texture.get(); }
+        void SetTerrainTexture(std::shared_ptr<RHI_Texture> texture) { m_terrain_texture = std::move(texture); }
+
+        // the hardware occlusion query slot this renderable owns for as long as it's part of an entity
+        uint32_t GetOcclusionQuerySlot() const { return m_occlusion_query_slot; }
+
         // flags
         bool HasFlag(const RenderableFlags flag) const { return m_flags & flag; }
         void SetFlag(const RenderableFlags flag, const bool enable = true);
@@ -115,6 +138,7 @@ namespace spartan
     private:
         void UpdateFrustumAndDistanceCulling();
         void UpdateLodIndices();
+        void UpdateClusterCulling();
 
         // geometry/mesh
         Mesh* m_mesh                          = nullptr;
@@ -137,13 +161,22 @@ namespace spartan
         // misc
         math::Matrix m_transform_previous = math::Matrix::Identity;
         uint32_t m_flags                  = RenderableFlags::CastsShadows;
+        std::shared_ptr<RHI_Texture> m_terrain_texture;
 
         // visibility & lods
         float m_max_distance_render                                 = FLT_MAX;
         float m_max_distance_shadow                                 = FLT_MAX;
         std::array<float, renderer_max_entities> m_distance_squared = { 0.0f };
         std::array<bool, renderer_max_entities> m_is_visible        = { false };
+        std::array<bool, renderer_max_entities> m_is_hidden         = { false };
         std::array<uint32_t, renderer_max_entities> m_lod_indices   = { 0 };
+        float m_projected_size                                      = 0.0f;
         uint64_t m_previous_lights                                  = 0; // lights whose frustums this renderable was in last frame
+        uint32_t m_occlusion_query_slot                             = RHI_QuerySlotAllocator::invalid_slot;
+
+        // clusters
+        std::vector<MeshIndexRange> m_cluster_ranges;
+        uint32_t m_cluster_ranges_lod = 0;
+        bool m_cluster_ranges_valid   = false;
     };
 }
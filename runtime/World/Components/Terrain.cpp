@@ -22,7 +22,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =================================
 #include "pch.h"
 #include "Terrain.h"
+#include "Camera.h"
 #include "Renderable.h"
+#include "TerrainCache.h"
 #include "../Entity.h"
 #include "../World.h"
 #include "../../RHI/RHI_Texture.h"
@@ -30,8 +32,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Rendering/Mesh.h"
 #include "../../Rendering/Material.h"
 #include "../../Geometry/GeometryProcessing.h"
+#include "../../Geometry/GeometryScatter.h"
 #include "../../Core/ThreadPool.h"
 #include "../../Core/ProgressTracker.h"
+#include "../../Core/Stopwatch.h"
 //============================================
 
 //= NAMESPACES ===============
@@ -50,6 +54,7 @@ namespace spartan
         const uint32_t scale                = 6;         // the scale of the mesh, this determines the physical size of the terrain, it doesn't affect density
         const uint32_t tile_count           = 8 * scale; // the number of tiles in each dimension to split the terrain into
         const bool create_border            = true;      // if true, the terrain will have a natural border around it, useful for creating mountains or walls, prevents the player from falling off the terrain
+        const bool cdlod                    = true;      // if true, the terrain is drawn with continuous lod patches over streamed pages, otherwise with a mesh per tile
     }
 
     namespace
@@ -101,6 +106,8 @@ namespace spartan
 
         vector<Matrix> find_transforms(
             const uint32_t transform_count,
+            const float radius,                        // the minimum distance between meshes
+            const uint64_t seed,                       // the same seed places the meshes at the same places
             const float max_slope_radians,             // the maximum slope in radians that is acceptable for placing the mesh
             const bool rotate_to_match_surface_normal, // if true, the mesh will be rotated to match the surface normal of the terrain
             const float terrain_offset,                // the offset to apply to the terrain height, useful for placing meshes a bit below the terrain surface
@@ -113,93 +120,195 @@ namespace spartan
         )
         {
             SP_ASSERT(!triangle_data.empty());
-        
-            // step 1: filter acceptable triangles using precomputed data
+
+            // step 1: filter acceptable triangles using precomputed data, and find the area they cover
             vector<uint32_t> acceptable_triangles;
             acceptable_triangles.reserve(triangle_data.size());
+            float min_x    = numeric_limits<float>::max();
+            float min_z    = numeric_limits<float>::max();
+            float max_x    = numeric_limits<float>::lowest();
+            float max_z    = numeric_limits<float>::lowest();
+            float overhang = 0.0f; // the furthest a triangle reaches from its center
             {
-                mt19937 generator(random_device{}());
-                uniform_real_distribution<float> jitter_dist(0.0f, height_jitter);
-                float jitter_amount = jitter_dist(generator);
-
                 for (uint32_t i = 0; i < triangle_data.size(); i++)
                 {
-                    if (triangle_data[i].slope_radians <= max_slope_radians &&
-                        triangle_data[i].height_min >= height_min - jitter_amount &&
-                        triangle_data[i].height_max <= height_max + jitter_amount)
+                    const TriangleData& tri   = triangle_data[i];
+                    const float jitter_amount = height_jitter * static_cast<float>(geometry_scatter::hash(seed, i) >> 40) / static_cast<float>(1 << 24);
+                    if (tri.slope_radians <= max_slope_radians &&
+                        tri.height_min >= height_min - jitter_amount &&
+                        tri.height_max <= height_max + jitter_amount)
                     {
                         acceptable_triangles.push_back(i);
-                        jitter_amount = jitter_dist(generator);
+
+                        const Vector3 center = tri.v0 + (tri.v1_minus_v0 + tri.v2_minus_v0) / 3.0f;
+                        min_x    = min(min_x, center.x);
+                        min_z    = min(min_z, center.z);
+                        max_x    = max(max_x, center.x);
+                        max_z    = max(max_z, center.z);
+                        overhang = max(overhang, Vector2(tri.v0.x - center.x, tri.v0.z - center.z).Length());
+                        overhang = max(overhang, Vector2(tri.v0.x + tri.v1_minus_v0.x - center.x, tri.v0.z + tri.v1_minus_v0.z - center.z).Length());
+                        overhang = max(overhang, Vector2(tri.v0.x + tri.v2_minus_v0.x - center.x, tri.v0.z + tri.v2_minus_v0.z - center.z).Length());
                     }
                 }
-        
+
                 if (acceptable_triangles.empty())
                 {
                     SP_LOG_WARNING("No acceptable triangles found for the given criteria");
                     return {};
                 }
             }
-        
-            // step 2: pre-allocate output vector
-            vector<Matrix> transforms(transform_count);
-        
-            // step 3: parallel placement without mutex by direct assignment
-            auto place_mesh = [&](uint32_t start_index, uint32_t end_index)
+
+            // step 2: sort the triangles into tiles (by their center), and split the count over the tiles by how many they have
+            const geometry_scatter::Tiling tiling = geometry_scatter::create_tiling(min_x, min_z, max_x, max_z, radius, overhang);
+            const uint32_t tile_count             = tiling.GetTileCount();
+            vector<uint32_t> tile_triangle_counts(tile_count, 0);
+            vector<uint32_t> tile_triangle_offsets(tile_count + 1, 0);
+            vector<uint32_t> tile_triangles(acceptable_triangles.size());
+            vector<uint32_t> tile_targets;
             {
-                mt19937 generator(random_device{}());
-                const uint32_t tri_count = static_cast<uint32_t>(acceptable_triangles.size());
-                uniform_int_distribution<> triangle_dist(0, tri_count - 1);
-                uniform_real_distribution<float> dist(0.0f, 1.0f);
-                uniform_real_distribution<float> angle_dist(0.0f, 360.0f);
-                uniform_real_distribution<float> scale_dist(scale_min, scale_max);
-        
-                for (uint32_t i = start_index; i < end_index; i++)
+                vector<uint32_t> triangle_tiles(acceptable_triangles.size());
+                for (size_t i = 0; i < acceptable_triangles.size(); i++)
+                {
+                    const TriangleData& tri = triangle_data[acceptable_triangles[i]];
+                    const Vector3 center    = tri.v0 + (tri.v1_minus_v0 + tri.v2_minus_v0) / 3.0f;
+                    triangle_tiles[i]       = tiling.GetTileIndex(center.x, center.z);
+                    tile_triangle_counts[triangle_tiles[i]]++;
+                }
+
+                for (uint32_t i = 0; i < tile_count; i++)
                 {
-                    uint32_t tri_idx        = acceptable_triangles[triangle_dist(generator)];
-                    const TriangleData& tri = triangle_data[tri_idx];
+                    tile_triangle_offsets[i + 1] = tile_triangle_offsets[i] + tile_triangle_counts[i];
+                }
 
-                    // position
-                    Vector3 position = Vector3::Zero;
+                vector<uint32_t> tile_cursors(tile_triangle_offsets.begin(), tile_triangle_offsets.end() - 1);
+                for (size_t i = 0; i < acceptable_triangles.size(); i++)
+                {
+                    tile_triangles[tile_cursors[triangle_tiles[i]]++] = acceptable_triangles[i];
+                }
+
+                geometry_scatter::distribute(transform_count, tile_triangle_counts, tile_targets);
+            }
+
+            // step 3: sample the tiles of each phase in parallel, every tile has its own generator, seeded by its index, and
+            // writes its transforms straight into its range of the output, which has room for the target count of the tile
+            vector<uint32_t> tile_transform_offsets(tile_count + 1, 0);
+            for (uint32_t i = 0; i < tile_count; i++)
+            {
+                tile_transform_offsets[i + 1] = tile_transform_offsets[i] + tile_targets[i];
+            }
+            vector<uint32_t> tile_transform_counts(tile_count, 0);
+            vector<Matrix> transforms(tile_transform_offsets.back());
+
+            for (uint32_t phase = 0; phase < geometry_scatter::phase_count; phase++)
+            {
+                vector<uint32_t> phase_tiles;
+                for (uint32_t i = 0; i < tile_count; i++)
+                {
+                    if (tiling.GetPhase(i) == phase && tile_targets[i] > 0)
                     {
-                        // compute barycentric coordinates
-                        float r1      = dist(generator);
-                        float r2      = dist(generator);
-                        float sqrt_r1 = sqrtf(r1);
-                        float u       = 1.0f - sqrt_r1;
-                        float v       = r2 * sqrt_r1;
-                        position      = tri.v0 + u * tri.v1_minus_v0 + v * tri.v2_minus_v0 + Vector3(0.0f, terrain_offset, 0.0f);
+                        phase_tiles.push_back(i);
                     }
+                }
 
-                    // rotation
-                    Quaternion rotation;
+                auto sample_tiles = [&](uint32_t start_index, uint32_t end_index)
+                {
+                    vector<geometry_scatter::Cell> grid;
+                    for (uint32_t i = start_index; i < end_index; i++)
                     {
-                        if (rotate_to_match_surface_normal)
+                        const uint32_t tile_index  = phase_tiles[i];
+                        const uint32_t* triangles  = &tile_triangles[tile_triangle_offsets[tile_index]];
+                        const uint32_t tri_count   = tile_triangle_counts[tile_index];
+                        mt19937 generator(static_cast<uint32_t>(geometry_scatter::hash(seed, tile_index)));
+                        uniform_int_distribution<uint32_t> triangle_dist(0, tri_count - 1);
+                        uniform_real_distribution<float> dist(0.0f, 1.0f);
+                        uniform_real_distribution<float> angle_dist(0.0f, 360.0f);
+                        uniform_real_distribution<float> scale_dist(scale_min, scale_max);
+
+                        // the last candidate, which becomes a transform if it's accepted
+                        uint32_t triangle = 0;
+                        float angle       = 0.0f;
+                        float scale       = 1.0f;
+
+                        auto candidate = [&](Vector3& position)
                         {
-                            Quaternion rotate_to_normal  = tri.rotation_to_normal;
-                            Quaternion random_y_rotation = Quaternion::FromEulerAngles(0.0f, angle_dist(generator), 0.0f);
-                            rotation                     = rotate_to_normal * random_y_rotation;
-                        }
-                        else
+                            triangle                = triangles[triangle_dist(generator)];
+                            const TriangleData& tri = triangle_data[triangle];
+
+                            // compute barycentric coordinates
+                            const float sqrt_r1 = sqrtf(dist(generator));
+                            const float u       = 1.0f - sqrt_r1;
+                            const float v       = dist(generator) * sqrt_r1;
+                            position            = tri.v0 + u * tri.v1_minus_v0 + v * tri.v2_minus_v0;
+                            angle               = angle_dist(generator);
+                            scale               = scale_dist(generator);
+
+                            return true;
+                        };
+
+                        auto accept = [&](const Vector3& position)
                         {
-                            rotation = Quaternion::FromEulerAngles(0.0f, angle_dist(generator), 0.0f);
-                        }
-                    }
+                            const TriangleData& tri = triangle_data[triangle];
 
-                    // scale
-                    float scale = scale_dist(generator);
-                    if (scale_by_slope)
-                    {
-                        float slope_normalized = tri.slope_radians / max_slope_radians;
-                        slope_normalized       = clamp(slope_normalized, 0.0f, 1.0f);
-                        scale                  = lerp(scale_max, scale_min, slope_normalized);
+                            // rotation
+                            Quaternion rotation = Quaternion::FromEulerAngles(0.0f, angle, 0.0f);
+                            if (rotate_to_match_surface_normal)
+                            {
+                                rotation = tri.rotation_to_normal * rotation;
+                            }
+
+                            // scale
+                            float scale_final = scale;
+                            if (scale_by_slope)
+                            {
+                                float slope_normalized = tri.slope_radians / max_slope_radians;
+                                slope_normalized       = clamp(slope_normalized, 0.0f, 1.0f);
+                                scale_final            = lerp(scale_max, scale_min, slope_normalized);
+                            }
+
+                            const Vector3 translation = position + Vector3(0.0f, terrain_offset, 0.0f);
+                            return Matrix::CreateScale(scale_final) * Matrix::CreateRotation(rotation) * Matrix::CreateTranslation(translation);
+                        };
+
+                        // more attempts than samples, as candidates close to existing samples are rejected
+                        const uint32_t attempt_count      = tile_targets[tile_index] * 4 + 16;
+                        tile_transform_counts[tile_index] = geometry_scatter::sample_tile(
+                            tiling, tile_index, tile_targets[tile_index], attempt_count,
+                            transforms.data(), tile_transform_offsets, tile_transform_counts,
+                            candidate, accept, grid
+                        );
                     }
-        
-                    transforms[i] = Matrix::CreateScale(scale) * Matrix::CreateRotation(rotation) * Matrix::CreateTranslation(position);
+                };
+
+                // with a small tiling or a low target count, a phase can have one tile or none
+                const uint32_t phase_tile_count = static_cast<uint32_t>(phase_tiles.size());
+                if (phase_tile_count > 1)
+                {
+                    ThreadPool::ParallelLoop(sample_tiles, phase_tile_count);
                 }
-            };
-        
-            ThreadPool::ParallelLoop(place_mesh, transform_count);
-        
+                else if (phase_tile_count == 1)
+                {
+                    sample_tiles(0, phase_tile_count);
+                }
+            }
+
+            // step 4: close the gaps tiles which fell short of their target left, the transforms stay in tile order
+            size_t transform_end = 0;
+            for (uint32_t i = 0; i < tile_count; i++)
+            {
+                const auto tile_begin = transforms.begin() + tile_transform_offsets[i];
+                if (transform_end != tile_transform_offsets[i])
+                {
+                    move(tile_begin, tile_begin + tile_transform_counts[i], transforms.begin() + transform_end);
+                }
+                transform_end += tile_transform_counts[i];
+            }
+            transforms.resize(transform_end);
+
+            if (transforms.size() < transform_count)
+            {
+                SP_LOG_INFO("Placed %u of %u meshes, the rest didn't fit at a distance of %.2f m from each other", static_cast<uint32_t>(transforms.size()), transform_count, radius);
+            }
+
             return transforms;
         }
 
@@ -879,6 +988,258 @@ namespace spartan
         
             ThreadPool::ParallelLoop(apply_noise, width * height);
         }
+
+        // the cache file, its format is in TerrainCache.h
+        namespace cache
+        {
+            const char* file_path = "terrain_cache.bin";
+
+            // identifies the height map and the parameters the terrain was generated with, a cache only applies when it matches
+            uint64_t compute_source_hash(RHI_Texture* height_texture, const float min_y, const float max_y)
+            {
+                // fnv-1a
+                uint64_t hash = 14695981039346656037ull;
+                auto mix      = [&hash](const void* data, const size_t size)
+                {
+                    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                    for (size_t i = 0; i < size; i++)
+                    {
+                        hash = (hash ^ bytes[i]) * 1099511628211ull;
+                    }
+                };
+
+                const vector<byte>& bytes = height_texture->GetMip(0, 0).bytes;
+                const uint32_t values[]   =
+                {
+                    height_texture->GetWidth(),
+                    height_texture->GetHeight(),
+                    height_texture->GetChannelCount(),
+                    height_texture->GetBitsPerChannel(),
+                    parameters::smoothing_iterations,
+                    parameters::density,
+                    parameters::scale,
+                    parameters::tile_count,
+                    static_cast<uint32_t>(parameters::create_border),
+                    static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan))
+                };
+                mix(bytes.data(), bytes.size());
+                mix(values, sizeof(values));
+                mix(&min_y, sizeof(float));
+                mix(&max_y, sizeof(float));
+
+                return hash;
+            }
+        }
+
+        // the terrain is drawn with a single grid patch, instanced over the nodes a quadtree selects around the camera, the patches
+        // are displaced in the vertex shader by pages of (normal, height) texels, a coarse page of the whole terrain is always
+        // resident and full resolution pages of the tiles near the camera are streamed in from a file
+        namespace cdlod
+        {
+            const uint32_t tile_lod        = 3;          // the quadtree lod whose nodes are tiles, finer nodes need the page of their tile
+            const uint32_t tile_samples    = TerrainQuadtree::patch_resolution << tile_lod;
+            const uint32_t coarse_step     = 4;          // the coarse page keeps every nth sample, the grid of a tile node is coarser
+            const uint32_t pages_resident  = 48;         // the most tile pages requested at once
+            const float distance_request   = 1.25f;      // tile pages are requested within this many times the range they are needed at
+            const float distance_evict     = 1.5f;       // and evicted beyond this many times, so that they don't thrash at the boundary
+            const uint32_t file_magic      = 0x4C545453; // "STTL"
+            const uint32_t file_version    = 2;
+
+            struct Texel
+            {
+                float normal[3];
+                float height;
+            };
+
+            struct FileHeader
+            {
+                uint32_t magic         = file_magic;
+                uint32_t version       = file_version;
+                uint64_t source_hash   = 0; // the same as the terrain cache, so the pages never outlive it
+                uint32_t width         = 0; // in samples
+                uint32_t height        = 0;
+                float spacing          = 0.0f;
+                float origin_x         = 0.0f;
+                float origin_z         = 0.0f;
+                uint32_t tile_samples  = cdlod::tile_samples;
+                uint32_t tiles_x       = 0;
+                uint32_t tiles_z       = 0;
+                uint32_t coarse_step   = cdlod::coarse_step;
+                uint32_t coarse_width  = 0;
+                uint32_t coarse_height = 0;
+
+                uint64_t GetTilesOffset() const { return sizeof(FileHeader) + static_cast<uint64_t>(coarse_width) * coarse_height * sizeof(Texel); }
+                uint64_t GetTileSize() const    { return static_cast<uint64_t>(tile_samples + 1) * (tile_samples + 1) * sizeof(Texel); }
+                float GetExtentX() const        { return static_cast<float>(width - 1) * spacing; }
+                float GetExtentZ() const        { return static_cast<float>(height - 1) * spacing; }
+            };
+            static FileHeader file_header;
+
+            // it's derived from the terrain cache, so it's kept with the rest of the project's caches
+            string get_file_path()
+            {
+                return ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "/terrain_tiles.bin";
+            }
+
+            FileHeader create_header(const vector<RHI_Vertex_PosTexNorTan>& vertices, const uint32_t width, const uint32_t height)
+            {
+                FileHeader header;
+                header.width         = width;
+                header.height        = height;
+                header.origin_x      = vertices[0].pos[0];
+                header.origin_z      = vertices[0].pos[2];
+                header.spacing       = (vertices[width - 1].pos[0] - header.origin_x) / static_cast<float>(width - 1);
+                header.tiles_x       = (width  - 2) / tile_samples + 1;
+                header.tiles_z       = (height - 2) / tile_samples + 1;
+                header.coarse_width  = (width  - 2) / coarse_step + 2;
+                header.coarse_height = (height - 2) / coarse_step + 2;
+
+                return header;
+            }
+
+            // samples past the edge of the terrain are clamped to it
+            Texel get_texel(const vector<RHI_Vertex_PosTexNorTan>& vertices, const FileHeader& header, const uint32_t x, const uint32_t z)
+            {
+                const RHI_Vertex_PosTexNorTan& vertex = vertices[min(z, header.height - 1) * header.width + min(x, header.width - 1)];
+                return { { vertex.nor[0], vertex.nor[1], vertex.nor[2] }, vertex.pos[1] };
+            }
+
+            bool write_file(const vector<RHI_Vertex_PosTexNorTan>& vertices, const FileHeader& header)
+            {
+                const string file_path = get_file_path();
+                FileSystem::CreateDirectory_(FileSystem::GetDirectoryFromFilePath(file_path));
+                ofstream file(file_path, ios::binary);
+                if (!file.is_open())
+                {
+                    SP_LOG_ERROR("failed to open file for writing: %s", file_path.c_str());
+                    return false;
+                }
+
+                file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+
+                // the coarse page
+                vector<Texel> texels(header.coarse_width);
+                for (uint32_t z = 0; z < header.coarse_height; z++)
+                {
+                    for (uint32_t x = 0; x < header.coarse_width; x++)
+                    {
+                        texels[x] = get_texel(vertices, header, x * coarse_step, z * coarse_step);
+                    }
+                    file.write(reinterpret_cast<const char*>(texels.data()), texels.size() * sizeof(Texel));
+                }
+
+                // the tile pages, every tile also holds the first row and column of its neighbours, so it covers its own edges
+                texels.resize(header.tile_samples + 1);
+                for (uint32_t tile_z = 0; tile_z < header.tiles_z; tile_z++)
+                {
+                    for (uint32_t tile_x = 0; tile_x < header.tiles_x; tile_x++)
+                    {
+                        for (uint32_t z = 0; z <= header.tile_samples; z++)
+                        {
+                            for (uint32_t x = 0; x <= header.tile_samples; x++)
+                            {
+                                texels[x] = get_texel(vertices, header, tile_x * header.tile_samples + x, tile_z * header.tile_samples + z);
+                            }
+                            file.write(reinterpret_cast<const char*>(texels.data()), texels.size() * sizeof(Texel));
+                        }
+                    }
+                }
+
+                return file.good();
+            }
+
+            bool read_header(FileHeader& header)
+            {
+                ifstream file(get_file_path(), ios::binary);
+                if (!file.is_open())
+                    return false;
+
+                file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+                return file.good() && header.magic == file_magic && header.version == file_version;
+            }
+
+            // a page is a texture of texels with an extra first row, which describes where the page is, so that the vertex
+            // shader can place any patch on any page: the position of the first texel and the texel spacing, then the
+            // rectangle the whole terrain covers
+            shared_ptr<RHI_Texture> load_page(const FileHeader& header, const uint64_t offset, const uint32_t width, const uint32_t height, const float x, const float z, const float spacing, const string& name)
+            {
+                ifstream file(get_file_path(), ios::binary);
+                if (!file.is_open())
+                    return nullptr;
+
+                vector<RHI_Texture_Slice> data;
+                vector<byte>& bytes = data.emplace_back().mips.emplace_back().bytes;
+                bytes.resize(static_cast<size_t>(width) * (height + 1) * sizeof(Texel));
+
+                Texel* texels = reinterpret_cast<Texel*>(bytes.data());
+                texels[0]     = { { x, z, spacing }, 0.0f };
+                texels[1]     = { { header.origin_x, header.origin_z, header.GetExtentX() }, header.GetExtentZ() };
+
+                file.seekg(static_cast<streamoff>(offset));
+                file.read(reinterpret_cast<char*>(texels + width), static_cast<streamsize>(width) * height * sizeof(Texel));
+                if (!file.good())
+                    return nullptr;
+
+                return make_shared<RHI_Texture>(RHI_Texture_Type::Type2D, width, height + 1, 1, 1, RHI_Format::R32G32B32A32_Float, RHI_Texture_Srv, name.c_str(), move(data));
+            }
+
+            shared_ptr<RHI_Texture> load_page_coarse(const FileHeader& header)
+            {
+                const float spacing = header.spacing * static_cast<float>(header.coarse_step);
+                return load_page(header, sizeof(FileHeader), header.coarse_width, header.coarse_height, header.origin_x, header.origin_z, spacing, "terrain_page_coarse");
+            }
+
+            shared_ptr<RHI_Texture> load_page_tile(const FileHeader& header, const uint32_t tile_index)
+            {
+                const uint32_t tile_x = tile_index % header.tiles_x;
+                const uint32_t tile_z = tile_index / header.tiles_x;
+                const float x         = header.origin_x + static_cast<float>(tile_x * header.tile_samples) * header.spacing;
+                const float z         = header.origin_z + static_cast<float>(tile_z * header.tile_samples) * header.spacing;
+                const uint64_t offset = header.GetTilesOffset() + tile_index * header.GetTileSize();
+
+                return load_page(header, offset, header.tile_samples + 1, header.tile_samples + 1, x, z, header.spacing, "terrain_page_" + to_string(tile_index));
+            }
+
+            // a unit grid, its far corner is raised so that the bounding box is a unit cube, which the instance
+            // transforms then scale to the extent of each node, heights included
+            shared_ptr<Mesh> create_patch_mesh()
+            {
+                const uint32_t resolution = TerrainQuadtree::patch_resolution;
+                const float step          = 1.0f / static_cast<float>(resolution);
+
+                vector<RHI_Vertex_PosTexNorTan> vertices;
+                vector<uint32_t> indices;
+                vertices.reserve((resolution + 1) * (resolution + 1));
+                indices.reserve(resolution * resolution * 6);
+                for (uint32_t z = 0; z <= resolution; z++)
+                {
+                    for (uint32_t x = 0; x <= resolution; x++)
+                    {
+                        const float y = (x == resolution && z == resolution) ? 1.0f : 0.0f;
+                        vertices.emplace_back(Vector3(x * step, y, z * step), Vector2(x * step, z * step), Vector3::Up, Vector3::Right);
+                    }
+                }
+                for (uint32_t z = 0; z < resolution; z++)
+                {
+                    for (uint32_t x = 0; x < resolution; x++)
+                    {
+                        const uint32_t bottom_left  = z * (resolution + 1) + x;
+                        const uint32_t bottom_right = bottom_left + 1;
+                        const uint32_t top_left     = bottom_left + resolution + 1;
+                        const uint32_t top_right    = top_left + 1;
+                        indices.insert(indices.end(), { bottom_right, bottom_left, top_left, bottom_right, top_left, top_right });
+                    }
+                }
+
+                shared_ptr<Mesh> mesh = make_shared<Mesh>();
+                mesh->SetObjectName("terrain_patch");
+                mesh->SetFlag(static_cast<uint32_t>(MeshFlags::PostProcessOptimize), false);
+                mesh->AddGeometry(vertices, indices, false);
+                mesh->CreateGpuBuffers();
+
+                return mesh;
+            }
+        }
     }
 
     Terrain::Terrain(Entity* entity) : Component(entity)
@@ -889,9 +1250,18 @@ namespace spartan
 
     Terrain::~Terrain()
     {
+        WaitForPages();
         m_height_texture = nullptr;
     }
 
+    void Terrain::OnTick()
+    {
+        if (m_patches_ready)
+        {
+            UpdatePatches();
+        }
+    }
+
     void Terrain::GenerateTransforms(vector<Matrix>* transforms, const uint32_t count, const TerrainProp terrain_prop, float offset_y)
     {
         bool rotate_match_surface_normal = false;                        // don't rotate to match the surface normal
@@ -903,6 +1273,8 @@ namespace spartan
         float scale_max                  = 1.0f;
         bool scale_by_slope              = false;                        // relevant for rocks (in real life, larger rocks tend to settle on flatter terrain)
         float height_variation           = 0.0f;
+        float radius                     = 1.0f;                         // the minimum distance between instances
+        const uint64_t seed              = static_cast<uint64_t>(terrain_prop) + 1; // every prop type is placed the same way every time
     
         if (terrain_prop == TerrainProp::Tree)
         {
@@ -911,6 +1283,7 @@ namespace spartan
             height_max = parameters::level_snow + 20;  // stop a bit above the snow
             scale_min  = 0.8f;
             scale_max  = 1.5f;
+            radius     = 6.0f;                         // about the width of a canopy
         }
         else if (terrain_prop == TerrainProp::Grass)
         {
@@ -921,6 +1294,7 @@ namespace spartan
             scale_min                   = 1.0f;
             scale_max                   = 1.5f;
             height_variation            = 5.0f;                        // ensure grass doesn't hit a min or max limit and form a perfect line
+            radius                      = 0.2f;                         // blades can be dense, but not on top of each other
         }
         else if (terrain_prop == TerrainProp::Rock)
         {
@@ -931,124 +1305,150 @@ namespace spartan
             scale_min                   = 0.1f;
             scale_max                   = 1.5f;
             scale_by_slope              = true;
+            radius                      = 3.0f;
         }
         else
         {
             SP_ASSERT_MSG(false, "Unknown terrain prop type for GenerateTransforms");
         }
     
-        *transforms = find_transforms(count, max_slope, rotate_match_surface_normal, terrain_offset, height_min, height_max, scale_min, scale_max, scale_by_slope, height_variation);
+        *transforms = find_transforms(count, radius, seed, max_slope, rotate_match_surface_normal, terrain_offset, height_min, height_max, scale_min, scale_max, scale_by_slope, height_variation);
     }
 
     void Terrain::SaveToFile(const char* file_path)
     {
-        ofstream file(file_path, ios::binary);
-        if (!file.is_open())
+        // the sections, the placement data isn't stored as it's as large as everything else together and quick to recompute
+        vector<terrain_cache::SectionData> sections;
+        auto add_section = [&sections](const terrain_cache::SectionType type, const uint32_t tile_index, void* data, const uint64_t size)
         {
-            SP_LOG_ERROR("failed to open file for writing: %s", file_path);
-            return;
+            sections.push_back({ { type, tile_index, 0, size }, static_cast<char*>(data) });
+        };
+        add_section(terrain_cache::SectionType::HeightData,  0, m_height_data.data(),  m_height_data.size()  * sizeof(float));
+        add_section(terrain_cache::SectionType::Vertices,    0, m_vertices.data(),     m_vertices.size()     * sizeof(RHI_Vertex_PosTexNorTan));
+        add_section(terrain_cache::SectionType::Indices,     0, m_indices.data(),      m_indices.size()      * sizeof(uint32_t));
+        add_section(terrain_cache::SectionType::TileOffsets, 0, m_tile_offsets.data(), m_tile_offsets.size() * sizeof(Vector3));
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_tile_vertices.size()); i++)
+        {
+            add_section(terrain_cache::SectionType::TileVertices, i, m_tile_vertices[i].data(), m_tile_vertices[i].size() * sizeof(RHI_Vertex_PosTexNorTan));
+            add_section(terrain_cache::SectionType::TileIndices,  i, m_tile_indices[i].data(),  m_tile_indices[i].size()  * sizeof(uint32_t));
         }
-    
-        uint32_t width = GetWidth();
-        uint32_t height = GetHeight();
-        uint32_t height_data_size = static_cast<uint32_t>(m_height_data.size());
-        uint32_t vertex_count = static_cast<uint32_t>(m_vertices.size());
-        uint32_t index_count = static_cast<uint32_t>(m_indices.size());
-        uint32_t tile_count = static_cast<uint32_t>(m_tile_vertices.size());
-        uint32_t placement_count = static_cast<uint32_t>(triangle_data.size());
-        uint32_t offset_count = static_cast<uint32_t>(m_tile_offsets.size());
-    
-        file.write(reinterpret_cast<const char*>(&width), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&height), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&height_data_size), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&vertex_count), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&index_count), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&tile_count), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&placement_count), sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(&offset_count), sizeof(uint32_t));
-    
-        file.write(reinterpret_cast<const char*>(m_height_data.data()), height_data_size * sizeof(float));
-        file.write(reinterpret_cast<const char*>(m_vertices.data()), vertex_count * sizeof(RHI_Vertex_PosTexNorTan));
-        file.write(reinterpret_cast<const char*>(m_indices.data()), index_count * sizeof(uint32_t));
-        file.write(reinterpret_cast<const char*>(triangle_data.data()), placement_count * sizeof(TriangleData));
-        file.write(reinterpret_cast<const char*>(m_tile_offsets.data()), offset_count * sizeof(Vector3));
-    
-        for (uint32_t i = 0; i < tile_count; i++)
+
+        terrain_cache::FileHeader header;
+        header.source_hash = m_source_hash;
+        header.width       = m_width;
+        header.height      = m_height;
+        header.tile_count  = static_cast<uint32_t>(m_tile_vertices.size());
+
+        const uint64_t file_size = terrain_cache::write_sections(file_path, header, sections);
+        if (file_size == 0)
         {
-            uint32_t vertex_size = static_cast<uint32_t>(m_tile_vertices[i].size());
-            uint32_t index_size = static_cast<uint32_t>(m_tile_indices[i].size());
-            file.write(reinterpret_cast<const char*>(&vertex_size), sizeof(uint32_t));
-            file.write(reinterpret_cast<const char*>(&index_size), sizeof(uint32_t));
-            file.write(reinterpret_cast<const char*>(m_tile_vertices[i].data()), vertex_size * sizeof(RHI_Vertex_PosTexNorTan));
-            file.write(reinterpret_cast<const char*>(m_tile_indices[i].data()), index_size * sizeof(uint32_t));
+            SP_LOG_ERROR("failed to write terrain to %s", file_path);
+            return;
         }
-    
-        file.close();
-    
-        SP_LOG_INFO("saved terrain to %s: width=%u, height=%u, height_data_size=%u, vertex_count=%u, index_count=%u, tile_count=%u, offset_count=%u",
-                    file_path, width, height, height_data_size, vertex_count, index_count, tile_count, offset_count);
+
+        SP_LOG_INFO("saved terrain to %s: width=%u, height=%u, sections=%u, size=%.1f MB",
+                    file_path, header.width, header.height, header.section_count, static_cast<double>(file_size) / (1024.0 * 1024.0));
     }
-    
-    void Terrain::LoadFromFile(const char* file_path)
+
+    bool Terrain::LoadFromFile(const char* file_path)
     {
-        ifstream file(file_path, ios::binary);
+        const Stopwatch timer;
+
+        ifstream file(file_path, ios::binary | ios::ate);
         if (!file.is_open())
-            return;
-    
-        uint32_t height_data_size = 0;
-        uint32_t vertex_count = 0;
-        uint32_t index_count = 0;
-        uint32_t tile_count = 0;
-        uint32_t placement_count = 0;
-        uint32_t offset_count = 0;
-    
-        file.read(reinterpret_cast<char*>(&m_width), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&m_height), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&height_data_size), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&vertex_count), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&index_count), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&tile_count), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&placement_count), sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(&offset_count), sizeof(uint32_t)); 
-    
-        if (tile_count > 10000 || offset_count > 10000)
+            return false;
+
+        const uint64_t file_size = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+
+        // the cache only applies to the height map and the parameters it was generated from
+        terrain_cache::FileHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(terrain_cache::FileHeader));
+        if (!file.good() || header.magic != terrain_cache::file_magic || header.version != terrain_cache::file_version)
         {
-            SP_LOG_ERROR("invalid tile_count (%u) or offset_count (%u) read from file, aborting load", tile_count, offset_count);
-            file.close();
-            return;
+            SP_LOG_INFO("%s doesn't match the current format, ignoring it", file_path);
+            return false;
         }
-    
-        m_height_data.resize(height_data_size);
-        m_vertices.resize(vertex_count);
-        m_indices.resize(index_count);
-        m_tile_vertices.resize(tile_count);
-        m_tile_indices.resize(tile_count);
-        m_tile_offsets.resize(offset_count);
-        triangle_data.resize(placement_count);
-    
-        file.read(reinterpret_cast<char*>(m_height_data.data()), height_data_size * sizeof(float));
-        file.read(reinterpret_cast<char*>(m_vertices.data()), vertex_count * sizeof(RHI_Vertex_PosTexNorTan));
-        file.read(reinterpret_cast<char*>(m_indices.data()), index_count * sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(triangle_data.data()), placement_count * sizeof(TriangleData));
-        file.read(reinterpret_cast<char*>(m_tile_offsets.data()), offset_count * sizeof(Vector3));
-    
-        for (uint32_t i = 0; i < tile_count; i++)
+
+        if (header.source_hash != m_source_hash)
         {
-            uint32_t vertex_size, index_size;
-            file.read(reinterpret_cast<char*>(&vertex_size), sizeof(uint32_t));
-            file.read(reinterpret_cast<char*>(&index_size), sizeof(uint32_t));
-    
-            m_tile_vertices[i].resize(vertex_size);
-            m_tile_indices[i].resize(index_size);
-    
-            file.read(reinterpret_cast<char*>(m_tile_vertices[i].data()), vertex_size * sizeof(RHI_Vertex_PosTexNorTan));
-            file.read(reinterpret_cast<char*>(m_tile_indices[i].data()), index_size * sizeof(uint32_t));
+            SP_LOG_INFO("%s was generated from another height map or with other parameters, ignoring it", file_path);
+            return false;
         }
-    
+
+        if (header.tile_count > 10000 || header.section_count != 4 + header.tile_count * 2)
+        {
+            SP_LOG_ERROR("invalid tile_count (%u) or section_count (%u) read from %s, ignoring it", header.tile_count, header.section_count, file_path);
+            return false;
+        }
+
+        vector<terrain_cache::Section> table(header.section_count);
+        file.read(reinterpret_cast<char*>(table.data()), table.size() * sizeof(terrain_cache::Section));
+        if (!file.good())
+            return false;
         file.close();
-    
-        SP_LOG_INFO("loaded terrain from %s: width=%u, height=%u, height_data_size=%u, vertex_count=%u, index_count=%u, tile_count=%u, offset_count=%u",
-                    file_path, m_width, m_height, height_data_size, vertex_count, index_count, tile_count, offset_count);
+
+        // size the destinations, sections which don't fit in the file or their element type are rejected before anything is allocated
+        m_tile_vertices.assign(header.tile_count, {});
+        m_tile_indices.assign(header.tile_count, {});
+        vector<terrain_cache::SectionData> sections;
+        sections.reserve(table.size());
+        bool valid  = true;
+        auto resize = [&valid](auto& destination, const uint64_t size) -> char*
+        {
+            using element = typename remove_reference_t<decltype(destination)>::value_type;
+            valid        &= size % sizeof(element) == 0;
+            destination.resize(valid ? size / sizeof(element) : 0);
+            return reinterpret_cast<char*>(destination.data());
+        };
+        for (const terrain_cache::Section& section : table)
+        {
+            const bool is_tile = section.type == terrain_cache::SectionType::TileVertices || section.type == terrain_cache::SectionType::TileIndices;
+            valid &= section.offset <= file_size && section.size <= file_size - section.offset;
+            valid &= !is_tile || section.tile_index < header.tile_count;
+            if (!valid)
+                break;
+
+            char* data = nullptr;
+            switch (section.type)
+            {
+                case terrain_cache::SectionType::HeightData:   data = resize(m_height_data,                       section.size); break;
+                case terrain_cache::SectionType::Vertices:     data = resize(m_vertices,                          section.size); break;
+                case terrain_cache::SectionType::Indices:      data = resize(m_indices,                           section.size); break;
+                case terrain_cache::SectionType::TileOffsets:  data = resize(m_tile_offsets,                      section.size); break;
+                case terrain_cache::SectionType::TileVertices: data = resize(m_tile_vertices[section.tile_index], section.size); break;
+                case terrain_cache::SectionType::TileIndices:  data = resize(m_tile_indices[section.tile_index],  section.size); break;
+                default:                                       valid = false;                                                    break;
+            }
+            sections.push_back({ section, data });
+        }
+
+        // the full resolution grid has to match the height map as well
+        const uint64_t dense_width  = parameters::density * (static_cast<uint64_t>(header.width)  - 1) + 1;
+        const uint64_t dense_height = parameters::density * (static_cast<uint64_t>(header.height) - 1) + 1;
+        valid &= header.width > 1 && header.height > 1 && m_tile_offsets.size() == header.tile_count;
+        valid &= m_vertices.size() == dense_width * dense_height && m_indices.size() == (dense_width - 1) * (dense_height - 1) * 6;
+
+        if (!valid || !terrain_cache::read_sections(file_path, sections))
+        {
+            SP_LOG_ERROR("%s is corrupt, ignoring it", file_path);
+            m_height_data.clear();
+            m_vertices.clear();
+            m_indices.clear();
+            m_tile_offsets.clear();
+            m_tile_vertices.clear();
+            m_tile_indices.clear();
+            return false;
+        }
+
+        m_width  = header.width;
+        m_height = header.height;
+        compute_triangle_data(m_vertices, m_indices);
+
+        SP_LOG_INFO("loaded terrain from %s: width=%u, height=%u, sections=%u, size=%.1f MB, duration %.2f ms",
+                    file_path, m_width, m_height, header.section_count, static_cast<double>(file_size) / (1024.0 * 1024.0), timer.GetElapsedTimeMs());
+
+        return true;
     }
 
     uint32_t Terrain::GetDensity() const
@@ -1083,14 +1483,11 @@ namespace spartan
         uint32_t job_count = 9;
         ProgressTracker::GetProgress(ProgressType::Terrain).Start(job_count, "generating terrain...");
     
-        // define cache file path
-        const string cache_file = "terrain_cache.bin";
-        bool loaded_from_cache  = false;
-    
         // try to load from cache
+        bool loaded_from_cache = false;
         {
-            LoadFromFile(cache_file.c_str());
-            if (!m_vertices.empty())
+            m_source_hash = cache::compute_source_hash(m_height_texture, m_min_y, m_max_y);
+            if (LoadFromFile(cache::file_path))
             {
                 loaded_from_cache = true;
                 ProgressTracker::GetProgress(ProgressType::Terrain).SetText("loaded from cache, skipping to mesh creation...");
@@ -1170,19 +1567,41 @@ namespace spartan
             // 8. split into tiles
             {
                 ProgressTracker::GetProgress(ProgressType::Terrain).SetText("splitting into tiles...");
-                spartan::geometry_processing::split_surface_into_tiles(m_vertices, m_indices, parameters::tile_count, m_tile_vertices, m_tile_indices, m_tile_offsets);
+                spartan::geometry_processing::split_grid_into_tiles(m_vertices, dense_width, dense_height, parameters::tile_count, m_tile_vertices, m_tile_indices, m_tile_offsets);
                 ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
-                SaveToFile(cache_file.c_str());
+                SaveToFile(cache::file_path);
             }
         }
     
-        // initialize members
+        // initialize members, the dimensions are known from the cache as well
+        dense_width      = parameters::density * (m_width - 1) + 1;
+        dense_height     = parameters::density * (m_height - 1) + 1;
         m_height_samples = dense_width * dense_height;
         m_vertex_count   = static_cast<uint32_t>(m_vertices.size());
         m_index_count    = static_cast<uint32_t>(m_indices.size());
         m_triangle_count = m_index_count / 3;
+
+        // keep the surface (the vertices are released below), colliders are built from it
+        {
+            m_height_field.width    = dense_width;
+            m_height_field.height   = dense_height;
+            m_height_field.origin_x = m_vertices[0].pos[0];
+            m_height_field.origin_z = m_vertices[0].pos[2];
+            m_height_field.spacing  = (m_vertices[dense_width - 1].pos[0] - m_height_field.origin_x) / static_cast<float>(dense_width - 1);
+            m_height_field.heights.resize(m_vertices.size());
+            for (size_t i = 0; i < m_vertices.size(); i++)
+            {
+                m_height_field.heights[i] = m_vertices[i].pos[1];
+            }
+        }
+
+        if (parameters::cdlod)
+        {
+            CreatePatches(dense_width, dense_height, !loaded_from_cache);
+        }
     
-        // 8. create a mesh for each tile
+        // 8. create a mesh for each tile, unless the patches draw the terrain
+        if (!m_patches_ready)
         {
             ProgressTracker::GetProgress(ProgressType::Terrain).SetText("creating gpu mesh...");
             m_mesh = make_shared<Mesh>();
@@ -1191,10 +1610,12 @@ namespace spartan
             m_mesh->SetFlag(static_cast<uint32_t>(MeshFlags::PostProcessPreserveTerrainEdges), true); // so that nearby tiles with low lods don't have visible seams
             m_mesh->SetLodDropoff(MeshLodDropoff::Linear);
     
+            vector<uint32_t> sub_mesh_indices;
             for (uint32_t tile_index = 0; tile_index < static_cast<uint32_t>(m_tile_vertices.size()); tile_index++)
             {
                 uint32_t sub_mesh_index = 0;
-                m_mesh->AddGeometry(m_tile_vertices[tile_index], m_tile_indices[tile_index], true, &sub_mesh_index);
+                m_mesh->AddGeometry(m_tile_vertices[tile_index], m_tile_indices[tile_index], false, &sub_mesh_index);
+                sub_mesh_indices.push_back(sub_mesh_index);
                 shared_ptr<Entity> entity = World::CreateEntity();
                 entity->SetObjectName("tile_" + to_string(tile_index));
                 entity->SetParent(World::GetEntityById(m_entity_ptr->GetObjectId()));
@@ -1205,10 +1626,12 @@ namespace spartan
                     renderable->SetMaterial(m_material);
                 }
             }
-    
+
+            // generate the lods of all tiles in parallel
+            m_mesh->GenerateLods(sub_mesh_indices);
             m_mesh->CreateGpuBuffers();
-            ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
         }
+        ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
     
         m_area_km2      = compute_terrain_area_km2(m_vertices);
         m_is_generating = false;
@@ -1222,10 +1645,25 @@ namespace spartan
 
     void Terrain::Clear()
     {
+        m_patches_ready = false;
+        WaitForPages();
+        m_pages.clear();
+        m_pages_loaded.clear();
+        m_pages_requested.clear();
+        m_page_coarse = nullptr;
+        if (Entity* entity = m_entity_ptr->GetDescendantByName("terrain_cdlod"))
+        {
+            World::RemoveEntity(entity);
+        }
+        m_patch_entities.clear();
+        m_patch_nodes.clear();
+        m_patch_mesh = nullptr;
+
         m_vertices.clear();
         m_indices.clear();
         m_tile_vertices.clear();
         m_tile_indices.clear();
+        m_height_field = TerrainHeightField();
         ResourceCache::Remove(m_mesh);
         m_mesh = nullptr;
 
@@ -1237,4 +1675,213 @@ namespace spartan
             }
         }
     }
+
+    void Terrain::CreatePatches(const uint32_t width, const uint32_t height, const bool rewrite_pages)
+    {
+        // the pages are written whenever the terrain is generated, or when they don't match it
+        cdlod::FileHeader header = cdlod::create_header(m_vertices, width, height);
+        header.source_hash       = m_source_hash;
+        cdlod::FileHeader header_file;
+        const bool file_matches = cdlod::read_header(header_file) &&
+            header_file.source_hash  == header.source_hash  &&
+            header_file.width        == header.width        &&
+            header_file.height       == header.height       &&
+            header_file.spacing      == header.spacing      &&
+            header_file.tile_samples == header.tile_samples &&
+            header_file.coarse_step  == header.coarse_step;
+
+        bool pages_valid = file_matches && !rewrite_pages;
+        if (!pages_valid)
+        {
+            ProgressTracker::GetProgress(ProgressType::Terrain).SetText("writing pages...");
+            pages_valid = cdlod::write_file(m_vertices, header);
+        }
+
+        cdlod::file_header = header;
+        m_page_coarse      = pages_valid ? cdlod::load_page_coarse(header) : nullptr;
+        if (!m_page_coarse)
+        {
+            SP_LOG_ERROR("failed to prepare the terrain pages, falling back to the tiles");
+            return;
+        }
+
+        // quadtree
+        {
+            m_quadtree.Build(m_height_field.heights.data(), width, height, header.spacing, header.origin_x, header.origin_z);
+            m_tiles_x = header.tiles_x;
+            m_tiles_z = header.tiles_z;
+        }
+
+        // an entity for the patches of the coarse page, and one for those of every tile page
+        {
+            m_patch_mesh = cdlod::create_patch_mesh();
+
+            shared_ptr<Entity> entity_root = World::CreateEntity();
+            entity_root->SetObjectName("terrain_cdlod");
+            entity_root->SetParent(World::GetEntityById(m_entity_ptr->GetObjectId()));
+
+            m_patch_entities.clear();
+            for (uint32_t i = 0; i < 1 + m_tiles_x * m_tiles_z; i++)
+            {
+                shared_ptr<Entity> entity = World::CreateEntity();
+                entity->SetObjectName(i == 0 ? string("patches_coarse") : "patches_tile_" + to_string(i - 1));
+                entity->SetParent(entity_root);
+                if (Renderable* renderable = entity->AddComponent<Renderable>())
+                {
+                    renderable->SetMesh(m_patch_mesh.get());
+                    renderable->SetMaterial(m_material);
+                    renderable->SetHidden(true);
+                }
+                m_patch_entities.push_back(entity);
+            }
+            m_patch_nodes.assign(m_patch_entities.size(), {});
+        }
+
+        m_patches_ready = true;
+    }
+
+    void Terrain::UpdatePatches()
+    {
+        Camera* camera = World::GetCamera();
+        if (!camera)
+            return;
+
+        const Vector3 camera_position = camera->GetEntity()->GetPosition();
+        const uint32_t tile_samples   = cdlod::tile_samples;
+        auto get_tile_index = [this, tile_samples](const TerrainQuadtree::Node& node)
+        {
+            return (node.z / tile_samples) * m_tiles_x + node.x / tile_samples;
+        };
+
+        // take the pages which finished loading
+        {
+            lock_guard<mutex> lock(m_pages_mutex);
+            for (auto& [tile_index, page] : m_pages_loaded)
+            {
+                // a page which failed to load is no longer requested either, so it's retried while it's still needed
+                m_pages_requested.erase(tile_index);
+                if (!page)
+                {
+                    SP_LOG_ERROR("failed to load the page of terrain tile %u", tile_index);
+                    continue;
+                }
+
+                m_pages[tile_index] = page;
+            }
+            m_pages_loaded.clear();
+        }
+
+        // request the pages of the nearest tiles, before they are needed, and evict those which are well past it
+        {
+            const float range = m_quadtree.GetRange(cdlod::tile_lod - 1);
+            m_quadtree.GetNodesWithin(cdlod::tile_lod, camera_position.x, camera_position.y, camera_position.z, range * cdlod::distance_request, m_nodes);
+            for (uint32_t i = 0; i < min(static_cast<uint32_t>(m_nodes.size()), cdlod::pages_resident); i++)
+            {
+                RequestPage(get_tile_index(m_nodes[i]));
+            }
+
+            for (auto it = m_pages.begin(); it != m_pages.end();)
+            {
+                TerrainQuadtree::Node node;
+                node.x          = (it->first % m_tiles_x) * tile_samples;
+                node.z          = (it->first / m_tiles_x) * tile_samples;
+                node.size       = tile_samples;
+                node.height_min = numeric_limits<float>::lowest();
+                node.height_max = numeric_limits<float>::max();
+                const bool far  = m_quadtree.GetDistance(node, camera_position.x, camera_position.y, camera_position.z) > range * cdlod::distance_evict;
+                it              = far ? m_pages.erase(it) : next(it); // a patch which still draws with it keeps it alive
+            }
+        }
+
+        // select the nodes to draw, a tile can only be split once its page is resident
+        m_quadtree.Select(camera_position.x, camera_position.y, camera_position.z, m_nodes, [this, &get_tile_index](const TerrainQuadtree::Node& node)
+        {
+            return node.lod != cdlod::tile_lod || m_pages.find(get_tile_index(node)) != m_pages.end();
+        });
+
+        // group them by the page they are drawn with, nodes at least as large as a tile use the coarse page
+        auto get_patches_index = [&get_tile_index](const TerrainQuadtree::Node& node)
+        {
+            return node.lod >= cdlod::tile_lod ? 0 : 1 + get_tile_index(node);
+        };
+        sort(m_nodes.begin(), m_nodes.end(), [&get_patches_index](const TerrainQuadtree::Node& a, const TerrainQuadtree::Node& b)
+        {
+            const uint32_t index_a = get_patches_index(a);
+            const uint32_t index_b = get_patches_index(b);
+            return index_a != index_b ? index_a < index_b : (a.z != b.z ? a.z < b.z : a.x < b.x);
+        });
+
+        // update the patches whose nodes changed, which only happens when the camera crosses a range or a page arrives
+        const float spacing  = m_quadtree.GetSpacing();
+        const float origin_x = m_quadtree.GetOriginX();
+        const float origin_z = m_quadtree.GetOriginZ();
+        vector<Matrix> transforms;
+        size_t begin = 0;
+        for (uint32_t index = 0; index < static_cast<uint32_t>(m_patch_entities.size()); index++)
+        {
+            size_t end = begin;
+            while (end < m_nodes.size() && get_patches_index(m_nodes[end]) == index)
+            {
+                end++;
+            }
+
+            vector<TerrainQuadtree::Node>& nodes = m_patch_nodes[index];
+            if (!equal(m_nodes.begin() + begin, m_nodes.begin() + end, nodes.begin(), nodes.end()))
+            {
+                nodes.assign(m_nodes.begin() + begin, m_nodes.begin() + end);
+
+                // the unit patch is scaled to the extent of the node, heights included, so that its bounding box can be culled
+                transforms.clear();
+                for (const TerrainQuadtree::Node& node : nodes)
+                {
+                    const float size   = static_cast<float>(node.size) * spacing;
+                    const float height = max(node.height_max - node.height_min, 0.01f);
+                    const Vector3 position(origin_x + static_cast<float>(node.x) * spacing, node.height_min, origin_z + static_cast<float>(node.z) * spacing);
+                    transforms.emplace_back(position, Quaternion::Identity, Vector3(size, height, size));
+                }
+
+                if (shared_ptr<Entity> entity = m_patch_entities[index].lock())
+                {
+                    Renderable* renderable = entity->GetComponent<Renderable>();
+                    auto page              = index == 0 ? m_pages.end() : m_pages.find(index - 1);
+                    renderable->SetInstances(transforms, false);
+                    renderable->SetTerrainTexture(page != m_pages.end() ? page->second : m_page_coarse); // pages describe their placement, so any of them will do
+                    renderable->SetHidden(nodes.empty());
+                    renderable->OnTick(); // cull now, it might have ticked already this frame
+                }
+            }
+
+            begin = end;
+        }
+    }
+
+    void Terrain::RequestPage(const uint32_t tile_index)
+    {
+        {
+            lock_guard<mutex> lock(m_pages_mutex);
+            if (m_pages.find(tile_index) != m_pages.end() || !m_pages_requested.insert(tile_index).second)
+                return;
+
+            m_pages_pending++;
+        }
+
+        ThreadPool::AddTask([this, tile_index]()
+        {
+            shared_ptr<RHI_Texture> page = cdlod::load_page_tile(cdlod::file_header, tile_index);
+
+            // notified under the lock, a waiter could otherwise wake up, return and destroy the terrain before the call
+            lock_guard<mutex> lock(m_pages_mutex);
+            m_pages_loaded[tile_index] = page;
+            if (--m_pages_pending == 0)
+            {
+                m_pages_condition.notify_all();
+            }
+        });
+    }
+
+    void Terrain::WaitForPages()
+    {
+        unique_lock<mutex> lock(m_pages_mutex);
+        m_pages_condition.wait(lock, [this]() { return m_pages_pending == 0; });
+    }
 }
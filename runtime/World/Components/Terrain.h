@@ -23,7 +23,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =========================
 #include "Component.h"
+#include <mutex>
 #include <atomic>
+#include <unordered_map>
+#include <condition_variable>
+#include <unordered_set>
+#include "TerrainQuadtree.h"
 #include "../../RHI/RHI_Definitions.h"
 //====================================
 
@@ -44,12 +49,26 @@ namespace spartan
         Max
     };
 
+    // the final surface as a row-major grid of width x height samples, spacing apart, the first sample is at (origin_x, origin_z)
+    struct TerrainHeightField
+    {
+        std::vector<float> heights;
+        uint32_t width  = 0;
+        uint32_t height = 0;
+        float spacing   = 0.0f;
+        float origin_x  = 0.0f;
+        float origin_z  = 0.0f;
+    };
+
     class Terrain : public Component
     {
     public:
         Terrain(Entity* entity);
         ~Terrain();
 
+        // component
+        void OnTick() override;
+
         RHI_Texture* GetHeightMap() const          { return m_height_texture; }
         void SetHeightMap(RHI_Texture* height_map) { m_height_texture = height_map;}
 
@@ -72,17 +91,26 @@ namespace spartan
 
         // io
         void SaveToFile(const char* file_path);
-        void LoadFromFile(const char* file_path);
+        bool LoadFromFile(const char* file_path); // fails if the file doesn't match the height map and the parameters
 
         uint32_t GetVertexCount() const         { return m_vertex_count; }
         uint32_t GetIndexCount() const          { return m_index_count; }
         uint64_t GetHeightSampleCount() const   { return m_height_samples; }
         float* GetHeightData()                  { return !m_height_data.empty() ? &m_height_data[0] : nullptr; }
         std::shared_ptr<Material> GetMaterial() { return m_material; }
+
+        // the surface colliders are built from, available once generated
+        const TerrainHeightField& GetHeightField() const { return m_height_field; }
  
     private:
         void Clear();
 
+        // cdlod
+        void CreatePatches(const uint32_t width, const uint32_t height, const bool rewrite_pages);
+        void UpdatePatches();
+        void RequestPage(const uint32_t tile_index);
+        void WaitForPages();
+
         // properties
         float m_min_y = -64.0f;
         float m_max_y = 800.0f;
@@ -97,6 +125,7 @@ namespace spartan
         uint32_t m_index_count            = 0;
         uint32_t m_triangle_count         = 0;
         RHI_Texture* m_height_texture     = nullptr;
+        uint64_t m_source_hash            = 0;
         std::vector<float> m_height_data;
         std::vector<std::vector<RHI_Vertex_PosTexNorTan>> m_tile_vertices;
         std::vector<RHI_Vertex_PosTexNorTan> m_vertices;
@@ -105,5 +134,23 @@ namespace spartan
         std::shared_ptr<Mesh> m_mesh;
         std::shared_ptr<Material> m_material;
         std::vector<math::Vector3> m_tile_offsets;
+        TerrainHeightField m_height_field;
+
+        // cdlod
+        TerrainQuadtree m_quadtree;
+        std::shared_ptr<Mesh> m_patch_mesh;
+        std::vector<std::weak_ptr<Entity>> m_patch_entities;              // the patches of the coarse page, followed by those of every tile
+        std::vector<std::vector<TerrainQuadtree::Node>> m_patch_nodes;    // the nodes each of the above currently draws
+        std::vector<TerrainQuadtree::Node> m_nodes;                       // scratch
+        std::shared_ptr<RHI_Texture> m_page_coarse;
+        std::unordered_map<uint32_t, std::shared_ptr<RHI_Texture>> m_pages;        // tile index -> page
+        std::unordered_map<uint32_t, std::shared_ptr<RHI_Texture>> m_pages_loaded; // handed over by the loading threads
+        std::unordered_set<uint32_t> m_pages_requested;
+        std::mutex m_pages_mutex;
+        std::condition_variable m_pages_condition;  // signaled when the last page being loaded is handed over
+        uint32_t m_pages_pending              = 0;  // guarded by m_pages_mutex
+        std::atomic<bool> m_patches_ready     = false;
+        uint32_t m_tiles_x                    = 0;
+        uint32_t m_tiles_z                    = 0;
     };
 }
@@ -0,0 +1,151 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <atomic>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include "../../Core/ThreadPool.h"
+//=============================
+
+// the generated terrain is cached to a file of sections, which are located through a table, so each one is read
+// straight into its destination and all of them are read in parallel, data which is cheap to derive isn't stored
+namespace spartan::terrain_cache
+{
+    const uint32_t file_magic   = 0x43545453; // "STTC"
+    const uint32_t file_version = 3;          // increment when the generation changes, the hash only covers the inputs
+
+    enum class SectionType : uint32_t
+    {
+        HeightData,
+        Vertices,
+        Indices,
+        TileOffsets,
+        TileVertices,
+        TileIndices
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic         = file_magic;
+        uint32_t version       = file_version;
+        uint64_t source_hash   = 0;
+        uint32_t width         = 0; // of the height map
+        uint32_t height        = 0;
+        uint32_t tile_count    = 0;
+        uint32_t section_count = 0;
+    };
+
+    struct Section
+    {
+        SectionType type    = SectionType::HeightData;
+        uint32_t tile_index = 0;
+        uint64_t offset     = 0; // from the start of the file
+        uint64_t size       = 0; // in bytes
+    };
+
+    struct SectionData
+    {
+        Section section;
+        char* data = nullptr; // what to write from, or read into
+    };
+
+    // writes the header, the table and the sections after it, the section offsets and the header's section count are filled in,
+    // returns the file size or 0 on failure, in which case no partial file is left behind (the table would point past its end)
+    static uint64_t write_sections(const char* file_path, FileHeader& header, std::vector<SectionData>& sections)
+    {
+        header.section_count = static_cast<uint32_t>(sections.size());
+
+        uint64_t offset = sizeof(FileHeader) + sections.size() * sizeof(Section);
+        for (SectionData& section_data : sections)
+        {
+            section_data.section.offset  = offset;
+            offset                      += section_data.section.size;
+        }
+
+        std::ofstream file(file_path, std::ios::binary);
+        if (!file.is_open())
+            return 0;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        for (const SectionData& section_data : sections)
+        {
+            file.write(reinterpret_cast<const char*>(&section_data.section), sizeof(Section));
+        }
+        for (const SectionData& section_data : sections)
+        {
+            file.write(section_data.data, static_cast<std::streamsize>(section_data.section.size));
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            std::remove(file_path);
+            return 0;
+        }
+
+        return offset;
+    }
+
+    // reads sections in parallel, large sections are split into chunks so that they are spread over the threads
+    // as well, every thread uses its own stream and seeks to the chunks it was given
+    static bool read_sections(const char* file_path, const std::vector<SectionData>& sections)
+    {
+        const uint64_t chunk_size = 16 * 1024 * 1024;
+
+        std::vector<SectionData> chunks;
+        for (const SectionData& section_data : sections)
+        {
+            for (uint64_t offset = 0; offset < section_data.section.size; offset += chunk_size)
+            {
+                SectionData chunk     = section_data;
+                chunk.section.offset += offset;
+                chunk.section.size    = std::min(chunk_size, section_data.section.size - offset);
+                chunk.data           += offset;
+                chunks.push_back(chunk);
+            }
+        }
+
+        std::atomic<bool> result = true;
+        auto read_range = [file_path, &chunks, &result](uint32_t start, uint32_t end)
+        {
+            std::ifstream file(file_path, std::ios::binary);
+            for (uint32_t i = start; i < end && file.good(); i++)
+            {
+                file.seekg(static_cast<std::streamoff>(chunks[i].section.offset));
+                file.read(chunks[i].data, static_cast<std::streamsize>(chunks[i].section.size));
+            }
+
+            if (!file.good())
+            {
+                result = false;
+            }
+        };
+        ThreadPool::ParallelLoop(read_range, static_cast<uint32_t>(chunks.size()));
+
+        return result;
+    }
+}
@@ -0,0 +1,313 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+//=====================
+
+namespace spartan
+{
+    // continuous distance-dependent level of detail (cdlod) over a height field, it's pure cpu logic so it can be driven without a device
+    // - every node is drawn with the same grid patch, a node of lod n is 2^n leaves wide, so its patch is 2^n times coarser
+    // - a node is refined while the camera is within the range of the next finer lod, ranges are proportional to the node size
+    // - vertices morph to the grid of the next coarser lod over the end of their range, so neighbouring lods meet without seams
+    // the constants and MorphVertex() are mirrored by common_vertex_processing.hlsl, which morphs and displaces the patch
+    class TerrainQuadtree
+    {
+    public:
+        static constexpr uint32_t patch_resolution = 32;    // quads per side of the patch, a leaf has a quad per sample
+        static constexpr float range_scale         = 4.0f;  // the range of a lod, in node sizes
+        static constexpr float morph_start         = 0.75f; // where, within its range, a lod starts morphing to the next
+        static constexpr uint32_t max_morph_levels = 8;     // how many coarser lods a vertex can morph through
+
+        struct Node
+        {
+            uint32_t x       = 0; // in samples
+            uint32_t z       = 0; // in samples
+            uint32_t size    = 0; // in samples
+            uint32_t lod     = 0;
+            float height_min = 0.0f;
+            float height_max = 0.0f;
+
+            bool operator==(const Node& other) const { return x == other.x && z == other.z && size == other.size; }
+        };
+
+        // heights is a row-major grid of width x height samples, spacing apart, the first sample is at (origin_x, origin_z)
+        void Build(const float* heights, const uint32_t width, const uint32_t height, const float spacing, const float origin_x, const float origin_z)
+        {
+            m_width    = width;
+            m_height   = height;
+            m_spacing  = spacing;
+            m_origin_x = origin_x;
+            m_origin_z = origin_z;
+            m_bounds.clear();
+            if (!heights || width < 2 || height < 2)
+                return;
+
+            // enough lods for a single root to cover the height field
+            const uint32_t extent = std::max(width, height) - 1;
+            m_lod_count           = 1;
+            while ((patch_resolution << (m_lod_count - 1)) < extent)
+            {
+                m_lod_count++;
+            }
+
+            // leaves, a node covers its last row and column of samples too, those are shared with its neighbours
+            m_bounds.resize(m_lod_count);
+            {
+                Level& level = m_bounds[0];
+                level.count_x = (width - 2) / patch_resolution + 1;
+                level.count_z = (height - 2) / patch_resolution + 1;
+                level.bounds.resize(level.count_x * level.count_z);
+                for (uint32_t node_z = 0; node_z < level.count_z; node_z++)
+                {
+                    for (uint32_t node_x = 0; node_x < level.count_x; node_x++)
+                    {
+                        float height_min = std::numeric_limits<float>::max();
+                        float height_max = std::numeric_limits<float>::lowest();
+                        const uint32_t x_end = std::min((node_x + 1) * patch_resolution, width - 1);
+                        const uint32_t z_end = std::min((node_z + 1) * patch_resolution, height - 1);
+                        for (uint32_t z = node_z * patch_resolution; z <= z_end; z++)
+                        {
+                            for (uint32_t x = node_x * patch_resolution; x <= x_end; x++)
+                            {
+                                height_min = std::min(height_min, heights[z * width + x]);
+                                height_max = std::max(height_max, heights[z * width + x]);
+                            }
+                        }
+                        level.bounds[node_z * level.count_x + node_x] = { height_min, height_max };
+                    }
+                }
+            }
+
+            // every other lod merges the four nodes below it
+            for (uint32_t lod = 1; lod < m_lod_count; lod++)
+            {
+                const Level& finer = m_bounds[lod - 1];
+                Level& level       = m_bounds[lod];
+                level.count_x      = (finer.count_x + 1) / 2;
+                level.count_z      = (finer.count_z + 1) / 2;
+                level.bounds.resize(level.count_x * level.count_z);
+                for (uint32_t node_z = 0; node_z < level.count_z; node_z++)
+                {
+                    for (uint32_t node_x = 0; node_x < level.count_x; node_x++)
+                    {
+                        Bounds bounds = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+                        for (uint32_t child = 0; child < 4; child++)
+                        {
+                            const uint32_t child_x = node_x * 2 + (child & 1);
+                            const uint32_t child_z = node_z * 2 + (child >> 1);
+                            if (child_x < finer.count_x && child_z < finer.count_z)
+                            {
+                                const Bounds& child_bounds = finer.bounds[child_z * finer.count_x + child_x];
+                                bounds.min = std::min(bounds.min, child_bounds.min);
+                                bounds.max = std::max(bounds.max, child_bounds.max);
+                            }
+                        }
+                        level.bounds[node_z * level.count_x + node_x] = bounds;
+                    }
+                }
+            }
+        }
+
+        // the nodes to draw, they cover the height field without overlapping, can_refine (optional) can keep a node
+        // from being split, e.g. until the data of its children is resident, the selection doesn't depend on the view
+        // direction, so it only changes when the camera crosses a range, frustum culling is left to the caller
+        void Select(const float camera_x, const float camera_y, const float camera_z, std::vector<Node>& nodes, const std::function<bool(const Node&)>& can_refine = nullptr) const
+        {
+            nodes.clear();
+            if (m_bounds.empty())
+                return;
+
+            const float camera[3] = { camera_x, camera_y, camera_z };
+            const uint32_t lod    = m_lod_count - 1;
+            if (!select(camera, lod, 0, 0, nodes, can_refine))
+            {
+                nodes.push_back(get_node(lod, 0, 0));
+            }
+        }
+
+        // the distance from a point to the bounding box of a node
+        float GetDistance(const Node& node, const float x, const float y, const float z) const
+        {
+            const float min_x = m_origin_x + static_cast<float>(node.x) * m_spacing;
+            const float min_z = m_origin_z + static_cast<float>(node.z) * m_spacing;
+            const float size  = static_cast<float>(node.size) * m_spacing;
+            const float dx    = std::max({ min_x - x, 0.0f, x - (min_x + size) });
+            const float dy    = std::max({ node.height_min - y, 0.0f, y - node.height_max });
+            const float dz    = std::max({ min_z - z, 0.0f, z - (min_z + size) });
+
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+
+        // beyond this distance from the camera, a node of the given lod is drawn by its parent
+        float GetRange(const uint32_t lod) const
+        {
+            return static_cast<float>(patch_resolution << lod) * m_spacing * range_scale;
+        }
+
+        // the nodes of a lod which are within a distance of a point, nearest first (used to decide what to stream)
+        void GetNodesWithin(const uint32_t lod, const float x, const float y, const float z, const float distance, std::vector<Node>& nodes) const
+        {
+            nodes.clear();
+            if (lod >= m_lod_count)
+                return;
+
+            const Level& level = m_bounds[lod];
+            for (uint32_t node_z = 0; node_z < level.count_z; node_z++)
+            {
+                for (uint32_t node_x = 0; node_x < level.count_x; node_x++)
+                {
+                    Node node = get_node(lod, node_x, node_z);
+                    if (GetDistance(node, x, y, z) <= distance)
+                    {
+                        nodes.push_back(node);
+                    }
+                }
+            }
+
+            std::sort(nodes.begin(), nodes.end(), [this, x, y, z](const Node& a, const Node& b)
+            {
+                return GetDistance(a, x, y, z) < GetDistance(b, x, y, z);
+            });
+        }
+
+        // how far a vertex is morphed towards the grid of the next coarser lod, node_size is in world units
+        static float ComputeMorph(const float distance, const float node_size)
+        {
+            const float end   = node_size * range_scale;
+            const float start = end * morph_start;
+
+            return std::clamp((distance - start) / (end - start), 0.0f, 1.0f);
+        }
+
+        // the position a patch vertex is drawn at, x and z are relative to the origin of the height field, node_size is in
+        // world units and distance(x, z) gives the distance from the camera to the surface at a position, odd vertices slide
+        // onto their even neighbours as the end of the range approaches, while a vertex is fully morphed onto the grid of the
+        // next coarser lod it carries on into the one after, so nodes drawn in place of their parent (see select()) match it
+        template<typename Distance>
+        static void MorphVertex(float& x, float& z, const float node_size, Distance distance)
+        {
+            float spacing = node_size / static_cast<float>(patch_resolution);
+            float size    = node_size;
+            x             = std::round(x / spacing) * spacing;
+            z             = std::round(z / spacing) * spacing;
+            for (uint32_t level = 0; level < max_morph_levels; level++)
+            {
+                const float morph = ComputeMorph(distance(x, z), size);
+                x                 = morph_coordinate(x, spacing, morph);
+                z                 = morph_coordinate(z, spacing, morph);
+                if (morph < 1.0f)
+                    break;
+
+                spacing *= 2.0f;
+                size    *= 2.0f;
+            }
+        }
+
+        uint32_t GetLodCount() const { return m_lod_count; }
+        uint32_t GetWidth() const    { return m_width; }
+        uint32_t GetHeight() const   { return m_height; }
+        float GetSpacing() const     { return m_spacing; }
+        float GetOriginX() const     { return m_origin_x; }
+        float GetOriginZ() const     { return m_origin_z; }
+
+    private:
+        // rounding to the grid first keeps the parity exact, the coordinate is only approximately a multiple of the spacing
+        static float morph_coordinate(const float coordinate, const float spacing, const float morph)
+        {
+            const float grid = std::round(coordinate / spacing);
+            const float odd  = grid - 2.0f * std::floor(grid * 0.5f);
+
+            return (grid - odd * morph) * spacing;
+        }
+
+        struct Bounds
+        {
+            float min = 0.0f;
+            float max = 0.0f;
+        };
+
+        struct Level
+        {
+            uint32_t count_x = 0;
+            uint32_t count_z = 0;
+            std::vector<Bounds> bounds;
+        };
+
+        Node get_node(const uint32_t lod, const uint32_t node_x, const uint32_t node_z) const
+        {
+            const Level& level  = m_bounds[lod];
+            const Bounds& bounds = level.bounds[node_z * level.count_x + node_x];
+            const uint32_t size  = patch_resolution << lod;
+
+            return { node_x * size, node_z * size, size, lod, bounds.min, bounds.max };
+        }
+
+        // returns false if the node is out of its range, in which case its parent covers its area
+        bool select(const float* camera, const uint32_t lod, const uint32_t node_x, const uint32_t node_z, std::vector<Node>& nodes, const std::function<bool(const Node&)>& can_refine) const
+        {
+            const Node node      = get_node(lod, node_x, node_z);
+            const float distance = GetDistance(node, camera[0], camera[1], camera[2]);
+            if (lod + 1 < m_lod_count && distance > GetRange(lod))
+                return false;
+
+            if (lod == 0 || distance > GetRange(lod - 1) || (can_refine && !can_refine(node)))
+            {
+                nodes.push_back(node);
+                return true;
+            }
+
+            // children which are out of their range are still drawn with their own (smaller) patch, but they are beyond
+            // the end of their range, so their vertices morph through to the grid of this node (see MorphVertex())
+            const Level& finer = m_bounds[lod - 1];
+            for (uint32_t child = 0; child < 4; child++)
+            {
+                const uint32_t child_x = node_x * 2 + (child & 1);
+                const uint32_t child_z = node_z * 2 + (child >> 1);
+                if (child_x >= finer.count_x || child_z >= finer.count_z)
+                    continue;
+
+                if (!select(camera, lod - 1, child_x, child_z, nodes, can_refine))
+                {
+                    nodes.push_back(get_node(lod - 1, child_x, child_z));
+                }
+            }
+
+            return true;
+        }
+
+        std::vector<Level> m_bounds; // per lod, the height range of every node
+        uint32_t m_lod_count = 0;
+        uint32_t m_width     = 0;
+        uint32_t m_height    = 0;
+        float m_spacing      = 1.0f;
+        float m_origin_x     = 0.0f;
+        float m_origin_z     = 0.0f;
+    };
+}
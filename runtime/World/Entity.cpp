@@ -455,6 +455,7 @@ namespace spartan
 
         m_parent = new_parent_in;
         UpdateTransform();
+        World::MarkHierarchyChanged();
     }
 
     void Entity::AddChild(Entity* child)
@@ -60,7 +60,11 @@ namespace spartan
 
         // active
         bool GetActive() const;
-        void SetActive(const bool active) { m_is_active = active; }
+        void SetActive(const bool active)
+        {
+            m_is_active = active;
+            World::MarkHierarchyChanged();
+        }
 
         // adds a component of type T
         template <class T>
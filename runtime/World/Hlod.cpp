@@ -0,0 +1,299 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "pch.h"
+#include "Hlod.h"
+#include "StaticMerging.h"
+#include "World.h"
+#include "Entity.h"
+#include "Components/Renderable.h"
+#include "Components/Physics.h"
+#include "Components/Camera.h"
+#include "../Rendering/Mesh.h"
+#include "../Rendering/Material.h"
+#include "../Resource/ResourceCache.h"
+#include "../Geometry/GeometryHlod.h"
+#include "../Core/Stopwatch.h"
+#include "../Profiling/Profiler.h"
+//======================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        // a renderable, or an instance group of it, which a proxy can replace
+        struct HlodMember
+        {
+            weak_ptr<Entity> entity;
+            uint32_t instance_group_index = 0;
+        };
+
+        struct HlodCell
+        {
+            BoundingBox aabb;
+            vector<uint32_t> members;
+            vector<weak_ptr<Entity>> proxies;
+            bool proxy_active = false;
+        };
+
+        vector<HlodMember> members;
+        vector<HlodCell> cells;
+        vector<shared_ptr<Mesh>> meshes;
+        uint32_t proxy_count  = 0;
+        float distance_switch = 0.0f;
+
+        // to avoid flickering between the proxy and the originals when the camera is at the switch distance
+        const float switch_hysteresis = 0.9f;
+
+        void set_members_hidden(const HlodCell& cell, const bool hidden)
+        {
+            for (uint32_t member_index : cell.members)
+            {
+                const HlodMember& member = members[member_index];
+                if (shared_ptr<Entity> entity = member.entity.lock())
+                {
+                    if (Renderable* renderable = entity->GetComponent<Renderable>())
+                    {
+                        renderable->SetHidden(hidden, member.instance_group_index);
+                    }
+                }
+            }
+        }
+    }
+
+    void Hlod::Build(const float cell_size, const float switch_distance)
+    {
+        Clear();
+
+        const Stopwatch timer;
+        distance_switch = switch_distance;
+
+        // the geometry of the lowest lod of each eligible renderable, instances share it
+        struct Source
+        {
+            shared_ptr<Entity> entity;
+            Renderable* renderable = nullptr;
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vector<uint32_t> indices;
+            BoundingBox aabb; // mesh space
+        };
+        vector<Source> sources;
+        for (const shared_ptr<Entity>& entity : World::GetEntities())
+        {
+            if (Renderable* renderable = entity->GetComponent<Renderable>())
+            {
+                // already drawn by something else (e.g. a static batch), instanced renderables hide per group
+                if (static_merging::is_eligible(entity.get(), renderable) && (renderable->HasInstancing() || !renderable->IsHidden()))
+                {
+                    Source& source    = sources.emplace_back();
+                    source.entity     = entity;
+                    source.renderable = renderable;
+                }
+            }
+        }
+
+        // gather parts, the sources vector no longer grows so the parts can point into it
+        vector<geometry_hlod::HlodPart> parts;
+        for (Source& source : sources)
+        {
+            Renderable* renderable = source.renderable;
+            renderable->GetGeometry(&source.indices, &source.vertices, renderable->GetLodCount() - 1);
+            source.aabb = BoundingBox(source.vertices.data(), static_cast<uint32_t>(source.vertices.size()));
+
+            const Matrix& transform    = source.entity->GetMatrix();
+            const uint64_t material_id = renderable->GetMaterial()->GetObjectId();
+            auto add_part = [&](const Matrix& part_transform, const uint32_t member_index)
+            {
+                geometry_hlod::HlodPart& part = parts.emplace_back();
+                part.vertices                 = &source.vertices;
+                part.indices                  = &source.indices;
+                part.transform                = part_transform;
+                part.aabb                     = source.aabb * part_transform;
+                part.material_id              = material_id;
+                part.member_index             = member_index;
+            };
+
+            if (renderable->HasInstancing())
+            {
+                for (uint32_t group_index = 0; group_index < renderable->GetInstanceGroupCount(); group_index++)
+                {
+                    const uint32_t member_index = static_cast<uint32_t>(members.size());
+                    members.push_back({ source.entity, group_index });
+
+                    const uint32_t instance_start = renderable->GetInstanceGroupStartIndex(group_index);
+                    const uint32_t instance_end   = min(instance_start + renderable->GetInstanceGroupCount(group_index), renderable->GetInstanceCount());
+                    for (uint32_t instance_index = instance_start; instance_index < instance_end; instance_index++)
+                    {
+                        add_part(transform * renderable->GetInstanceTransform(instance_index), member_index);
+                    }
+                }
+            }
+            else
+            {
+                const uint32_t member_index = static_cast<uint32_t>(members.size());
+                members.push_back({ source.entity, 0 });
+                add_part(transform, member_index);
+            }
+        }
+
+        // merge and simplify
+        geometry_hlod::HlodParameters parameters;
+        parameters.cell_size = cell_size;
+        vector<geometry_hlod::HlodCell> built_cells;
+        geometry_hlod::build_cells(parts, parameters, built_cells);
+
+        // create the proxies, one entity per material per cell, sharing one mesh per cell
+        for (uint32_t cell_index = 0; cell_index < static_cast<uint32_t>(built_cells.size()); cell_index++)
+        {
+            geometry_hlod::HlodCell& built_cell = built_cells[cell_index];
+
+            HlodCell& cell = cells.emplace_back();
+            cell.aabb      = built_cell.aabb;
+            cell.members   = built_cell.members;
+
+            // the proxy inherits the most permissive distances of the members it replaces
+            float max_render_distance = 0.0f;
+            float max_shadow_distance = 0.0f;
+            bool casts_shadows        = false;
+            for (uint32_t member_index : cell.members)
+            {
+                Renderable* renderable = members[member_index].entity.lock()->GetComponent<Renderable>();
+                max_render_distance    = max(max_render_distance, renderable->GetMaxRenderDistance());
+                max_shadow_distance    = max(max_shadow_distance, renderable->GetMaxShadowDistance());
+                casts_shadows         |= renderable->HasFlag(RenderableFlags::CastsShadows);
+            }
+
+            shared_ptr<Mesh> mesh = meshes.emplace_back(make_shared<Mesh>());
+            mesh->SetObjectName("hlod_cell_" + to_string(cell_index));
+            mesh->SetFlag(static_cast<uint32_t>(MeshFlags::PostProcessOptimize), false); // already simplified and optimized
+
+            vector<pair<uint32_t, shared_ptr<Material>>> sub_meshes;
+            for (geometry_hlod::HlodProxy& proxy : built_cell.proxies)
+            {
+                if (shared_ptr<Material> material = static_merging::get_material(proxy.material_id))
+                {
+                    uint32_t sub_mesh_index = 0;
+                    mesh->AddGeometry(proxy.vertices, proxy.indices, false, &sub_mesh_index);
+                    sub_meshes.emplace_back(sub_mesh_index, material);
+                }
+            }
+
+            if (sub_meshes.empty())
+                continue;
+
+            mesh->CreateGpuBuffers();
+
+            for (auto& [sub_mesh_index, material] : sub_meshes)
+            {
+                shared_ptr<Entity> entity = World::CreateEntity();
+                entity->SetObjectName("hlod_cell_" + to_string(cell_index) + "_" + material->GetObjectName());
+                entity->SetPosition(built_cell.center);
+                entity->SetActive(false);
+
+                Renderable* renderable = entity->AddComponent<Renderable>();
+                renderable->SetMesh(mesh.get(), sub_mesh_index);
+
+                renderable->SetMaterial(material, false); // shared with the members, so it keeps the world dimensions they computed
+
+                renderable->SetMaxRenderDistance(max_render_distance);
+                renderable->SetMaxShadowDistance(max_shadow_distance);
+                renderable->SetFlag(RenderableFlags::CastsShadows, casts_shadows);
+
+                cell.proxies.push_back(entity);
+                proxy_count++;
+            }
+        }
+
+        SP_LOG_INFO("Built %u hlod cells with %u proxies from %u parts, duration %.2f ms", static_cast<uint32_t>(cells.size()), proxy_count, static_cast<uint32_t>(parts.size()), timer.GetElapsedTimeMs());
+    }
+
+    void Hlod::Tick()
+    {
+        if (cells.empty())
+            return;
+
+        Camera* camera = World::GetCamera();
+        if (!camera)
+            return;
+
+        SP_PROFILE_CPU();
+
+        const Vector3 camera_position = camera->GetEntity()->GetPosition();
+        for (HlodCell& cell : cells)
+        {
+            const float distance = Vector3::Distance(camera_position, cell.aabb.GetClosestPoint(camera_position));
+            const bool use_proxy = cell.proxy_active ? distance > distance_switch * switch_hysteresis : distance > distance_switch;
+            if (use_proxy == cell.proxy_active)
+                continue;
+
+            cell.proxy_active = use_proxy;
+            set_members_hidden(cell, use_proxy);
+            for (weak_ptr<Entity>& proxy : cell.proxies)
+            {
+                if (shared_ptr<Entity> entity = proxy.lock())
+                {
+                    entity->SetActive(use_proxy);
+                }
+            }
+        }
+    }
+
+    void Hlod::Clear()
+    {
+        // restore the originals and remove the proxies, if the world was cleared first, there is nothing left to do
+        for (HlodCell& cell : cells)
+        {
+            if (cell.proxy_active)
+            {
+                set_members_hidden(cell, false);
+            }
+
+            for (weak_ptr<Entity>& proxy : cell.proxies)
+            {
+                if (shared_ptr<Entity> entity = proxy.lock())
+                {
+                    World::RemoveEntity(entity.get());
+                }
+            }
+        }
+
+        members.clear();
+        cells.clear();
+        meshes.clear();
+        proxy_count = 0;
+    }
+
+    uint32_t Hlod::GetCellCount()
+    {
+        return static_cast<uint32_t>(cells.size());
+    }
+
+    uint32_t Hlod::GetProxyCount()
+    {
+        return proxy_count;
+    }
+}
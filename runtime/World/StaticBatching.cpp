@@ -0,0 +1,265 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "pch.h"
+#include "StaticBatching.h"
+#include "StaticMerging.h"
+#include "World.h"
+#include "Entity.h"
+#include "Components/Renderable.h"
+#include "Components/Physics.h"
+#include "../Rendering/Mesh.h"
+#include "../Rendering/Material.h"
+#include "../Resource/ResourceCache.h"
+#include "../Geometry/GeometryProcessing.h"
+#include "../Core/Stopwatch.h"
+//======================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        vector<weak_ptr<Entity>> batched; // the originals, hidden while their batch exists
+        vector<weak_ptr<Entity>> batches;
+        shared_ptr<Mesh> mesh;            // all batches are sub-meshes of it, so they share the same gpu buffers
+
+        // renderables which share all of these can be drawn as one
+        struct BatchKey
+        {
+            int32_t x, y, z;
+            uint64_t material_id;
+            float max_render_distance;
+            float max_shadow_distance;
+            bool casts_shadows;
+
+            bool operator==(const BatchKey& other) const
+            {
+                return x == other.x && y == other.y && z == other.z &&
+                       material_id         == other.material_id &&
+                       max_render_distance == other.max_render_distance &&
+                       max_shadow_distance == other.max_shadow_distance &&
+                       casts_shadows       == other.casts_shadows;
+            }
+        };
+
+        struct BatchKeyHash
+        {
+            size_t operator()(const BatchKey& key) const
+            {
+                size_t seed = hash<uint64_t>()(key.material_id);
+                seed ^= hash<int32_t>()(key.x) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                seed ^= hash<int32_t>()(key.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                seed ^= hash<int32_t>()(key.z) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                return seed;
+            }
+        };
+
+        bool is_eligible(Entity* entity, Renderable* renderable)
+        {
+            if (!static_merging::is_eligible(entity, renderable) || renderable->HasInstancing() || renderable->IsHidden())
+                return false;
+
+            // large meshes have their own clusters and lods, they gain nothing from batching
+            if (renderable->GetIndexCount() >= mesh_cluster_min_index_count)
+                return false;
+
+            // wind displaces vertices by their height in mesh space, which pre-transforming would change
+            if (renderable->GetMaterial()->GetProperty(MaterialProperty::WindAnimation) != 0.0f)
+                return false;
+
+            return true;
+        }
+    }
+
+    void StaticBatching::Build(const float cell_size)
+    {
+        Clear();
+
+        const Stopwatch timer;
+
+        // a renderable to merge, bounds are computed from the geometry since the renderable
+        // bounding boxes are only refreshed when the world ticks, which it doesn't while loading
+        struct Part
+        {
+            shared_ptr<Entity> entity;
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vector<uint32_t> indices;
+            BoundingBox aabb; // world space
+        };
+
+        // group
+        unordered_map<BatchKey, vector<Part>, BatchKeyHash> groups;
+        uint32_t draw_calls_before = 0;
+        for (const shared_ptr<Entity>& entity : World::GetEntities())
+        {
+            Renderable* renderable = entity->GetComponent<Renderable>();
+            if (!renderable || !entity->GetActive())
+                continue;
+
+            draw_calls_before += renderable->HasInstancing() ? renderable->GetInstanceGroupCount() : 1;
+
+            if (!is_eligible(entity.get(), renderable))
+                continue;
+
+            Part part;
+            part.entity = entity;
+            renderable->GetGeometry(&part.indices, &part.vertices);
+            part.aabb = BoundingBox(part.vertices.data(), static_cast<uint32_t>(part.vertices.size())) * entity->GetMatrix();
+
+            const Vector3 center = part.aabb.GetCenter();
+            BatchKey key;
+            key.x                   = static_cast<int32_t>(floor(center.x / cell_size));
+            key.y                   = static_cast<int32_t>(floor(center.y / cell_size));
+            key.z                   = static_cast<int32_t>(floor(center.z / cell_size));
+            key.material_id         = renderable->GetMaterial()->GetObjectId();
+            key.max_render_distance = renderable->GetMaxRenderDistance();
+            key.max_shadow_distance = renderable->GetMaxShadowDistance();
+            key.casts_shadows       = renderable->HasFlag(RenderableFlags::CastsShadows);
+            groups[key].push_back(move(part));
+        }
+
+        // merge, all batches are added to the mesh before any renderable can reference it
+        struct Batch
+        {
+            BatchKey key;
+            shared_ptr<Material> material;
+            Vector3 origin;
+            uint32_t sub_mesh_index = 0;
+        };
+        vector<Batch> pending;
+        mesh = make_shared<Mesh>();
+        mesh->SetObjectName("static_batches");
+        for (auto& [key, parts] : groups)
+        {
+            if (parts.size() < 2)
+                continue;
+
+            shared_ptr<Material> material = static_merging::get_material(key.material_id);
+            if (!material)
+                continue;
+
+            BoundingBox aabb;
+            for (const Part& part : parts)
+            {
+                aabb.Merge(part.aabb);
+            }
+            const Vector3 origin = aabb.GetCenter();
+
+            // pre-transform every part and make it a cluster, relative to the batch origin
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vector<uint32_t> indices;
+            vector<MeshCluster> clusters;
+            for (const Part& part : parts)
+            {
+                MeshCluster& cluster  = clusters.emplace_back();
+                cluster.index_offset  = static_cast<uint32_t>(indices.size());
+                cluster.index_count   = static_cast<uint32_t>(part.indices.size());
+                cluster.sphere_center = part.aabb.GetCenter() - origin;
+                cluster.sphere_radius = part.aabb.GetExtents().Length();
+                cluster.cone_cutoff   = 1.0f; // parts can face any direction
+
+                geometry_processing::append_transformed(part.vertices, part.indices, part.entity->GetMatrix(), origin, vertices, indices);
+
+                part.entity->GetComponent<Renderable>()->SetHidden(true);
+                batched.push_back(part.entity);
+            }
+
+            Batch& batch   = pending.emplace_back();
+            batch.key      = key;
+            batch.material = material;
+            batch.origin   = origin;
+            mesh->AddGeometry(vertices, indices, clusters, &batch.sub_mesh_index);
+        }
+
+        if (pending.empty())
+        {
+            mesh = nullptr;
+            return;
+        }
+
+        // create the batch renderables
+        mesh->CreateGpuBuffers();
+        for (Batch& batch : pending)
+        {
+            shared_ptr<Entity> entity = World::CreateEntity();
+            entity->SetObjectName("static_batch_" + to_string(batches.size()) + "_" + batch.material->GetObjectName());
+            entity->SetPosition(batch.origin);
+            batches.push_back(entity);
+
+            Renderable* renderable = entity->AddComponent<Renderable>();
+            renderable->SetMesh(mesh.get(), batch.sub_mesh_index);
+
+            renderable->SetMaterial(batch.material, false); // shared with the originals, so it keeps the world dimensions they computed
+
+            renderable->SetMaxRenderDistance(batch.key.max_render_distance);
+            renderable->SetMaxShadowDistance(batch.key.max_shadow_distance);
+            renderable->SetFlag(RenderableFlags::CastsShadows, batch.key.casts_shadows);
+        }
+
+        const uint32_t batch_count      = static_cast<uint32_t>(batches.size());
+        const uint32_t batched_count    = static_cast<uint32_t>(batched.size());
+        const uint32_t draw_calls_after = draw_calls_before - batched_count + batch_count;
+        SP_LOG_INFO("Merged %u renderables into %u static batches, draw calls %u -> %u, duration %.2f ms", batched_count, batch_count, draw_calls_before, draw_calls_after, timer.GetElapsedTimeMs());
+    }
+
+    void StaticBatching::Clear()
+    {
+        // restore the originals and remove the batches, if the world was cleared first, there is nothing left to do
+        for (weak_ptr<Entity>& entity_weak : batched)
+        {
+            if (shared_ptr<Entity> entity = entity_weak.lock())
+            {
+                if (Renderable* renderable = entity->GetComponent<Renderable>())
+                {
+                    renderable->SetHidden(false);
+                }
+            }
+        }
+
+        for (weak_ptr<Entity>& entity_weak : batches)
+        {
+            if (shared_ptr<Entity> entity = entity_weak.lock())
+            {
+                World::RemoveEntity(entity.get());
+            }
+        }
+
+        batched.clear();
+        batches.clear();
+        mesh = nullptr;
+    }
+
+    uint32_t StaticBatching::GetBatchCount()
+    {
+        return static_cast<uint32_t>(batches.size());
+    }
+
+    uint32_t StaticBatching::GetBatchedRenderableCount()
+    {
+        return static_cast<uint32_t>(batched.size());
+    }
+}
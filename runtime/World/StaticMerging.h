@@ -0,0 +1,71 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========================
+#include "Entity.h"
+#include "Components/Renderable.h"
+#include "Components/Physics.h"
+#include "../Rendering/Material.h"
+#include "../Resource/ResourceCache.h"
+//=====================================
+
+// what static batching and hlod have in common, both bake renderables into merged geometry
+namespace spartan::static_merging
+{
+    // whether the geometry of a renderable can be baked, the callers add their own conditions on top
+    static bool is_eligible(Entity* entity, Renderable* renderable)
+    {
+        if (!entity->GetActive() || !renderable->HasMesh())
+            return false;
+
+        // skinned geometry is deformed in place every frame
+        if (renderable->GetMesh()->IsSkinned())
+            return false;
+
+        // transparents are sorted per renderable, special materials have their own shading or lod scheme
+        Material* material = renderable->GetMaterial();
+        if (!material || material->IsTransparent() ||
+            material->GetProperty(MaterialProperty::IsTerrain)    != 0.0f ||
+            material->GetProperty(MaterialProperty::IsGrassBlade) != 0.0f ||
+            material->GetProperty(MaterialProperty::IsWater)      != 0.0f)
+            return false;
+
+        // anything that can move is excluded
+        if (Physics* physics = entity->GetComponent<Physics>())
+        {
+            if (!physics->IsStatic())
+                return false;
+        }
+
+        return true;
+    }
+
+    static std::shared_ptr<Material> get_material(const uint64_t material_id)
+    {
+        std::shared_ptr<IResource> resource = ResourceCache::GetById(material_id);
+        if (!resource || resource->GetResourceType() != ResourceType::Material)
+            return nullptr;
+
+        return std::static_pointer_cast<Material>(resource);
+    }
+}
@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "World.h"
 #include "Entity.h"
+#include "Hlod.h"
+#include "StaticBatching.h"
 #include "../Resource/ResourceCache.h"
 #include "../Game/Game.h"
 #include "../Profiling/Profiler.h"
@@ -49,12 +51,13 @@ namespace spartan
         vector<shared_ptr<Entity>> entities_lights; // entities subset that contains only lights
         string file_path;
         mutex entity_access_mutex;
-        bool resolve                = false;
-        bool was_in_editor_mode     = false;
-        BoundingBox bounding_box    = BoundingBox::Unit;
-        shared_ptr<Entity> camera   = nullptr;
-        shared_ptr<Entity> light    = nullptr;
-        uint32_t audio_source_count = 0;
+        bool resolve                        = false;
+        atomic<uint64_t> hierarchy_revision = 0;
+        bool was_in_editor_mode             = false;
+        BoundingBox bounding_box            = BoundingBox::Unit;
+        shared_ptr<Entity> camera           = nullptr;
+        shared_ptr<Entity> light            = nullptr;
+        uint32_t audio_source_count         = 0;
 
         void compute_bounding_box()
         {
@@ -141,6 +144,9 @@ namespace spartan
                 entity->Tick();
             }
         }
+
+        // swap distant cells of static renderables for their proxies
+        Hlod::Tick();
         
         if (resolve)
         {
@@ -195,7 +201,10 @@ namespace spartan
         
         // clear
         entities.clear();
+        hierarchy_revision++;
         entities_lights.clear();
+        Hlod::Clear();
+        StaticBatching::Clear();
         camera = nullptr;
         light  = nullptr;
         file_path.clear();
@@ -340,6 +349,16 @@ namespace spartan
         resolve = true;
     }
 
+    void World::MarkHierarchyChanged()
+    {
+        hierarchy_revision++;
+    }
+
+    uint64_t World::GetHierarchyRevision()
+    {
+        return hierarchy_revision.load();
+    }
+
     shared_ptr<Entity> World::CreateEntity()
     {
         lock_guard lock(entity_access_mutex);
@@ -347,6 +366,7 @@ namespace spartan
         shared_ptr<Entity> entity = make_shared<Entity>();
         entity->Initialize();
         entities.push_back(entity);
+        hierarchy_revision++;
 
         return entity;
     }
@@ -399,6 +419,7 @@ namespace spartan
 
         resolve      = true;
         bounding_box = BoundingBox::Unit;
+        hierarchy_revision++;
     }
 
     vector<shared_ptr<Entity>> World::GetRootEntities()
@@ -54,6 +54,8 @@ namespace spartan
         // misc
         static void Clear();
         static void Resolve();
+        static void MarkHierarchyChanged();     // entities were added, removed, re-parented, renamed or (de)activated
+        static uint64_t GetHierarchyRevision(); // so that views of the hierarchy only rebuild when it changes
         static std::string GetName();
         static const std::string& GetFilePath();
         static math::BoundingBox& GetBoundingBox();
@@ -0,0 +1,70 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========
+#include <vector>
+#include <functional>
+//====================
+
+// a minimal harness for the cpu side of the engine: tests and benchmarks register themselves with the macros
+// below, checks report and count failures without stopping the test, and benchmarks only run when asked for
+
+namespace spartan::test
+{
+    struct Case
+    {
+        const char* name = nullptr;
+        std::function<void()> function;
+        bool is_benchmark = false;
+    };
+
+    std::vector<Case>& get_cases();
+    void report_failure(const char* expression, const char* file, const int line);
+
+    struct Registrar
+    {
+        Registrar(const char* name, std::function<void()>&& function, const bool is_benchmark)
+        {
+            get_cases().push_back({ name, std::move(function), is_benchmark });
+        }
+    };
+}
+
+#define SP_TEST(name)                                                                               \
+    static void test_##name();                                                                      \
+    static spartan::test::Registrar registrar_test_##name(#name, test_##name, false);               \
+    static void test_##name()
+
+#define SP_BENCHMARK(name)                                                                          \
+    static void benchmark_##name();                                                                 \
+    static spartan::test::Registrar registrar_benchmark_##name(#name, benchmark_##name, true);      \
+    static void benchmark_##name()
+
+#define SP_CHECK(expression)                                                                        \
+    do                                                                                              \
+    {                                                                                               \
+        if (!(expression))                                                                          \
+        {                                                                                           \
+            spartan::test::report_failure(#expression, __FILE__, __LINE__);                         \
+        }                                                                                           \
+    } while (false)
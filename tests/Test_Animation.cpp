@@ -0,0 +1,179 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "pch.h"
+#include "Test.h"
+#include "Rendering/Animation.h"
+//===============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    const uint32_t bone_count   = 60;
+    const uint32_t key_count    = 121;
+    const double ticks_per_sec  = 30.0;
+
+    // key reduction honours the tolerance exactly, the stored values then add their quantization step on top
+    const float quantization_error_position = 1e-5f; // 16 bits over the track's extent
+    const float quantization_error_rotation = 1e-4f; // 15 bits per smallest three component, in radians
+
+    // a chain of bones with smooth, per bone phase shifted, position and rotation curves
+    shared_ptr<Skeleton> create_skeleton()
+    {
+        shared_ptr<Skeleton> skeleton = make_shared<Skeleton>();
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            skeleton->AddBone("bone_" + to_string(i), static_cast<int32_t>(i) - 1, Matrix::Identity, Vector3(0.0f, 1.0f, 0.0f), Quaternion::Identity, Vector3::One);
+        }
+
+        return skeleton;
+    }
+
+    vector<AnimationNode> create_channels()
+    {
+        vector<AnimationNode> channels(bone_count);
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            channels[i].name = "bone_" + to_string(i);
+            for (uint32_t k = 0; k < key_count; k++)
+            {
+                const double time = static_cast<double>(k);
+                channels[i].positionFrames.push_back({ time, Vector3(0.0f, 1.0f + 0.1f * sinf(k * 0.05f + i), 0.0f) });
+                channels[i].rotationFrames.push_back({ time, Quaternion::FromAxisAngle(Vector3(0.0f, 0.0f, 1.0f), 0.5f * sinf(k * 0.07f + i * 0.3f)) });
+                channels[i].scaleFrames.push_back({ time, Vector3::One });
+            }
+        }
+
+        return channels;
+    }
+
+    Quaternion get_rotation(const AnimationPose& pose, const uint32_t bone)
+    {
+        return Quaternion(pose.rotation[0][bone], pose.rotation[1][bone], pose.rotation[2][bone], pose.rotation[3][bone]);
+    }
+
+    float get_angle(const Quaternion& a, const Quaternion& b)
+    {
+        return 2.0f * acosf(min(1.0f, fabsf(Quaternion::Dot(a, b))));
+    }
+}
+
+SP_TEST(animation_compression_stays_within_tolerance)
+{
+    shared_ptr<Skeleton> skeleton   = create_skeleton();
+    vector<AnimationNode> channels  = create_channels();
+    AnimationCompressionSettings settings;
+
+    Animation animation;
+    animation.SetDuration(static_cast<double>(key_count - 1));
+    animation.SetTicksPerSec(ticks_per_sec);
+    animation.Compress(skeleton, channels, settings);
+
+    // the compressor's own measurement, and the data actually shrank
+    const AnimationCompressionStats& stats = animation.GetCompressionStats();
+    SP_CHECK(stats.key_count < stats.key_count_source);
+    SP_CHECK(stats.size < stats.size_source);
+    SP_CHECK(stats.error_position <= settings.tolerance_position + quantization_error_position);
+    SP_CHECK(stats.error_rotation <= settings.tolerance_rotation + quantization_error_rotation);
+    SP_CHECK(stats.error_scale <= settings.tolerance_scale + quantization_error_position);
+
+    // sampling at the source key times also goes through the quantized key times, so it gets some extra slack
+    AnimationPose pose;
+    float error_position = 0.0f;
+    float error_rotation = 0.0f;
+    for (uint32_t k = 0; k < key_count - 1; k++)
+    {
+        animation.Sample(static_cast<float>(k / ticks_per_sec), false, pose);
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            error_position = max(error_position, fabsf(pose.position[1][i] - channels[i].positionFrames[k].value.y));
+            error_rotation = max(error_rotation, get_angle(get_rotation(pose, i), channels[i].rotationFrames[k].value));
+        }
+    }
+    SP_CHECK(error_position <= settings.tolerance_position * 2.0f);
+    SP_CHECK(error_rotation <= settings.tolerance_rotation * 2.0f);
+}
+
+SP_TEST(animation_blending_matches_a_scalar_reference)
+{
+    Animation animation;
+    animation.SetDuration(static_cast<double>(key_count - 1));
+    animation.SetTicksPerSec(ticks_per_sec);
+    animation.Compress(create_skeleton(), create_channels(), AnimationCompressionSettings());
+
+    AnimationPose a, b, blended;
+    const float weight = 0.3f;
+    animation.Sample(1.3f, true, a);
+    animation.Sample(2.7f, true, b);
+    animation::pose_blend(a, b, weight, blended);
+
+    float error = 0.0f;
+    for (uint32_t i = 0; i < bone_count; i++)
+    {
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            error = max(error, fabsf(a.position[axis][i] * (1.0f - weight) + b.position[axis][i] * weight - blended.position[axis][i]));
+            error = max(error, fabsf(a.scale[axis][i] * (1.0f - weight) + b.scale[axis][i] * weight - blended.scale[axis][i]));
+        }
+
+        const Quaternion reference = Quaternion::Lerp(get_rotation(a, i), get_rotation(b, i), weight).Normalized();
+        error = max(error, fabsf(fabsf(Quaternion::Dot(reference, get_rotation(blended, i))) - 1.0f));
+    }
+    SP_CHECK(error < 1e-5f);
+}
+
+SP_TEST(animation_bind_pose_produces_an_identity_palette)
+{
+    // a bone posed exactly at its bind transform skins nothing
+    const Vector3 position      = Vector3(1.0f, 2.0f, 3.0f);
+    const Quaternion rotation   = Quaternion::FromAxisAngle(Vector3(0.0f, 1.0f, 0.0f), 0.4f);
+    const Matrix bind           = Matrix(position, rotation, Vector3::One);
+
+    Skeleton skeleton;
+    skeleton.AddBone("root", -1, bind.Inverted(), position, rotation, Vector3::One);
+
+    AnimationPose pose;
+    pose.Resize(1);
+    pose.position[0][0] = position.x;
+    pose.position[1][0] = position.y;
+    pose.position[2][0] = position.z;
+    pose.rotation[0][0] = rotation.x;
+    pose.rotation[1][0] = rotation.y;
+    pose.rotation[2][0] = rotation.z;
+    pose.rotation[3][0] = rotation.w;
+
+    Matrix palette;
+    animation::pose_to_palette(skeleton, pose, &palette);
+
+    const float* data = palette.Data();
+    float error       = 0.0f;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        error = max(error, fabsf(data[i] - (i % 5 == 0 ? 1.0f : 0.0f)));
+    }
+    SP_CHECK(error < 1e-5f);
+}
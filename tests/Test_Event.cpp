@@ -0,0 +1,94 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======
+#include "pch.h"
+#include "Test.h"
+#include "Core/Event.h"
+//=================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+SP_TEST(event_coalesces_1000_property_changes_into_one_main_thread_dispatch)
+{
+    // a material edit of 1000 properties, made from two threads, the way loaders and the editor fire them
+    atomic<uint32_t> runs_caller = 0;
+    uint32_t runs_main           = 0;
+    SP_SUBSCRIBE_TO_EVENT(EventType::MaterialOnChanged,             [&runs_caller](sp_variant) { runs_caller++; });
+    SP_SUBSCRIBE_TO_EVENT_MAIN_THREAD(EventType::MaterialOnChanged, [&runs_main](sp_variant)   { runs_main++; });
+
+    auto edit = []()
+    {
+        for (uint32_t property = 0; property < 500; property++)
+        {
+            SP_FIRE_EVENT(EventType::MaterialOnChanged);
+        }
+    };
+    thread editor(edit);
+    edit();
+    editor.join();
+
+    // the caller subscriber ran for every change, the main thread one waits for the dispatch and then runs once
+    SP_CHECK(runs_caller == 1000);
+    SP_CHECK(runs_main == 0);
+    Event::Dispatch();
+    SP_CHECK(runs_main == 1);
+
+    // nothing fired since
+    Event::Dispatch();
+    SP_CHECK(runs_main == 1);
+
+    Event::Shutdown();
+}
+
+SP_TEST(event_dispatches_the_last_data_and_defers_events_fired_while_dispatching)
+{
+    vector<int> received;
+    SP_SUBSCRIBE_TO_EVENT_MAIN_THREAD(EventType::LightOnChanged, [&received](sp_variant data)
+    {
+        received.push_back(get<int>(data));
+
+        // picked up by the next dispatch, not this one
+        if (received.size() == 1)
+        {
+            SP_FIRE_EVENT_DATA(EventType::LightOnChanged, -1);
+        }
+    });
+
+    for (int i = 0; i < 1000; i++)
+    {
+        SP_FIRE_EVENT_DATA(EventType::LightOnChanged, i);
+    }
+
+    Event::Dispatch();
+    SP_CHECK(received == vector<int>({ 999 }));
+    Event::Dispatch();
+    SP_CHECK(received == vector<int>({ 999, -1 }));
+
+    // shutting down drops the subscribers and anything pending
+    SP_FIRE_EVENT(EventType::LightOnChanged);
+    Event::Shutdown();
+    Event::Dispatch();
+    SP_CHECK(received.size() == 2);
+}
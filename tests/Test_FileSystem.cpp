@@ -0,0 +1,124 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======================
+#include "pch.h"
+#include "Test.h"
+#include "FileSystem/FileSystem.h"
+//==================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    const uint32_t directory_count = 100;
+    const uint32_t file_count      = 10000;
+
+    // a flat directory of sub-directories and files, file i is i % 100 bytes, every third one is text
+    struct ScratchDirectory
+    {
+        ScratchDirectory()
+        {
+            path = (filesystem::temp_directory_path() / "spartan_tests_file_system").string();
+            filesystem::remove_all(path);
+            filesystem::create_directories(path);
+
+            for (uint32_t i = 0; i < directory_count; i++)
+            {
+                filesystem::create_directories(path + "/directory_" + to_string(i));
+            }
+
+            for (uint32_t i = 0; i < file_count; i++)
+            {
+                ofstream(path + "/file_" + to_string(i) + (i % 3 == 0 ? ".txt" : ".png")) << string(i % 100, 'x');
+            }
+        }
+
+        ~ScratchDirectory()
+        {
+            filesystem::remove_all(path);
+        }
+
+        string path;
+    };
+}
+
+SP_TEST(file_system_enumerates_a_large_directory_in_one_pass)
+{
+    const ScratchDirectory directory;
+    const vector<FileSystemEntry> entries = FileSystem::GetEntriesInDirectory(directory.path);
+    SP_CHECK(entries.size() == directory_count + file_count);
+
+    // directories first, then files with their size and time filled in
+    bool is_ordered  = true;
+    bool is_complete = true;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const FileSystemEntry& entry = entries[i];
+        if (entry.is_directory != (i < directory_count))
+        {
+            is_ordered = false;
+        }
+
+        if (!entry.is_directory)
+        {
+            const size_t index_start = entry.path.rfind("file_") + 5;
+            const uint32_t index     = static_cast<uint32_t>(stoul(entry.path.substr(index_start, entry.path.find('.', index_start) - index_start)));
+            is_complete              = is_complete && entry.size == index % 100 && entry.time_modified != 0;
+        }
+    }
+    SP_CHECK(is_ordered);
+    SP_CHECK(is_complete);
+
+    // the same listing as the separate queries
+    SP_CHECK(FileSystem::GetDirectoriesInDirectory(directory.path).size() == directory_count);
+    SP_CHECK(FileSystem::GetFilesInDirectory(directory.path).size() == file_count);
+
+    SP_CHECK(FileSystem::GetEntriesInDirectory(directory.path + "/does_not_exist").empty());
+}
+
+SP_BENCHMARK(file_system_enumeration)
+{
+    const ScratchDirectory directory;
+
+    Stopwatch stopwatch;
+    const vector<FileSystemEntry> entries = FileSystem::GetEntriesInDirectory(directory.path);
+    const float time_single_pass          = stopwatch.GetElapsedTimeMs();
+
+    // what the asset browser used to do: two listings, then a query per item
+    stopwatch.Start();
+    uint32_t image_count = 0;
+    for (const string& path : FileSystem::GetDirectoriesInDirectory(directory.path))
+    {
+        FileSystem::IsDirectory(path);
+    }
+    for (const string& path : FileSystem::GetFilesInDirectory(directory.path))
+    {
+        FileSystem::IsDirectory(path);
+        image_count += FileSystem::IsSupportedImageFile(path) ? 1 : 0;
+    }
+    const float time_per_item = stopwatch.GetElapsedTimeMs();
+
+    printf("    %zu entries, single pass: %.2f ms, listings and per item queries: %.2f ms\n", entries.size(), time_single_pass, time_per_item);
+}
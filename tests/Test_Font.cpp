@@ -0,0 +1,141 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "pch.h"
+#include "Test.h"
+#include "Font/FontLayout.h"
+//=========================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    // a monospaced font, every printable ascii glyph is 8x12 and advances by 10
+    GlyphTable create_glyphs()
+    {
+        GlyphTable glyphs;
+        for (uint32_t code = 32; code < 127; code++)
+        {
+            Glyph glyph;
+            glyph.offset_x           = 1;
+            glyph.offset_y           = 12;
+            glyph.width              = code == font_layout::ascii_space ? 0 : 8;
+            glyph.height             = code == font_layout::ascii_space ? 0 : 12;
+            glyph.horizontal_advance = 10;
+            glyph.uv_x_left          = static_cast<float>(code) / 128.0f;
+            glyph.uv_x_right         = static_cast<float>(code + 1) / 128.0f;
+            glyph.uv_y_top           = 0.0f;
+            glyph.uv_y_bottom        = 1.0f;
+            glyphs.Set(code, glyph);
+        }
+
+        return glyphs;
+    }
+
+    vector<RHI_Vertex_PosTex> create_vertices(const uint32_t quad_count)
+    {
+        return vector<RHI_Vertex_PosTex>(static_cast<size_t>(quad_count) * 4, RHI_Vertex_PosTex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+    }
+}
+
+SP_TEST(font_layout_writes_a_quad_per_visible_glyph)
+{
+    const GlyphTable glyphs = create_glyphs();
+    const string text       = "ab c\n\td";
+    SP_CHECK(font_layout::count_quads(text) == 4);
+
+    vector<RHI_Vertex_PosTex> vertices = create_vertices(4);
+    SP_CHECK(font_layout::write_quads(glyphs, text, Vector2(0.0f, 0.0f), 1.0f, 20.0f, vertices.data(), 4) == 4);
+
+    // a, b and (after a space) c on the first line, left-top corners advance by 10
+    SP_CHECK(vertices[0].pos[0] == 1.0f  && vertices[0].pos[1] == 12.0f);
+    SP_CHECK(vertices[4].pos[0] == 11.0f && vertices[4].pos[1] == 12.0f);
+    SP_CHECK(vertices[8].pos[0] == 31.0f && vertices[8].pos[1] == 12.0f);
+
+    // the right-bottom corner is the glyph size away
+    SP_CHECK(vertices[1].pos[0] == 9.0f && vertices[1].pos[1] == 0.0f);
+
+    // d is a line down and a tab (four spaces) in
+    SP_CHECK(vertices[12].pos[0] == 41.0f && vertices[12].pos[1] == -8.0f);
+    SP_CHECK(vertices[12].tex[0] == static_cast<float>('d') / 128.0f);
+}
+
+SP_TEST(font_layout_truncates_at_the_reserved_quads)
+{
+    const GlyphTable glyphs = create_glyphs();
+    const string text       = "abcdef";
+
+    // the quads past the reserved ones are left untouched
+    vector<RHI_Vertex_PosTex> vertices = create_vertices(4);
+    vertices[12].pos[0]                = -1.0f;
+    SP_CHECK(font_layout::write_quads(glyphs, text, Vector2(0.0f, 0.0f), 2.0f, 20.0f, vertices.data(), 3) == 3);
+    SP_CHECK(vertices[8].pos[0] == 42.0f);
+    SP_CHECK(vertices[12].pos[0] == -1.0f);
+    SP_CHECK(font_layout::write_quads(glyphs, text, Vector2(0.0f, 0.0f), 2.0f, 20.0f, vertices.data(), 0) == 0);
+}
+
+SP_BENCHMARK(font_layout_glyphs_per_ms)
+{
+    const GlyphTable glyphs = create_glyphs();
+
+    // a screen full of debug text, 200 lines of 80 characters
+    string text;
+    for (uint32_t line = 0; line < 200; line++)
+    {
+        for (uint32_t column = 0; column < 80; column++)
+        {
+            text += static_cast<char>(column % 8 == 7 ? ' ' : 33 + (line * 80 + column) % 94);
+        }
+        text += '\n';
+    }
+
+    const uint32_t quad_count          = font_layout::count_quads(text);
+    const uint32_t iterations          = 200;
+    vector<RHI_Vertex_PosTex> vertices = create_vertices(quad_count);
+
+    // laid out, the way new text is
+    uint32_t written = 0;
+    Stopwatch stopwatch;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        written += font_layout::write_quads(glyphs, text, Vector2(-640.0f, 360.0f), 1.0f, 14.0f, vertices.data(), font_layout::count_quads(text));
+    }
+    const double ms_layout = stopwatch.GetElapsedTimeMs();
+    SP_CHECK(written == quad_count * iterations);
+
+    // copied, the way text that was drawn the previous frame is
+    vector<RHI_Vertex_PosTex> batch = create_vertices(quad_count);
+    stopwatch.Start();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        memcpy(batch.data(), vertices.data(), vertices.size() * sizeof(RHI_Vertex_PosTex));
+    }
+    const double ms_cached = stopwatch.GetElapsedTimeMs();
+    SP_CHECK(batch[4].pos[0] == vertices[4].pos[0]);
+
+    const double glyph_total = static_cast<double>(quad_count) * iterations;
+    printf("    %u glyphs per frame, laid out: %.0f glyphs/ms, cached: %.0f glyphs/ms\n", quad_count, glyph_total / ms_layout, glyph_total / max(ms_cached, 0.001));
+}
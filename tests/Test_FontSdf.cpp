@@ -0,0 +1,213 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "pch.h"
+#include "Test.h"
+#include "Font/FontSdf.h"
+//=======================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    // a filled circle, with its coverage from 8x8 samples per pixel, like an anti-aliased rasterizer would produce
+    vector<uint8_t> create_circle(const uint32_t size, const float center, const float radius)
+    {
+        const uint32_t samples = 8;
+        vector<uint8_t> coverage(static_cast<size_t>(size) * size);
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                uint32_t inside = 0;
+                for (uint32_t sy = 0; sy < samples; sy++)
+                {
+                    for (uint32_t sx = 0; sx < samples; sx++)
+                    {
+                        const float px = x + (sx + 0.5f) / samples - center;
+                        const float py = y + (sy + 0.5f) / samples - center;
+                        inside        += (px * px + py * py <= radius * radius) ? 1 : 0;
+                    }
+                }
+                coverage[static_cast<size_t>(y) * size + x] = static_cast<uint8_t>(inside * 255 / (samples * samples));
+            }
+        }
+
+        return coverage;
+    }
+
+    font_sdf::Atlas create_atlas()
+    {
+        font_sdf::Atlas atlas;
+        atlas.font_size = 32;
+        atlas.spread    = 4;
+        atlas.width     = 64;
+        atlas.height    = 32;
+        atlas.pixels.resize(static_cast<size_t>(atlas.width) * atlas.height);
+        for (size_t i = 0; i < atlas.pixels.size(); i++)
+        {
+            atlas.pixels[i] = static_cast<byte>(i * 7);
+        }
+
+        for (uint32_t char_code : { 65u, 66u, 0x263Au })
+        {
+            Glyph glyph;
+            glyph.offset_x           = -static_cast<int32_t>(char_code % 5);
+            glyph.offset_y           = static_cast<int32_t>(char_code % 11);
+            glyph.width              = 10 + char_code % 3;
+            glyph.height             = 14;
+            glyph.horizontal_advance = 12;
+            glyph.uv_x_left          = 0.125f;
+            glyph.uv_x_right         = 0.25f;
+            glyph.uv_y_top           = 0.5f;
+            glyph.uv_y_bottom        = 0.75f;
+            atlas.glyphs.emplace_back(char_code, glyph);
+        }
+
+        return atlas;
+    }
+
+    bool is_identical(const font_sdf::Atlas& a, const font_sdf::Atlas& b)
+    {
+        if (a.font_size != b.font_size || a.spread != b.spread || a.width != b.width || a.height != b.height || a.pixels != b.pixels || a.glyphs.size() != b.glyphs.size())
+            return false;
+
+        for (size_t i = 0; i < a.glyphs.size(); i++)
+        {
+            const Glyph& x = a.glyphs[i].second;
+            const Glyph& y = b.glyphs[i].second;
+            if (a.glyphs[i].first != b.glyphs[i].first || x.offset_x != y.offset_x || x.offset_y != y.offset_y || x.width != y.width || x.height != y.height ||
+                x.horizontal_advance != y.horizontal_advance || x.uv_x_left != y.uv_x_left || x.uv_x_right != y.uv_x_right || x.uv_y_top != y.uv_y_top || x.uv_y_bottom != y.uv_y_bottom)
+                return false;
+        }
+
+        return true;
+    }
+
+    // writes a value over the file at an offset, or truncates the file there when no value is given
+    void corrupt(const string& path, const uint64_t offset, const uint32_t* value)
+    {
+        if (value)
+        {
+            fstream file(path, ios::binary | ios::in | ios::out);
+            file.seekp(static_cast<streamoff>(offset));
+            file.write(reinterpret_cast<const char*>(value), sizeof(uint32_t));
+        }
+        else
+        {
+            filesystem::resize_file(path, offset);
+        }
+    }
+}
+
+SP_TEST(font_sdf_generates_distances_within_a_pixel)
+{
+    const uint32_t size            = 48;
+    const uint32_t spread          = 8;
+    const float center             = 24.0f;
+    const float radius             = 15.0f;
+    const vector<uint8_t> coverage = create_circle(size, center, radius);
+
+    // into a region of a larger atlas, the way glyphs are generated side by side
+    const uint32_t padded = size + spread * 2;
+    const uint32_t pitch  = padded + 10;
+    vector<byte> atlas(static_cast<size_t>(pitch) * padded, byte{ 0x7F });
+    font_sdf::generate(coverage.data(), size, size, spread, atlas.data(), pitch);
+
+    // the decoded distance against the true distance to the circle, where it isn't clamped
+    float error_max = 0.0f;
+    for (uint32_t y = 0; y < padded; y++)
+    {
+        for (uint32_t x = 0; x < padded; x++)
+        {
+            const float value    = static_cast<float>(atlas[static_cast<size_t>(y) * pitch + x]) / 255.0f;
+            const float decoded  = (0.5f - value) * 2.0f * spread; // positive outside
+            const float dx       = x + 0.5f - spread - center;
+            const float dy       = y + 0.5f - spread - center;
+            const float distance = sqrtf(dx * dx + dy * dy) - radius;
+            if (fabsf(distance) < spread - 1.0f)
+            {
+                error_max = max(error_max, fabsf(decoded - distance));
+            }
+        }
+    }
+    SP_CHECK(error_max < 0.75f);
+
+    // deep inside is fully in, the padding corners are fully out, and the columns past the region are untouched
+    SP_CHECK(atlas[static_cast<size_t>(spread + 24) * pitch + spread + 24] == byte{ 255 });
+    SP_CHECK(atlas[0] == byte{ 0 });
+    SP_CHECK(atlas[static_cast<size_t>(padded - 1) * pitch + padded - 1] == byte{ 0 });
+    SP_CHECK(atlas[padded] == byte{ 0x7F } && atlas[static_cast<size_t>(padded - 1) * pitch + pitch - 1] == byte{ 0x7F });
+}
+
+SP_TEST(font_sdf_cache_round_trips_and_rejects_corrupt_files)
+{
+    const string directory = (filesystem::temp_directory_path() / "spartan_tests_font_sdf").string();
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    const string path      = directory + "/atlas.bin";
+    const uint64_t hash    = 0x1234'5678'9ABC'DEF0ull;
+
+    const font_sdf::Atlas atlas = create_atlas();
+    SP_CHECK(font_sdf::save(atlas, path, hash));
+    const uint64_t pixel_count = static_cast<uint64_t>(atlas.width) * atlas.height;
+    SP_CHECK(filesystem::file_size(path) == font_sdf::cache_header_size + pixel_count + sizeof(uint32_t) + atlas.glyphs.size() * font_sdf::cache_glyph_size);
+
+    font_sdf::Atlas loaded;
+    SP_CHECK(font_sdf::load(loaded, path, hash));
+    SP_CHECK(is_identical(atlas, loaded));
+
+    // another source, or no file at all
+    font_sdf::Atlas untouched = create_atlas();
+    SP_CHECK(!font_sdf::load(untouched, path, hash + 1));
+    SP_CHECK(!font_sdf::load(untouched, directory + "/missing.bin", hash));
+
+    // every kind of damage is rejected, before anything is allocated for it, and leaves the atlas as it was
+    const uint32_t huge     = 0xFFFF'FFFF;
+    const uint32_t wrong    = 63;
+    const uint32_t version  = font_sdf::cache_version + 1;
+    const uint64_t glyph_at = font_sdf::cache_header_size + pixel_count;
+    const pair<uint64_t, const uint32_t*> damages[] =
+    {
+        { 4,             &version }, // another version
+        { 24,            &huge    }, // width
+        { 28,            &wrong   }, // height, within limits but not what the pixels add up to
+        { 32,            &huge    }, // pixel count
+        { glyph_at,      &huge    }, // glyph count
+        { glyph_at,      &wrong   }, // glyph count, within limits but not what the file holds
+        { glyph_at + 20, nullptr  }, // truncated in the glyphs
+        { 100,           nullptr  }, // truncated in the pixels
+        { 10,            nullptr  }, // truncated in the header
+    };
+    for (const auto& [offset, value] : damages)
+    {
+        SP_CHECK(font_sdf::save(atlas, path, hash));
+        corrupt(path, offset, value);
+        SP_CHECK(!font_sdf::load(untouched, path, hash));
+        SP_CHECK(is_identical(untouched, atlas));
+    }
+
+    filesystem::remove_all(directory);
+}
@@ -0,0 +1,196 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "pch.h"
+#include "Test.h"
+#include "Core/FreeListAllocator.h"
+//===============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    // allocations must not overlap, and the used and free space must add up to the capacity
+    bool is_consistent(const FreeListAllocator& allocator, const vector<uint32_t>& ids)
+    {
+        vector<pair<uint64_t, uint64_t>> ranges;
+        uint64_t used = 0;
+        for (uint32_t id : ids)
+        {
+            if (!allocator.IsAllocated(id))
+                return false;
+
+            ranges.emplace_back(allocator.GetOffset(id), allocator.GetSize(id));
+            used += allocator.GetSize(id);
+        }
+
+        sort(ranges.begin(), ranges.end());
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            const uint64_t end = ranges[i].first + ranges[i].second;
+            if (end > allocator.GetCapacity() || (i + 1 < ranges.size() && end > ranges[i + 1].first))
+                return false;
+        }
+
+        const FreeListAllocator::Stats stats = allocator.GetStats();
+        return stats.used == used && stats.used + stats.free == stats.capacity && stats.allocation_count == ids.size();
+    }
+}
+
+SP_TEST(free_list_allocator_allocates_and_coalesces)
+{
+    FreeListAllocator allocator(100);
+    const uint32_t a = allocator.Allocate(10);
+    const uint32_t b = allocator.Allocate(20);
+    const uint32_t c = allocator.Allocate(30);
+    SP_CHECK(allocator.GetOffset(a) == 0 && allocator.GetOffset(b) == 10 && allocator.GetOffset(c) == 30);
+    SP_CHECK(allocator.Allocate(0) == FreeListAllocator::invalid_id);
+    SP_CHECK(allocator.Allocate(41) == FreeListAllocator::invalid_id);
+
+    // a hole in the middle, then merged with its neighbour
+    allocator.Free(b);
+    SP_CHECK(allocator.GetStats().free_block_count == 2);
+    SP_CHECK(!allocator.IsAllocated(b));
+    allocator.Free(a);
+    SP_CHECK(allocator.GetStats().free_block_count == 2);
+    SP_CHECK(allocator.GetStats().largest_free == 40);
+
+    // best fit, the 30 element hole is used instead of the 40 element tail
+    const uint32_t d = allocator.Allocate(30);
+    SP_CHECK(allocator.GetOffset(d) == 0);
+    SP_CHECK(allocator.GetStats().free_block_count == 1);
+
+    // freeing everything leaves a single range
+    allocator.Free(c);
+    allocator.Free(d);
+    allocator.Free(d); // double free is ignored
+    const FreeListAllocator::Stats stats = allocator.GetStats();
+    SP_CHECK(stats.used == 0 && stats.free_block_count == 1 && stats.largest_free == 100 && stats.fragmentation == 0.0f);
+}
+
+SP_TEST(free_list_allocator_grows_into_its_free_tail)
+{
+    FreeListAllocator allocator(64);
+    const uint32_t a = allocator.Allocate(48);
+    SP_CHECK(allocator.Allocate(32) == FreeListAllocator::invalid_id);
+
+    allocator.Grow(128);
+    SP_CHECK(allocator.GetCapacity() == 128);
+    SP_CHECK(allocator.GetStats().free_block_count == 1); // the old tail and the new space are one range
+    const uint32_t b = allocator.Allocate(80);
+    SP_CHECK(b != FreeListAllocator::invalid_id && allocator.GetOffset(b) == 48);
+    SP_CHECK(is_consistent(allocator, { a, b }));
+}
+
+SP_TEST(free_list_allocator_defragments_in_place)
+{
+    // every element holds the id of the allocation it belongs to, so moves can be verified
+    const uint64_t capacity = 4096;
+    FreeListAllocator allocator(capacity);
+    vector<uint32_t> memory(capacity, FreeListAllocator::invalid_id);
+    vector<uint32_t> ids;
+    mt19937 random(7);
+    while (true)
+    {
+        const uint32_t id = allocator.Allocate(1 + random() % 16);
+        if (id == FreeListAllocator::invalid_id)
+            break;
+
+        fill_n(memory.begin() + allocator.GetOffset(id), allocator.GetSize(id), id);
+        ids.push_back(id);
+    }
+
+    // free every other allocation, to scatter the free space (no large tail is left since the allocator is full)
+    vector<uint32_t> ids_alive;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (i % 2 == 0)
+        {
+            allocator.Free(ids[i]);
+        }
+        else
+        {
+            ids_alive.push_back(ids[i]);
+        }
+    }
+    SP_CHECK(allocator.GetStats().fragmentation > 0.5f);
+
+    vector<FreeListAllocator::Move> moves;
+    allocator.Defragment(moves);
+    SP_CHECK(!moves.empty());
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        SP_CHECK(moves[i].offset_destination < moves[i].offset_source);
+        SP_CHECK(i == 0 || moves[i].offset_source > moves[i - 1].offset_source);
+        memmove(&memory[moves[i].offset_destination], &memory[moves[i].offset_source], moves[i].size * sizeof(uint32_t));
+    }
+
+    // packed, and the contents followed their (stable) ids
+    const FreeListAllocator::Stats stats = allocator.GetStats();
+    SP_CHECK(stats.free_block_count == 1 && stats.fragmentation == 0.0f && stats.largest_free == capacity - stats.used);
+    SP_CHECK(is_consistent(allocator, ids_alive));
+    for (uint32_t id : ids_alive)
+    {
+        SP_CHECK(allocator.GetOffset(id) + allocator.GetSize(id) <= stats.used);
+        SP_CHECK(all_of(memory.begin() + allocator.GetOffset(id), memory.begin() + allocator.GetOffset(id) + allocator.GetSize(id), [id](uint32_t value) { return value == id; }));
+    }
+}
+
+SP_TEST(free_list_allocator_stays_consistent_under_random_use)
+{
+    FreeListAllocator allocator(1 << 16);
+    vector<uint32_t> ids;
+    mt19937 random(42);
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        if (ids.empty() || random() % 3 != 0)
+        {
+            const uint32_t id = allocator.Allocate(1 + random() % 512);
+            if (id != FreeListAllocator::invalid_id)
+            {
+                ids.push_back(id);
+            }
+        }
+        else
+        {
+            const size_t index = random() % ids.size();
+            allocator.Free(ids[index]);
+            ids[index] = ids.back();
+            ids.pop_back();
+        }
+
+        if (i % 1000 == 0)
+        {
+            SP_CHECK(is_consistent(allocator, ids));
+        }
+    }
+    SP_CHECK(is_consistent(allocator, ids));
+
+    for (uint32_t id : ids)
+    {
+        allocator.Free(id);
+    }
+    SP_CHECK(allocator.GetStats().free_block_count == 1 && allocator.GetStats().used == 0);
+}
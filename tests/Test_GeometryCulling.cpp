@@ -0,0 +1,166 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "pch.h"
+#include "Test.h"
+#include "RHI/RHI_Vertex.h"
+#include "Geometry/GeometryProcessing.h"
+#include "Geometry/GeometryCulling.h"
+//=================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    // a rolling, upward facing grid, large enough to be split into clusters
+    void create_grid(const uint32_t quads, vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+        for (uint32_t z = 0; z <= quads; z++)
+        {
+            for (uint32_t x = 0; x <= quads; x++)
+            {
+                RHI_Vertex_PosTexNorTan vertex = {};
+                vertex.pos[0] = static_cast<float>(x);
+                vertex.pos[1] = sinf(x * 0.1f) * cosf(z * 0.13f) * 5.0f;
+                vertex.pos[2] = static_cast<float>(z);
+                vertices.push_back(vertex);
+            }
+        }
+
+        for (uint32_t z = 0; z < quads; z++)
+        {
+            for (uint32_t x = 0; x < quads; x++)
+            {
+                const uint32_t a = z * (quads + 1) + x;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + quads + 1;
+                const uint32_t d = c + 1;
+                indices.insert(indices.end(), { a, c, b, b, c, d });
+            }
+        }
+    }
+
+    uint32_t get_cluster_count(const geometry_culling::ClusterCullingStats& stats)
+    {
+        return stats.clusters_visible + stats.clusters_frustum + stats.clusters_backface + stats.clusters_distance;
+    }
+}
+
+SP_TEST(clusters_partition_the_index_buffer)
+{
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(200, vertices, indices);
+    const size_t index_count = indices.size();
+
+    vector<MeshCluster> clusters;
+    geometry_processing::build_clusters(indices, vertices, clusters);
+    SP_CHECK(!clusters.empty());
+    SP_CHECK(indices.size() == index_count);
+
+    // clusters are contiguous, in order, and within the meshlet limits
+    uint32_t index_offset = 0;
+    for (const MeshCluster& cluster : clusters)
+    {
+        SP_CHECK(cluster.index_offset == index_offset);
+        SP_CHECK(cluster.index_count > 0 && cluster.index_count <= mesh_cluster_max_triangles * 3);
+        SP_CHECK(cluster.sphere_radius > 0.0f);
+        index_offset += cluster.index_count;
+    }
+    SP_CHECK(index_offset == index_count);
+
+    // small meshes are not clustered
+    create_grid(8, vertices, indices);
+    geometry_processing::build_clusters(indices, vertices, clusters);
+    SP_CHECK(clusters.empty());
+}
+
+SP_TEST(cluster_culling_merges_visible_ranges)
+{
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(200, vertices, indices);
+
+    vector<MeshCluster> clusters;
+    geometry_processing::build_clusters(indices, vertices, clusters);
+
+    // nothing culled, so every cluster merges into one range, offset by where the lod starts
+    geometry_culling::ClusterCullingParameters parameters;
+    parameters.cull_frustum   = false;
+    parameters.cull_backfaces = false;
+    vector<MeshIndexRange> ranges;
+    const geometry_culling::ClusterCullingStats stats = geometry_culling::cull_clusters(clusters, 1000, parameters, ranges);
+    SP_CHECK(stats.clusters_visible == clusters.size());
+    SP_CHECK(ranges.size() == 1);
+    SP_CHECK(!ranges.empty() && ranges[0].index_offset == 1000 && ranges[0].index_count == indices.size());
+}
+
+SP_TEST(cluster_culling_rejects_backfaces_distance_and_frustum)
+{
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(200, vertices, indices);
+
+    vector<MeshCluster> clusters;
+    geometry_processing::build_clusters(indices, vertices, clusters);
+
+    vector<MeshIndexRange> ranges;
+    geometry_culling::ClusterCullingParameters parameters;
+    parameters.cull_frustum = false;
+
+    // from below, the clusters face away from the camera
+    parameters.camera_position = Vector3(100.0f, -50.0f, 100.0f);
+    const geometry_culling::ClusterCullingStats below = geometry_culling::cull_clusters(clusters, 0, parameters, ranges);
+    parameters.camera_position = Vector3(100.0f, 50.0f, 100.0f);
+    const geometry_culling::ClusterCullingStats above = geometry_culling::cull_clusters(clusters, 0, parameters, ranges);
+    SP_CHECK(below.clusters_backface > 0);
+    SP_CHECK(above.clusters_backface == 0);
+    SP_CHECK(get_cluster_count(below) == clusters.size() && get_cluster_count(above) == clusters.size());
+
+    // distance, only the clusters near the camera survive
+    parameters.max_distance = 50.0f;
+    const geometry_culling::ClusterCullingStats distance = geometry_culling::cull_clusters(clusters, 0, parameters, ranges);
+    SP_CHECK(distance.clusters_distance > 0 && distance.clusters_visible > 0);
+    SP_CHECK(get_cluster_count(distance) == clusters.size());
+
+    // frustum, looking at the grid from its side and then away from it
+    parameters.max_distance    = FLT_MAX;
+    parameters.cull_frustum    = true;
+    parameters.cull_backfaces  = false;
+    parameters.camera_position = Vector3(-50.0f, 20.0f, 100.0f);
+    const Matrix projection    = Matrix::CreatePerspectiveFieldOfViewLH(1.0f, 1.0f, 0.1f, 1000.0f);
+
+    parameters.frustum = Frustum(Matrix::CreateLookAtLH(parameters.camera_position, Vector3(100.0f, 0.0f, 100.0f), Vector3::Up), projection, 1000.0f);
+    const geometry_culling::ClusterCullingStats toward = geometry_culling::cull_clusters(clusters, 0, parameters, ranges);
+    SP_CHECK(toward.clusters_visible > 0);
+
+    parameters.frustum = Frustum(Matrix::CreateLookAtLH(parameters.camera_position, Vector3(-200.0f, 20.0f, 100.0f), Vector3::Up), projection, 1000.0f);
+    const geometry_culling::ClusterCullingStats away = geometry_culling::cull_clusters(clusters, 0, parameters, ranges);
+    SP_CHECK(away.clusters_visible == 0 && away.clusters_frustum == clusters.size());
+    SP_CHECK(ranges.empty());
+}
@@ -0,0 +1,143 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "pch.h"
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "RHI/RHI_Vertex.h"
+#include "Geometry/GeometryHlod.h"
+//================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    // a bumpy grid of 1 m quads, centered, the texture coordinates hold the grid coordinates
+    void create_grid(const uint32_t width, vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices)
+    {
+        vertices.assign(static_cast<size_t>(width) * width, RHI_Vertex_PosTexNorTan());
+        for (uint32_t z = 0; z < width; z++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                RHI_Vertex_PosTexNorTan& vertex = vertices[static_cast<size_t>(z) * width + x];
+                vertex.pos[0]                   = x - width * 0.5f;
+                vertex.pos[1]                   = sinf(x * 0.3f) * cosf(z * 0.2f) * 2.0f;
+                vertex.pos[2]                   = z - width * 0.5f;
+                vertex.nor[1]                   = 1.0f;
+                vertex.tex[0]                   = static_cast<float>(x) / width;
+                vertex.tex[1]                   = static_cast<float>(z) / width;
+            }
+        }
+
+        indices.clear();
+        for (uint32_t z = 0; z + 1 < width; z++)
+        {
+            for (uint32_t x = 0; x + 1 < width; x++)
+            {
+                const uint32_t bottom_left  = z * width + x;
+                const uint32_t bottom_right = bottom_left + 1;
+                const uint32_t top_left     = bottom_left + width;
+                const uint32_t top_right    = top_left + 1;
+                indices.insert(indices.end(), { bottom_right, bottom_left, top_left, bottom_right, top_left, top_right });
+            }
+        }
+    }
+
+    geometry_hlod::HlodPart create_part(const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<uint32_t>& indices, const Vector3& position, const float angle, const uint64_t material_id, const uint32_t member_index)
+    {
+        geometry_hlod::HlodPart part;
+        part.vertices     = &vertices;
+        part.indices      = &indices;
+        part.transform    = Matrix::CreateScale(1.5f) * Matrix::CreateRotation(Quaternion::FromEulerAngles(0.0f, angle, 0.0f)) * Matrix::CreateTranslation(position);
+        part.aabb         = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size())) * part.transform;
+        part.material_id  = material_id;
+        part.member_index = member_index;
+
+        return part;
+    }
+}
+
+SP_TEST(geometry_hlod_builds_a_cell_proxy_within_budget_and_bounds)
+{
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(33, vertices, indices);
+
+    // six instances in the first cell, alternating between two materials, and two in a cell too sparse for a proxy
+    vector<geometry_hlod::HlodPart> parts;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        parts.push_back(create_part(vertices, indices, Vector3(40.0f + i * 30.0f, 5.0f, 60.0f + (i % 2) * 50.0f), i * 25.0f, 1 + i % 2, i));
+    }
+    parts.push_back(create_part(vertices, indices, Vector3(1040.0f, 0.0f, 60.0f), 0.0f, 1, 6));
+    parts.push_back(create_part(vertices, indices, Vector3(1080.0f, 0.0f, 60.0f), 0.0f, 1, 7));
+
+    geometry_hlod::HlodParameters parameters;
+    vector<geometry_hlod::HlodCell> cells;
+    geometry_hlod::build_cells(parts, parameters, cells);
+    SP_CHECK(cells.size() == 1);
+    if (cells.size() != 1)
+        return;
+
+    const geometry_hlod::HlodCell& cell = cells[0];
+    SP_CHECK(cell.members == vector<uint32_t>({ 0, 1, 2, 3, 4, 5 }));
+
+    // the bounds enclose exactly the parts, and the proxy is centered on them
+    BoundingBox aabb;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        aabb.Merge(parts[i].aabb);
+    }
+    SP_CHECK(cell.aabb == aabb);
+    SP_CHECK(cell.center == aabb.GetCenter());
+
+    // a proxy per material, each one within the triangle budget and within the bounds
+    SP_CHECK(cell.proxies.size() == 2);
+    const size_t budget = static_cast<size_t>(indices.size() * 3 * parameters.reduction);
+    for (const geometry_hlod::HlodProxy& proxy : cell.proxies)
+    {
+        SP_CHECK(proxy.material_id == 1 || proxy.material_id == 2);
+        SP_CHECK(!proxy.indices.empty() && proxy.indices.size() % 3 == 0);
+        SP_CHECK(proxy.indices.size() <= budget);
+
+        const BoundingBox aabb_padded(aabb.GetMin() - Vector3(0.01f), aabb.GetMax() + Vector3(0.01f));
+        bool is_inside = true;
+        for (const RHI_Vertex_PosTexNorTan& vertex : proxy.vertices)
+        {
+            is_inside = is_inside && aabb_padded.Contains(Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]) + cell.center);
+        }
+        SP_CHECK(is_inside);
+
+        bool is_indexed = true;
+        for (const uint32_t index : proxy.indices)
+        {
+            is_indexed = is_indexed && index < proxy.vertices.size();
+        }
+        SP_CHECK(is_indexed);
+    }
+    SP_CHECK(cell.proxies[0].material_id != cell.proxies[1].material_id);
+}
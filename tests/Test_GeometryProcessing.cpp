@@ -0,0 +1,169 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "pch.h"
+#include "Test.h"
+#include "RHI/RHI_Vertex.h"
+#include "Geometry/GeometryProcessing.h"
+//=================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    // a centered grid of 2 m quads with the winding of the terrain, the texture coordinates hold the grid coordinates
+    void create_grid(const uint32_t width, vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices)
+    {
+        vertices.assign(static_cast<size_t>(width) * width, RHI_Vertex_PosTexNorTan());
+        for (uint32_t z = 0; z < width; z++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                RHI_Vertex_PosTexNorTan& vertex = vertices[static_cast<size_t>(z) * width + x];
+                vertex.pos[0]                   = x * 2.0f - width;
+                vertex.pos[1]                   = sinf(x * 0.1f) * cosf(z * 0.07f) * 20.0f;
+                vertex.pos[2]                   = z * 2.0f - width;
+                vertex.tex[0]                   = static_cast<float>(x);
+                vertex.tex[1]                   = static_cast<float>(z);
+            }
+        }
+
+        indices.clear();
+        indices.reserve(static_cast<size_t>(width - 1) * (width - 1) * 6);
+        for (uint32_t z = 0; z + 1 < width; z++)
+        {
+            for (uint32_t x = 0; x + 1 < width; x++)
+            {
+                const uint32_t bottom_left  = z * width + x;
+                const uint32_t bottom_right = bottom_left + 1;
+                const uint32_t top_left     = bottom_left + width;
+                const uint32_t top_right    = top_left + 1;
+                indices.insert(indices.end(), { bottom_right, bottom_left, top_left, bottom_right, top_left, top_right });
+            }
+        }
+    }
+
+    // the grid (density 3 over a 512 height map) and tile count the terrain uses
+    const uint32_t benchmark_width      = 3 * (512 - 1) + 1;
+    const uint32_t benchmark_tile_count = 48;
+}
+
+SP_TEST(geometry_grid_tiles_match_the_source_triangles)
+{
+    const uint32_t width      = 3 * (64 - 1) + 1;
+    const uint32_t tile_count = 8;
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(width, vertices, indices);
+
+    vector<vector<RHI_Vertex_PosTexNorTan>> tile_vertices;
+    vector<vector<uint32_t>> tile_indices;
+    vector<Vector3> tile_offsets;
+    geometry_processing::split_grid_into_tiles(vertices, width, width, tile_count, tile_vertices, tile_indices, tile_offsets);
+    SP_CHECK(tile_vertices.size() == tile_count * tile_count);
+
+    // every source triangle is in exactly one tile, with the same vertices (once offset) and the same winding
+    vector<uint32_t> seen(indices.size() / 3, 0);
+    bool is_equivalent = true;
+    for (size_t t = 0; t < tile_vertices.size(); t++)
+    {
+        for (size_t i = 0; i < tile_indices[t].size(); i += 3)
+        {
+            uint32_t source[3];
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                const RHI_Vertex_PosTexNorTan& vertex = tile_vertices[t][tile_indices[t][i + corner]];
+                source[corner]                        = static_cast<uint32_t>(vertex.tex[1]) * width + static_cast<uint32_t>(vertex.tex[0]);
+                const RHI_Vertex_PosTexNorTan& origin = vertices[source[corner]];
+                is_equivalent                         = is_equivalent &&
+                    fabsf(vertex.pos[0] + tile_offsets[t].x - origin.pos[0]) < 1e-3f &&
+                    vertex.pos[1] == origin.pos[1] &&
+                    fabsf(vertex.pos[2] + tile_offsets[t].z - origin.pos[2]) < 1e-3f;
+            }
+
+            // the quad is the one at the smallest grid coordinates, its first triangle starts with bottom right, bottom left
+            const uint32_t quad_x = min({ source[0] % width, source[1] % width, source[2] % width });
+            const uint32_t quad_z = min({ source[0] / width, source[1] / width, source[2] / width });
+            const bool is_first   = source[1] == quad_z * width + quad_x;
+            const size_t triangle = (static_cast<size_t>(quad_z) * (width - 1) + quad_x) * 2 + (is_first ? 0 : 1);
+            is_equivalent         = is_equivalent && equal(source, source + 3, indices.begin() + triangle * 3);
+            seen[triangle]++;
+        }
+    }
+    SP_CHECK(is_equivalent);
+    SP_CHECK(all_of(seen.begin(), seen.end(), [](const uint32_t count) { return count == 1; }));
+}
+
+SP_BENCHMARK(geometry_grid_tiling)
+{
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(benchmark_width, vertices, indices);
+
+    vector<vector<RHI_Vertex_PosTexNorTan>> tile_vertices;
+    vector<vector<uint32_t>> tile_indices;
+    vector<Vector3> tile_offsets;
+
+    Stopwatch stopwatch;
+    geometry_processing::split_grid_into_tiles(vertices, benchmark_width, benchmark_width, benchmark_tile_count, tile_vertices, tile_indices, tile_offsets);
+    const float time_grid = stopwatch.GetElapsedTimeMs();
+
+    stopwatch.Start();
+    geometry_processing::split_surface_into_tiles(vertices, indices, benchmark_tile_count, tile_vertices, tile_indices, tile_offsets);
+    const float time_surface = stopwatch.GetElapsedTimeMs();
+
+    printf("    %ux%u grid, %zu triangles into %ux%u tiles, grid tiler: %.0f ms, surface tiler: %.0f ms\n",
+        benchmark_width, benchmark_width, indices.size() / 3, benchmark_tile_count, benchmark_tile_count, time_grid, time_surface);
+}
+
+SP_BENCHMARK(geometry_lod_chain_2m_triangles)
+{
+    // a dense, import sized mesh, 1000x1000 quads
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_grid(1001, vertices, indices);
+
+    // five levels (including lod 0) with an exponential dropoff, like an imported model gets
+    vector<geometry_processing::LodLevel> lods;
+    const Stopwatch stopwatch;
+    geometry_processing::build_lod_chain(vertices, indices, 5, true, false, lods);
+    const float time = stopwatch.GetElapsedTimeMs();
+
+    // every level is coarser than the one before it, and further from lod 0
+    SP_CHECK(!lods.empty());
+    for (size_t i = 1; i < lods.size(); i++)
+    {
+        SP_CHECK(lods[i].indices.size() < lods[i - 1].indices.size());
+        SP_CHECK(lods[i].error >= lods[i - 1].error);
+    }
+
+    string triangles;
+    for (const geometry_processing::LodLevel& lod : lods)
+    {
+        triangles += " " + to_string(lod.indices.size() / 3);
+    }
+    printf("    %zu triangles, %zu lods in %.0f ms, triangles per lod:%s\n", indices.size() / 3, lods.size(), time, triangles.c_str());
+}
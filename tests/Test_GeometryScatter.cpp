@@ -0,0 +1,314 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "pch.h"
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "Geometry/GeometryScatter.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    struct Triangle
+    {
+        Vector3 v0;
+        Vector3 v1_minus_v0;
+        Vector3 v2_minus_v0;
+    };
+
+    struct Sample
+    {
+        Vector3 position;
+        uint32_t triangle = 0;
+    };
+
+    // runs a range of work split into chunks, the way ThreadPool::ParallelLoop does, but lets the test choose how
+    using Loop = function<void(const function<void(uint32_t, uint32_t)>&, uint32_t)>;
+
+    // a bumpy grid of 2 m quads, two triangles each, like the terrain
+    vector<Triangle> create_terrain(const uint32_t quads)
+    {
+        const float spacing = 2.0f;
+        auto height         = [](const float x, const float z) { return sinf(x * 0.05f) * 10.0f + cosf(z * 0.03f) * 8.0f; };
+
+        vector<Triangle> triangles;
+        for (uint32_t z = 0; z < quads; z++)
+        {
+            for (uint32_t x = 0; x < quads; x++)
+            {
+                const float x0 = x * spacing;
+                const float z0 = z * spacing;
+                const Vector3 bottom_left(x0, height(x0, z0), z0);
+                const Vector3 bottom_right(x0 + spacing, height(x0 + spacing, z0), z0);
+                const Vector3 top_left(x0, height(x0, z0 + spacing), z0 + spacing);
+                const Vector3 top_right(x0 + spacing, height(x0 + spacing, z0 + spacing), z0 + spacing);
+                triangles.push_back({ bottom_right, bottom_left - bottom_right, top_left - bottom_right });
+                triangles.push_back({ bottom_right, top_left - bottom_right, top_right - bottom_right });
+            }
+        }
+
+        return triangles;
+    }
+
+    // the same steps as the terrain's placement of meshes, with every 8th triangle (by hash) excluded
+    vector<Sample> scatter(const vector<Triangle>& triangles, const uint32_t count, const float radius, const uint64_t seed, const Loop& loop)
+    {
+        vector<uint32_t> acceptable;
+        float min_x    = numeric_limits<float>::max();
+        float min_z    = numeric_limits<float>::max();
+        float max_x    = numeric_limits<float>::lowest();
+        float max_z    = numeric_limits<float>::lowest();
+        float overhang = 0.0f;
+        for (uint32_t i = 0; i < triangles.size(); i++)
+        {
+            if ((geometry_scatter::hash(99, i) & 7) == 0)
+                continue;
+
+            const Triangle& triangle = triangles[i];
+            const Vector3 center     = triangle.v0 + (triangle.v1_minus_v0 + triangle.v2_minus_v0) / 3.0f;
+            min_x                    = min(min_x, center.x);
+            min_z                    = min(min_z, center.z);
+            max_x                    = max(max_x, center.x);
+            max_z                    = max(max_z, center.z);
+            for (const Vector3& vertex : { triangle.v0, triangle.v0 + triangle.v1_minus_v0, triangle.v0 + triangle.v2_minus_v0 })
+            {
+                overhang = max(overhang, Vector2(vertex.x - center.x, vertex.z - center.z).Length());
+            }
+            acceptable.push_back(i);
+        }
+
+        const geometry_scatter::Tiling tiling = geometry_scatter::create_tiling(min_x, min_z, max_x, max_z, radius, overhang);
+        const uint32_t tile_count             = tiling.GetTileCount();
+        vector<uint32_t> tile_triangle_counts(tile_count, 0);
+        vector<uint32_t> tile_triangle_offsets(tile_count + 1, 0);
+        vector<uint32_t> tile_triangles(acceptable.size());
+        vector<uint32_t> triangle_tiles(acceptable.size());
+        for (size_t i = 0; i < acceptable.size(); i++)
+        {
+            const Triangle& triangle = triangles[acceptable[i]];
+            const Vector3 center     = triangle.v0 + (triangle.v1_minus_v0 + triangle.v2_minus_v0) / 3.0f;
+            triangle_tiles[i]        = tiling.GetTileIndex(center.x, center.z);
+            tile_triangle_counts[triangle_tiles[i]]++;
+        }
+        for (uint32_t i = 0; i < tile_count; i++)
+        {
+            tile_triangle_offsets[i + 1] = tile_triangle_offsets[i] + tile_triangle_counts[i];
+        }
+        vector<uint32_t> tile_cursors(tile_triangle_offsets.begin(), tile_triangle_offsets.end() - 1);
+        for (size_t i = 0; i < acceptable.size(); i++)
+        {
+            tile_triangles[tile_cursors[triangle_tiles[i]]++] = acceptable[i];
+        }
+
+        vector<uint32_t> tile_targets;
+        geometry_scatter::distribute(count, tile_triangle_counts, tile_targets);
+
+        vector<uint32_t> tile_sample_offsets(tile_count + 1, 0);
+        for (uint32_t i = 0; i < tile_count; i++)
+        {
+            tile_sample_offsets[i + 1] = tile_sample_offsets[i] + tile_targets[i];
+        }
+        vector<uint32_t> tile_sample_counts(tile_count, 0);
+        vector<Sample> samples(tile_sample_offsets.back());
+
+        for (uint32_t phase = 0; phase < geometry_scatter::phase_count; phase++)
+        {
+            vector<uint32_t> phase_tiles;
+            for (uint32_t i = 0; i < tile_count; i++)
+            {
+                if (tiling.GetPhase(i) == phase && tile_targets[i] > 0)
+                {
+                    phase_tiles.push_back(i);
+                }
+            }
+
+            // like the terrain, a phase with one tile or none doesn't go through the loop
+            auto sample_tiles = [&](uint32_t start_index, uint32_t end_index)
+            {
+                vector<geometry_scatter::Cell> grid;
+                for (uint32_t i = start_index; i < end_index; i++)
+                {
+                    const uint32_t tile_index = phase_tiles[i];
+                    const uint32_t* tile_tris = &tile_triangles[tile_triangle_offsets[tile_index]];
+                    mt19937 generator(static_cast<uint32_t>(geometry_scatter::hash(seed, tile_index)));
+                    uniform_int_distribution<uint32_t> triangle_dist(0, tile_triangle_counts[tile_index] - 1);
+                    uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+                    uint32_t triangle = 0;
+                    auto candidate    = [&](Vector3& position)
+                    {
+                        triangle            = tile_tris[triangle_dist(generator)];
+                        const Triangle& tri = triangles[triangle];
+                        const float sqrt_r1 = sqrtf(dist(generator));
+                        const float u       = 1.0f - sqrt_r1;
+                        const float v       = dist(generator) * sqrt_r1;
+                        position            = tri.v0 + u * tri.v1_minus_v0 + v * tri.v2_minus_v0;
+                        return true;
+                    };
+                    auto accept = [&](const Vector3& position) { return Sample{ position, triangle }; };
+
+                    tile_sample_counts[tile_index] = geometry_scatter::sample_tile(
+                        tiling, tile_index, tile_targets[tile_index], tile_targets[tile_index] * 4 + 16,
+                        samples.data(), tile_sample_offsets, tile_sample_counts,
+                        candidate, accept, grid
+                    );
+                }
+            };
+
+            const uint32_t phase_tile_count = static_cast<uint32_t>(phase_tiles.size());
+            if (phase_tile_count > 1)
+            {
+                loop(sample_tiles, phase_tile_count);
+            }
+            else if (phase_tile_count == 1)
+            {
+                sample_tiles(0, phase_tile_count);
+            }
+        }
+
+        vector<Sample> result;
+        for (uint32_t i = 0; i < tile_count; i++)
+        {
+            result.insert(result.end(), samples.begin() + tile_sample_offsets[i], samples.begin() + tile_sample_offsets[i] + tile_sample_counts[i]);
+        }
+
+        return result;
+    }
+
+    // chunks of a few tiles, run in a shuffled order on the calling thread
+    Loop create_shuffled_loop(const uint32_t seed)
+    {
+        return [seed](const function<void(uint32_t, uint32_t)>& function, const uint32_t work_total)
+        {
+            vector<pair<uint32_t, uint32_t>> chunks;
+            for (uint32_t start = 0; start < work_total; start += 3)
+            {
+                chunks.emplace_back(start, min(start + 3, work_total));
+            }
+            shuffle(chunks.begin(), chunks.end(), mt19937(seed));
+
+            for (const auto& [start, end] : chunks)
+            {
+                function(start, end);
+            }
+        };
+    }
+
+    bool is_identical(const vector<Sample>& a, const vector<Sample>& b)
+    {
+        return a.size() == b.size() && equal(a.begin(), a.end(), b.begin(), [](const Sample& x, const Sample& y)
+        {
+            return x.position.x == y.position.x && x.position.y == y.position.y && x.position.z == y.position.z && x.triangle == y.triangle;
+        });
+    }
+
+    // the smallest horizontal distance between any two samples, through buckets as large as the radius
+    float get_distance_min(const vector<Sample>& samples, const float radius)
+    {
+        auto get_key = [](const int64_t x, const int64_t z) { return (x << 32) ^ (z & 0xFFFFFFFF); };
+        unordered_map<int64_t, vector<uint32_t>> buckets;
+        for (uint32_t i = 0; i < samples.size(); i++)
+        {
+            buckets[get_key(static_cast<int64_t>(floorf(samples[i].position.x / radius)), static_cast<int64_t>(floorf(samples[i].position.z / radius)))].push_back(i);
+        }
+
+        float distance_min = numeric_limits<float>::max();
+        for (uint32_t i = 0; i < samples.size(); i++)
+        {
+            const int64_t x = static_cast<int64_t>(floorf(samples[i].position.x / radius));
+            const int64_t z = static_cast<int64_t>(floorf(samples[i].position.z / radius));
+            for (int64_t dz = -1; dz <= 1; dz++)
+            {
+                for (int64_t dx = -1; dx <= 1; dx++)
+                {
+                    auto it = buckets.find(get_key(x + dx, z + dz));
+                    if (it == buckets.end())
+                        continue;
+
+                    for (const uint32_t j : it->second)
+                    {
+                        if (j != i)
+                        {
+                            distance_min = min(distance_min, Vector2(samples[i].position.x - samples[j].position.x, samples[i].position.z - samples[j].position.z).Length());
+                        }
+                    }
+                }
+            }
+        }
+
+        return distance_min;
+    }
+}
+
+SP_TEST(geometry_scatter_is_deterministic_across_threads_and_chunk_orders)
+{
+    const vector<Triangle> triangles = create_terrain(300);
+    const Loop loop_pool             = [](const function<void(uint32_t, uint32_t)>& function, const uint32_t work_total) { ThreadPool::ParallelLoop(std::function<void(uint32_t, uint32_t)>(function), work_total); };
+
+    for (const auto& [count, radius] : { pair<uint32_t, float>(5000, 6.0f), pair<uint32_t, float>(50000, 1.5f) })
+    {
+        const vector<Sample> reference = scatter(triangles, count, radius, 3, create_shuffled_loop(0));
+        SP_CHECK(!reference.empty() && reference.size() <= count);
+        SP_CHECK(is_identical(reference, scatter(triangles, count, radius, 3, create_shuffled_loop(1))));
+        SP_CHECK(is_identical(reference, scatter(triangles, count, radius, 3, create_shuffled_loop(2))));
+        SP_CHECK(is_identical(reference, scatter(triangles, count, radius, 3, loop_pool)));
+
+        // a different seed places them elsewhere
+        SP_CHECK(!is_identical(reference, scatter(triangles, count, radius, 4, loop_pool)));
+    }
+}
+
+SP_TEST(geometry_scatter_keeps_the_minimum_distance)
+{
+    const vector<Triangle> triangles = create_terrain(300);
+    for (const auto& [count, radius] : { pair<uint32_t, float>(5000, 6.0f), pair<uint32_t, float>(50000, 1.5f), pair<uint32_t, float>(1000000, 0.5f) })
+    {
+        const vector<Sample> samples = scatter(triangles, count, radius, 7, create_shuffled_loop(0));
+        SP_CHECK(samples.size() > count / 2); // even the dense case places most of what it asked for
+        SP_CHECK(get_distance_min(samples, radius) >= radius);
+    }
+}
+
+SP_TEST(geometry_scatter_handles_phases_with_one_tile_or_none)
+{
+    // a handful of targets leaves most tiles, and so most phases, without any
+    const vector<Triangle> triangles = create_terrain(300);
+    const Loop loop_pool             = [](const function<void(uint32_t, uint32_t)>& function, const uint32_t work_total) { ThreadPool::ParallelLoop(std::function<void(uint32_t, uint32_t)>(function), work_total); };
+
+    for (const uint32_t count : { 1u, 2u, 3u, 5u })
+    {
+        const vector<Sample> reference = scatter(triangles, count, 6.0f, 3, create_shuffled_loop(0));
+        SP_CHECK(!reference.empty() && reference.size() <= count);
+        SP_CHECK(is_identical(reference, scatter(triangles, count, 6.0f, 3, loop_pool)));
+    }
+
+    // a tiling of a single tile
+    const vector<Triangle> patch = create_terrain(2);
+    const vector<Sample> samples = scatter(patch, 1, 10.0f, 3, loop_pool);
+    SP_CHECK(samples.size() == 1);
+}
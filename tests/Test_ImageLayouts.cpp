@@ -0,0 +1,189 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ================
+#include "pch.h"
+#include "Test.h"
+#include "RHI/RHI_Definitions.h"
+//===========================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    const uint32_t image_count  = 512;
+    const uint32_t thread_count = 4;
+    const uint32_t pass_count   = 2000; // per thread, a pass moves every image through a few layouts
+
+    // how layouts were tracked before, a map from the image to its layouts, behind a mutex, with a lookup per mip
+    class LayoutsMapped
+    {
+    public:
+        RHI_Image_Layout Get(void* image, const uint32_t mip)
+        {
+            lock_guard<mutex> lock(m_mutex);
+            auto it = m_layouts.find(image);
+            return it == m_layouts.end() ? RHI_Image_Layout::Max : it->second[mip];
+        }
+
+        void Set(void* image, const uint32_t mip_index, const uint32_t mip_range, const RHI_Image_Layout layout)
+        {
+            lock_guard<mutex> lock(m_mutex);
+            auto it = m_layouts.find(image);
+            if (it == m_layouts.end())
+            {
+                array<RHI_Image_Layout, rhi_max_mip_count> layouts;
+                layouts.fill(RHI_Image_Layout::Max);
+                it = m_layouts.emplace(image, layouts).first;
+            }
+
+            for (uint32_t i = mip_index; i < mip_index + mip_range; i++)
+            {
+                it->second[i] = layout;
+            }
+        }
+
+    private:
+        unordered_map<void*, array<RHI_Image_Layout, rhi_max_mip_count>> m_layouts;
+        mutex m_mutex;
+    };
+
+    // the decision InsertBarrier makes: read the layout of every mip in the range, skip the mips already in the new
+    // layout, count the barriers the rest need, then record the new layout, returns the barrier count
+    template<typename Get, typename Set>
+    uint32_t decide(const uint32_t mip_range, const RHI_Image_Layout layout_new, Get&& get, Set&& set)
+    {
+        array<RHI_Image_Layout, rhi_max_mip_count> layouts_old;
+        bool all_mips_match = true;
+        for (uint32_t i = 0; i < mip_range; i++)
+        {
+            layouts_old[i] = get(i);
+            all_mips_match = all_mips_match && layouts_old[i] == layout_new;
+        }
+        if (all_mips_match)
+            return 0;
+
+        uint32_t barrier_count = 0;
+        for (uint32_t i = 0; i < mip_range; i++)
+        {
+            barrier_count += layouts_old[i] != layout_new ? 1 : 0;
+        }
+        set(layout_new);
+
+        return barrier_count;
+    }
+
+    // every thread walks its own share of the images through the layouts a frame would, returns decisions per second
+    template<typename Record>
+    double run(Record&& record)
+    {
+        const RHI_Image_Layout sequence[] = { RHI_Image_Layout::Attachment, RHI_Image_Layout::Shader_Read, RHI_Image_Layout::General, RHI_Image_Layout::Shader_Read };
+
+        const Stopwatch stopwatch;
+        vector<thread> threads;
+        atomic<uint64_t> barrier_total = 0; // consumed, so the decisions can't be optimized away
+        for (uint32_t t = 0; t < thread_count; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                uint64_t barrier_count = 0;
+                for (uint32_t pass = 0; pass < pass_count; pass++)
+                {
+                    for (uint32_t image = t; image < image_count; image += thread_count)
+                    {
+                        const uint32_t mip_range = 1 + image % rhi_max_mip_count;
+                        barrier_count           += record(image, mip_range, sequence[(pass + image) % size(sequence)]);
+                    }
+                }
+                barrier_total += barrier_count;
+            });
+        }
+
+        for (thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        const double decisions = static_cast<double>(pass_count) * image_count;
+        return decisions / (stopwatch.GetElapsedTimeMs() / 1000.0);
+    }
+}
+
+SP_TEST(image_layouts_start_unknown_and_track_every_mip)
+{
+    RHI_ImageLayouts layouts;
+    bool is_unknown = true;
+    for (uint32_t mip = 0; mip < rhi_max_mip_count; mip++)
+    {
+        is_unknown = is_unknown && layouts.Get(mip) == RHI_Image_Layout::Max;
+    }
+    SP_CHECK(is_unknown);
+
+    layouts.Set(0, rhi_max_mip_count, RHI_Image_Layout::Shader_Read);
+    layouts.Set(2, 3, RHI_Image_Layout::General);
+    SP_CHECK(layouts.Get(1) == RHI_Image_Layout::Shader_Read);
+    SP_CHECK(layouts.Get(2) == RHI_Image_Layout::General && layouts.Get(4) == RHI_Image_Layout::General);
+    SP_CHECK(layouts.Get(5) == RHI_Image_Layout::Shader_Read);
+
+    // a range past the last mip stops there
+    layouts.Set(rhi_max_mip_count - 1, 4, RHI_Image_Layout::Attachment);
+    SP_CHECK(layouts.Get(rhi_max_mip_count - 1) == RHI_Image_Layout::Attachment);
+
+    // a deferred decision sees what the previous one recorded, the second transition to the same layout needs nothing
+    auto get = [&layouts](const uint32_t mip) { return layouts.Get(mip); };
+    auto set = [&layouts](const RHI_Image_Layout layout) { layouts.Set(0, 4, layout); };
+    SP_CHECK(decide(4, RHI_Image_Layout::Attachment, get, set) == 4);
+    SP_CHECK(decide(4, RHI_Image_Layout::Attachment, get, set) == 0);
+
+    layouts.Reset();
+    SP_CHECK(layouts.Get(0) == RHI_Image_Layout::Max);
+}
+
+SP_BENCHMARK(image_layouts_barrier_decisions_512_images)
+{
+    // the layouts as they were, in a map behind a mutex
+    LayoutsMapped mapped;
+    vector<uint64_t> handles(image_count); // stand-ins for the images, only their addresses are used
+    const double rate_mapped = run([&](const uint32_t image, const uint32_t mip_range, const RHI_Image_Layout layout)
+    {
+        void* handle = &handles[image];
+        return decide(mip_range, layout,
+            [&](const uint32_t mip) { return mapped.Get(handle, mip); },
+            [&](const RHI_Image_Layout layout_new) { mapped.Set(handle, 0, mip_range, layout_new); }
+        );
+    });
+
+    // the layouts as they are, in the image
+    vector<RHI_ImageLayouts> layouts(image_count);
+    const double rate_owned = run([&](const uint32_t image, const uint32_t mip_range, const RHI_Image_Layout layout)
+    {
+        RHI_ImageLayouts& image_layouts = layouts[image];
+        return decide(mip_range, layout,
+            [&](const uint32_t mip) { return image_layouts.Get(mip); },
+            [&](const RHI_Image_Layout layout_new) { image_layouts.Set(0, mip_range, layout_new); }
+        );
+    });
+
+    printf("    %u images, %u threads, map and mutex: %.1f M decisions/s, in the image: %.1f M decisions/s\n", image_count, thread_count, rate_mapped / 1e6, rate_owned / 1e6);
+}
@@ -0,0 +1,175 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include "pch.h"
+#include "Test.h"
+//=====================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    const uint32_t thread_count  = 16;
+    const uint32_t message_count = 20000; // per thread
+
+    // counts the messages of every producer and checks that each one arrives in the order it was logged
+    class LoggerChecker : public ILogger
+    {
+    public:
+        void Log(const string& text, const uint32_t type) override
+        {
+            const size_t position = text.find("thread ");
+            if (position == string::npos)
+                return;
+
+            uint32_t thread  = 0;
+            uint32_t message = 0;
+            if (sscanf(text.c_str() + position, "thread %u message %u", &thread, &message) != 2 || thread >= thread_count)
+                return;
+
+            is_ordered    = is_ordered && message == next[thread];
+            next[thread]  = message + 1;
+            received     += 1;
+        }
+
+        uint32_t next[thread_count] = {};
+        uint64_t received           = 0;
+        bool is_ordered             = true;
+    };
+
+    // logs from inside the logger, an echo for every original, some of them as errors which are drained in place
+    class LoggerEchoing : public ILogger
+    {
+    public:
+        void Log(const string& text, const uint32_t type) override
+        {
+            uint32_t index = 0;
+            if (const size_t position = text.find("original "); position != string::npos && sscanf(text.c_str() + position, "original %u", &index) == 1 && index < count)
+            {
+                originals[index]++;
+                if (index % 2 == 0)
+                {
+                    SP_LOG_ERROR("echo %u", index);
+                }
+                else
+                {
+                    SP_LOG_INFO("echo %u", index);
+                }
+            }
+            else if (const size_t position = text.find("echo "); position != string::npos && sscanf(text.c_str() + position, "echo %u", &index) == 1 && index < count)
+            {
+                echoes[index]++;
+            }
+        }
+
+        static const uint32_t count = 10000; // more than the ring holds
+        uint32_t originals[count]   = {};
+        uint32_t echoes[count]      = {};
+    };
+
+    // returns the time it took the producers to log everything, in milliseconds
+    double log_from_threads()
+    {
+        const Stopwatch stopwatch;
+
+        vector<thread> threads;
+        for (uint32_t t = 0; t < thread_count; t++)
+        {
+            threads.emplace_back([t]()
+            {
+                for (uint32_t i = 0; i < message_count; i++)
+                {
+                    SP_LOG_INFO("thread %u message %u", t, i);
+                }
+            });
+        }
+
+        for (thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        return stopwatch.GetElapsedTimeMs();
+    }
+}
+
+SP_TEST(log_delivers_every_message_in_order_from_16_threads)
+{
+    Log::Initialize();
+    Log::SetLogToFile(false);
+
+    LoggerChecker checker;
+    Log::SetLogger(&checker);
+    log_from_threads();
+    Log::Flush();
+    Log::SetLogger(nullptr);
+
+    SP_CHECK(checker.received == static_cast<uint64_t>(thread_count) * message_count);
+    SP_CHECK(checker.is_ordered);
+
+    Log::SetLogToFile(true);
+    Log::Shutdown();
+}
+
+SP_TEST(log_delivers_every_message_once_to_a_logger_that_logs)
+{
+    Log::Initialize();
+    Log::SetLogToFile(false);
+
+    unique_ptr<LoggerEchoing> logger = make_unique<LoggerEchoing>();
+    Log::SetLogger(logger.get());
+    for (uint32_t i = 0; i < LoggerEchoing::count; i++)
+    {
+        SP_LOG_INFO("original %u", i);
+    }
+    Log::Flush();
+    Log::SetLogger(nullptr);
+
+    bool is_once = true;
+    for (uint32_t i = 0; i < LoggerEchoing::count; i++)
+    {
+        is_once = is_once && logger->originals[i] == 1 && logger->echoes[i] == 1;
+    }
+    SP_CHECK(is_once);
+
+    Log::SetLogToFile(true);
+    Log::Shutdown();
+}
+
+SP_BENCHMARK(log_throughput_16_threads)
+{
+    Log::Initialize();
+    Log::SetLogToFile(true);
+
+    const double time_produce = log_from_threads();
+    const Stopwatch stopwatch;
+    Log::Flush();
+    const double time_flush   = stopwatch.GetElapsedTimeMs();
+
+    const double messages = static_cast<double>(thread_count) * message_count;
+    printf("    %.0f messages to file, producers: %.1f ms (%.2f M messages/s), remaining flush: %.1f ms\n", messages, time_produce, messages / time_produce / 1000.0, time_flush);
+
+    Log::Shutdown();
+}
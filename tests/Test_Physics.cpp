@@ -0,0 +1,620 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "pch.h"
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "RHI/RHI_Vertex.h"
+#include "Physics/PhysicsWorld.h"
+#include "Physics/PhysicsCooking.h"
+#include "Resource/ResourceCache.h"
+SP_WARNINGS_OFF
+#ifdef DEBUG
+    #define _DEBUG 1
+    #undef NDEBUG
+#else
+    #define NDEBUG 1
+    #undef _DEBUG
+#endif
+#define PX_PHYSX_STATIC_LIB
+#include <physx/PxPhysicsAPI.h>
+SP_WARNINGS_ON
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace physx;
+//============================
+
+// terrain colliders: height field tiles (what the terrain uses) against triangle mesh tiles (what it used before), over the
+// same samples, the same tiling (256 quads per side) and the same split of quads, so that both describe the same surface
+namespace
+{
+    const uint32_t tile_quads = 256;
+    const float spacing       = 1.0f;
+
+    struct Surface
+    {
+        uint32_t width = 0; // samples per side
+        vector<float> heights;
+
+        float GetHeight(const uint32_t x, const uint32_t z) const { return heights[static_cast<size_t>(z) * width + x]; }
+    };
+
+    struct Colliders
+    {
+        vector<PxRigidStatic*> actors;
+        uint64_t size        = 0; // bytes, of the cooked (serialized) data
+        double time_creation = 0.0;
+    };
+
+    Surface create_surface(const uint32_t width)
+    {
+        Surface surface;
+        surface.width = width;
+        surface.heights.resize(static_cast<size_t>(width) * width);
+        for (uint32_t z = 0; z < width; z++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                surface.heights[static_cast<size_t>(z) * width + x] = sinf(x * 0.02f) * 40.0f + cosf(z * 0.015f) * 30.0f + sinf((x + z) * 0.11f) * 2.0f;
+            }
+        }
+
+        return surface;
+    }
+
+    // calls the function with the first sample and the sample count of every tile, neighbouring tiles share their edge samples
+    template<typename Function>
+    void for_each_tile(const Surface& surface, Function&& function)
+    {
+        for (uint32_t z0 = 0; z0 + 1 < surface.width; z0 += tile_quads)
+        {
+            for (uint32_t x0 = 0; x0 + 1 < surface.width; x0 += tile_quads)
+            {
+                function(x0, z0, min(tile_quads, surface.width - 1 - x0) + 1, min(tile_quads, surface.width - 1 - z0) + 1);
+            }
+        }
+    }
+
+    PxRigidStatic* create_actor(PxPhysics* physics, PxMaterial* material, const PxGeometry& geometry, const PxVec3& position)
+    {
+        PxRigidStatic* actor = physics->createRigidStatic(PxTransform(position));
+        PxShape* shape       = physics->createShape(geometry, *material, true);
+        actor->attachShape(*shape);
+        shape->release();
+        static_cast<PxScene*>(PhysicsWorld::GetScene())->addActor(*actor);
+
+        return actor;
+    }
+
+    Colliders create_height_fields(const Surface& surface, PxMaterial* material)
+    {
+        PxPhysics* physics = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+        Colliders colliders;
+        double time_cooking = 0.0;
+
+        const Stopwatch stopwatch;
+        for_each_tile(surface, [&](const uint32_t x0, const uint32_t z0, const uint32_t count_x, const uint32_t count_z)
+        {
+            float height_min = numeric_limits<float>::max();
+            float height_max = numeric_limits<float>::lowest();
+            for (uint32_t z = z0; z < z0 + count_z; z++)
+            {
+                for (uint32_t x = x0; x < x0 + count_x; x++)
+                {
+                    height_min = min(height_min, surface.GetHeight(x, z));
+                    height_max = max(height_max, surface.GetHeight(x, z));
+                }
+            }
+            const float height_scale = max((height_max - height_min) / 32767.0f, PX_MIN_HEIGHTFIELD_Y_SCALE);
+
+            // rows run along x and columns along z, the tessellation flag stays clear like the terrain's
+            vector<PxHeightFieldSample> samples(static_cast<size_t>(count_x) * count_z);
+            for (uint32_t x = 0; x < count_x; x++)
+            {
+                for (uint32_t z = 0; z < count_z; z++)
+                {
+                    PxHeightFieldSample& sample = samples[static_cast<size_t>(x) * count_z + z];
+                    sample.height               = static_cast<PxI16>((surface.GetHeight(x0 + x, z0 + z) - height_min) / height_scale + 0.5f);
+                    sample.materialIndex0       = PxBitAndByte(0);
+                    sample.materialIndex1       = PxBitAndByte(0);
+                }
+            }
+
+            PxHeightFieldDesc desc;
+            desc.format         = PxHeightFieldFormat::eS16_TM;
+            desc.nbRows         = count_x;
+            desc.nbColumns      = count_z;
+            desc.samples.data   = samples.data();
+            desc.samples.stride = sizeof(PxHeightFieldSample);
+
+            PxHeightField* height_field = PxCreateHeightField(desc);
+            PxHeightFieldGeometry geometry(height_field, PxMeshGeometryFlags(), height_scale, spacing, spacing);
+            colliders.actors.push_back(create_actor(physics, material, geometry, PxVec3(x0 * spacing, height_min, z0 * spacing)));
+            height_field->release();
+
+            // the size of what would be kept, cooked aside so that it stays out of the creation time
+            const Stopwatch stopwatch_cooking;
+            PxDefaultMemoryOutputStream stream;
+            if (PxCookHeightField(desc, stream))
+            {
+                colliders.size += stream.getSize();
+            }
+            time_cooking += stopwatch_cooking.GetElapsedTimeMs();
+        });
+        colliders.time_creation = stopwatch.GetElapsedTimeMs() - time_cooking;
+
+        return colliders;
+    }
+
+    Colliders create_triangle_meshes(const Surface& surface, PxMaterial* material)
+    {
+        PxPhysics* physics = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+        Colliders colliders;
+
+        PxCookingParams params(physics->getTolerancesScale());
+        params.meshPreprocessParams |= PxMeshPreprocessingFlag::eWELD_VERTICES;
+        params.meshWeldTolerance     = 0.01f;
+
+        const Stopwatch stopwatch;
+        for_each_tile(surface, [&](const uint32_t x0, const uint32_t z0, const uint32_t count_x, const uint32_t count_z)
+        {
+            vector<PxVec3> vertices;
+            vertices.reserve(static_cast<size_t>(count_x) * count_z);
+            for (uint32_t z = 0; z < count_z; z++)
+            {
+                for (uint32_t x = 0; x < count_x; x++)
+                {
+                    vertices.emplace_back(x * spacing, surface.GetHeight(x0 + x, z0 + z), z * spacing);
+                }
+            }
+
+            // the terrain's split, (bottom right, bottom left, top left) and (bottom right, top left, top right)
+            vector<uint32_t> indices;
+            indices.reserve(static_cast<size_t>(count_x - 1) * (count_z - 1) * 6);
+            for (uint32_t z = 0; z + 1 < count_z; z++)
+            {
+                for (uint32_t x = 0; x + 1 < count_x; x++)
+                {
+                    const uint32_t bottom_left  = z * count_x + x;
+                    const uint32_t bottom_right = bottom_left + 1;
+                    const uint32_t top_left     = bottom_left + count_x;
+                    const uint32_t top_right    = top_left + 1;
+                    indices.insert(indices.end(), { bottom_right, bottom_left, top_left, bottom_right, top_left, top_right });
+                }
+            }
+
+            PxTriangleMeshDesc desc;
+            desc.points.count     = static_cast<PxU32>(vertices.size());
+            desc.points.stride    = sizeof(PxVec3);
+            desc.points.data      = vertices.data();
+            desc.triangles.count  = static_cast<PxU32>(indices.size() / 3);
+            desc.triangles.stride = 3 * sizeof(uint32_t);
+            desc.triangles.data   = indices.data();
+
+            PxDefaultMemoryOutputStream stream;
+            if (!PxCookTriangleMesh(params, desc, stream))
+                return;
+
+            colliders.size += stream.getSize();
+            PxDefaultMemoryInputData input(stream.getData(), stream.getSize());
+            PxTriangleMesh* mesh = physics->createTriangleMesh(input);
+            PxTriangleMeshGeometry geometry(mesh);
+            colliders.actors.push_back(create_actor(physics, material, geometry, PxVec3(x0 * spacing, 0.0f, z0 * spacing)));
+            mesh->release();
+        });
+        colliders.time_creation = stopwatch.GetElapsedTimeMs();
+
+        return colliders;
+    }
+
+    void release(Colliders& colliders)
+    {
+        for (PxRigidStatic* actor : colliders.actors)
+        {
+            static_cast<PxScene*>(PhysicsWorld::GetScene())->removeActor(*actor);
+            actor->release();
+        }
+        colliders.actors.clear();
+    }
+
+    // vertical rays at pseudo random places over the surface, returns the hit heights (nan for a miss)
+    vector<float> cast_rays(const Surface& surface, const uint32_t ray_count, double& time)
+    {
+        PxScene* scene     = static_cast<PxScene*>(PhysicsWorld::GetScene());
+        const float extent = (surface.width - 1) * spacing;
+        mt19937 random(5);
+        uniform_real_distribution<float> distribution(0.01f, extent - 0.01f);
+        vector<PxVec3> origins(ray_count);
+        for (PxVec3& origin : origins)
+        {
+            origin = PxVec3(distribution(random), 1000.0f, distribution(random));
+        }
+
+        // the first query builds the scene's query structures
+        PxRaycastBuffer hit;
+        scene->raycast(origins[0], PxVec3(0.0f, -1.0f, 0.0f), 2000.0f, hit);
+
+        vector<float> heights(ray_count);
+        const Stopwatch stopwatch;
+        for (uint32_t i = 0; i < ray_count; i++)
+        {
+            heights[i] = scene->raycast(origins[i], PxVec3(0.0f, -1.0f, 0.0f), 2000.0f, hit, PxHitFlag::eDEFAULT | PxHitFlag::eMESH_BOTH_SIDES) ? hit.block.position.y : numeric_limits<float>::quiet_NaN();
+        }
+        time = stopwatch.GetElapsedTimeMs();
+
+        return heights;
+    }
+
+    // the height fields and the triangle meshes of a surface, compared, returns the largest difference between their hits
+    float compare(const uint32_t width, const uint32_t ray_count, const bool print)
+    {
+        const Surface surface = create_surface(width);
+        PxMaterial* material  = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics())->createMaterial(0.5f, 0.5f, 0.1f);
+
+        double time_height_field              = 0.0;
+        Colliders height_fields               = create_height_fields(surface, material);
+        const vector<float> hits_height_field = cast_rays(surface, ray_count, time_height_field);
+        const size_t tile_count               = height_fields.actors.size();
+        release(height_fields);
+
+        double time_mesh              = 0.0;
+        Colliders meshes              = create_triangle_meshes(surface, material);
+        const vector<float> hits_mesh = cast_rays(surface, ray_count, time_mesh);
+        release(meshes);
+
+        material->release();
+
+        float difference_max = 0.0f;
+        for (uint32_t i = 0; i < ray_count; i++)
+        {
+            difference_max = (isnan(hits_height_field[i]) || isnan(hits_mesh[i])) ? numeric_limits<float>::infinity() : max(difference_max, fabsf(hits_height_field[i] - hits_mesh[i]));
+        }
+
+        if (print)
+        {
+            printf("    %ux%u samples in %zu tiles, %u rays\n", width, width, tile_count, ray_count);
+            printf("    height fields:   creation %7.1f ms, cooked size %7.1f MB, %6.2f M rays/s\n", height_fields.time_creation, height_fields.size / (1024.0 * 1024.0), ray_count / time_height_field / 1000.0);
+            printf("    triangle meshes: cooking %7.1f ms, cooked size %7.1f MB, %6.2f M rays/s\n", meshes.time_creation, meshes.size / (1024.0 * 1024.0), ray_count / time_mesh / 1000.0);
+            printf("    largest height difference between the two: %.4f m\n", difference_max);
+        }
+
+        return difference_max;
+    }
+}
+
+// mesh colliders: the cooking cache, in a directory of its own, against meshes which are cooked, loaded and evicted
+namespace
+{
+    struct CacheDirectory
+    {
+        CacheDirectory()
+        {
+            directory_previous = ResourceCache::GetResourceDirectory(ResourceDirectory::Cache);
+            directory          = (filesystem::temp_directory_path() / "spartan_tests_physics_cache").string();
+            filesystem::remove_all(directory);
+            ResourceCache::AddResourceDirectory(ResourceDirectory::Cache, directory);
+        }
+
+        ~CacheDirectory()
+        {
+            ResourceCache::AddResourceDirectory(ResourceDirectory::Cache, directory_previous);
+            filesystem::remove_all(directory);
+        }
+
+        string directory;
+        string directory_previous;
+    };
+
+    // a bumpy grid, dense enough to be simplified before it's cooked
+    void create_mesh(const uint32_t width, vector<RHI_Vertex_PosTexNorTan>& vertices, vector<uint32_t>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+        for (uint32_t z = 0; z < width; z++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float height = sinf(x * 0.3f) * 2.0f + cosf(z * 0.2f) * 1.5f;
+                vertices.emplace_back(math::Vector3(static_cast<float>(x), height, static_cast<float>(z)), math::Vector2(0.0f, 0.0f));
+            }
+        }
+
+        for (uint32_t z = 0; z + 1 < width; z++)
+        {
+            for (uint32_t x = 0; x + 1 < width; x++)
+            {
+                const uint32_t bottom_left  = z * width + x;
+                const uint32_t bottom_right = bottom_left + 1;
+                const uint32_t top_left     = bottom_left + width;
+                const uint32_t top_right    = top_left + 1;
+                indices.insert(indices.end(), { bottom_right, bottom_left, top_left, bottom_right, top_left, top_right });
+            }
+        }
+    }
+
+    // the way the physics component does it, on a worker, waited on through the task's future
+    void* get_mesh(vector<uint32_t> indices, vector<RHI_Vertex_PosTexNorTan> vertices, const math::Vector3& scale, const bool is_static, bool& is_consumed)
+    {
+        const size_t index_count = indices.size();
+        void* mesh               = nullptr;
+        future<void> cooking     = ThreadPool::AddTask([&]()
+        {
+            mesh = physics_cooking::get_mesh(indices, vertices, scale, is_static);
+        });
+        cooking.wait();
+
+        // a hit returns before the geometry is simplified
+        is_consumed = indices.size() != index_count;
+
+        return mesh;
+    }
+
+    void release(void* mesh)
+    {
+        if (mesh)
+        {
+            static_cast<PxBase*>(mesh)->release();
+        }
+    }
+}
+
+// simulation: columns of boxes falling onto a plane, stepped through the scene's dispatcher (the thread pool)
+namespace
+{
+    const float box_extent = 0.5f; // half
+
+    struct Stack
+    {
+        PxScene* scene        = nullptr;
+        PxMaterial* material  = nullptr;
+        PxRigidStatic* ground = nullptr;
+        vector<PxRigidDynamic*> bodies;
+    };
+
+    // columns of ten boxes, a little apart, so that they fall, land and settle
+    Stack create_stack(PxScene* scene, const uint32_t body_count)
+    {
+        PxPhysics* physics = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+        Stack stack;
+        stack.scene    = scene;
+        stack.material = physics->createMaterial(0.5f, 0.5f, 0.1f);
+        stack.ground   = PxCreatePlane(*physics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *stack.material);
+        scene->addActor(*stack.ground);
+
+        const uint32_t height  = 10;
+        const uint32_t columns = static_cast<uint32_t>(ceilf(sqrtf(static_cast<float>((body_count + height - 1) / height))));
+        const PxBoxGeometry geometry(box_extent, box_extent, box_extent);
+        for (uint32_t i = 0; i < body_count; i++)
+        {
+            const uint32_t column = i / height;
+            const PxVec3 position(
+                (column % columns) * box_extent * 3.0f,
+                box_extent + (i % height) * box_extent * 2.2f + 0.5f,
+                (column / columns) * box_extent * 3.0f
+            );
+            PxRigidDynamic* body = PxCreateDynamic(*physics, PxTransform(position), geometry, *stack.material, 10.0f);
+            scene->addActor(*body);
+            stack.bodies.push_back(body);
+        }
+
+        return stack;
+    }
+
+    void release(Stack& stack)
+    {
+        for (PxRigidDynamic* body : stack.bodies)
+        {
+            stack.scene->removeActor(*body);
+            body->release();
+        }
+        stack.bodies.clear();
+        stack.scene->removeActor(*stack.ground);
+        stack.ground->release();
+        stack.material->release();
+    }
+
+    // returns the average time of a step, in milliseconds
+    double step(PxScene* scene, const uint32_t step_count)
+    {
+        const Stopwatch stopwatch;
+        for (uint32_t i = 0; i < step_count; i++)
+        {
+            scene->simulate(1.0f / 60.0f);
+            scene->fetchResults(true);
+        }
+
+        return stopwatch.GetElapsedTimeMs() / step_count;
+    }
+
+    // every body above the ground and at rest, within a tolerance
+    bool is_settled(const Stack& stack)
+    {
+        for (const PxRigidDynamic* body : stack.bodies)
+        {
+            if (body->getGlobalPose().p.y < box_extent * 0.9f || body->getLinearVelocity().magnitude() > 0.5f)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+SP_TEST(physics_height_fields_match_triangle_meshes)
+{
+    PhysicsWorld::Initialize();
+
+    // two tiles per side, so rays also land on the shared edges, the difference is the quantization of the heights
+    SP_CHECK(compare(2 * tile_quads + 1, 10'000, false) < 0.01f);
+
+    PhysicsWorld::Shutdown();
+}
+
+SP_BENCHMARK(physics_height_fields_against_triangle_meshes)
+{
+    PhysicsWorld::Initialize();
+
+    // a terrain of 2049x2049 samples at a meter apart, 8x8 tiles
+    SP_CHECK(compare(8 * tile_quads + 1, 1'000'000, true) < 0.01f);
+
+    PhysicsWorld::Shutdown();
+}
+
+SP_TEST(physics_cooking_cache_cooks_once_and_hits_after)
+{
+    PhysicsWorld::Initialize();
+    const CacheDirectory cache;
+
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_mesh(64, vertices, indices);
+    const math::Vector3 scale(1.0f, 2.0f, 1.0f);
+    const uint64_t key = physics_cooking::compute_key(vertices, indices, scale, true);
+
+    // cold, it's cooked and written
+    SP_CHECK(!filesystem::exists(physics_cooking::get_path(key)));
+    SP_CHECK(!physics_cooking::load(key, true));
+    bool is_consumed = false;
+    void* mesh       = get_mesh(indices, vertices, scale, true, is_consumed);
+    SP_CHECK(mesh && is_consumed);
+    SP_CHECK(filesystem::exists(physics_cooking::get_path(key)));
+    release(mesh);
+
+    // warm, it's read back without cooking
+    mesh = get_mesh(indices, vertices, scale, true, is_consumed);
+    SP_CHECK(mesh && !is_consumed);
+    SP_CHECK(static_cast<PxBase*>(mesh)->is<PxTriangleMesh>());
+    release(mesh);
+
+    // anything that affects the cooked mesh changes the key
+    vector<RHI_Vertex_PosTexNorTan> vertices_moved = vertices;
+    vertices_moved[7].pos[1]                      += 0.5f;
+    SP_CHECK(physics_cooking::compute_key(vertices_moved, indices, scale, true) != key);
+    SP_CHECK(physics_cooking::compute_key(vertices, indices, math::Vector3(1.0f, 2.5f, 1.0f), true) != key);
+    SP_CHECK(physics_cooking::compute_key(vertices, indices, scale, false) != key);
+    SP_CHECK(!physics_cooking::load(physics_cooking::compute_key(vertices, indices, scale, false), false));
+
+    // a damaged file is a miss, and is replaced by the mesh cooked for it
+    {
+        ofstream file(physics_cooking::get_path(key), ios::binary | ios::trunc);
+        file << "not a cooked mesh";
+    }
+    SP_CHECK(!physics_cooking::load(key, true));
+    mesh = get_mesh(indices, vertices, scale, true, is_consumed);
+    SP_CHECK(mesh && is_consumed);
+    release(mesh);
+    mesh = physics_cooking::load(key, true);
+    SP_CHECK(mesh);
+    release(mesh);
+
+    PhysicsWorld::Shutdown();
+}
+
+SP_TEST(physics_cooking_cache_evicts_the_least_recently_used)
+{
+    PhysicsWorld::Initialize();
+    const CacheDirectory cache;
+
+    vector<RHI_Vertex_PosTexNorTan> vertices;
+    vector<uint32_t> indices;
+    create_mesh(64, vertices, indices);
+
+    // three meshes, written a minute apart, oldest first
+    uint64_t keys[3] = {};
+    uint64_t size    = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const math::Vector3 scale(1.0f, static_cast<float>(i + 1), 1.0f);
+        bool is_consumed = false;
+        release(get_mesh(indices, vertices, scale, true, is_consumed));
+        keys[i] = physics_cooking::compute_key(vertices, indices, scale, true);
+        size    = max<uint64_t>(size, filesystem::file_size(physics_cooking::get_path(keys[i])));
+        filesystem::last_write_time(physics_cooking::get_path(keys[i]), filesystem::file_time_type::clock::now() - chrono::minutes(10 - i));
+    }
+
+    // within the limit, nothing goes
+    physics_cooking::evict(3 * size);
+    for (const uint64_t key : keys)
+    {
+        SP_CHECK(filesystem::exists(physics_cooking::get_path(key)));
+    }
+
+    // loading the oldest makes the second one the least recently used
+    release(physics_cooking::load(keys[0], true));
+    physics_cooking::evict(2 * size);
+    SP_CHECK(filesystem::exists(physics_cooking::get_path(keys[0])));
+    SP_CHECK(!filesystem::exists(physics_cooking::get_path(keys[1])));
+    SP_CHECK(filesystem::exists(physics_cooking::get_path(keys[2])));
+
+    PhysicsWorld::Shutdown();
+}
+
+SP_TEST(physics_steps_through_the_thread_pool)
+{
+    PhysicsWorld::Initialize();
+    PxScene* scene = static_cast<PxScene*>(PhysicsWorld::GetScene());
+    SP_CHECK(scene->getCpuDispatcher()->getWorkerCount() == ThreadPool::GetThreadCount());
+
+    // three seconds of simulation, the boxes land and settle on the plane instead of falling through it
+    Stack stack = create_stack(scene, 1000);
+    step(scene, 180);
+    SP_CHECK(is_settled(stack));
+    release(stack);
+
+    PhysicsWorld::Shutdown();
+}
+
+SP_BENCHMARK(physics_10k_bodies_thread_pool_against_physx_threads)
+{
+    PhysicsWorld::Initialize();
+    PxPhysics* physics   = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+    const uint32_t count = 10'000;
+    const uint32_t steps = 300;
+
+    // the engine's scene, whose tasks run on the thread pool
+    PxScene* scene_pool  = static_cast<PxScene*>(PhysicsWorld::GetScene());
+    Stack stack_pool     = create_stack(scene_pool, count);
+    const double ms_pool = step(scene_pool, steps);
+    SP_CHECK(is_settled(stack_pool));
+    release(stack_pool);
+
+    // the same scene with physx's own threads, as many as the pool has
+    PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(max(ThreadPool::GetThreadCount(), 1u));
+    PxSceneDesc scene_desc(physics->getTolerancesScale());
+    scene_desc.gravity        = scene_pool->getGravity();
+    scene_desc.cpuDispatcher  = dispatcher;
+    scene_desc.filterShader   = PxDefaultSimulationFilterShader;
+    scene_desc.flags         |= PxSceneFlag::eENABLE_CCD;
+    PxScene* scene_physx      = physics->createScene(scene_desc);
+    Stack stack_physx         = create_stack(scene_physx, count);
+    const double ms_physx     = step(scene_physx, steps);
+    SP_CHECK(is_settled(stack_physx));
+    release(stack_physx);
+    scene_physx->release();
+    dispatcher->release();
+
+    printf("    %u bodies, %u steps, thread pool (%u threads): %.2f ms/step, physx threads: %.2f ms/step\n", count, steps, ThreadPool::GetThreadCount(), ms_pool, ms_physx);
+
+    PhysicsWorld::Shutdown();
+}
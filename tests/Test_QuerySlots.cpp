@@ -0,0 +1,126 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============
+#include "pch.h"
+#include "Test.h"
+#include "RHI/RHI_QuerySlots.h"
+//==========================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+SP_TEST(query_slots_are_recycled_before_the_count_grows)
+{
+    RHI_QuerySlotAllocator slots;
+    vector<uint32_t> allocated;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        allocated.push_back(slots.Allocate());
+    }
+    SP_CHECK(allocated == vector<uint32_t>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+    SP_CHECK(slots.GetSlotCount() == 8 && slots.GetAllocatedCount() == 8);
+
+    // freed slots come back before new ones are made
+    slots.Free(2);
+    slots.Free(5);
+    SP_CHECK(!slots.IsAllocated(2) && !slots.IsAllocated(5) && slots.IsAllocated(3));
+    SP_CHECK(slots.GetAllocatedCount() == 6);
+    const uint32_t a = slots.Allocate();
+    const uint32_t b = slots.Allocate();
+    SP_CHECK((a == 2 && b == 5) || (a == 5 && b == 2));
+    SP_CHECK(slots.GetSlotCount() == 8 && slots.GetAllocatedCount() == 8);
+    SP_CHECK(slots.Allocate() == 8);
+
+    // freeing twice, or what was never allocated, changes nothing
+    slots.Free(3);
+    slots.Free(3);
+    slots.Free(100);
+    slots.Free(RHI_QuerySlotAllocator::invalid_slot);
+    SP_CHECK(slots.GetAllocatedCount() == 8);
+    SP_CHECK(slots.Allocate() == 3);
+    SP_CHECK(slots.Allocate() == 9);
+}
+
+SP_TEST(query_slots_stay_stable_under_churn)
+{
+    // renderables come and go, the slot count only has to cover the most that were alive at once
+    RHI_QuerySlotAllocator slots;
+    mt19937 random(11);
+    vector<uint32_t> alive;
+    uint32_t alive_max = 0;
+    bool is_unique     = true;
+    for (uint32_t i = 0; i < 100'000; i++)
+    {
+        if (alive.empty() || (random() % 3 != 0 && alive.size() < 500))
+        {
+            const uint32_t slot = slots.Allocate();
+            is_unique           = is_unique && find(alive.begin(), alive.end(), slot) == alive.end();
+            alive.push_back(slot);
+        }
+        else
+        {
+            const size_t index = random() % alive.size();
+            slots.Free(alive[index]);
+            alive[index] = alive.back();
+            alive.pop_back();
+        }
+        alive_max = max(alive_max, static_cast<uint32_t>(alive.size()));
+    }
+
+    SP_CHECK(is_unique);
+    SP_CHECK(slots.GetSlotCount() == alive_max);
+    SP_CHECK(slots.GetAllocatedCount() == alive.size());
+    SP_CHECK(all_of(alive.begin(), alive.end(), [&slots](const uint32_t slot) { return slots.IsAllocated(slot); }));
+}
+
+SP_TEST(query_range_covers_only_the_written_slots)
+{
+    RHI_QueryRange written;
+    SP_CHECK(written.IsEmpty() && written.GetCount() == 0);
+
+    // slot 0 on its own is not empty
+    written.Add(0);
+    SP_CHECK(!written.IsEmpty() && written.first == 0 && written.last == 0 && written.GetCount() == 1);
+
+    // the range grows to the lowest and highest slot written, in any order
+    written.Clear();
+    for (const uint32_t slot : { 40u, 12u, 77u, 12u, 50u })
+    {
+        written.Add(slot);
+    }
+    SP_CHECK(written.first == 12 && written.last == 77 && written.GetCount() == 66);
+
+    // cleared once read back, so the next frame in flight starts over
+    written.Clear();
+    SP_CHECK(written.IsEmpty() && written.GetCount() == 0);
+    written.Add(5);
+    SP_CHECK(written.first == 5 && written.last == 5 && written.GetCount() == 1);
+
+    // each command list keeps its own range, so frames in flight don't read back each other's slots
+    RHI_QueryRange frames[2];
+    frames[0].Add(3);
+    frames[0].Add(9);
+    frames[1].Add(100);
+    SP_CHECK(frames[0].GetCount() == 7 && frames[1].GetCount() == 1 && frames[1].first == 100);
+}
@@ -0,0 +1,424 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "pch.h"
+#include "Test.h"
+#include "Core/ThreadPool.h"
+#include "Resource/ResourceCache.h"
+//==============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    // a resource that is never loaded, only its path matters to the cache
+    class SyntheticResource : public IResource
+    {
+    public:
+        SyntheticResource() : IResource(ResourceType::Texture) {}
+    };
+
+    string get_path(const uint32_t index)
+    {
+        return "project/textures/synthetic_" + to_string(index) + ".png";
+    }
+
+    shared_ptr<SyntheticResource> create_resource(const uint32_t index)
+    {
+        shared_ptr<SyntheticResource> resource = make_shared<SyntheticResource>();
+        resource->SetResourceFilePath(get_path(index));
+        return resource;
+    }
+
+    // mock resources for asynchronous loading, they count their loads instead of reading the (empty) files
+    atomic<uint32_t> mock_load_count    = 0;
+    atomic<uint32_t> mock_texture_count = 0; // textures which finished loading
+    atomic<uint32_t> mock_load_ms       = 0;
+
+    class MockTexture : public IResource
+    {
+    public:
+        MockTexture() : IResource(ResourceType::Texture) {}
+
+        void LoadFromFile(const string& file_path) override
+        {
+            mock_load_count++;
+            this_thread::sleep_for(chrono::milliseconds(mock_load_ms.load()));
+            mock_texture_count++;
+        }
+    };
+
+    class MockMaterial : public IResource
+    {
+    public:
+        MockMaterial() : IResource(ResourceType::Material) {}
+
+        void LoadFromFile(const string& file_path) override
+        {
+            textures_ready = mock_texture_count.load();
+        }
+
+        uint32_t textures_ready = 0;
+    };
+
+    // a directory of empty files, since loading requires them to exist
+    struct MockFiles
+    {
+        MockFiles()
+        {
+            directory = (filesystem::temp_directory_path() / "spartan_tests_resource_cache").string();
+            filesystem::remove_all(directory);
+            filesystem::create_directories(directory);
+            for (uint32_t i = 0; i < 128; i++)
+            {
+                ofstream(Get(i)).put(0);
+            }
+        }
+
+        ~MockFiles()
+        {
+            ResourceCache::Shutdown();
+            filesystem::remove_all(directory);
+        }
+
+        string Get(const uint32_t index) const
+        {
+            return directory + "/file_" + to_string(index) + ".bin";
+        }
+
+        string directory;
+    };
+}
+
+SP_TEST(resource_cache_finds_resources_by_path_and_id)
+{
+    ResourceCache::Shutdown();
+
+    const uint32_t count = 1000;
+    vector<shared_ptr<SyntheticResource>> resources;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        resources.push_back(ResourceCache::Cache(create_resource(i)));
+    }
+    SP_CHECK(ResourceCache::GetResourceCount() == count);
+    SP_CHECK(ResourceCache::GetResourceCount(ResourceType::Texture) == count);
+
+    // caching the same path again returns the resource which is already cached
+    SP_CHECK(ResourceCache::Cache(create_resource(7)) == resources[7]);
+    SP_CHECK(ResourceCache::GetResourceCount() == count);
+
+    bool is_found = true;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        string path_backslashes = get_path(i);
+        replace(path_backslashes.begin(), path_backslashes.end(), '/', '\\');
+
+        is_found = is_found && ResourceCache::GetByPath(get_path(i)) == resources[i];
+        is_found = is_found && ResourceCache::GetByPath(path_backslashes) == resources[i];
+        is_found = is_found && ResourceCache::GetById(resources[i]->GetObjectId()) == resources[i];
+    }
+    SP_CHECK(is_found);
+
+    // by name, the resource which was cached first wins when names repeat
+    shared_ptr<SyntheticResource> namesake = make_shared<SyntheticResource>();
+    namesake->SetResourceFilePath("project/other/synthetic_5.png");
+    ResourceCache::Cache(namesake);
+    SP_CHECK(ResourceCache::GetByName("synthetic_5", ResourceType::Texture) == resources[5]);
+    SP_CHECK(!ResourceCache::GetByName("synthetic_missing", ResourceType::Texture));
+    ResourceCache::Remove(resources[5]);
+    SP_CHECK(ResourceCache::GetByName("synthetic_5", ResourceType::Texture) == namesake);
+    ResourceCache::Remove(namesake);
+    ResourceCache::Cache(resources[5]);
+
+    ResourceCache::Remove(resources[3]);
+    SP_CHECK(!ResourceCache::GetByPath(get_path(3)));
+    SP_CHECK(!ResourceCache::GetById(resources[3]->GetObjectId()));
+    SP_CHECK(ResourceCache::GetResourceCount() == count - 1);
+
+    ResourceCache::Shutdown();
+    SP_CHECK(ResourceCache::GetResourceCount() == 0);
+}
+
+SP_TEST(resource_cache_stays_consistent_under_concurrent_use)
+{
+    ResourceCache::Shutdown();
+
+    // eight threads race to cache the same paths, while another one keeps looking them up
+    const uint32_t thread_count = 8;
+    const uint32_t path_count   = 1000;
+    vector<vector<shared_ptr<IResource>>> winners(thread_count, vector<shared_ptr<IResource>>(path_count));
+    atomic<bool> is_done       = false;
+    atomic<bool> is_consistent = true;
+
+    thread reader([&]()
+    {
+        while (!is_done)
+        {
+            for (uint32_t i = 0; i < path_count; i += 7)
+            {
+                if (shared_ptr<IResource> resource = ResourceCache::GetByPath(get_path(i)))
+                {
+                    shared_ptr<IResource> by_id = ResourceCache::GetById(resource->GetObjectId());
+                    if (by_id && by_id != resource)
+                    {
+                        is_consistent = false;
+                    }
+                }
+            }
+        }
+    });
+
+    vector<thread> cachers;
+    for (uint32_t t = 0; t < thread_count; t++)
+    {
+        cachers.emplace_back([&winners, t]()
+        {
+            for (uint32_t i = 0; i < path_count; i++)
+            {
+                winners[t][i] = ResourceCache::Cache(static_pointer_cast<IResource>(create_resource(i)));
+            }
+        });
+    }
+    for (thread& cacher : cachers)
+    {
+        cacher.join();
+    }
+
+    // every thread got the same resource for a given path
+    bool is_unique = true;
+    for (uint32_t i = 0; i < path_count; i++)
+    {
+        for (uint32_t t = 1; t < thread_count; t++)
+        {
+            is_unique = is_unique && winners[t][i] == winners[0][i];
+        }
+    }
+    SP_CHECK(is_unique);
+
+    // half of them are removed while new paths are being cached
+    thread remover([&winners]()
+    {
+        for (uint32_t i = 0; i < path_count; i += 2)
+        {
+            ResourceCache::Remove(winners[0][i]);
+        }
+    });
+
+    cachers.clear();
+    for (uint32_t t = 0; t < 4; t++)
+    {
+        cachers.emplace_back([]()
+        {
+            for (uint32_t i = path_count; i < path_count * 2; i++)
+            {
+                ResourceCache::Cache(static_pointer_cast<IResource>(create_resource(i)));
+            }
+        });
+    }
+
+    remover.join();
+    for (thread& cacher : cachers)
+    {
+        cacher.join();
+    }
+    is_done = true;
+    reader.join();
+
+    const uint32_t count_expected = path_count * 2 - path_count / 2;
+    SP_CHECK(is_consistent);
+    SP_CHECK(ResourceCache::GetResourceCount() == count_expected);
+    SP_CHECK(ResourceCache::GetByType().size() == count_expected);
+
+    ResourceCache::Shutdown();
+}
+
+SP_TEST(resource_cache_loads_asynchronously_after_dependencies)
+{
+    ResourceCache::Shutdown();
+    const MockFiles files;
+    mock_load_count    = 0;
+    mock_texture_count = 0;
+    mock_load_ms       = 5;
+
+    // a material which waits for its four textures
+    vector<ResourceHandle<MockTexture>> textures;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        textures.push_back(ResourceCache::LoadAsync<MockTexture>(files.Get(i)));
+    }
+    ResourceHandle<MockMaterial> material = ResourceCache::LoadAsync<MockMaterial>(files.Get(10), ResourceLoadPriority::Normal, { textures[0], textures[1], textures[2], textures[3] });
+
+    atomic<uint32_t> continuation_count = 0;
+    material.Then([&continuation_count](const shared_ptr<MockMaterial>& resource) { continuation_count++; });
+    for (const ResourceHandle<MockTexture>& texture : textures)
+    {
+        texture.Wait();
+    }
+    SP_CHECK(material.Wait() && material.Get()->textures_ready == 4);
+    SP_CHECK(material.GetState() == ResourceLoadState::Loaded);
+
+    // a continuation on a finished request runs right away
+    material.Then([&continuation_count](const shared_ptr<MockMaterial>& resource) { continuation_count++; });
+    SP_CHECK(continuation_count == 2);
+
+    // a cached path completes right away, with the cached resource
+    ResourceHandle<MockTexture> cached = ResourceCache::LoadAsync<MockTexture>(files.Get(0));
+    SP_CHECK(cached.IsDone() && cached.Get() == textures[0].Get());
+
+    // requests for a path which is loading share the load
+    mock_load_count = 0;
+    vector<ResourceHandle<MockTexture>> shared;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        shared.push_back(ResourceCache::LoadAsync<MockTexture>(files.Get(20)));
+    }
+    bool is_shared = true;
+    for (const ResourceHandle<MockTexture>& handle : shared)
+    {
+        handle.Wait();
+        is_shared = is_shared && handle.GetRequest() == shared[0].GetRequest();
+    }
+    SP_CHECK(is_shared);
+    SP_CHECK(mock_load_count == 1);
+
+    // a missing file fails
+    ResourceHandle<MockTexture> missing = ResourceCache::LoadAsync<MockTexture>(files.directory + "/missing.bin");
+    missing.Wait();
+    SP_CHECK(missing.GetState() == ResourceLoadState::Failed && !missing.Get());
+}
+
+SP_TEST(resource_cache_cancels_queued_loads)
+{
+    ResourceCache::Shutdown();
+    const MockFiles files;
+    mock_texture_count = 0;
+    mock_load_ms       = 10;
+
+    // more loads than there are workers, so the last one is still queued when it's cancelled
+    vector<ResourceHandle<MockTexture>> loads;
+    for (uint32_t i = 30; i < 94; i++)
+    {
+        loads.push_back(ResourceCache::LoadAsync<MockTexture>(files.Get(i), ResourceLoadPriority::Low));
+    }
+    const bool is_cancelled = loads.back().Cancel();
+    SP_CHECK(is_cancelled);
+    SP_CHECK(loads.back().GetState() == (is_cancelled ? ResourceLoadState::Cancelled : ResourceLoadState::Loaded));
+
+    // a dependent of a cancelled request still runs
+    ResourceHandle<MockMaterial> material = ResourceCache::LoadAsync<MockMaterial>(files.Get(100), ResourceLoadPriority::Normal, { loads.back() });
+    for (const ResourceHandle<MockTexture>& load : loads)
+    {
+        load.Wait();
+    }
+    material.Wait();
+    SP_CHECK(material.GetState() == ResourceLoadState::Loaded);
+    SP_CHECK(!is_cancelled || !loads.back().Get());
+}
+
+SP_TEST(resource_cache_loads_overlapping_paths_from_many_threads)
+{
+    ResourceCache::Shutdown();
+    const MockFiles files;
+    mock_load_ms = 0;
+
+    // materials never finish before their textures, whether they are cancelled or not
+    for (uint32_t round = 0; round < 20; round++)
+    {
+        atomic<uint32_t> failure_count = 0;
+        vector<thread> threads;
+        for (uint32_t t = 0; t < 8; t++)
+        {
+            threads.emplace_back([&files, &failure_count, t]()
+            {
+                ResourceHandle<MockTexture> a         = ResourceCache::LoadAsync<MockTexture>(files.Get(t % 4));
+                ResourceHandle<MockTexture> b         = ResourceCache::LoadAsync<MockTexture>(files.Get(4 + t % 4));
+                ResourceHandle<MockMaterial> material = ResourceCache::LoadAsync<MockMaterial>(files.Get(40 + t % 4), ResourceLoadPriority::High, { a, b });
+                if (t == 7)
+                {
+                    material.Cancel();
+                }
+
+                material.Wait();
+                if (material.GetState() == ResourceLoadState::Loaded && (!a.IsDone() || !b.IsDone()))
+                {
+                    failure_count++;
+                }
+            });
+        }
+
+        for (thread& thread : threads)
+        {
+            thread.join();
+        }
+        SP_CHECK(failure_count == 0);
+
+        ThreadPool::Flush();
+        ResourceCache::Shutdown();
+    }
+}
+
+SP_BENCHMARK(resource_cache_100k)
+{
+    ResourceCache::Shutdown();
+
+    const uint32_t count = 100'000;
+    vector<shared_ptr<SyntheticResource>> resources(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        resources[i] = create_resource(i);
+    }
+
+    Stopwatch stopwatch;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ResourceCache::Cache(resources[i]);
+    }
+    const float time_cache = stopwatch.GetElapsedTimeMs();
+
+    stopwatch.Start();
+    uint32_t hit_count = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        hit_count += ResourceCache::GetByPath(get_path(i)) == resources[i] ? 1 : 0;
+    }
+    const float time_lookup = stopwatch.GetElapsedTimeMs();
+    SP_CHECK(hit_count == count);
+
+    // names aren't indexed, so a lookup visits every resource, materials and imports do one per texture
+    const uint32_t name_lookup_count = 100;
+    stopwatch.Start();
+    hit_count = 0;
+    for (uint32_t i = 0; i < name_lookup_count; i++)
+    {
+        const uint32_t index  = (i * 997) % count;
+        hit_count            += ResourceCache::GetByName("synthetic_" + to_string(index), ResourceType::Texture) == resources[index] ? 1 : 0;
+    }
+    const float time_lookup_name = stopwatch.GetElapsedTimeMs();
+    SP_CHECK(hit_count == name_lookup_count);
+
+    printf("    %u resources, cache: %.1f ms, lookup by path: %.1f ms, %u lookups by name: %.1f ms\n", count, time_cache, time_lookup, name_lookup_count, time_lookup_name);
+
+    ResourceCache::Shutdown();
+}
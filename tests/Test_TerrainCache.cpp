@@ -0,0 +1,241 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "pch.h"
+#include "Test.h"
+#include "RHI/RHI_Vertex.h"
+#include "World/Components/TerrainCache.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+//==============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+using namespace spartan::math;
+//============================
+
+namespace
+{
+    // what the terrain caches, a height map of width x width samples densified 3 times, split into tiles
+    struct TerrainData
+    {
+        vector<float> height_data;
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;
+        vector<Vector3> tile_offsets;
+        vector<vector<RHI_Vertex_PosTexNorTan>> tile_vertices;
+        vector<vector<uint32_t>> tile_indices;
+
+        TerrainData(const uint32_t width, const uint32_t tile_count)
+        {
+            const uint32_t dense_width = 3 * (width - 1) + 1;
+            height_data.resize(static_cast<size_t>(width) * width);
+            vertices.resize(static_cast<size_t>(dense_width) * dense_width);
+            indices.resize(static_cast<size_t>(dense_width - 1) * (dense_width - 1) * 6);
+            tile_offsets.resize(tile_count);
+            tile_vertices.resize(tile_count);
+            tile_indices.resize(tile_count);
+
+            // the tiles hold as much again as the whole, only the sizes matter to the cache
+            for (uint32_t i = 0; i < tile_count; i++)
+            {
+                tile_vertices[i].resize(vertices.size() / tile_count);
+                tile_indices[i].resize(indices.size() / tile_count);
+            }
+        }
+
+        void Fill(const uint32_t seed)
+        {
+            for (size_t i = 0; i < height_data.size(); i++)
+            {
+                height_data[i] = static_cast<float>((i * 7 + seed) % 1000);
+            }
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                vertices[i].pos[0] = static_cast<float>(i + seed);
+                vertices[i].tan[2] = static_cast<float>(i);
+            }
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                indices[i] = static_cast<uint32_t>(i * 3 + seed);
+            }
+            for (size_t t = 0; t < tile_vertices.size(); t++)
+            {
+                tile_offsets[t] = Vector3(static_cast<float>(t), 0.0f, static_cast<float>(seed));
+                for (size_t i = 0; i < tile_vertices[t].size(); i++)
+                {
+                    tile_vertices[t][i].pos[1] = static_cast<float>(t + i + seed);
+                }
+                for (size_t i = 0; i < tile_indices[t].size(); i++)
+                {
+                    tile_indices[t][i] = static_cast<uint32_t>(t * i + seed);
+                }
+            }
+        }
+
+        // in the order Terrain::SaveToFile() writes them
+        vector<terrain_cache::SectionData> GetSections()
+        {
+            vector<terrain_cache::SectionData> sections;
+            auto add_section = [&sections](const terrain_cache::SectionType type, const uint32_t tile_index, void* data, const uint64_t size)
+            {
+                sections.push_back({ { type, tile_index, 0, size }, static_cast<char*>(data) });
+            };
+            add_section(terrain_cache::SectionType::HeightData,  0, height_data.data(),  height_data.size()  * sizeof(float));
+            add_section(terrain_cache::SectionType::Vertices,    0, vertices.data(),     vertices.size()     * sizeof(RHI_Vertex_PosTexNorTan));
+            add_section(terrain_cache::SectionType::Indices,     0, indices.data(),      indices.size()      * sizeof(uint32_t));
+            add_section(terrain_cache::SectionType::TileOffsets, 0, tile_offsets.data(), tile_offsets.size() * sizeof(Vector3));
+            for (uint32_t i = 0; i < static_cast<uint32_t>(tile_vertices.size()); i++)
+            {
+                add_section(terrain_cache::SectionType::TileVertices, i, tile_vertices[i].data(), tile_vertices[i].size() * sizeof(RHI_Vertex_PosTexNorTan));
+                add_section(terrain_cache::SectionType::TileIndices,  i, tile_indices[i].data(),  tile_indices[i].size()  * sizeof(uint32_t));
+            }
+
+            return sections;
+        }
+
+        bool operator==(const TerrainData& other) const
+        {
+            auto equal = [](const auto& a, const auto& b)
+            {
+                return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0;
+            };
+
+            bool is_equal = equal(height_data, other.height_data) && equal(vertices, other.vertices) && equal(indices, other.indices) && equal(tile_offsets, other.tile_offsets);
+            for (size_t i = 0; is_equal && i < tile_vertices.size(); i++)
+            {
+                is_equal = equal(tile_vertices[i], other.tile_vertices[i]) && equal(tile_indices[i], other.tile_indices[i]);
+            }
+
+            return is_equal;
+        }
+    };
+
+    // the written table, pointed at another destination of the same size
+    vector<terrain_cache::SectionData> retarget(const vector<terrain_cache::SectionData>& written, TerrainData& destination)
+    {
+        vector<terrain_cache::SectionData> sections = destination.GetSections();
+        for (size_t i = 0; i < sections.size(); i++)
+        {
+            sections[i].section = written[i].section;
+        }
+
+        return sections;
+    }
+
+    // evicts the file from the operating system's cache, so that the next read comes from the disk
+    bool evict_from_os_cache(const string& file_path)
+    {
+    #ifdef _WIN32
+        // an unbuffered handle purges the cached pages of the file, once it's the only one open
+        HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        CloseHandle(file);
+        return true;
+    #else
+        // dirty pages can't be dropped, so they are written first
+        const int file = open(file_path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+        const bool evicted = fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(file);
+        return evicted;
+    #endif
+    }
+
+    struct ScratchFile
+    {
+        ScratchFile(const char* name) : path((filesystem::temp_directory_path() / name).string()) { }
+        ~ScratchFile() { filesystem::remove(path); }
+        string path;
+    };
+}
+
+SP_TEST(terrain_cache_round_trips_sections_and_rejects_truncated_files)
+{
+    const ScratchFile file("spartan_tests_terrain_cache.bin");
+
+    TerrainData saved(17, 16);
+    saved.Fill(1);
+    vector<terrain_cache::SectionData> sections = saved.GetSections();
+    terrain_cache::FileHeader header;
+    header.width             = 17;
+    header.height            = 17;
+    header.tile_count        = 16;
+    const uint64_t file_size = terrain_cache::write_sections(file.path.c_str(), header, sections);
+    SP_CHECK(file_size == filesystem::file_size(file.path));
+    SP_CHECK(header.section_count == 4 + 16 * 2);
+
+    // the sections follow the header and the table, back to back
+    SP_CHECK(sections.front().section.offset == sizeof(terrain_cache::FileHeader) + sections.size() * sizeof(terrain_cache::Section));
+    SP_CHECK(sections.back().section.offset + sections.back().section.size == file_size);
+
+    TerrainData loaded(17, 16);
+    SP_CHECK(terrain_cache::read_sections(file.path.c_str(), retarget(sections, loaded)));
+    SP_CHECK(loaded == saved);
+
+    // a section past the end of the file fails the read
+    filesystem::resize_file(file.path, file_size - 1);
+    SP_CHECK(!terrain_cache::read_sections(file.path.c_str(), retarget(sections, loaded)));
+}
+
+SP_BENCHMARK(terrain_cache_cold_and_warm_loads)
+{
+    const ScratchFile file("spartan_tests_terrain_cache_benchmark.bin");
+
+    // a 512x512 height map with the terrain's 48x48 tiles
+    const uint32_t width      = 512;
+    const uint32_t tile_count = 48 * 48;
+    TerrainData saved(width, tile_count);
+    saved.Fill(1);
+    vector<terrain_cache::SectionData> sections = saved.GetSections();
+    terrain_cache::FileHeader header;
+    header.width             = width;
+    header.height            = width;
+    header.tile_count        = tile_count;
+    const uint64_t file_size = terrain_cache::write_sections(file.path.c_str(), header, sections);
+    SP_CHECK(file_size != 0);
+
+    // cold, the first load after the file was evicted from the operating system's cache
+    TerrainData loaded(width, tile_count);
+    const bool is_evicted = evict_from_os_cache(file.path);
+    Stopwatch stopwatch;
+    SP_CHECK(terrain_cache::read_sections(file.path.c_str(), retarget(sections, loaded)));
+    const float time_cold = stopwatch.GetElapsedTimeMs();
+
+    // warm, the file is still cached
+    stopwatch.Start();
+    SP_CHECK(terrain_cache::read_sections(file.path.c_str(), retarget(sections, loaded)));
+    const float time_warm = stopwatch.GetElapsedTimeMs();
+    SP_CHECK(loaded == saved);
+
+    const double megabytes = static_cast<double>(file_size) / (1024.0 * 1024.0);
+    printf("    %.0f MB in %u sections, %u worker threads, cold%s: %.0f ms (%.0f MB/s), warm: %.0f ms (%.0f MB/s)\n",
+        megabytes, header.section_count, ThreadPool::GetThreadCount(), is_evicted ? "" : " (not evicted)",
+        time_cold, megabytes * 1000.0 / time_cold, time_warm, megabytes * 1000.0 / time_warm);
+}
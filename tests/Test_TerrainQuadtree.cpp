@@ -0,0 +1,169 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================================
+#include "pch.h"
+#include "Test.h"
+#include "World/Components/TerrainQuadtree.h"
+//============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    const uint32_t samples = 1025; // 1024 quads per side, 32x32 leaves, 6 lods
+
+    vector<float> create_heights()
+    {
+        vector<float> heights(static_cast<size_t>(samples) * samples);
+        for (uint32_t z = 0; z < samples; z++)
+        {
+            for (uint32_t x = 0; x < samples; x++)
+            {
+                heights[static_cast<size_t>(z) * samples + x] = sinf(x * 0.01f) * 50.0f + cosf(z * 0.02f) * 25.0f;
+            }
+        }
+
+        return heights;
+    }
+
+    // every quad of the height field must be drawn by exactly one node
+    bool covers_once(const vector<TerrainQuadtree::Node>& nodes)
+    {
+        const uint32_t quads = samples - 1;
+        vector<uint8_t> coverage(static_cast<size_t>(quads) * quads, 0);
+        for (const TerrainQuadtree::Node& node : nodes)
+        {
+            for (uint32_t z = node.z; z < min(node.z + node.size, quads); z++)
+            {
+                for (uint32_t x = node.x; x < min(node.x + node.size, quads); x++)
+                {
+                    coverage[static_cast<size_t>(z) * quads + x]++;
+                }
+            }
+        }
+
+        return all_of(coverage.begin(), coverage.end(), [](const uint8_t count) { return count == 1; });
+    }
+}
+
+SP_TEST(terrain_quadtree_bounds_contain_the_heights)
+{
+    const vector<float> heights = create_heights();
+    TerrainQuadtree quadtree;
+    quadtree.Build(heights.data(), samples, samples, 1.0f, 0.0f, 0.0f);
+    SP_CHECK(quadtree.GetLodCount() == 6);
+
+    // every lod, from the leaves to the root, must bound the samples under each of its nodes
+    for (uint32_t lod = 0; lod < quadtree.GetLodCount(); lod++)
+    {
+        vector<TerrainQuadtree::Node> nodes;
+        quadtree.GetNodesWithin(lod, 0.0f, 0.0f, 0.0f, numeric_limits<float>::max(), nodes);
+        SP_CHECK(nodes.size() == static_cast<size_t>(32 >> lod) * (32 >> lod));
+
+        bool contained = true;
+        for (const TerrainQuadtree::Node& node : nodes)
+        {
+            for (uint32_t z = node.z; z <= min(node.z + node.size, samples - 1); z++)
+            {
+                for (uint32_t x = node.x; x <= min(node.x + node.size, samples - 1); x++)
+                {
+                    const float height = heights[static_cast<size_t>(z) * samples + x];
+                    contained          = contained && height >= node.height_min && height <= node.height_max;
+                }
+            }
+        }
+        SP_CHECK(contained);
+    }
+}
+
+SP_TEST(terrain_quadtree_selection_covers_the_height_field)
+{
+    const vector<float> heights = create_heights();
+    TerrainQuadtree quadtree;
+    quadtree.Build(heights.data(), samples, samples, 1.0f, 0.0f, 0.0f);
+
+    // a camera flying from a corner, over the middle, to high above
+    vector<TerrainQuadtree::Node> nodes;
+    const float path[][3] = { { 0.0f, 60.0f, 0.0f }, { 300.0f, 80.0f, 700.0f }, { 512.0f, 100.0f, 512.0f }, { 1024.0f, 0.0f, 1024.0f }, { 512.0f, 5000.0f, 512.0f } };
+    for (const auto& camera : path)
+    {
+        quadtree.Select(camera[0], camera[1], camera[2], nodes);
+        SP_CHECK(covers_once(nodes));
+
+        // no node is farther than the range of its parent, beyond its own range it's morphed onto the grid of its parent
+        bool within_range = true;
+        for (const TerrainQuadtree::Node& node : nodes)
+        {
+            within_range = within_range && (node.lod + 1 == quadtree.GetLodCount() || quadtree.GetDistance(node, camera[0], camera[1], camera[2]) <= quadtree.GetRange(node.lod + 1));
+        }
+        SP_CHECK(within_range);
+    }
+
+    // close to the ground, the node under the camera is a leaf
+    quadtree.Select(300.0f, 80.0f, 700.0f, nodes);
+    SP_CHECK(any_of(nodes.begin(), nodes.end(), [](const TerrainQuadtree::Node& node)
+    {
+        return node.lod == 0 && node.x <= 300 && 300 < node.x + node.size && node.z <= 700 && 700 < node.z + node.size;
+    }));
+
+    // far above, the root alone
+    quadtree.Select(512.0f, 5000.0f, 512.0f, nodes);
+    SP_CHECK(nodes.size() == 1 && nodes[0].lod + 1 == quadtree.GetLodCount());
+
+    // nodes which can't be refined (their children aren't resident) are drawn in place of their children, still covering everything
+    quadtree.Select(300.0f, 80.0f, 700.0f, nodes, [](const TerrainQuadtree::Node& node) { return node.lod > 2; });
+    SP_CHECK(covers_once(nodes));
+    SP_CHECK(all_of(nodes.begin(), nodes.end(), [](const TerrainQuadtree::Node& node) { return node.lod >= 2; }));
+}
+
+SP_TEST(terrain_quadtree_morph_meets_the_coarser_grid)
+{
+    const float node_size = static_cast<float>(TerrainQuadtree::patch_resolution); // a leaf, a meter per quad
+    const float spacing   = node_size / TerrainQuadtree::patch_resolution;
+
+    // near the camera vertices stay where they are, at the end of the range they sit on the grid of the parent
+    bool unmorphed = true;
+    bool morphed   = true;
+    for (uint32_t i = 0; i <= TerrainQuadtree::patch_resolution; i++)
+    {
+        float x = i * spacing;
+        float z = (TerrainQuadtree::patch_resolution - i) * spacing;
+        TerrainQuadtree::MorphVertex(x, z, node_size, [](float, float) { return 0.0f; });
+        unmorphed = unmorphed && x == i * spacing && z == (TerrainQuadtree::patch_resolution - i) * spacing;
+
+        x = i * spacing;
+        z = (TerrainQuadtree::patch_resolution - i) * spacing;
+        TerrainQuadtree::MorphVertex(x, z, node_size, [node_size](float, float) { return node_size * TerrainQuadtree::range_scale; });
+        morphed = morphed && fmodf(x, 2.0f * spacing) == 0.0f && fmodf(z, 2.0f * spacing) == 0.0f && fabsf(x - i * spacing) <= spacing;
+    }
+    SP_CHECK(unmorphed);
+    SP_CHECK(morphed);
+
+    // the morph is continuous, it starts at morph_start and ends at the range
+    const float range = node_size * TerrainQuadtree::range_scale;
+    SP_CHECK(TerrainQuadtree::ComputeMorph(range * TerrainQuadtree::morph_start, node_size) == 0.0f);
+    SP_CHECK(TerrainQuadtree::ComputeMorph(range, node_size) == 1.0f);
+    SP_CHECK(fabsf(TerrainQuadtree::ComputeMorph(range * (1.0f + TerrainQuadtree::morph_start) * 0.5f, node_size) - 0.5f) < 1e-5f);
+}
@@ -0,0 +1,215 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "pch.h"
+#include "Test.h"
+#include "Rendering/TextureStreaming.h"
+//===================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    // the size of every mip of an rgba8 texture, down to 1x1
+    vector<uint64_t> get_mip_sizes(uint32_t width, uint32_t height)
+    {
+        vector<uint64_t> sizes;
+        while (true)
+        {
+            sizes.push_back(static_cast<uint64_t>(width) * height * 4);
+            if (width == 1 && height == 1)
+                break;
+
+            width  = max(1u, width / 2);
+            height = max(1u, height / 2);
+        }
+
+        return sizes;
+    }
+}
+
+SP_TEST(texture_residency_computes_mips)
+{
+    SP_CHECK(TextureResidency::ComputeTailMip(4096, 4096, 13) == 5);
+    SP_CHECK(TextureResidency::ComputeTailMip(4096, 1024, 13) == 5);
+    SP_CHECK(TextureResidency::ComputeTailMip(128, 64, 8) == 0);
+
+    SP_CHECK(TextureResidency::ComputeMip(1024, 1024, 11, 1024.0f) == 0);
+    SP_CHECK(TextureResidency::ComputeMip(1024, 1024, 11, 512.0f) == 1);
+    SP_CHECK(TextureResidency::ComputeMip(1024, 1024, 11, 300.0f) == 1); // never less than a texel per pixel
+    SP_CHECK(TextureResidency::ComputeMip(1024, 1024, 11, 0.0f) == 10);
+    SP_CHECK(TextureResidency::ComputeMip(1024, 1024, 11, 1e9f) == 0);
+    SP_CHECK(TextureResidency::ComputeMip(1024, 1024, 11, 1024.0f, 4.0f) == 2);
+}
+
+SP_TEST(texture_residency_follows_a_camera_path_within_budget)
+{
+    // textures scattered along a line, with a camera moving along it and requesting what's close
+    const uint32_t texture_count = 300;
+    TextureResidency residency;
+    vector<float> positions(texture_count);
+    vector<uint32_t> mip_counts(texture_count);
+    vector<uint32_t> mip_tails(texture_count);
+    mt19937 random(1);
+    for (uint32_t i = 0; i < texture_count; i++)
+    {
+        const uint32_t size          = 1u << (9 + random() % 4);
+        const vector<uint64_t> sizes = get_mip_sizes(size, size);
+        mip_counts[i]                = static_cast<uint32_t>(sizes.size());
+        mip_tails[i]                 = TextureResidency::ComputeTailMip(size, size, mip_counts[i]);
+        positions[i]                 = static_cast<float>(random() % 10000);
+        SP_CHECK(residency.Register(i, sizes, mip_tails[i]) == mip_tails[i]);
+    }
+    residency.SetBudget(256ull << 20);
+    residency.SetUploadLimit(32ull << 20);
+
+    auto request = [&](const float camera)
+    {
+        for (uint32_t i = 0; i < texture_count; i++)
+        {
+            const float distance = fabsf(positions[i] - camera);
+            if (distance < 400.0f)
+            {
+                residency.Request(i, TextureResidency::ComputeMip(512, 512, mip_counts[i], 20000.0f / max(distance, 1.0f)));
+            }
+        }
+    };
+
+    // the budget shrinks half way, the resident memory has to follow right away
+    vector<TextureResidency::Change> changes;
+    bool is_within_budget = true;
+    bool is_within_chain  = true;
+    for (uint32_t frame = 0; frame < 2000; frame++)
+    {
+        if (frame == 1000)
+        {
+            residency.SetBudget(64ull << 20);
+        }
+
+        request(frame * 5.0f);
+        residency.Update(changes);
+
+        const TextureResidency::Stats stats = residency.GetStats();
+        is_within_budget                    = is_within_budget && stats.resident <= stats.budget;
+        for (const TextureResidency::Change& change : changes)
+        {
+            is_within_chain = is_within_chain && change.mip_to <= mip_tails[change.id] && change.mip_from != change.mip_to;
+        }
+    }
+    SP_CHECK(is_within_budget);
+    SP_CHECK(is_within_chain);
+
+    // once the camera stops, and the budget is restored, every request is honored within a few frames
+    residency.SetBudget(256ull << 20);
+    for (uint32_t frame = 0; frame < 16; frame++)
+    {
+        request(5000.0f);
+        residency.Update(changes);
+    }
+    request(5000.0f);
+    SP_CHECK(residency.GetStats().wanted <= residency.GetBudget());
+    bool is_honored = true;
+    for (uint32_t i = 0; i < texture_count; i++)
+    {
+        const float distance = fabsf(positions[i] - 5000.0f);
+        if (distance < 400.0f)
+        {
+            const uint32_t mip = min(TextureResidency::ComputeMip(512, 512, mip_counts[i], 20000.0f / max(distance, 1.0f)), mip_tails[i]);
+            is_honored         = is_honored && residency.GetResidentMip(i) <= mip;
+        }
+    }
+    SP_CHECK(is_honored);
+}
+
+SP_TEST(texture_residency_evicts_the_least_recently_requested)
+{
+    const vector<uint64_t> sizes = get_mip_sizes(1024, 1024);
+    const uint32_t mip_tail      = TextureResidency::ComputeTailMip(1024, 1024, static_cast<uint32_t>(sizes.size()));
+
+    TextureResidency residency;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        residency.Register(i, sizes, mip_tail);
+    }
+    residency.SetBudget(sizes[0] * 5);
+    residency.SetUploadLimit(UINT64_MAX);
+
+    // texture 0 is requested before texture 1
+    vector<TextureResidency::Change> changes;
+    residency.Request(0, 0);
+    residency.Update(changes);
+    residency.Request(1, 0);
+    residency.Update(changes);
+    SP_CHECK(residency.GetResidentMip(0) == 0 && residency.GetResidentMip(1) == 0);
+
+    // room for two full chains only, so the oldest gives up its detail
+    residency.SetBudget(static_cast<uint64_t>(sizes[0] * 2.7));
+    residency.Request(2, 0);
+    residency.Update(changes);
+    SP_CHECK(residency.GetResidentMip(2) == 0);
+    SP_CHECK(residency.GetResidentMip(1) == 0);
+    SP_CHECK(residency.GetResidentMip(0) == mip_tail);
+}
+
+SP_TEST(texture_residency_limits_uploads_per_update)
+{
+    const vector<uint64_t> sizes = get_mip_sizes(2048, 2048);
+    const uint32_t mip_tail      = TextureResidency::ComputeTailMip(2048, 2048, static_cast<uint32_t>(sizes.size()));
+
+    TextureResidency residency;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        residency.Register(i, sizes, mip_tail);
+        residency.Request(i, 0);
+    }
+    residency.SetUploadLimit(32ull << 20);
+
+    // a full 2048 chain is about 21 MB, so only one fits within the limit, the others move part of the way
+    vector<TextureResidency::Change> changes;
+    residency.Update(changes);
+    uint32_t full_count = 0;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        full_count += residency.GetResidentMip(i) == 0 ? 1 : 0;
+    }
+    SP_CHECK(full_count == 1);
+    SP_CHECK(!changes.empty());
+
+    // and the rest catch up over the following updates
+    for (uint32_t frame = 0; frame < 10; frame++)
+    {
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            residency.Request(i, 0);
+        }
+        residency.Update(changes);
+    }
+    bool is_complete = true;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        is_complete = is_complete && residency.GetResidentMip(i) == 0;
+    }
+    SP_CHECK(is_complete);
+}
@@ -0,0 +1,129 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "pch.h"
+#include "Test.h"
+#include "Profiling/Trace.h"
+//============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    const char* scope_names[] = { "scope_a", "scope_b", "scope_c" };
+
+    string read_file(const string& path)
+    {
+        ifstream file(path, ios::in | ios::binary);
+        return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    uint32_t count_occurrences(const string& text, const string& pattern)
+    {
+        uint32_t count = 0;
+        for (size_t position = text.find(pattern); position != string::npos; position = text.find(pattern, position + pattern.size()))
+        {
+            count++;
+        }
+
+        return count;
+    }
+}
+
+SP_TEST(trace_exports_scopes_flows_and_counters_from_every_thread)
+{
+    Trace::Initialize();
+
+    uint64_t flow = 0;
+    {
+        TraceScope scope("trace_test_submit");
+        flow = Trace::FlowBegin("trace_test_flow");
+    }
+
+    thread([flow]()
+    {
+        Trace::SetThreadName("trace_test_worker");
+        TraceScope outer("trace_test_outer");
+        {
+            TraceScope inner("trace_test_inner");
+            Trace::FlowEnd("trace_test_flow", flow);
+        }
+    }).join();
+    Trace::Counter("trace_test_counter", 16.5);
+
+    const string path = (filesystem::temp_directory_path() / "spartan_tests_trace.json").string();
+    SP_CHECK(Trace::Export(path, 10.0));
+
+    // every scope became a complete event, the flow has both of its ends, and the worker kept its name
+    const string json = read_file(path);
+    SP_CHECK(json.find("\"traceEvents\"") != string::npos && json.rfind("]}") != string::npos);
+    SP_CHECK(count_occurrences(json, "\"ph\":\"X\",") >= 3);
+    SP_CHECK(count_occurrences(json, "\"trace_test_submit\"") == 1);
+    SP_CHECK(count_occurrences(json, "\"trace_test_outer\"") == 1);
+    SP_CHECK(count_occurrences(json, "\"trace_test_inner\"") == 1);
+    SP_CHECK(count_occurrences(json, "\"trace_test_flow\"") == 2);
+    SP_CHECK(json.find("\"trace_test_worker\"") != string::npos);
+    SP_CHECK(json.find("\"value\":16.5},\"name\":\"trace_test_counter\"") != string::npos);
+
+    filesystem::remove(path);
+}
+
+SP_BENCHMARK(trace_scope_overhead)
+{
+    Trace::Initialize();
+
+    // one thread, which is the main thread's case
+    const uint32_t scope_count = 2'000'000;
+    Stopwatch stopwatch;
+    for (uint32_t i = 0; i < scope_count; i++)
+    {
+        TraceScope scope(scope_names[i % 3]);
+    }
+    const double ns_single = stopwatch.GetElapsedTimeMs() * 1'000'000.0 / scope_count;
+
+    // eight threads with nested scopes, each records into its own buffer
+    const uint32_t thread_count     = 8;
+    const uint32_t scope_count_pair = 200'000;
+    stopwatch.Start();
+    vector<thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++)
+    {
+        threads.emplace_back([]()
+        {
+            for (uint32_t i = 0; i < scope_count_pair; i++)
+            {
+                TraceScope outer("outer");
+                TraceScope inner("inner");
+            }
+        });
+    }
+    for (thread& thread : threads)
+    {
+        thread.join();
+    }
+    const double ns_threads = stopwatch.GetElapsedTimeMs() * 1'000'000.0 / (scope_count_pair * 2.0 * thread_count);
+
+    printf("    one thread: %.1f ns per scope, %u threads: %.1f ns per scope (cpu time, summed over threads)\n", ns_single, thread_count, ns_threads);
+}
@@ -0,0 +1,112 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "pch.h"
+#include "Test.h"
+#include "Widgets/WorldHierarchy.h"
+//=================================
+
+//= NAMESPACES ===============
+using namespace std;
+//============================
+
+namespace
+{
+    const uint64_t tree_count = 50000;
+
+    // a forest of trees under one root, a camera, an inactive root with a child, and a branch under the first tree
+    vector<WorldHierarchy::Node> create_nodes()
+    {
+        vector<WorldHierarchy::Node> nodes;
+        nodes.push_back({ 1, 0, "Forest", true });
+        for (uint64_t i = 0; i < tree_count; i++)
+        {
+            nodes.push_back({ 100 + i, 1, "Tree_" + to_string(i), true });
+        }
+        nodes.push_back({ 2, 0, "Camera", true });
+        nodes.push_back({ 3, 0, "Hidden", false });
+        nodes.push_back({ 4, 3, "HiddenChild", true });
+        nodes.push_back({ 5, 100, "Branch", true });
+
+        return nodes;
+    }
+}
+
+SP_TEST(world_hierarchy_rows_follow_expansion)
+{
+    WorldHierarchy hierarchy;
+    vector<WorldHierarchy::Node> nodes = create_nodes();
+    hierarchy.Build(nodes);
+
+    // collapsed, only the active roots
+    SP_CHECK(hierarchy.GetRows().size() == 2);
+
+    hierarchy.SetExpanded(1, true);
+    const vector<WorldHierarchy::Row>& rows = hierarchy.GetRows();
+    SP_CHECK(rows.size() == 2 + tree_count);
+    SP_CHECK(hierarchy.GetNode(rows[1].node).name == "Tree_0" && rows[1].depth == 1 && rows[1].has_children);
+    SP_CHECK(hierarchy.GetNode(rows.back().node).name == "Camera");
+
+    // revealing a nested node expands its ancestors
+    hierarchy.SetExpanded(1, false);
+    hierarchy.ExpandTo(5);
+    SP_CHECK(hierarchy.IsExpanded(1) && hierarchy.IsExpanded(100));
+    SP_CHECK(hierarchy.GetRows().size() == 3 + tree_count);
+    const int32_t row_branch = hierarchy.GetRowIndex(5);
+    SP_CHECK(row_branch == 2 && hierarchy.GetRows()[row_branch].depth == 2);
+    SP_CHECK(hierarchy.GetRowIndex(4) == -1);
+
+    // a rebuild keeps the expansion state
+    nodes.pop_back();
+    hierarchy.Build(nodes);
+    SP_CHECK(hierarchy.GetRows().size() == 2 + tree_count);
+    SP_CHECK(!hierarchy.GetRows()[1].has_children);
+}
+
+SP_TEST(world_hierarchy_search_is_case_insensitive_and_incremental)
+{
+    WorldHierarchy hierarchy;
+    hierarchy.Build(create_nodes());
+
+    // 1, 10-19, 100-199, 1000-1999 and 10000-19999
+    hierarchy.SetSearch("tree_1");
+    SP_CHECK(hierarchy.IsSearching());
+    SP_CHECK(hierarchy.GetMatches().size() == 11111);
+
+    // narrowing the text, and changing its case
+    hierarchy.SetSearch("TREE_12");
+    SP_CHECK(hierarchy.GetMatches().size() == 1111);
+    hierarchy.SetSearch("tree_123");
+    SP_CHECK(hierarchy.GetMatches().size() == 111);
+    SP_CHECK(is_sorted(hierarchy.GetMatches().begin(), hierarchy.GetMatches().end()));
+
+    // not an extension of the previous text, so a full search
+    hierarchy.SetSearch("ee_1");
+    SP_CHECK(hierarchy.GetMatches().size() == 11111);
+
+    // inactive nodes can be found too
+    hierarchy.SetSearch("hidden");
+    SP_CHECK(hierarchy.GetMatches().size() == 2);
+
+    hierarchy.SetSearch("");
+    SP_CHECK(!hierarchy.IsSearching());
+}
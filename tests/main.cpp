@@ -0,0 +1,100 @@
+/*
+Copyright(c) 2015-2025 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "Test.h"
+#include "Core/ThreadPool.h"
+//=============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan;
+//============================
+
+namespace
+{
+    uint32_t failure_count = 0;
+}
+
+namespace spartan::test
+{
+    vector<Case>& get_cases()
+    {
+        static vector<Case> cases;
+        return cases;
+    }
+
+    void report_failure(const char* expression, const char* file, const int line)
+    {
+        printf("    failed: %s (%s:%d)\n", expression, file, line);
+        failure_count++;
+    }
+}
+
+// usage: tests [--benchmark] [name filter...]
+// runs every test (and with --benchmark, every benchmark as well) whose name contains one of the filters
+int main(int argc, char** argv)
+{
+    bool run_benchmarks = false;
+    vector<string> filters;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--benchmark")
+        {
+            run_benchmarks = true;
+        }
+        else
+        {
+            filters.emplace_back(argv[i]);
+        }
+    }
+
+    ThreadPool::Initialize();
+
+    uint32_t run_count    = 0;
+    uint32_t failed_count = 0;
+    for (const test::Case& test_case : test::get_cases())
+    {
+        if (test_case.is_benchmark && !run_benchmarks)
+            continue;
+
+        const string name = test_case.name;
+        if (!filters.empty() && none_of(filters.begin(), filters.end(), [&name](const string& filter) { return name.find(filter) != string::npos; }))
+            continue;
+
+        printf("%s %s\n", test_case.is_benchmark ? "[benchmark]" : "[test]", test_case.name);
+
+        const uint32_t failures_before = failure_count;
+        const Stopwatch stopwatch;
+        test_case.function();
+        const bool passed = failure_count == failures_before;
+        printf("    %s (%.1f ms)\n", passed ? "passed" : "FAILED", stopwatch.GetElapsedTimeMs());
+
+        run_count++;
+        failed_count += passed ? 0 : 1;
+    }
+
+    ThreadPool::Shutdown();
+
+    printf("%u of %u passed\n", run_count - failed_count, run_count);
+    return failed_count == 0 ? 0 : 1;
+}